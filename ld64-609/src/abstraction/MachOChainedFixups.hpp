@@ -0,0 +1,204 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __MACH_O_CHAINED_FIXUPS__
+#define __MACH_O_CHAINED_FIXUPS__
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "MachOFileAbstraction.hpp"
+
+
+namespace mach_o {
+namespace chained_fixups {
+
+//
+// One location in a chain, decoded.  Rebases have a target, binds have an
+// import ordinal and an addend to add to the import's own addend.
+//
+struct Fixup
+{
+	bool		isBind;
+	bool		isAuth;
+	uint32_t	bindOrdinal;	// index into the chained imports table
+	int64_t		addend;			// added to import's addend
+	uint64_t	target;			// unslid address a rebase points to
+	uint16_t	diversity;
+	bool		addrDiv;
+	uint8_t		key;
+};
+
+__attribute__((noreturn))
+static inline void throwMalformed(const char* format, ...)
+{
+	va_list	list;
+	char*	p;
+	va_start(list, format);
+	vasprintf(&p, format, list);
+	va_end(list);
+
+	const char*	t = p;
+	throw t;
+}
+
+//
+// Walks every chain in the LC_DYLD_CHAINED_FIXUPS payload at chainData and
+// calls handler for each fixup, in segment, page and chain order.  32-bit
+// chains may co-opt non-pointer values to make long steps; those are walked
+// but not reported.  Throws a const char* if the payload is malformed.
+//
+template <typename A>
+void forEachFixup(const uint8_t* machHeader, const uint8_t* chainData, uint32_t chainDataSize,
+				  const std::vector<const macho_segment_command<typename A::P>*>& segments, uint64_t baseAddress,
+				  const std::function<void(uint32_t segIndex, uint64_t address, const Fixup& fixup)>& handler)
+{
+	typedef typename A::P::E	E;
+
+	const uint8_t* chainDataEnd = chainData + chainDataSize;
+	const dyld_chained_fixups_header* header = (dyld_chained_fixups_header*)chainData;
+	const dyld_chained_starts_in_image* startsInImage = (dyld_chained_starts_in_image*)(chainData + header->starts_offset);
+	if ( (uint8_t*)&startsInImage->seg_info_offset[0] > chainDataEnd )
+		throw "chained fixups starts_offset out of range";
+	if ( (uint8_t*)&startsInImage->seg_info_offset[startsInImage->seg_count] > chainDataEnd )
+		throw "chained fixups segment count out of range";
+	const uint32_t segCount = std::min<uint32_t>(startsInImage->seg_count, (uint32_t)segments.size());
+	for (uint32_t segIndex=0; segIndex < segCount; ++segIndex) {
+		if ( startsInImage->seg_info_offset[segIndex] == 0 )
+			continue;
+		const macho_segment_command<typename A::P>* segCmd = segments[segIndex];
+		const dyld_chained_starts_in_segment* segInfo = (dyld_chained_starts_in_segment*)((uint8_t*)startsInImage + startsInImage->seg_info_offset[segIndex]);
+		if ( (uint8_t*)&segInfo->page_start[segInfo->page_count] > chainDataEnd )
+			throwMalformed("chained fixups for segment %s extend beyond LC_DYLD_CHAINED_FIXUPS data", segCmd->segname());
+		const uint16_t format = segInfo->pointer_format;
+		uint32_t stride;
+		bool arm64e = false;
+		switch ( format ) {
+			case DYLD_CHAINED_PTR_ARM64E:
+			case DYLD_CHAINED_PTR_ARM64E_USERLAND:
+			case DYLD_CHAINED_PTR_ARM64E_USERLAND24:
+				stride = 8;
+				arm64e = true;
+				break;
+			case DYLD_CHAINED_PTR_ARM64E_KERNEL:
+				stride = 4;
+				arm64e = true;
+				break;
+			case DYLD_CHAINED_PTR_64:
+			case DYLD_CHAINED_PTR_64_OFFSET:
+			case DYLD_CHAINED_PTR_32:
+				stride = 4;
+				break;
+			default:
+				throwMalformed("unsupported chained fixup pointer format %d in segment %s", format, segCmd->segname());
+		}
+		const bool is32 = (format == DYLD_CHAINED_PTR_32);
+		auto walkChain = [&](uint64_t segOffset) {
+			uint64_t next;
+			do {
+				if ( segOffset + (is32 ? sizeof(uint32_t) : sizeof(uint64_t)) > segCmd->filesize() )
+					throwMalformed("chained fixup at offset 0x%llX beyond end of segment %s", segOffset, segCmd->segname());
+				const uint8_t* location = machHeader + segCmd->fileoff() + segOffset;
+				Fixup fixup = { false, false, 0, 0, 0, 0, false, 0 };
+				bool isPointer = true;
+				if ( is32 ) {
+					const uint32_t value = E::get32(*(uint32_t*)location);
+					next = (value >> 26) & 0x1F;
+					fixup.isBind = (value >> 31) != 0;
+					if ( fixup.isBind ) {
+						fixup.bindOrdinal = value & 0xFFFFF;
+						fixup.addend      = (value >> 20) & 0x3F;
+					}
+					else {
+						fixup.target = value & 0x3FFFFFF;
+						// larger values are non-pointers that dyld does not slide
+						isPointer = (fixup.target <= segInfo->max_valid_pointer);
+					}
+				}
+				else {
+					const uint64_t value = E::get64(*(uint64_t*)location);
+					if ( arm64e ) {
+						fixup.isAuth = (value >> 63) != 0;
+						fixup.isBind = ((value >> 62) & 1) != 0;
+						next = (value >> 51) & 0x7FF;
+						if ( fixup.isAuth ) {
+							fixup.diversity = (uint16_t)(value >> 32);
+							fixup.addrDiv   = ((value >> 48) & 1) != 0;
+							fixup.key       = (value >> 49) & 3;
+						}
+						if ( fixup.isBind ) {
+							fixup.bindOrdinal = (format == DYLD_CHAINED_PTR_ARM64E_USERLAND24) ? (value & 0xFFFFFF) : (value & 0xFFFF);
+							if ( !fixup.isAuth )
+								fixup.addend = ((int64_t)(value << 13)) >> 45;		// signed 19-bit field at bit 32
+						}
+						else if ( fixup.isAuth ) {
+							fixup.target = baseAddress + (value & 0xFFFFFFFFULL);
+						}
+						else {
+							fixup.target = (value & 0x7FFFFFFFFFFULL) | (((value >> 43) & 0xFF) << 56);
+							if ( format != DYLD_CHAINED_PTR_ARM64E )
+								fixup.target += baseAddress;
+						}
+					}
+					else {
+						fixup.isBind = (value >> 63) != 0;
+						next = (value >> 51) & 0xFFF;
+						if ( fixup.isBind ) {
+							fixup.bindOrdinal = value & 0xFFFFFF;
+							fixup.addend      = (value >> 24) & 0xFF;
+						}
+						else {
+							fixup.target = (value & 0xFFFFFFFFFULL) | (((value >> 36) & 0xFF) << 56);
+							if ( format == DYLD_CHAINED_PTR_64_OFFSET )
+								fixup.target += baseAddress;
+						}
+					}
+				}
+				if ( isPointer )
+					handler(segIndex, segCmd->vmaddr() + segOffset, fixup);
+				segOffset += next * stride;
+			} while ( next != 0 );
+		};
+		const uint8_t* segInfoEnd = (uint8_t*)segInfo + segInfo->size;
+		for (uint32_t pageIndex=0; pageIndex < segInfo->page_count; ++pageIndex) {
+			const uint64_t pageOffset = (uint64_t)pageIndex * segInfo->page_size;
+			const uint16_t start = segInfo->page_start[pageIndex];
+			if ( start == DYLD_CHAINED_PTR_START_NONE )
+				continue;
+			if ( (start & DYLD_CHAINED_PTR_START_MULTI) == 0 ) {
+				walkChain(pageOffset + start);
+				continue;
+			}
+			// some 32-bit formats have several chains per page, listed in page_start[] slots after the pages
+			for (uint32_t i = (start & ~DYLD_CHAINED_PTR_START_MULTI); ; ++i) {
+				if ( ((uint8_t*)&segInfo->page_start[i+1] > segInfoEnd) || ((uint8_t*)&segInfo->page_start[i+1] > chainDataEnd) )
+					throwMalformed("chained fixup starts for segment %s extend beyond its chained starts info", segCmd->segname());
+				walkChain(pageOffset + (segInfo->page_start[i] & ~DYLD_CHAINED_PTR_START_LAST));
+				if ( (segInfo->page_start[i] & DYLD_CHAINED_PTR_START_LAST) != 0 )
+					break;
+			}
+		}
+	}
+}
+
+
+}; // namespace chained_fixups
+}; // namespace mach_o
+
+
+#endif	// __MACH_O_CHAINED_FIXUPS__
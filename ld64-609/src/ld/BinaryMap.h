@@ -0,0 +1,64 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __BINARY_MAP_H__
+#define __BINARY_MAP_H__
+
+#include <stdint.h>
+
+//
+// Layout of the file written by -map_binary.  It holds the same information as the -map
+// text file, stored column by column so size analysis tools can mmap() it and index it
+// directly.  All values are in the byte order of the machine that ran the linker, and all
+// offsets are from the start of the file.  Every array starts on an 8-byte boundary, the
+// uint32_t arrays are followed by padding when their count is odd.
+//
+// Atoms are listed in the same order as the text map: the atoms of each section in address
+// order, then any dead stripped atoms.  Index 0 of the object file table is the linker itself,
+// for atoms the linker synthesized.
+//
+
+#define BINARY_MAP_MAGIC			"ld64map"
+#define BINARY_MAP_VERSION			1
+#define BINARY_MAP_DEAD_STRIPPED	0xFFFFFFFF		// section index of dead stripped atoms
+
+struct binary_map_header {
+	char		magic[8];				// BINARY_MAP_MAGIC
+	uint32_t	version;				// BINARY_MAP_VERSION
+	uint32_t	cputype;				// of the output file
+	uint64_t	outputPathOffset;		// string offset of the output file path
+	uint32_t	fileCount;
+	uint32_t	sectionCount;
+	uint64_t	atomCount;
+	uint64_t	filesOffset;			// uint64_t[fileCount], string offset of each object file path
+	uint64_t	sectionsOffset;			// struct binary_map_section[sectionCount]
+	uint64_t	addressesOffset;		// uint64_t[atomCount], address of each atom (0 if dead stripped)
+	uint64_t	sizesOffset;			// uint64_t[atomCount], size of each atom
+	uint64_t	nameOffsetsOffset;		// uint64_t[atomCount], string offset of each atom's name
+	uint64_t	sectionIndexesOffset;	// uint32_t[atomCount], section of each atom or BINARY_MAP_DEAD_STRIPPED
+	uint64_t	fileIndexesOffset;		// uint32_t[atomCount], object file each atom came from
+	uint64_t	stringsOffset;			// zero terminated strings, string offsets are from here
+	uint64_t	stringsSize;
+};
+
+struct binary_map_section {
+	uint64_t	address;
+	uint64_t	size;
+	uint64_t	segmentNameOffset;		// string offset
+	uint64_t	sectionNameOffset;		// string offset
+};
+
+#endif // __BINARY_MAP_H__
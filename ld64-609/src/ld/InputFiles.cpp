@@ -64,6 +64,7 @@
 #include "opaque_section_file.h"
 #include "MachOFileAbstraction.hpp"
 #include "Snapshot.h"
+#include "Parallel.h"
 
 const bool _s_logPThreads = false;
 
@@ -254,16 +255,23 @@ ld::File* InputFiles::makeFile(const Options::FileInfo& info, bool indirectDylib
 	// Note: fat header is always big-endian
 	bool isFatFile = false;
 	uint32_t sliceToUse, sliceCount;
+	uint64_t sliceFileOffset = 0;
 	const fat_header* fh = (fat_header*)p;
-	if ( fh->magic == OSSwapBigToHostInt32(FAT_MAGIC) ) {
+	const bool isFat64 = (fh->magic == OSSwapBigToHostInt32(FAT_MAGIC_64));
+	if ( (fh->magic == OSSwapBigToHostInt32(FAT_MAGIC)) || isFat64 ) {
 		isFatFile = true;
 		const struct fat_arch* archs = (struct fat_arch*)(p + sizeof(struct fat_header));
+		const struct fat_arch_64* archs64 = (struct fat_arch_64*)(p + sizeof(struct fat_header));
+		auto sliceCPUType    = [&](uint32_t i) { return isFat64 ? OSSwapBigToHostInt32(archs64[i].cputype) : OSSwapBigToHostInt32(archs[i].cputype); };
+		auto sliceCPUSubType = [&](uint32_t i) { return isFat64 ? OSSwapBigToHostInt32(archs64[i].cpusubtype) : OSSwapBigToHostInt32(archs[i].cpusubtype); };
+		auto sliceOffset     = [&](uint32_t i) { return isFat64 ? OSSwapBigToHostInt64(archs64[i].offset) : (uint64_t)OSSwapBigToHostInt32(archs[i].offset); };
+		auto sliceSize       = [&](uint32_t i) { return isFat64 ? OSSwapBigToHostInt64(archs64[i].size) : (uint64_t)OSSwapBigToHostInt32(archs[i].size); };
 		bool sliceFound = false;
 		sliceCount = OSSwapBigToHostInt32(fh->nfat_arch);
 		// first try to find a slice that match cpu-type and cpu-sub-type
 		for (uint32_t i=0; i < sliceCount; ++i) {
-			if ( (OSSwapBigToHostInt32(archs[i].cputype) == (uint32_t)_options.architecture())
-			  && ((OSSwapBigToHostInt32(archs[i].cpusubtype) & ~CPU_SUBTYPE_MASK) == (uint32_t)_options.subArchitecture()) ) {
+			if ( (sliceCPUType(i) == (uint32_t)_options.architecture())
+			  && ((sliceCPUSubType(i) & ~CPU_SUBTYPE_MASK) == (uint32_t)_options.subArchitecture()) ) {
 				sliceToUse = i;
 				sliceFound = true;
 				break;
@@ -272,7 +280,7 @@ ld::File* InputFiles::makeFile(const Options::FileInfo& info, bool indirectDylib
 		if ( !sliceFound && _options.allowSubArchitectureMismatches() ) {
 			// look for any slice that matches just cpu-type
 			for (uint32_t i=0; i < sliceCount; ++i) {
-				if ( OSSwapBigToHostInt32(archs[i].cputype) == (uint32_t)_options.architecture() ) {
+				if ( sliceCPUType(i) == (uint32_t)_options.architecture() ) {
 					sliceToUse = i;
 					sliceFound = true;
 					break;
@@ -282,8 +290,8 @@ ld::File* InputFiles::makeFile(const Options::FileInfo& info, bool indirectDylib
 		if ( !sliceFound ) {
 			// Look for a fallback slice.
 			for (uint32_t i = 0; i < sliceCount; ++i) {
-				if ( OSSwapBigToHostInt32(archs[i].cputype) == (uint32_t)_options.fallbackArchitecture() &&
-					(OSSwapBigToHostInt32(archs[i].cpusubtype) & ~CPU_SUBTYPE_MASK) == (uint32_t)_options.fallbackSubArchitecture() ) {
+				if ( sliceCPUType(i) == (uint32_t)_options.fallbackArchitecture() &&
+					(sliceCPUSubType(i) & ~CPU_SUBTYPE_MASK) == (uint32_t)_options.fallbackSubArchitecture() ) {
 					sliceToUse = i;
 					sliceFound = true;
 					break;
@@ -293,8 +301,8 @@ ld::File* InputFiles::makeFile(const Options::FileInfo& info, bool indirectDylib
 		if ( !sliceFound && (_options.architecture() == CPU_TYPE_ARM64) && (_options.subArchitecture() == CPU_SUBTYPE_ARM64_ALL) ) {
 			// <rdar://problem/65681348> let arm64 executables link against arm64e slice of dylibs
 			for (uint32_t i = 0; i < sliceCount; ++i) {
-				if ( (OSSwapBigToHostInt32(archs[i].cputype) == CPU_TYPE_ARM64) &&
-					(OSSwapBigToHostInt32(archs[i].cpusubtype) & ~CPU_SUBTYPE_MASK) == CPU_SUBTYPE_ARM64E) {
+				if ( (sliceCPUType(i) == CPU_TYPE_ARM64) &&
+					(sliceCPUSubType(i) & ~CPU_SUBTYPE_MASK) == CPU_SUBTYPE_ARM64E) {
 					sliceToUse = i;
 					sliceFound = true;
 					break;
@@ -302,8 +310,9 @@ ld::File* InputFiles::makeFile(const Options::FileInfo& info, bool indirectDylib
 			}
 		}
 		if ( sliceFound ) {
-			uint32_t fileOffset = OSSwapBigToHostInt32(archs[sliceToUse].offset);
-			len = OSSwapBigToHostInt32(archs[sliceToUse].size);
+			uint64_t fileOffset = sliceOffset(sliceToUse);
+			len = sliceSize(sliceToUse);
+			sliceFileOffset = fileOffset;
 			if ( fileOffset+len > stat_buf.st_size ) {
 				// <rdar://problem/17593430> file size was read awhile ago.  If file is being written, wait a second to see if big enough now
 				sleep(1);
@@ -313,7 +322,7 @@ ld::File* InputFiles::makeFile(const Options::FileInfo& info, bool indirectDylib
 					newFileLen = statBuffer.st_size;
 				}
 				if ( fileOffset+len > newFileLen ) {
-					throwf("truncated fat file. Slice from %u to %llu is past end of file with length %llu", 
+					throwf("truncated fat file. Slice from %llu to %llu is past end of file with length %llu", 
 						fileOffset, fileOffset+len, stat_buf.st_size);
 				}
 			}
@@ -401,6 +410,7 @@ ld::File* InputFiles::makeFile(const Options::FileInfo& info, bool indirectDylib
 	::archive::ParserOptions archOpts;
 	archOpts.objOpts				= objOpts;
 	archOpts.objOpts.forceHidden	= info.options.fLoadHidden;
+	archOpts.sliceOffset			= sliceFileOffset;
 	archOpts.forceLoadThisArchive	= info.options.fForceLoad;
 	archOpts.forceLoadAll			= _options.fullyLoadArchives();
 	archOpts.forceLoadObjC			= _options.loadAllObjcObjectsFromArchives();
@@ -465,7 +475,7 @@ ld::File* InputFiles::makeFile(const Options::FileInfo& info, bool indirectDylib
 	}
 
 	// error handling
-	if ( ((fat_header*)p)->magic == OSSwapBigToHostInt32(FAT_MAGIC) ) {
+	if ( (((fat_header*)p)->magic == OSSwapBigToHostInt32(FAT_MAGIC)) || (((fat_header*)p)->magic == OSSwapBigToHostInt32(FAT_MAGIC_64)) ) {
 		throwf("missing required architecture %s in file %s (%u slices)", _options.architectureName(), info.path, sliceCount);
 	}
 	else {
@@ -951,8 +961,6 @@ InputFiles::InputFiles(Options& opts)
 	_inputFiles.reserve(files.size());
 #if HAVE_PTHREADS
 	unsigned int inputFileSlot = 0;
-	_availableInputFiles = 0;
-	_parseCursor = 0;
 #endif
 	Options::FileInfo* entry;
 	for (std::vector<Options::FileInfo>::const_iterator it = files.begin(); it != files.end(); ++it) {
@@ -963,7 +971,7 @@ InputFiles::InputFiles(Options& opts)
 		entry->inputFileSlot = inputFileSlot;
 		entry->readyToParse = !entry->fromFileList || !_options.pipelineEnabled();
 		if (entry->readyToParse)
-			_availableInputFiles++;
+			queueFileToParse(*entry);
 		_inputFiles.push_back(NULL);
 		inputFileSlot++;
 #else
@@ -975,16 +983,6 @@ InputFiles::InputFiles(Options& opts)
 #if HAVE_PTHREADS
 	_remainingInputFiles = files.size();
 	
-	// initialize info for parsing input files on worker threads
-	unsigned int ncpus;
-	int mib[2];
-	size_t len = sizeof(ncpus);
-	mib[0] = CTL_HW;
-	mib[1] = HW_NCPU;
-	if (sysctl(mib, 2, &ncpus, &len, NULL, 0) != 0) {
-		ncpus = 1;
-	}
-	_availableWorkers = MIN(ncpus, files.size()); // max # workers we permit
 	_idleWorkers = 0;
 	
 	if (_options.pipelineEnabled()) {
@@ -992,9 +990,14 @@ InputFiles::InputFiles(Options& opts)
 		startThread(InputFiles::waitForInputFiles);
 	}
 
-	// Start up one parser thread. More start on demand as parsed input files get consumed.
-	startThread(InputFiles::parseWorkerThread);
-	_availableWorkers--;
+	// Start up the parser threads.  The main thread parses a file itself when it needs one no
+	// worker has started on yet, so it counts as one of the workers.
+	unsigned int workers = ld::parallel::workerCount();
+	workers = (workers > 1) ? workers-1 : 1;
+	if ( workers > files.size() )
+		workers = (unsigned int)files.size();
+	for (unsigned int i=0; i < workers; ++i)
+		startThread(InputFiles::parseWorkerThread);
 #else
 	if (_options.pipelineEnabled()) {
 		throwf("pipelined linking not supported on this platform");
@@ -1015,65 +1018,112 @@ void InputFiles::startThread(void (*threadFunc)(InputFiles *)) const {
 	pthread_attr_destroy(&attr);
 }
 
-// Work loop for input file parsing threads
-void InputFiles::parseWorkerThread() {
+// Adds a file that is ready to parse to the queue, called with _parseLock held
+// (or before any threads are started).
+void InputFiles::queueFileToParse(const Options::FileInfo& entry)
+{
+	_parseQueue.insert(std::make_pair(entry.fileLen, entry.inputFileSlot));
+}
+
+
+// Takes the next file for a parse thread, called with _parseLock held.  The file the resolver
+// is blocked on goes first, otherwise the biggest ready file, so a large object late on the
+// command line does not start last and hold up the files after it.  Returns -1 if none are ready.
+int InputFiles::claimFileToParse()
+{
+	if ( _parseQueue.empty() )
+		return -1;
+	if ( (_neededFileSlot != -1) && claimFileToParse(_neededFileSlot) )
+		return _neededFileSlot;
+	int slot = _parseQueue.begin()->second;
+	_parseQueue.erase(_parseQueue.begin());
+	const std::vector<Options::FileInfo>& files = _options.getInputFiles();
+	((Options::FileInfo&)files[slot]).readyToParse = false; // to avoid multiple threads finding this file
+	return slot;
+}
+
+
+// Takes a specific file if it is still waiting to be parsed, called with _parseLock held.
+bool InputFiles::claimFileToParse(int slot)
+{
+	const std::vector<Options::FileInfo>& files = _options.getInputFiles();
+	Options::FileInfo& entry = (Options::FileInfo&)files[slot];
+	if ( !entry.readyToParse )
+		return false;
+	if ( _parseQueue.erase(std::make_pair(entry.fileLen, slot)) == 0 )
+		return false;
+	entry.readyToParse = false; // to avoid multiple threads finding this file
+	return true;
+}
+
+
+// Parses a claimed file and publishes the result, called with _parseLock held.
+// The lock is dropped while parsing.
+void InputFiles::parseFileInSlot(int slot)
+{
+	const std::vector<Options::FileInfo>& files = _options.getInputFiles();
+	const Options::FileInfo& entry = files[slot];
 	ld::File *file;
 	const char *exception = NULL;
+	pthread_mutex_unlock(&_parseLock);
+	if (_s_logPThreads) printf("parsing index %u\n", slot);
+	try {
+		// the parsers' own forEach() calls must leave this thread's core alone
+		ld::parallel::BusyScope busy;
+		file = makeFile(entry, false);
+	}
+	catch (const char *msg) {
+		if ( ((strstr(msg, "architecture") != NULL)  || (strstr(msg, "attempting to link") != NULL)) && !_options.errorOnOtherArchFiles() ) {
+			if ( _options.ignoreOtherArchInputFiles() ) {
+				// ignore, because this is about an architecture not in use
+			}
+			else {
+				warning("ignoring file %s, %s", entry.path, msg);
+			}
+		} 
+		else if ( strstr(msg, "ignoring unexpected") != NULL ) {
+			warning("%s, %s", entry.path, msg);
+		}
+		else {
+			asprintf((char**)&exception, "%s file '%s'", msg, entry.path);
+		}
+		file = new IgnoredFile(entry.path, entry.modTime, entry.ordinal, ld::File::Other);
+	}
+	pthread_mutex_lock(&_parseLock);
+	if (_remainingInputFiles > 0)
+		_remainingInputFiles--;
+	if (_s_logPThreads) printf("done with index %u, %d remaining\n", slot, _remainingInputFiles);
+	if (exception) {
+		// We are about to die, so set to zero to stop other threads from doing unneeded work.
+		_remainingInputFiles = 0;
+		_exception = exception;
+		pthread_cond_signal(&_newFileAvailable);
+	} 
+	else {
+		_inputFiles[slot] = file;
+		if (_neededFileSlot == slot)
+			pthread_cond_signal(&_newFileAvailable);
+	}
+	// wake idle workers so they see there is nothing left to do
+	if (_remainingInputFiles == 0)
+		pthread_cond_broadcast(&_parseWorkReady);
+}
+
+
+// Work loop for input file parsing threads
+void InputFiles::parseWorkerThread() {
 	pthread_mutex_lock(&_parseLock);
-	const std::vector<Options::FileInfo>& files = _options.getInputFiles();
 	if (_s_logPThreads) printf("worker starting\n");
-	do {
-		if (_availableInputFiles == 0) {
+	while (_remainingInputFiles) {
+		int slot = claimFileToParse();
+		if (slot == -1) {
 			_idleWorkers++;
 			pthread_cond_wait(&_parseWorkReady, &_parseLock);
 			_idleWorkers--;
 		} else {
-			int slot = _parseCursor;
-			while (slot < (int)files.size() && (_inputFiles[slot] != NULL || !files[slot].readyToParse))
-				slot++;
-			assert(slot < (int)files.size());
-			Options::FileInfo& entry = (Options::FileInfo&)files[slot];
-			_parseCursor = slot+1;
-			_availableInputFiles--;
-			entry.readyToParse = false; // to avoid multiple threads finding this file
-			pthread_mutex_unlock(&_parseLock);
-			if (_s_logPThreads) printf("parsing index %u\n", slot);
-			try {
-				file = makeFile(entry, false);
-			}
-			catch (const char *msg) {
-				if ( ((strstr(msg, "architecture") != NULL)  || (strstr(msg, "attempting to link") != NULL)) && !_options.errorOnOtherArchFiles() ) {
-					if ( _options.ignoreOtherArchInputFiles() ) {
-						// ignore, because this is about an architecture not in use
-					}
-					else {
-						warning("ignoring file %s, %s", entry.path, msg);
-					}
-				} 
-				else if ( strstr(msg, "ignoring unexpected") != NULL ) {
-					warning("%s, %s", entry.path, msg);
-				}
-				else {
-					asprintf((char**)&exception, "%s file '%s'", msg, entry.path);
-				}
-				file = new IgnoredFile(entry.path, entry.modTime, entry.ordinal, ld::File::Other);
-			}
-			pthread_mutex_lock(&_parseLock);
-			if (_remainingInputFiles > 0)
-				_remainingInputFiles--;
-			if (_s_logPThreads) printf("done with index %u, %d remaining\n", slot, _remainingInputFiles);
-			if (exception) {
-				// We are about to die, so set to zero to stop other threads from doing unneeded work.
-				_remainingInputFiles = 0;
-				_exception = exception;
-			} 
-			else {
-				_inputFiles[slot] = file;
-				if (_neededFileSlot == slot)
-					pthread_cond_signal(&_newFileAvailable);
-			}
+			parseFileInSlot(slot);
 		}
-	} while (_remainingInputFiles);
+	}
 	if (_s_logPThreads) printf("worker exiting\n");
 	pthread_cond_broadcast(&_parseWorkReady);
 	pthread_cond_signal(&_newFileAvailable);
@@ -1190,10 +1240,11 @@ void InputFiles::waitForInputFiles()
 			if (_idleWorkers)
 				pthread_cond_signal(&_parseWorkReady);
 			inputInfo->readyToParse = true;
-			if (_parseCursor > inputInfo->inputFileSlot)
-				_parseCursor = inputInfo->inputFileSlot;
-			_availableInputFiles++;
-			if (_s_logPThreads) printf("pipeline listener: %s slot=%d, _parseCursor=%d, _availableInputFiles = %d remaining = %ld\n", path_buf, inputInfo->inputFileSlot, _parseCursor, _availableInputFiles, fileMap.size()-1);
+			queueFileToParse(*inputInfo);
+			// the resolver may be waiting for exactly this file, and will parse it itself
+			if (_neededFileSlot == inputInfo->inputFileSlot)
+				pthread_cond_signal(&_newFileAvailable);
+			if (_s_logPThreads) printf("pipeline listener: %s slot=%d, queued = %lu remaining = %ld\n", path_buf, inputInfo->inputFileSlot, _parseQueue.size(), fileMap.size()-1);
 			pthread_mutex_unlock(&_parseLock);
 			fileMap.erase(it);
 		}
@@ -1224,14 +1275,14 @@ void InputFiles::forEachInitialAtom(ld::File::AtomHandler& handler, ld::Internal
 		
 		// this loop waits for the needed file to be ready (parsed by worker thread)
 		while (_inputFiles[fileIndex] == NULL && _exception == NULL) {
-			// We are starved for input. If there are still files to parse and we have
-			// not maxed out the worker thread count start a new worker thread.
-			if (_availableInputFiles > 0 && _availableWorkers > 0) {
-				if (_s_logPThreads) printf("starting worker\n");
-				startThread(InputFiles::parseWorkerThread);
-				_availableWorkers--;
-			}
 			_neededFileSlot = fileIndex;
+			// We are starved for input.  If no worker has started on the needed file yet,
+			// parse it here rather than wait for one to get to it.
+			if (claimFileToParse((int)fileIndex)) {
+				if (_s_logPThreads) printf("consumer parsing %lu: %s\n", fileIndex, files[fileIndex].path);
+				parseFileInSlot((int)fileIndex);
+				continue;
+			}
 			if (_s_logPThreads) printf("consumer blocking for %lu: %s\n", fileIndex, files[fileIndex].path);
 			pthread_cond_wait(&_newFileAvailable, &_parseLock);
 		}
@@ -47,6 +47,7 @@
 #endif
 
 #include <vector>
+#include <set>
 
 #include "Options.h"
 #include "ld.hpp"
@@ -107,6 +108,10 @@ private:
 	void						parseWorkerThread();
 	static void					parseWorkerThread(InputFiles *inputFiles);
 	void						startThread(void (*threadFunc)(InputFiles *)) const;
+	void						queueFileToParse(const Options::FileInfo& entry);
+	int							claimFileToParse();
+	bool						claimFileToParse(int slot);
+	void						parseFileInSlot(int slot);
 
 	typedef std::map<std::string, ld::dylib::File*>	InstallNameToDylib;
 
@@ -120,17 +125,24 @@ private:
     struct strcompclass {
         bool operator() (const char *a, const char *b) const { return ::strcmp(a, b) < 0; }
     };
+	// biggest file first, then command line order
+	struct ParseQueueOrder {
+		bool operator() (const std::pair<uint64_t, int>& a, const std::pair<uint64_t, int>& b) const {
+			if ( a.first != b.first )
+				return a.first > b.first;
+			return a.second < b.second;
+		}
+	};
+	typedef std::set<std::pair<uint64_t, int>, ParseQueueOrder> ParseQueue;
 
 	// for threaded input file processing
 #if HAVE_PTHREADS
 	pthread_mutex_t				_parseLock;
 	pthread_cond_t				_parseWorkReady;		// used by parse threads to block for work
 	pthread_cond_t				_newFileAvailable;		// used by main thread to block for parsed input files
-	int							_availableWorkers;		// number of remaining unstarted parse threads
 	int							_idleWorkers;			// number of running parse threads that are idle
 	int							_neededFileSlot;		// input file the resolver is currently blocked waiting for
-	int							_parseCursor;			// slot to begin searching for a file to parse
-	int							_availableInputFiles;	// number of input fileinfos with readyToParse==true
+	ParseQueue					_parseQueue;			// (size, slot) of input files with readyToParse==true
 #endif
 	const char *				_exception;				// passes an exception message from parse thread to main thread
 	int							_remainingInputFiles;	// number of input files still to parse
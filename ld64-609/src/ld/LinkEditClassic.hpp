@@ -38,6 +38,7 @@
 #include "ld.hpp"
 #include "Architectures.hpp"
 #include "MachOFileAbstraction.hpp"
+#include "Parallel.h"
 
 namespace ld {
 namespace tool {
@@ -2289,13 +2290,37 @@ void SectionRelocationsAtom<A>::addSectionReloc(ld::Internal::FinalSection*	sect
 template <typename A>
 void SectionRelocationsAtom<A>::encode()
 {
-	// convert each Entry record to one or two reloc records
+	// convert each Entry record to one or two reloc records.  Symbol numbers were assigned
+	// when the symbol table was encoded, so runs of entries can be encoded concurrently and
+	// then appended to their section's relocs in order.
+	struct EncodeChunk {
+		SectionAndEntries*						se;
+		size_t									entriesBegin;
+		size_t									entriesEnd;
+		std::vector<macho_relocation_info<P> >	relocs;
+	};
+	const size_t entriesPerChunk = 4096;
+	std::vector<EncodeChunk> chunks;
 	for(typename std::vector<SectionAndEntries>::iterator it=_entriesBySection.begin(); it != _entriesBySection.end(); ++it) {
 		SectionAndEntries& se = *it;
-		for(typename std::vector<Entry>::iterator eit=se.entries.begin(); eit != se.entries.end(); ++eit) {
-			encodeSectionReloc(se.sect, *eit, se.relocs);
+		for (size_t begin=0; begin < se.entries.size(); begin += entriesPerChunk) {
+			chunks.emplace_back();
+			EncodeChunk& chunk = chunks.back();
+			chunk.se			= &se;
+			chunk.entriesBegin	= begin;
+			chunk.entriesEnd	= std::min(begin + entriesPerChunk, se.entries.size());
 		}
 	}
+	ld::parallel::forEach(chunks.size(), [&](size_t chunkIndex) {
+		EncodeChunk& chunk = chunks[chunkIndex];
+		chunk.relocs.reserve(chunk.entriesEnd - chunk.entriesBegin);
+		for (size_t i=chunk.entriesBegin; i < chunk.entriesEnd; ++i)
+			encodeSectionReloc(chunk.se->sect, chunk.se->entries[i], chunk.relocs);
+	});
+	for (EncodeChunk& chunk : chunks) {
+		chunk.se->relocs.insert(chunk.se->relocs.end(), chunk.relocs.begin(), chunk.relocs.end());
+		std::vector<macho_relocation_info<P> >().swap(chunk.relocs);
+	}
 	
 	// update sections with start and count or relocs
 	uint32_t index = 0;
@@ -0,0 +1,408 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include <string>
+#include <vector>
+
+#include "LinkServer.h"
+#include "ResidentInputs.h"
+
+extern char** environ;
+
+namespace ld {
+namespace tool {
+
+//
+// A link request is a sendmsg() carrying the client's stdout and stderr as SCM_RIGHTS plus the
+// 32-bit length of the payload that follows.  The payload is the argument count, environment
+// count and umask, then the working directory, arguments and environment strings each zero
+// terminated.  When the link finishes the server writes back its 32-bit exit status.  A client
+// sends nothing else, so if its socket becomes readable it has gone away and the link is
+// interrupted.
+//
+static const int kPassedFDCount = 2;
+
+static bool writeAll(int fd, const void* buffer, size_t length)
+{
+	const uint8_t* p = (uint8_t*)buffer;
+	while ( length != 0 ) {
+		ssize_t amount = ::write(fd, p, length);
+		if ( amount == -1 ) {
+			if ( errno == EINTR )
+				continue;
+			return false;
+		}
+		p      += amount;
+		length -= amount;
+	}
+	return true;
+}
+
+static bool readAll(int fd, void* buffer, size_t length)
+{
+	uint8_t* p = (uint8_t*)buffer;
+	while ( length != 0 ) {
+		ssize_t amount = ::read(fd, p, length);
+		if ( amount == -1 ) {
+			if ( errno == EINTR )
+				continue;
+			return false;
+		}
+		if ( amount == 0 )
+			return false;
+		p      += amount;
+		length -= amount;
+	}
+	return true;
+}
+
+static void closeOnExec(int fd)
+{
+	::fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+static bool socketAddress(const char* socketPath, struct sockaddr_un& addr)
+{
+	if ( strlen(socketPath) >= sizeof(addr.sun_path) )
+		return false;
+	bzero(&addr, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strlcpy(addr.sun_path, socketPath, sizeof(addr.sun_path));
+	return true;
+}
+
+
+struct ServedLink {
+	pid_t			pid;
+	int				clientFD;
+	int				missFD;
+	bool			interrupted;
+	std::string		misses;
+};
+
+struct LinkRequest {
+	int							fds[kPassedFDCount];
+	mode_t						umask;
+	std::string					workingDir;
+	std::vector<std::string>	args;
+	std::vector<std::string>	env;
+};
+
+static bool receiveRequest(int clientFD, LinkRequest& request)
+{
+	for (int i=0; i < kPassedFDCount; ++i)
+		request.fds[i] = -1;
+
+	uint32_t length;
+	struct iovec iov = { &length, sizeof(length) };
+	union {
+		struct cmsghdr	align;
+		char			buffer[CMSG_SPACE(sizeof(int)*kPassedFDCount)];
+	} control;
+	struct msghdr msg;
+	bzero(&msg, sizeof(msg));
+	msg.msg_iov        = &iov;
+	msg.msg_iovlen     = 1;
+	msg.msg_control    = control.buffer;
+	msg.msg_controllen = sizeof(control.buffer);
+	ssize_t amount;
+	do {
+		amount = ::recvmsg(clientFD, &msg, 0);
+	} while ( (amount == -1) && (errno == EINTR) );
+	for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		if ( (cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS) && (cmsg->cmsg_len == CMSG_LEN(sizeof(int)*kPassedFDCount)) )
+			memcpy(request.fds, CMSG_DATA(cmsg), sizeof(int)*kPassedFDCount);
+	}
+	for (int i=0; i < kPassedFDCount; ++i) {
+		if ( request.fds[i] == -1 )
+			return false;
+		closeOnExec(request.fds[i]);
+	}
+	if ( (amount != sizeof(length)) || (length < 3*sizeof(uint32_t)) || (length > 64*1024*1024) )
+		return false;
+
+	std::vector<char> payload(length);
+	if ( !readAll(clientFD, &payload[0], length) || (payload.back() != '\0') )
+		return false;
+	uint32_t counts[3];
+	memcpy(counts, &payload[0], sizeof(counts));
+	std::vector<std::string> strings;
+	for (const char* s = &payload[sizeof(counts)]; s < &payload[length]; s += strlen(s)+1)
+		strings.push_back(s);
+	if ( (counts[0] == 0) || (strings.size() != 1 + (uint64_t)counts[0] + counts[1]) )
+		return false;
+	request.umask      = (mode_t)(counts[2] & 0777);
+	request.workingDir = strings[0];
+	request.args.assign(strings.begin()+1, strings.begin()+1+counts[0]);
+	request.env.assign(strings.begin()+1+counts[0], strings.end());
+	return true;
+}
+
+static void closeRequestFDs(LinkRequest& request)
+{
+	for (int i=0; i < kPassedFDCount; ++i) {
+		if ( request.fds[i] != -1 )
+			::close(request.fds[i]);
+	}
+}
+
+static void finishLink(ServedLink& link)
+{
+	::close(link.missFD);
+	int status;
+	int32_t exitStatus = 1;
+	while ( ::waitpid(link.pid, &status, 0) == -1 ) {
+		if ( errno != EINTR ) {
+			status = -1;
+			break;
+		}
+	}
+	if ( status != -1 ) {
+		if ( WIFEXITED(status) )
+			exitStatus = WEXITSTATUS(status);
+		else if ( WIFSIGNALED(status) )
+			exitStatus = 128 + WTERMSIG(status);
+	}
+	// the client may have gone away, nothing to do about that
+	(void)writeAll(link.clientFD, &exitStatus, sizeof(exitStatus));
+	::close(link.clientFD);
+
+	// queue what this link had to parse itself, so later links find it resident
+	for (size_t start=0, end; (end = link.misses.find('\n', start)) != std::string::npos; start = end+1) {
+		std::string line = link.misses.substr(start, end-start);
+		ResidentInputs::preload(line.c_str());
+	}
+}
+
+bool LinkServer::serve(const char* socketPath, int& argc, const char**& argv)
+{
+	struct sockaddr_un addr;
+	if ( !socketAddress(socketPath, addr) ) {
+		fprintf(stderr, "ld: link server socket path too long: %s\n", socketPath);
+		return false;
+	}
+	int listenFD = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if ( listenFD == -1 ) {
+		fprintf(stderr, "ld: can't create link server socket, errno=%d\n", errno);
+		return false;
+	}
+	closeOnExec(listenFD);
+	::unlink(socketPath);
+	// only the user running the server may submit links to it
+	mode_t oldMask = ::umask(077);
+	int result = ::bind(listenFD, (struct sockaddr*)&addr, sizeof(addr));
+	::umask(oldMask);
+	if ( (result != 0) || (::listen(listenFD, 64) != 0) ) {
+		fprintf(stderr, "ld: can't listen on link server socket %s, errno=%d\n", socketPath, errno);
+		::close(listenFD);
+		return false;
+	}
+	// a client that exits before its status is written must not kill the server
+	::signal(SIGPIPE, SIG_IGN);
+
+	std::vector<ServedLink> links;
+	for (;;) {
+		std::vector<struct pollfd> pollFDs;
+		pollFDs.push_back({ listenFD, POLLIN, 0 });
+		for (const ServedLink& link : links) {
+			pollFDs.push_back({ link.missFD, POLLIN, 0 });
+			pollFDs.push_back({ (link.interrupted ? -1 : link.clientFD), POLLIN, 0 });
+		}
+		if ( ::poll(&pollFDs[0], (nfds_t)pollFDs.size(), -1) == -1 ) {
+			if ( errno == EINTR )
+				continue;
+			fprintf(stderr, "ld: link server poll failed, errno=%d\n", errno);
+			return false;
+		}
+
+		for (size_t i=links.size(); i > 0; --i) {
+			ServedLink& link = links[i-1];
+			const struct pollfd& missPoll   = pollFDs[2*i-1];
+			const struct pollfd& clientPoll = pollFDs[2*i];
+			if ( (clientPoll.revents & (POLLIN|POLLHUP|POLLERR)) != 0 ) {
+				// the client was interrupted, so interrupt its link too, which removes any partial output
+				::kill(link.pid, SIGINT);
+				link.interrupted = true;
+			}
+			// a link is done when its end of the miss pipe closes
+			if ( (missPoll.revents & (POLLIN|POLLHUP|POLLERR)) == 0 )
+				continue;
+			char buffer[4096];
+			ssize_t amount = ::read(link.missFD, buffer, sizeof(buffer));
+			if ( amount > 0 ) {
+				link.misses.append(buffer, amount);
+			}
+			else if ( (amount == 0) || (errno != EINTR) ) {
+				finishLink(link);
+				links.erase(links.begin() + (i-1));
+			}
+		}
+
+		if ( (pollFDs[0].revents & POLLIN) == 0 )
+			continue;
+		int clientFD = ::accept(listenFD, NULL, NULL);
+		if ( clientFD == -1 )
+			continue;
+		closeOnExec(clientFD);
+		// don't let a stalled client hold up the server
+		struct timeval timeout = { 10, 0 };
+		::setsockopt(clientFD, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		LinkRequest request;
+		int missPipe[2];
+		if ( !receiveRequest(clientFD, request) || (::pipe(missPipe) != 0) ) {
+			closeRequestFDs(request);
+			::close(clientFD);
+			continue;
+		}
+		closeOnExec(missPipe[0]);
+		closeOnExec(missPipe[1]);
+		// the new link gets everything earlier links' misses have made resident by now
+		ResidentInputs::installPreloaded();
+		pid_t pid = ::fork();
+		if ( pid == 0 ) {
+			// this is the link process
+			::signal(SIGPIPE, SIG_DFL);
+			::close(listenFD);
+			::close(clientFD);
+			::close(missPipe[0]);
+			for (const ServedLink& link : links) {
+				::close(link.clientFD);
+				::close(link.missFD);
+			}
+			::dup2(request.fds[0], STDOUT_FILENO);
+			::dup2(request.fds[1], STDERR_FILENO);
+			closeRequestFDs(request);
+			::umask(request.umask);
+			if ( ::chdir(request.workingDir.c_str()) != 0 ) {
+				fprintf(stderr, "ld: link server can't change to directory %s, errno=%d\n", request.workingDir.c_str(), errno);
+				_exit(1);
+			}
+			char** env = new char*[request.env.size()+1];
+			for (size_t i=0; i < request.env.size(); ++i)
+				env[i] = strdup(request.env[i].c_str());
+			env[request.env.size()] = NULL;
+			environ = env;
+			argc = (int)request.args.size();
+			argv = new const char*[argc+1];
+			for (int i=0; i < argc; ++i)
+				argv[i] = strdup(request.args[i].c_str());
+			argv[argc] = NULL;
+			ResidentInputs::reportMissesTo(missPipe[1]);
+			return true;
+		}
+		closeRequestFDs(request);
+		::close(missPipe[1]);
+		if ( pid == -1 ) {
+			int32_t exitStatus = 1;
+			(void)writeAll(clientFD, &exitStatus, sizeof(exitStatus));
+			::close(clientFD);
+			::close(missPipe[0]);
+			continue;
+		}
+		links.push_back({ pid, clientFD, missPipe[0], false, std::string() });
+	}
+}
+
+bool LinkServer::forward(int argc, const char* argv[], int& exitStatus)
+{
+	const char* socketPath = getenv("LD_LINK_SERVER");
+	if ( (socketPath == NULL) || (socketPath[0] == '\0') )
+		return false;
+	char workingDir[PATH_MAX];
+	if ( ::getcwd(workingDir, sizeof(workingDir)) == NULL )
+		return false;
+	struct sockaddr_un addr;
+	if ( !socketAddress(socketPath, addr) )
+		return false;
+	int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if ( fd == -1 )
+		return false;
+#ifdef SO_NOSIGPIPE
+	int on = 1;
+	::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+	if ( ::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ) {
+		::close(fd);
+		return false;
+	}
+
+	std::string payload;
+	uint32_t envCount = 0;
+	for (char** e = environ; *e != NULL; ++e)
+		++envCount;
+	mode_t mask = ::umask(0);
+	::umask(mask);
+	uint32_t counts[3] = { (uint32_t)argc, envCount, (uint32_t)mask };
+	payload.append((char*)counts, sizeof(counts));
+	payload.append(workingDir, strlen(workingDir)+1);
+	for (int i=0; i < argc; ++i)
+		payload.append(argv[i], strlen(argv[i])+1);
+	for (char** e = environ; *e != NULL; ++e)
+		payload.append(*e, strlen(*e)+1);
+
+	uint32_t length = (uint32_t)payload.size();
+	struct iovec iov = { &length, sizeof(length) };
+	union {
+		struct cmsghdr	align;
+		char			buffer[CMSG_SPACE(sizeof(int)*kPassedFDCount)];
+	} control;
+	bzero(&control, sizeof(control));
+	struct msghdr msg;
+	bzero(&msg, sizeof(msg));
+	msg.msg_iov        = &iov;
+	msg.msg_iovlen     = 1;
+	msg.msg_control    = control.buffer;
+	msg.msg_controllen = sizeof(control.buffer);
+	struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type  = SCM_RIGHTS;
+	cmsg->cmsg_len   = CMSG_LEN(sizeof(int)*kPassedFDCount);
+	const int passedFDs[kPassedFDCount] = { STDOUT_FILENO, STDERR_FILENO };
+	memcpy(CMSG_DATA(cmsg), passedFDs, sizeof(passedFDs));
+
+	// if the request can't be sent the link has not started, so it can still be done in-process
+	if ( (::sendmsg(fd, &msg, 0) != sizeof(length)) || !writeAll(fd, payload.data(), payload.size()) ) {
+		::close(fd);
+		return false;
+	}
+	int32_t status;
+	if ( !readAll(fd, &status, sizeof(status)) ) {
+		// the server went away mid-link, its output can't be trusted
+		fprintf(stderr, "ld: lost connection to link server %s\n", socketPath);
+		status = 1;
+	}
+	::close(fd);
+	exitStatus = status;
+	return true;
+}
+
+} // namespace tool
+} // namespace ld
@@ -0,0 +1,42 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __LINK_SERVER_H__
+#define __LINK_SERVER_H__
+
+namespace ld {
+namespace tool {
+
+//
+// "ld -link_server <socket>" runs a server that forks a process for each link requested on the
+// socket.  The forked links inherit the inputs the server keeps resident (see ResidentInputs.h).
+// A normal ld invocation with LD_LINK_SERVER set to the socket path hands its arguments,
+// environment, working directory, stdout and stderr to the server and exits with the status of
+// the link.  If the server can't be reached, ld links in-process as usual.
+//
+class LinkServer {
+public:
+	// Only returns in a forked link process, with argc and argv replaced by the requested link's
+	// arguments, or returns false if the server could not be started.
+	static bool		serve(const char* socketPath, int& argc, const char**& argv);
+	// Returns true if the link was run by the server named by LD_LINK_SERVER.
+	static bool		forward(int argc, const char* argv[], int& exitStatus);
+};
+
+} // namespace tool
+} // namespace ld
+
+#endif // __LINK_SERVER_H__
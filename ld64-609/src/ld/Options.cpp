@@ -25,6 +25,8 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <dirent.h>
+#include <ctype.h>
 #include <mach/vm_prot.h>
 #include <sys/sysctl.h>
 #include <mach-o/dyld.h>
@@ -47,6 +49,7 @@
 #include "Snapshot.h"
 #include "macho_relocatable_file.h"
 #include "ResponseFiles.h"
+#include "Parallel.h"
 
 // from FunctionNameDemangle.h
 extern "C" size_t fnd_get_demangled_name(const char *mangledName, char *outputBuffer, size_t length);
@@ -85,6 +88,16 @@ static int			sWarningsCount = 0;
 
 void warning(const char* format, ...)
 {
+	if ( ld::parallel::WarningBuffer* buffer = ld::parallel::currentWarnings() ) {
+		va_list	list;
+		char*	message;
+		va_start(list, format);
+		vasprintf(&message, format, list);
+		va_end(list);
+		buffer->push_back(message);
+		free(message);
+		return;
+	}
 	++sWarningsCount;
 	if ( sEmitWarnings ) {
 		va_list	list;
@@ -123,6 +136,7 @@ bool Options::FileInfo::checkFileExists(const Options& options, const char *p)
 {
 	if (isInlined) {
 		modTime = 0;
+		fileLen = 0;
 		return true;
 	}
 	struct stat statBuffer;
@@ -131,6 +145,7 @@ bool Options::FileInfo::checkFileExists(const Options& options, const char *p)
 	if ( stat(p, &statBuffer) == 0 ) {
 		if (p != path) path = strdup(p);
 		modTime = statBuffer.st_mtime;
+		fileLen = statBuffer.st_size;
 		return true;
 	}
 	options.addDependency(Options::depNotFound, p);
@@ -139,6 +154,76 @@ bool Options::FileInfo::checkFileExists(const Options& options, const char *p)
 }
 
 
+static bool lowerCaseASCII(const char* str, std::string& result)
+{
+	result.clear();
+	for (const char* s = str; *s != '\0'; ++s) {
+		// names with non-ASCII characters may be normalized by the file system, so are never cached
+		if ( (unsigned char)*s >= 0x80 )
+			return false;
+		result.push_back(tolower(*s));
+	}
+	return true;
+}
+
+const Options::DirectoryCache::Listing& Options::DirectoryCache::listing(const std::string& dir)
+{
+	auto pos = fDirectories.find(dir);
+	if ( pos != fDirectories.end() )
+		return pos->second;
+
+	Listing& result = fDirectories[dir];
+	DIR* d = ::opendir(dir.c_str());
+	if ( d != NULL ) {
+		std::string name;
+		result.complete = true;
+		while ( struct dirent* entry = ::readdir(d) ) {
+			if ( lowerCaseASCII(entry->d_name, name) )
+				result.entries.insert(name);
+		}
+		::closedir(d);
+	}
+	else if ( (errno == ENOENT) || (errno == ENOTDIR) ) {
+		// directory does not exist, so nothing in it can either
+		result.complete = true;
+	}
+	return result;
+}
+
+bool Options::DirectoryCache::mayExist(const char* path)
+{
+	const char* lastSlash = strrchr(path, '/');
+	std::string dir;
+	const char* leaf;
+	if ( lastSlash == NULL ) {
+		dir = ".";
+		leaf = path;
+	}
+	else {
+		dir.assign(path, (lastSlash == path) ? 1 : lastSlash - path);
+		leaf = lastSlash + 1;
+	}
+	std::string lowerLeaf;
+	if ( (leaf[0] == '\0') || !lowerCaseASCII(leaf, lowerLeaf) )
+		return true;
+	const Listing& dirListing = listing(dir);
+	if ( !dirListing.complete )
+		return true;
+	return (dirListing.entries.count(lowerLeaf) != 0);
+}
+
+// Like FileInfo::checkFileExists() but consults the directory cache first,
+// so paths probed while searching do not all need their own stat().
+bool Options::checkSearchPathFile(const char* path, FileInfo& result) const
+{
+	if ( !fSearchDirCache.mayExist(path) ) {
+		this->addDependency(Options::depNotFound, path);
+		return false;
+	}
+	return result.checkFileExists(*this, path);
+}
+
+
 Options::Options(int argc, const char* argv[])
 	: fOutputFile("a.out"), fArchitecture(0), fSubArchitecture(0),
 	  fFallbackArchitecture(0), fFallbackSubArchitecture(0), fArchitectureName("unknown"), fOutputKind(kDynamicExecutable),
@@ -153,7 +238,7 @@ Options::Options(int argc, const char* argv[])
 	  fWeakReferenceMismatchTreatment(kWeakReferenceMismatchNonWeak),
 	  fClientName(NULL),
 	  fUmbrellaName(NULL), fInitFunctionName(NULL), fDotOutputFile(NULL), fExecutablePath(NULL),
-	  fBundleLoader(NULL), fDtraceScriptName(NULL), fMapPath(NULL),
+	  fBundleLoader(NULL), fDtraceScriptName(NULL), fMapPath(NULL), fBinaryMapPath(NULL),
 	  fDyldInstallPath("/usr/lib/dyld"), fLtoCachePath(NULL), fTempLtoObjectPath(NULL), fOverridePathlibLTO(NULL), fLtoCpu(NULL),
 	  fKextObjectsEnable(-1),fKextObjectsDirPath(NULL),fToolchainPath(NULL),fOrderFilePath(NULL),
 	  fZeroPageSize(ULLONG_MAX), fStackSize(0), fStackAddr(0), fSourceVersion(0), fSDKVersion(0), fExecutableStack(false), 
@@ -224,6 +309,8 @@ Options::Options(int argc, const char* argv[])
 	this->addDependency(depOutputFile, fOutputFile);
 	if ( fMapPath != NULL )
 		this->addDependency(depOutputFile, fMapPath);
+	if ( fBinaryMapPath != NULL )
+		this->addDependency(depOutputFile, fBinaryMapPath);
 }
 
 Options::~Options()
@@ -793,7 +880,7 @@ bool Options::checkForFile(const char* format, const char* dir, const char* root
 {
 	char possiblePath[strlen(dir)+strlen(rootName)+strlen(format)+8];
 	sprintf(possiblePath, format,  dir, rootName);
-	bool found = result.checkFileExists(*this, possiblePath);
+	bool found = checkSearchPathFile(possiblePath, result);
 	if ( fTraceDylibSearching )
 		printf("[Logging for XBS]%sfound library: '%s'\n", (found ? " " : " not "), possiblePath);
 	return found;
@@ -948,7 +1035,7 @@ bool Options::findFile(const std::string &path, const std::vector<std::string> &
 	FileInfo tbdInfo;
 	for ( const auto &ext : tbdExtensions ) {
 		auto newPath = replace_extension(path, ext);
-		bool found = tbdInfo.checkFileExists(*this, newPath.c_str());
+		bool found = checkSearchPathFile(newPath.c_str(), tbdInfo);
 		if ( fTraceDylibSearching )
 			printf("[Logging for XBS]%sfound library: '%s'\n", (found ? " " : " not "), newPath.c_str());
 		if ( found )
@@ -957,7 +1044,7 @@ bool Options::findFile(const std::string &path, const std::vector<std::string> &
 
 	FileInfo dylibInfo;
 	{
-		bool found = dylibInfo.checkFileExists(*this, path.c_str());
+		bool found = checkSearchPathFile(path.c_str(), dylibInfo);
 		if ( fTraceDylibSearching )
 			printf("[Logging for XBS]%sfound library: '%s'\n", (found ? " " : " not "), path.c_str());
 	}
@@ -3503,6 +3590,9 @@ void Options::parse(int argc, const char* argv[])
 			else if ( strcmp(arg, "-map") == 0 ) {
 				fMapPath = checkForNullArgument(arg, argv[++i]);
 			}
+			else if ( strcmp(arg, "-map_binary") == 0 ) {
+				fBinaryMapPath = checkForNullArgument(arg, argv[++i]);
+			}
 			else if ( strcmp(arg, "-pie") == 0 ) {
 				fPositionIndependentExecutable = true;
 				fPIEOnCommandLine = true;
@@ -30,6 +30,7 @@
 #include <mach/machine.h>
 #include <tapi/tapi.h>
 
+#include <string>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -137,6 +138,7 @@ public:
     public:
 		const char*				path;
 		time_t					modTime;
+		uint64_t				fileLen;
 		LibraryOptions			options;
 		ld::File::Ordinal		ordinal;
 		bool					fromFileList;
@@ -149,11 +151,12 @@ public:
         // The use pattern for FileInfo is to create one on the stack in a leaf function and return
         // it to the calling frame by copy. Therefore the copy constructor steals the path string from
         // the source, which dies with the stack frame.
-        FileInfo(FileInfo const &other) : path(other.path), modTime(other.modTime), options(other.options), ordinal(other.ordinal), fromFileList(other.fromFileList), isInlined(other.isInlined), inputFileSlot(-1) { ((FileInfo&)other).path = NULL; };
+        FileInfo(FileInfo const &other) : path(other.path), modTime(other.modTime), fileLen(other.fileLen), options(other.options), ordinal(other.ordinal), fromFileList(other.fromFileList), isInlined(other.isInlined), inputFileSlot(-1) { ((FileInfo&)other).path = NULL; };
 
 		FileInfo &operator=(FileInfo other) {
 			std::swap(path, other.path);
 			std::swap(modTime, other.modTime);
+			std::swap(fileLen, other.fileLen);
 			std::swap(options, other.options);
 			std::swap(ordinal, other.ordinal);
 			std::swap(fromFileList, other.fromFileList);
@@ -164,10 +167,10 @@ public:
 		}
 
         // Create an empty FileInfo. The path can be set implicitly by checkFileExists().
-        FileInfo() : path(NULL), modTime(-1), options(), fromFileList(false), isInlined(false) {};
+        FileInfo() : path(NULL), modTime(-1), fileLen(0), options(), fromFileList(false), isInlined(false) {};
         
         // Create a FileInfo for a specific path, but does not stat the file.
-        FileInfo(const char *_path) : path(strdup(_path)), modTime(-1), options(), fromFileList(false), isInlined(false) {};
+        FileInfo(const char *_path) : path(strdup(_path)), modTime(-1), fileLen(0), options(), fromFileList(false), isInlined(false) {};
 
         ~FileInfo() { if (path) ::free((void*)path); }
         
@@ -336,6 +339,7 @@ public:
 	UndefinesIterator			initialUndefinesEnd() const { return &fInitialUndefines[fInitialUndefines.size()]; }
 	const std::vector<const char*>&	initialUndefines() const { return fInitialUndefines; }
 	bool						printWhyLive(const char* name) const;
+	bool						hasWhyLive() const { return !fWhyLive.empty(); }
 	uint32_t					minimumHeaderPad() const { return fMinimumHeaderPad; }
 	bool						maxMminimumHeaderPad() const { return fMaxMinimumHeaderPad; }
 	ExtraSection::const_iterator	extraSectionsBegin() const { return &fExtraSections[0]; }
@@ -377,6 +381,7 @@ public:
 	bool						readOnlyx86Stubs() { return fReadOnlyx86Stubs; }
 	const std::vector<DylibOverride>&	dylibOverrides() const { return fDylibOverrides; }
 	const char*					generatedMapPath() const { return fMapPath; }
+	const char*					generatedBinaryMapPath() const { return fBinaryMapPath; }
 	bool						positionIndependentExecutable() const { return fPositionIndependentExecutable; }
 	Options::FileInfo			findIndirectDylib(const std::string& installName, const ld::dylib::File* fromDylib) const;
 	bool						deadStripDylibs() const { return fDeadStripDylibs; }
@@ -582,6 +587,23 @@ private:
 		std::string			path;
 	};
 
+	// Caches the entries of each directory probed while searching -L/-F/SDK/rpath paths,
+	// so that a candidate which is not in its directory costs a hash lookup instead of a stat().
+	class DirectoryCache {
+	public:
+		// returns false only if the directory listing proves the path does not exist
+		bool					mayExist(const char* path);
+	private:
+		struct Listing {
+								Listing() : complete(false) {}
+			bool							complete;	// false if directory could not be read
+			std::unordered_set<std::string>	entries;	// lower cased, for case insensitive volumes
+		};
+		const Listing&			listing(const std::string& dir);
+
+		std::unordered_map<std::string, Listing>	fDirectories;
+	};
+
 	const char*					checkForNullArgument(const char* argument_name, const char* arg, bool allowDashArg=false) const;
 	const char*					checkForNullVersionArgument(const char* argument_name, const char* arg) const;
 	void						parse(int argc, const char* argv[]);
@@ -592,6 +614,7 @@ private:
 	FileInfo					findFramework(const char* rootName, const char* suffix) const;
 	bool						checkForFile(const char* format, const char* dir, const char* rootName,
 											 FileInfo& result) const;
+	bool						checkSearchPathFile(const char* path, FileInfo& result) const;
 	uint64_t					parseVersionNumber64(const char*);
 	std::string					getVersionString32(uint32_t ver) const;
 	std::string					getVersionString64(uint64_t ver) const;
@@ -681,6 +704,7 @@ private:
 	const char*							fBundleLoader;
 	const char*							fDtraceScriptName;
 	const char*							fMapPath;
+	const char*							fBinaryMapPath;
 	const char*							fDyldInstallPath;
 	const char*							fLtoCachePath;
 	bool								fLtoPruneIntervalOverwrite;
@@ -892,6 +916,7 @@ private:
 	uint8_t								fMaxDefaultCommonAlign;
 	UnalignedPointerTreatment			fUnalignedPointerTreatment;
 	mutable std::vector<DependencyEntry> fDependencies;
+	mutable DirectoryCache				fSearchDirCache;
 	mutable std::vector<Options::TAPIInterface> fTAPIFiles;
 	bool								fPreferTAPIFile;
 	const char*							fOSOPrefixPath;
@@ -52,6 +52,7 @@
 #include <algorithm>
 #include <unordered_set>
 #include <utility>
+#include <atomic>
 #include <iostream>
 #include <fstream>
 
@@ -63,6 +64,8 @@
 #include "Options.h"
 
 #include "OutputFile.h"
+#include "Parallel.h"
+#include "BinaryMap.h"
 #include "Architectures.hpp"
 #include "HeaderAndLoadCommands.hpp"
 #include "LinkEdit.hpp"
@@ -72,9 +75,9 @@
 namespace ld {
 namespace tool {
 
-uint32_t sAdrpNA = 0;
-uint32_t sAdrpNoped = 0;
-uint32_t sAdrpNotNoped = 0;
+std::atomic<uint32_t> sAdrpNA(0);
+std::atomic<uint32_t> sAdrpNoped(0);
+std::atomic<uint32_t> sAdrpNotNoped(0);
 
 
 OutputFile::OutputFile(const Options& opts, ld::Internal& state) 
@@ -1251,13 +1254,22 @@ static bool withinOneMeg(uint64_t addr1, uint64_t addr2) {
 }
 #endif // SUPPORT_ARCH_arm64
 
-void OutputFile::setInfo(ld::Internal& state, const ld::Atom* atom, uint8_t* buffer, const std::map<uint32_t, const Fixup*>& usedByHints, 
+OutputFile::HintLocation* OutputFile::findHintLocation(std::vector<HintLocation>& hintLocations, uint32_t offsetInAtom)
+{
+	const HintLocation key = { offsetInAtom, NULL };
+	auto pos = std::lower_bound(hintLocations.begin(), hintLocations.end(), key, HintLocation::lessOffset);
+	if ( (pos != hintLocations.end()) && (pos->offsetInAtom == offsetInAtom) )
+		return &*pos;
+	return NULL;
+}
+
+void OutputFile::setInfo(ld::Internal& state, const ld::Atom* atom, uint8_t* buffer, std::vector<HintLocation>& hintLocations, 
 						uint32_t offsetInAtom, uint32_t delta, InstructionInfo* info) 
 {
 	info->offsetInAtom = offsetInAtom + delta;
-	std::map<uint32_t, const Fixup*>::const_iterator pos = usedByHints.find(info->offsetInAtom);
-	if ( (pos != usedByHints.end()) && (pos->second != NULL) ) {
-		info->fixup = pos->second;
+	const HintLocation* pos = findHintLocation(hintLocations, info->offsetInAtom);
+	if ( (pos != NULL) && (pos->fixup != NULL) ) {
+		info->fixup = pos->fixup;
 		info->targetAddress = addressOf(state, info->fixup, &info->target);
 		if ( info->fixup->clusterSize != ld::Fixup::k1of1 ) {
 			assert(info->fixup->firstInCluster());
@@ -1362,9 +1374,11 @@ static bool isPageOffsetKind(const ld::Fixup* fixup, bool mustBeGOT=false)
 		break; \
 	} 
 
-void OutputFile::applyFixUps(ld::Internal& state, uint64_t mhAddress, const ld::Atom* atom, uint8_t* buffer)
+// returns true if atom has linker optimization hints, which applyOptimizationHints() applies later
+bool OutputFile::applyFixUps(ld::Internal& state, uint64_t mhAddress, const ld::Atom* atom, uint8_t* buffer)
 {
 	//fprintf(stderr, "applyFixUps() on %s\n", atom->name());
+	bool hasHints = false;
 	int64_t accumulator = 0;
 	const ld::Atom* toTarget = NULL;	
 	const ld::Atom* fromTarget;
@@ -1376,13 +1390,11 @@ void OutputFile::applyFixUps(ld::Internal& state, uint64_t mhAddress, const ld::
 	bool is_b;
 	bool thumbTarget = false;
 	bool isRelative = false;
-	std::map<uint32_t, const Fixup*> usedByHints;
 #if SUPPORT_ARCH_arm64e
 	Fixup::AuthData authData;
 #endif
 	for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
 		uint8_t* fixUpLocation = &buffer[fit->offsetInAtom];
-		ld::Fixup::LOH_arm64 lohExtra;
 		switch ( (ld::Fixup::Kind)(fit->kind) ) { 
 			case ld::Fixup::kindNone:
 			case ld::Fixup::kindNoneFollowOn:
@@ -1653,15 +1665,8 @@ void OutputFile::applyFixUps(ld::Internal& state, uint64_t mhAddress, const ld::
 			case ld::Fixup::kindDataInCodeEnd:
 				break;
 			case ld::Fixup::kindLinkerOptimizationHint:
-				// expand table of address/offsets used by hints
-				lohExtra.addend = fit->u.addend;
-				usedByHints[fit->offsetInAtom + (lohExtra.info.delta1 << 2)] = NULL;
-				if ( lohExtra.info.count > 0 )
-					usedByHints[fit->offsetInAtom + (lohExtra.info.delta2 << 2)] = NULL;
-				if ( lohExtra.info.count > 1 )
-					usedByHints[fit->offsetInAtom + (lohExtra.info.delta3 << 2)] = NULL;
-				if ( lohExtra.info.count > 2 )
-					usedByHints[fit->offsetInAtom + (lohExtra.info.delta4 << 2)] = NULL;
+				// applied by applyOptimizationHints() once all atoms have their fixups done
+				hasHints = true;
 				break;
 			case ld::Fixup::kindStoreTargetAddressLittleEndian32:
 				accumulator = addressOf(state, fit, &toTarget);
@@ -2224,460 +2229,481 @@ void OutputFile::applyFixUps(ld::Internal& state, uint64_t mhAddress, const ld::
 #endif
 		}
 	}
-	
+	return hasHints;
+}
+
 #if SUPPORT_ARCH_arm64
-	// after all fixups are done on atom, if there are potential optimizations, do those
-	if ( (usedByHints.size() != 0) && (_options.outputKind() != Options::kObjectFile) && !_options.ignoreOptimizationHints() ) {
-		// fill in second part of usedByHints map, so we can see the target of fixups that might be optimized
-		for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
-			switch ( fit->kind ) {
-				case ld::Fixup::kindLinkerOptimizationHint:
-				case ld::Fixup::kindNoneFollowOn:
-				case ld::Fixup::kindNoneGroupSubordinate:
-				case ld::Fixup::kindNoneGroupSubordinateFDE:
-				case ld::Fixup::kindNoneGroupSubordinateLSDA:
-				case ld::Fixup::kindNoneGroupSubordinatePersonality:
-					break;
-				default:
-					if ( fit->firstInCluster() ) {
-						std::map<uint32_t, const Fixup*>::iterator pos = usedByHints.find(fit->offsetInAtom);
-						if ( pos != usedByHints.end() ) {
-							assert(pos->second == NULL && "two fixups in same hint location");
-							pos->second = fit;
-							//fprintf(stderr, "setting %s usedByHints[0x%04X], kind = %d\n",  atom->name(), fit->offsetInAtom, fit->kind);
-						}
+void OutputFile::applyOptimizationHints(ld::Internal& state, const ld::Atom* atom, uint8_t* buffer)
+{
+	// build sorted table of instruction offsets used by hints and the fixup (if any) at each
+	std::vector<HintLocation> hintLocations;
+	for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
+		if ( fit->kind != ld::Fixup::kindLinkerOptimizationHint )
+			continue;
+		ld::Fixup::LOH_arm64 lohExtra;
+		lohExtra.addend = fit->u.addend;
+		hintLocations.push_back({ fit->offsetInAtom + (lohExtra.info.delta1 << 2), NULL });
+		if ( lohExtra.info.count > 0 )
+			hintLocations.push_back({ fit->offsetInAtom + (lohExtra.info.delta2 << 2), NULL });
+		if ( lohExtra.info.count > 1 )
+			hintLocations.push_back({ fit->offsetInAtom + (lohExtra.info.delta3 << 2), NULL });
+		if ( lohExtra.info.count > 2 )
+			hintLocations.push_back({ fit->offsetInAtom + (lohExtra.info.delta4 << 2), NULL });
+	}
+	if ( hintLocations.empty() )
+		return;
+	std::sort(hintLocations.begin(), hintLocations.end(), HintLocation::lessOffset);
+	hintLocations.erase(std::unique(hintLocations.begin(), hintLocations.end(),
+									[](const HintLocation& a, const HintLocation& b) { return a.offsetInAtom == b.offsetInAtom; }),
+						hintLocations.end());
+
+	// fill in fixups at those offsets, so we can see the target of fixups that might be optimized
+	for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
+		switch ( fit->kind ) {
+			case ld::Fixup::kindLinkerOptimizationHint:
+			case ld::Fixup::kindNoneFollowOn:
+			case ld::Fixup::kindNoneGroupSubordinate:
+			case ld::Fixup::kindNoneGroupSubordinateFDE:
+			case ld::Fixup::kindNoneGroupSubordinateLSDA:
+			case ld::Fixup::kindNoneGroupSubordinatePersonality:
+				break;
+			default:
+				if ( fit->firstInCluster() ) {
+					HintLocation* pos = findHintLocation(hintLocations, fit->offsetInAtom);
+					if ( pos != NULL ) {
+						assert(pos->fixup == NULL && "two fixups in same hint location");
+						pos->fixup = fit;
 					}
-			}
-		}
-		
-		// apply hints pass 1
-		for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
-			if ( fit->kind != ld::Fixup::kindLinkerOptimizationHint ) 
-				continue;
-			InstructionInfo infoA;
-			InstructionInfo infoB;
-			InstructionInfo infoC;
-			InstructionInfo infoD;
-			LoadStoreInfo ldrInfoB, ldrInfoC;
-			AddInfo addInfoB;
-			AdrpInfo adrpInfoA;
-			bool usableSegment;
-			bool targetFourByteAligned;
-			bool literalableSize, isADRP, isADD, isLDR, isSTR;
-			//uint8_t loadSize, destReg;
-			//uint32_t scaledOffset;
-			//uint32_t imm12;
-			ld::Fixup::LOH_arm64 alt;
-			alt.addend = fit->u.addend;
-			setInfo(state, atom, buffer, usedByHints, fit->offsetInAtom, (alt.info.delta1 << 2), &infoA);
-			if ( alt.info.count > 0 ) 
-				setInfo(state, atom, buffer, usedByHints, fit->offsetInAtom, (alt.info.delta2 << 2), &infoB);
-			if ( alt.info.count > 1 )
-				setInfo(state, atom, buffer, usedByHints, fit->offsetInAtom, (alt.info.delta3 << 2), &infoC);
-			if ( alt.info.count > 2 )
-				setInfo(state, atom, buffer, usedByHints, fit->offsetInAtom, (alt.info.delta4 << 2), &infoD);
-
-			if ( _options.sharedRegionEligible() ) {
-				if ( _options.sharedRegionEncodingV2() ) {
-					// In v2 format, all references might be move at dyld shared cache creation time
-					usableSegment = false;
-				}
-				else {
-					// In v1 format, only references to something in __TEXT segment could be optimized
-					usableSegment = (strcmp(atom->section().segmentName(), infoB.target->section().segmentName()) == 0);
 				}
+		}
+	}
+
+	// apply hints pass 1
+	for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
+		if ( fit->kind != ld::Fixup::kindLinkerOptimizationHint ) 
+			continue;
+		InstructionInfo infoA;
+		InstructionInfo infoB;
+		InstructionInfo infoC;
+		InstructionInfo infoD;
+		LoadStoreInfo ldrInfoB, ldrInfoC;
+		AddInfo addInfoB;
+		AdrpInfo adrpInfoA;
+		bool usableSegment;
+		bool targetFourByteAligned;
+		bool literalableSize, isADRP, isADD, isLDR, isSTR;
+		//uint8_t loadSize, destReg;
+		//uint32_t scaledOffset;
+		//uint32_t imm12;
+		ld::Fixup::LOH_arm64 alt;
+		alt.addend = fit->u.addend;
+		setInfo(state, atom, buffer, hintLocations, fit->offsetInAtom, (alt.info.delta1 << 2), &infoA);
+		if ( alt.info.count > 0 ) 
+			setInfo(state, atom, buffer, hintLocations, fit->offsetInAtom, (alt.info.delta2 << 2), &infoB);
+		if ( alt.info.count > 1 )
+			setInfo(state, atom, buffer, hintLocations, fit->offsetInAtom, (alt.info.delta3 << 2), &infoC);
+		if ( alt.info.count > 2 )
+			setInfo(state, atom, buffer, hintLocations, fit->offsetInAtom, (alt.info.delta4 << 2), &infoD);
+
+		if ( _options.sharedRegionEligible() ) {
+			if ( _options.sharedRegionEncodingV2() ) {
+				// In v2 format, all references might be move at dyld shared cache creation time
+				usableSegment = false;
 			}
 			else {
-				// main executables can optimize any reference
-				usableSegment = true;
+				// In v1 format, only references to something in __TEXT segment could be optimized
+				usableSegment = (strcmp(atom->section().segmentName(), infoB.target->section().segmentName()) == 0);
 			}
+		}
+		else {
+			// main executables can optimize any reference
+			usableSegment = true;
+		}
 
-			switch ( alt.info.kind ) {
-				case LOH_ARM64_ADRP_ADRP:
-					// processed in pass 2 because some ADRP may have been removed
+		switch ( alt.info.kind ) {
+			case LOH_ARM64_ADRP_ADRP:
+				// processed in pass 2 because some ADRP may have been removed
+				break;
+			case LOH_ARM64_ADRP_LDR:
+				LOH_ASSERT(alt.info.count == 1);
+				LOH_ASSERT(isPageKind(infoA.fixup));
+				LOH_ASSERT(isPageOffsetKind(infoB.fixup));
+				LOH_ASSERT(infoA.target == infoB.target);
+				LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
+				isADRP = parseADRP(infoA.instruction, adrpInfoA);
+				LOH_ASSERT(isADRP);
+				isLDR = parseLoadOrStore(infoB.instruction, ldrInfoB);
+				// silently ignore LDRs transformed to ADD by TLV pass
+				if ( !isLDR && infoB.fixup->kind == ld::Fixup::kindStoreTargetAddressARM64TLVPLoadNowLeaPageOff12 )
 					break;
-				case LOH_ARM64_ADRP_LDR:
-					LOH_ASSERT(alt.info.count == 1);
-					LOH_ASSERT(isPageKind(infoA.fixup));
-					LOH_ASSERT(isPageOffsetKind(infoB.fixup));
-					LOH_ASSERT(infoA.target == infoB.target);
-					LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
-					isADRP = parseADRP(infoA.instruction, adrpInfoA);
-					LOH_ASSERT(isADRP);
-					isLDR = parseLoadOrStore(infoB.instruction, ldrInfoB);
-					// silently ignore LDRs transformed to ADD by TLV pass
-					if ( !isLDR && infoB.fixup->kind == ld::Fixup::kindStoreTargetAddressARM64TLVPLoadNowLeaPageOff12 )
-						break;
-					LOH_ASSERT(isLDR);
-					LOH_ASSERT(ldrInfoB.baseReg == adrpInfoA.destReg);
-					LOH_ASSERT(ldrInfoB.offset == (infoA.targetAddress & 0x00000FFF));
-					literalableSize = ( (ldrInfoB.size != 1) && (ldrInfoB.size != 2) );
-					targetFourByteAligned = ( (infoA.targetAddress & 0x3) == 0 );
-					if ( literalableSize && usableSegment && targetFourByteAligned && withinOneMeg(infoB.instructionAddress, infoA.targetAddress) ) {
+				LOH_ASSERT(isLDR);
+				LOH_ASSERT(ldrInfoB.baseReg == adrpInfoA.destReg);
+				LOH_ASSERT(ldrInfoB.offset == (infoA.targetAddress & 0x00000FFF));
+				literalableSize = ( (ldrInfoB.size != 1) && (ldrInfoB.size != 2) );
+				targetFourByteAligned = ( (infoA.targetAddress & 0x3) == 0 );
+				if ( literalableSize && usableSegment && targetFourByteAligned && withinOneMeg(infoB.instructionAddress, infoA.targetAddress) ) {
+					set32LE(infoA.instructionContent, makeNOP());
+					set32LE(infoB.instructionContent, makeLDR_literal(ldrInfoB, infoA.targetAddress, infoB.instructionAddress));
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-ldr at 0x%08llX transformed to LDR literal, usableSegment=%d usableSegment\n", infoB.instructionAddress, usableSegment);
+				}
+				else {
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-ldr at 0x%08llX not transformed, isLDR=%d, literalableSize=%d, inRange=%d, usableSegment=%d, scaledOffset=%d\n", 
+							infoB.instructionAddress, isLDR, literalableSize, withinOneMeg(infoB.instructionAddress, infoA.targetAddress), usableSegment, ldrInfoB.offset);
+				}
+				break;
+			case LOH_ARM64_ADRP_ADD_LDR:
+				LOH_ASSERT(alt.info.count == 2);
+				LOH_ASSERT(isPageKind(infoA.fixup));
+				LOH_ASSERT(isPageOffsetKind(infoB.fixup));
+				LOH_ASSERT(infoC.fixup == NULL);
+				LOH_ASSERT(infoA.target == infoB.target);
+				LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
+				isADRP = parseADRP(infoA.instruction, adrpInfoA);
+				LOH_ASSERT(isADRP);
+				isADD = parseADD(infoB.instruction, addInfoB);
+				LOH_ASSERT(isADD);
+				LOH_ASSERT(adrpInfoA.destReg == addInfoB.srcReg);
+				isLDR = parseLoadOrStore(infoC.instruction, ldrInfoC);
+				LOH_ASSERT(isLDR);
+				LOH_ASSERT(addInfoB.destReg == ldrInfoC.baseReg);
+				targetFourByteAligned = ( ((infoB.targetAddress+ldrInfoC.offset) & 0x3) == 0 );
+				literalableSize  = ( (ldrInfoC.size != 1) && (ldrInfoC.size != 2) );
+				if ( literalableSize && usableSegment && targetFourByteAligned && withinOneMeg(infoC.instructionAddress, infoA.targetAddress+ldrInfoC.offset) ) {
+					// can do T1 transformation to LDR literal
+					set32LE(infoA.instructionContent, makeNOP());
+					set32LE(infoB.instructionContent, makeNOP());
+					set32LE(infoC.instructionContent, makeLDR_literal(ldrInfoC, infoA.targetAddress+ldrInfoC.offset, infoC.instructionAddress));
+					if ( _options.verboseOptimizationHints() ) {
+						fprintf(stderr, "adrp-add-ldr at 0x%08llX T1 transformed to LDR literal\n", infoC.instructionAddress);
+					}
+				}
+				else if ( usableSegment && withinOneMeg(infoA.instructionAddress, infoA.targetAddress+ldrInfoC.offset) ) {
+					// can to T4 transformation and turn ADRP/ADD into ADR
+					set32LE(infoA.instructionContent, makeADR(ldrInfoC.baseReg, infoA.targetAddress+ldrInfoC.offset, infoA.instructionAddress));
+					set32LE(infoB.instructionContent, makeNOP());	
+					ldrInfoC.offset = 0; // offset is now in ADR instead of ADD or LDR
+					set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
+					set32LE(infoC.instructionContent, infoC.instruction & 0xFFC003FF);	
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-add-ldr at 0x%08llX T4 transformed to ADR/LDR\n", infoB.instructionAddress);						
+				}
+				else if ( ((infoB.targetAddress % ldrInfoC.size) == 0) && (ldrInfoC.offset == 0) ) {
+					// can do T2 transformation by merging ADD into LD
+					// Leave ADRP as-is
+					set32LE(infoB.instructionContent, makeNOP());	
+					ldrInfoC.offset += addInfoB.addend;
+					ldrInfoC.baseReg = adrpInfoA.destReg;
+					set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-add-ldr at 0x%08llX T2 transformed to ADRP/LDR \n", infoC.instructionAddress);
+				}
+				else {
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-add-ldr at 0x%08llX could not be transformed, loadSize=%d, literalableSize=%d, inRange=%d, usableSegment=%d, targetFourByteAligned=%d, imm12=%d\n", 
+								infoC.instructionAddress, ldrInfoC.size, literalableSize, withinOneMeg(infoC.instructionAddress, infoA.targetAddress+ldrInfoC.offset), usableSegment, targetFourByteAligned, ldrInfoC.offset);
+				}
+				break;
+			case LOH_ARM64_ADRP_ADD:
+				LOH_ASSERT(alt.info.count == 1);
+				LOH_ASSERT(isPageKind(infoA.fixup));
+				LOH_ASSERT(isPageOffsetKind(infoB.fixup));
+				LOH_ASSERT(infoA.target == infoB.target);
+				LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
+				isADRP = parseADRP(infoA.instruction, adrpInfoA);
+				LOH_ASSERT(isADRP);
+				isADD = parseADD(infoB.instruction, addInfoB);
+				LOH_ASSERT(isADD);
+				LOH_ASSERT(adrpInfoA.destReg == addInfoB.srcReg);
+				if ( usableSegment && withinOneMeg(infoA.targetAddress, infoA.instructionAddress) ) {
+					// can do T4 transformation and use ADR 
+					set32LE(infoA.instructionContent, makeADR(addInfoB.destReg, infoA.targetAddress, infoA.instructionAddress));
+					set32LE(infoB.instructionContent, makeNOP());	
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-add at 0x%08llX transformed to ADR\n", infoB.instructionAddress);
+				}
+				else {
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-add at 0x%08llX not transformed, isAdd=%d, inRange=%d, usableSegment=%d\n", 
+							infoB.instructionAddress, isADD, withinOneMeg(infoA.targetAddress, infoA.instructionAddress), usableSegment);
+				}
+				break;
+			case LOH_ARM64_ADRP_LDR_GOT_LDR:
+				LOH_ASSERT(alt.info.count == 2);
+				LOH_ASSERT(isPageKind(infoA.fixup, true));
+				LOH_ASSERT(isPageOffsetKind(infoB.fixup, true));
+				LOH_ASSERT(infoC.fixup == NULL);
+				LOH_ASSERT(infoA.target == infoB.target);
+				LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
+				isADRP = parseADRP(infoA.instruction, adrpInfoA);
+				LOH_ASSERT(isADRP);
+				isLDR = parseLoadOrStore(infoC.instruction, ldrInfoC);
+				LOH_ASSERT(isLDR);
+				isADD = parseADD(infoB.instruction, addInfoB);
+				isLDR = parseLoadOrStore(infoB.instruction, ldrInfoB);
+				if ( isLDR ) {
+					// target of GOT is external
+					LOH_ASSERT((_options.architecture() == CPU_TYPE_ARM64 && ldrInfoB.size == 8) ||
+					           (_options.architecture() == CPU_TYPE_ARM64_32 && ldrInfoB.size == 4));
+					LOH_ASSERT(!ldrInfoB.isFloat);
+					LOH_ASSERT(ldrInfoC.baseReg == ldrInfoB.reg);
+					//fprintf(stderr, "infoA.target=%p, %s, infoA.targetAddress=0x%08llX\n", infoA.target, infoA.target->name(), infoA.targetAddress);
+					targetFourByteAligned = ( ((infoA.targetAddress + ldrInfoC.offset) & 0x3) == 0 );
+					if ( usableSegment && targetFourByteAligned && withinOneMeg(infoB.instructionAddress, infoA.targetAddress + ldrInfoC.offset) ) {
+						// can do T5 transform
 						set32LE(infoA.instructionContent, makeNOP());
 						set32LE(infoB.instructionContent, makeLDR_literal(ldrInfoB, infoA.targetAddress, infoB.instructionAddress));
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-ldr at 0x%08llX transformed to LDR literal, usableSegment=%d usableSegment\n", infoB.instructionAddress, usableSegment);
+						if ( _options.verboseOptimizationHints() ) {
+							fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX T5 transformed to LDR literal of GOT plus LDR\n", infoC.instructionAddress);
+						}
 					}
 					else {
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-ldr at 0x%08llX not transformed, isLDR=%d, literalableSize=%d, inRange=%d, usableSegment=%d, scaledOffset=%d\n", 
-								infoB.instructionAddress, isLDR, literalableSize, withinOneMeg(infoB.instructionAddress, infoA.targetAddress), usableSegment, ldrInfoB.offset);
+						if ( _options.verboseOptimizationHints() ) 
+							fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX no optimization done\n", infoC.instructionAddress);
 					}
-					break;
-				case LOH_ARM64_ADRP_ADD_LDR:
-					LOH_ASSERT(alt.info.count == 2);
-					LOH_ASSERT(isPageKind(infoA.fixup));
-					LOH_ASSERT(isPageOffsetKind(infoB.fixup));
-					LOH_ASSERT(infoC.fixup == NULL);
-					LOH_ASSERT(infoA.target == infoB.target);
-					LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
-					isADRP = parseADRP(infoA.instruction, adrpInfoA);
-					LOH_ASSERT(isADRP);
-					isADD = parseADD(infoB.instruction, addInfoB);
-					LOH_ASSERT(isADD);
-					LOH_ASSERT(adrpInfoA.destReg == addInfoB.srcReg);
-					isLDR = parseLoadOrStore(infoC.instruction, ldrInfoC);
-					LOH_ASSERT(isLDR);
+				}
+				else if ( isADD ) {
+					// target of GOT is in same linkage unit and B instruction was changed to ADD to compute LEA of target
+					LOH_ASSERT(addInfoB.srcReg == adrpInfoA.destReg);
 					LOH_ASSERT(addInfoB.destReg == ldrInfoC.baseReg);
-					targetFourByteAligned = ( ((infoB.targetAddress+ldrInfoC.offset) & 0x3) == 0 );
+					targetFourByteAligned = ( ((infoA.targetAddress) & 0x3) == 0 );
 					literalableSize  = ( (ldrInfoC.size != 1) && (ldrInfoC.size != 2) );
-					if ( literalableSize && usableSegment && targetFourByteAligned && withinOneMeg(infoC.instructionAddress, infoA.targetAddress+ldrInfoC.offset) ) {
-						// can do T1 transformation to LDR literal
-						set32LE(infoA.instructionContent, makeNOP());
-						set32LE(infoB.instructionContent, makeNOP());
-						set32LE(infoC.instructionContent, makeLDR_literal(ldrInfoC, infoA.targetAddress+ldrInfoC.offset, infoC.instructionAddress));
-						if ( _options.verboseOptimizationHints() ) {
-							fprintf(stderr, "adrp-add-ldr at 0x%08llX T1 transformed to LDR literal\n", infoC.instructionAddress);
-						}
+					if ( usableSegment && literalableSize && targetFourByteAligned && withinOneMeg(infoC.instructionAddress, infoA.targetAddress + ldrInfoC.offset) ) {
+						// can do T1 transform
+						set32LE(infoA.instructionContent, makeNOP());	
+						set32LE(infoB.instructionContent, makeNOP());	
+						set32LE(infoC.instructionContent, makeLDR_literal(ldrInfoC, infoA.targetAddress + ldrInfoC.offset, infoC.instructionAddress));
+						if ( _options.verboseOptimizationHints() ) 
+							fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX T1 transformed to LDR literal\n", infoC.instructionAddress);
 					}
-					else if ( usableSegment && withinOneMeg(infoA.instructionAddress, infoA.targetAddress+ldrInfoC.offset) ) {
-						// can to T4 transformation and turn ADRP/ADD into ADR
-						set32LE(infoA.instructionContent, makeADR(ldrInfoC.baseReg, infoA.targetAddress+ldrInfoC.offset, infoA.instructionAddress));
+					else if ( usableSegment && withinOneMeg(infoA.instructionAddress, infoA.targetAddress) ) {
+						// can do T4 transform
+						set32LE(infoA.instructionContent, makeADR(ldrInfoC.baseReg, infoA.targetAddress, infoA.instructionAddress));
 						set32LE(infoB.instructionContent, makeNOP());	
-						ldrInfoC.offset = 0; // offset is now in ADR instead of ADD or LDR
 						set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
-						set32LE(infoC.instructionContent, infoC.instruction & 0xFFC003FF);	
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-add-ldr at 0x%08llX T4 transformed to ADR/LDR\n", infoB.instructionAddress);						
+						if ( _options.verboseOptimizationHints() ) {
+							fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX T4 transformed to ADR/LDR\n", infoC.instructionAddress);
+						}
 					}
-					else if ( ((infoB.targetAddress % ldrInfoC.size) == 0) && (ldrInfoC.offset == 0) ) {
-						// can do T2 transformation by merging ADD into LD
-						// Leave ADRP as-is
-						set32LE(infoB.instructionContent, makeNOP());	
-						ldrInfoC.offset += addInfoB.addend;
+					else if ( ((infoA.targetAddress % ldrInfoC.size) == 0) && ((addInfoB.addend + ldrInfoC.offset) < 4096) ) {
+						// can do T2 transform
+						set32LE(infoB.instructionContent, makeNOP());
 						ldrInfoC.baseReg = adrpInfoA.destReg;
+						ldrInfoC.offset += addInfoB.addend;
 						set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-add-ldr at 0x%08llX T2 transformed to ADRP/LDR \n", infoC.instructionAddress);
-					}
-					else {
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-add-ldr at 0x%08llX could not be transformed, loadSize=%d, literalableSize=%d, inRange=%d, usableSegment=%d, targetFourByteAligned=%d, imm12=%d\n", 
-									infoC.instructionAddress, ldrInfoC.size, literalableSize, withinOneMeg(infoC.instructionAddress, infoA.targetAddress+ldrInfoC.offset), usableSegment, targetFourByteAligned, ldrInfoC.offset);
-					}
-					break;
-				case LOH_ARM64_ADRP_ADD:
-					LOH_ASSERT(alt.info.count == 1);
-					LOH_ASSERT(isPageKind(infoA.fixup));
-					LOH_ASSERT(isPageOffsetKind(infoB.fixup));
-					LOH_ASSERT(infoA.target == infoB.target);
-					LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
-					isADRP = parseADRP(infoA.instruction, adrpInfoA);
-					LOH_ASSERT(isADRP);
-					isADD = parseADD(infoB.instruction, addInfoB);
-					LOH_ASSERT(isADD);
-					LOH_ASSERT(adrpInfoA.destReg == addInfoB.srcReg);
-					if ( usableSegment && withinOneMeg(infoA.targetAddress, infoA.instructionAddress) ) {
-						// can do T4 transformation and use ADR 
-						set32LE(infoA.instructionContent, makeADR(addInfoB.destReg, infoA.targetAddress, infoA.instructionAddress));
-						set32LE(infoB.instructionContent, makeNOP());	
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-add at 0x%08llX transformed to ADR\n", infoB.instructionAddress);
+						if ( _options.verboseOptimizationHints() ) {
+							fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX T2 transformed to ADRP/NOP/LDR\n", infoC.instructionAddress);
+						}
 					}
 					else {
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-add at 0x%08llX not transformed, isAdd=%d, inRange=%d, usableSegment=%d\n", 
-								infoB.instructionAddress, isADD, withinOneMeg(infoA.targetAddress, infoA.instructionAddress), usableSegment);
-					}
-					break;
-				case LOH_ARM64_ADRP_LDR_GOT_LDR:
-					LOH_ASSERT(alt.info.count == 2);
-					LOH_ASSERT(isPageKind(infoA.fixup, true));
-					LOH_ASSERT(isPageOffsetKind(infoB.fixup, true));
-					LOH_ASSERT(infoC.fixup == NULL);
-					LOH_ASSERT(infoA.target == infoB.target);
-					LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
-					isADRP = parseADRP(infoA.instruction, adrpInfoA);
-					LOH_ASSERT(isADRP);
-					isLDR = parseLoadOrStore(infoC.instruction, ldrInfoC);
-					LOH_ASSERT(isLDR);
-					isADD = parseADD(infoB.instruction, addInfoB);
-					isLDR = parseLoadOrStore(infoB.instruction, ldrInfoB);
-					if ( isLDR ) {
-						// target of GOT is external
-						LOH_ASSERT((_options.architecture() == CPU_TYPE_ARM64 && ldrInfoB.size == 8) ||
-						           (_options.architecture() == CPU_TYPE_ARM64_32 && ldrInfoB.size == 4));
-						LOH_ASSERT(!ldrInfoB.isFloat);
-						LOH_ASSERT(ldrInfoC.baseReg == ldrInfoB.reg);
-						//fprintf(stderr, "infoA.target=%p, %s, infoA.targetAddress=0x%08llX\n", infoA.target, infoA.target->name(), infoA.targetAddress);
-						targetFourByteAligned = ( ((infoA.targetAddress + ldrInfoC.offset) & 0x3) == 0 );
-						if ( usableSegment && targetFourByteAligned && withinOneMeg(infoB.instructionAddress, infoA.targetAddress + ldrInfoC.offset) ) {
-							// can do T5 transform
-							set32LE(infoA.instructionContent, makeNOP());
-							set32LE(infoB.instructionContent, makeLDR_literal(ldrInfoB, infoA.targetAddress, infoB.instructionAddress));
-							if ( _options.verboseOptimizationHints() ) {
-								fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX T5 transformed to LDR literal of GOT plus LDR\n", infoC.instructionAddress);
-							}
-						}
-						else {
-							if ( _options.verboseOptimizationHints() ) 
-								fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX no optimization done\n", infoC.instructionAddress);
+						// T3 transform already done by ld::passes:got:doPass()
+						if ( _options.verboseOptimizationHints() ) {
+							fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX T3 transformed to ADRP/ADD/LDR\n", infoC.instructionAddress);
 						}
 					}
-					else if ( isADD ) {
-						// target of GOT is in same linkage unit and B instruction was changed to ADD to compute LEA of target
-						LOH_ASSERT(addInfoB.srcReg == adrpInfoA.destReg);
-						LOH_ASSERT(addInfoB.destReg == ldrInfoC.baseReg);
-						targetFourByteAligned = ( ((infoA.targetAddress) & 0x3) == 0 );
-						literalableSize  = ( (ldrInfoC.size != 1) && (ldrInfoC.size != 2) );
-						if ( usableSegment && literalableSize && targetFourByteAligned && withinOneMeg(infoC.instructionAddress, infoA.targetAddress + ldrInfoC.offset) ) {
-							// can do T1 transform
-							set32LE(infoA.instructionContent, makeNOP());	
-							set32LE(infoB.instructionContent, makeNOP());	
-							set32LE(infoC.instructionContent, makeLDR_literal(ldrInfoC, infoA.targetAddress + ldrInfoC.offset, infoC.instructionAddress));
-							if ( _options.verboseOptimizationHints() ) 
-								fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX T1 transformed to LDR literal\n", infoC.instructionAddress);
-						}
-						else if ( usableSegment && withinOneMeg(infoA.instructionAddress, infoA.targetAddress) ) {
-							// can do T4 transform
-							set32LE(infoA.instructionContent, makeADR(ldrInfoC.baseReg, infoA.targetAddress, infoA.instructionAddress));
-							set32LE(infoB.instructionContent, makeNOP());	
-							set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
-							if ( _options.verboseOptimizationHints() ) {
-								fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX T4 transformed to ADR/LDR\n", infoC.instructionAddress);
-							}
-						}
-						else if ( ((infoA.targetAddress % ldrInfoC.size) == 0) && ((addInfoB.addend + ldrInfoC.offset) < 4096) ) {
-							// can do T2 transform
-							set32LE(infoB.instructionContent, makeNOP());
-							ldrInfoC.baseReg = adrpInfoA.destReg;
-							ldrInfoC.offset += addInfoB.addend;
-							set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
-							if ( _options.verboseOptimizationHints() ) {
-								fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX T2 transformed to ADRP/NOP/LDR\n", infoC.instructionAddress);
-							}
-						}
-						else {
-							// T3 transform already done by ld::passes:got:doPass()
-							if ( _options.verboseOptimizationHints() ) {
-								fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX T3 transformed to ADRP/ADD/LDR\n", infoC.instructionAddress);
-							}
+				}
+				else {
+					if ( _options.verboseOptimizationHints() ) 							
+						fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX not ADD or LDR\n", infoC.instructionAddress);
+				}
+				break;
+			case LOH_ARM64_ADRP_ADD_STR:
+				LOH_ASSERT(alt.info.count == 2);
+				LOH_ASSERT(isPageKind(infoA.fixup));
+				LOH_ASSERT(isPageOffsetKind(infoB.fixup));
+				LOH_ASSERT(infoC.fixup == NULL);
+				LOH_ASSERT(infoA.target == infoB.target);
+				LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
+				isADRP = parseADRP(infoA.instruction, adrpInfoA);
+				LOH_ASSERT(isADRP);
+				isADD = parseADD(infoB.instruction, addInfoB);
+				LOH_ASSERT(isADD);
+				LOH_ASSERT(adrpInfoA.destReg == addInfoB.srcReg);
+				isSTR = (parseLoadOrStore(infoC.instruction, ldrInfoC) && ldrInfoC.isStore);
+				LOH_ASSERT(isSTR);
+				LOH_ASSERT(addInfoB.destReg == ldrInfoC.baseReg);
+				if ( usableSegment && withinOneMeg(infoA.instructionAddress, infoA.targetAddress+ldrInfoC.offset) ) {
+					// can to T4 transformation and turn ADRP/ADD into ADR
+					set32LE(infoA.instructionContent, makeADR(ldrInfoC.baseReg, infoA.targetAddress+ldrInfoC.offset, infoA.instructionAddress));
+					set32LE(infoB.instructionContent, makeNOP());	
+					ldrInfoC.offset = 0; // offset is now in ADR instead of ADD or LDR
+					set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
+					set32LE(infoC.instructionContent, infoC.instruction & 0xFFC003FF);	
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-add-str at 0x%08llX T4 transformed to ADR/STR\n", infoB.instructionAddress);						
+				}
+				else if ( ((infoB.targetAddress % ldrInfoC.size) == 0) && (ldrInfoC.offset == 0) ) {
+					// can do T2 transformation by merging ADD into STR
+					// Leave ADRP as-is
+					set32LE(infoB.instructionContent, makeNOP());	
+					ldrInfoC.offset += addInfoB.addend;
+					set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-add-str at 0x%08llX T2 transformed to ADRP/STR \n", infoC.instructionAddress);
+				}
+				else {
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-add-str at 0x%08llX could not be transformed, loadSize=%d, inRange=%d, usableSegment=%d, imm12=%d\n", 
+								infoC.instructionAddress, ldrInfoC.size, withinOneMeg(infoC.instructionAddress, infoA.targetAddress+ldrInfoC.offset), usableSegment, ldrInfoC.offset);
+				}
+				break;
+			case LOH_ARM64_ADRP_LDR_GOT_STR:
+				LOH_ASSERT(alt.info.count == 2);
+				LOH_ASSERT(isPageKind(infoA.fixup, true));
+				LOH_ASSERT(isPageOffsetKind(infoB.fixup, true));
+				LOH_ASSERT(infoC.fixup == NULL);
+				LOH_ASSERT(infoA.target == infoB.target);
+				LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
+				isADRP = parseADRP(infoA.instruction, adrpInfoA);
+				LOH_ASSERT(isADRP);
+				isSTR = (parseLoadOrStore(infoC.instruction, ldrInfoC) && ldrInfoC.isStore);
+				LOH_ASSERT(isSTR);
+				isADD = parseADD(infoB.instruction, addInfoB);
+				isLDR = parseLoadOrStore(infoB.instruction, ldrInfoB);
+				if ( isLDR ) {
+					// target of GOT is external
+					LOH_ASSERT((_options.architecture() == CPU_TYPE_ARM64 && ldrInfoB.size == 8) ||
+					           (_options.architecture() == CPU_TYPE_ARM64_32 && ldrInfoB.size == 4));
+					LOH_ASSERT(!ldrInfoB.isFloat);
+					LOH_ASSERT(ldrInfoC.baseReg == ldrInfoB.reg);
+					targetFourByteAligned = ( ((infoA.targetAddress + ldrInfoC.offset) & 0x3) == 0 );
+					if ( usableSegment && targetFourByteAligned && withinOneMeg(infoB.instructionAddress, infoA.targetAddress + ldrInfoC.offset) ) {
+						// can do T5 transform
+						set32LE(infoA.instructionContent, makeNOP());
+						set32LE(infoB.instructionContent, makeLDR_literal(ldrInfoB, infoA.targetAddress, infoB.instructionAddress));
+						if ( _options.verboseOptimizationHints() ) {
+							fprintf(stderr, "adrp-ldr-got-str at 0x%08llX T5 transformed to LDR literal of GOT plus STR\n", infoC.instructionAddress);
 						}
 					}
 					else {
-						if ( _options.verboseOptimizationHints() ) 							
-							fprintf(stderr, "adrp-ldr-got-ldr at 0x%08llX not ADD or LDR\n", infoC.instructionAddress);
+						if ( _options.verboseOptimizationHints() ) 
+							fprintf(stderr, "adrp-ldr-got-str at 0x%08llX no optimization done\n", infoC.instructionAddress);
 					}
-					break;
-				case LOH_ARM64_ADRP_ADD_STR:
-					LOH_ASSERT(alt.info.count == 2);
-					LOH_ASSERT(isPageKind(infoA.fixup));
-					LOH_ASSERT(isPageOffsetKind(infoB.fixup));
-					LOH_ASSERT(infoC.fixup == NULL);
-					LOH_ASSERT(infoA.target == infoB.target);
-					LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
-					isADRP = parseADRP(infoA.instruction, adrpInfoA);
-					LOH_ASSERT(isADRP);
-					isADD = parseADD(infoB.instruction, addInfoB);
-					LOH_ASSERT(isADD);
-					LOH_ASSERT(adrpInfoA.destReg == addInfoB.srcReg);
-					isSTR = (parseLoadOrStore(infoC.instruction, ldrInfoC) && ldrInfoC.isStore);
-					LOH_ASSERT(isSTR);
+				}
+				else if ( isADD ) {
+					// target of GOT is in same linkage unit and B instruction was changed to ADD to compute LEA of target
+					LOH_ASSERT(addInfoB.srcReg == adrpInfoA.destReg);
 					LOH_ASSERT(addInfoB.destReg == ldrInfoC.baseReg);
-					if ( usableSegment && withinOneMeg(infoA.instructionAddress, infoA.targetAddress+ldrInfoC.offset) ) {
-						// can to T4 transformation and turn ADRP/ADD into ADR
-						set32LE(infoA.instructionContent, makeADR(ldrInfoC.baseReg, infoA.targetAddress+ldrInfoC.offset, infoA.instructionAddress));
+					targetFourByteAligned = ( ((infoA.targetAddress) & 0x3) == 0 );
+					literalableSize  = ( (ldrInfoC.size != 1) && (ldrInfoC.size != 2) );
+					if ( usableSegment && withinOneMeg(infoA.instructionAddress, infoA.targetAddress) ) {
+						// can do T4 transform
+						set32LE(infoA.instructionContent, makeADR(ldrInfoC.baseReg, infoA.targetAddress, infoA.instructionAddress));
 						set32LE(infoB.instructionContent, makeNOP());	
-						ldrInfoC.offset = 0; // offset is now in ADR instead of ADD or LDR
 						set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
-						set32LE(infoC.instructionContent, infoC.instruction & 0xFFC003FF);	
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-add-str at 0x%08llX T4 transformed to ADR/STR\n", infoB.instructionAddress);						
+						if ( _options.verboseOptimizationHints() ) {
+							fprintf(stderr, "adrp-ldr-got-str at 0x%08llX T4 transformed to ADR/STR\n", infoC.instructionAddress);
+						}
 					}
-					else if ( ((infoB.targetAddress % ldrInfoC.size) == 0) && (ldrInfoC.offset == 0) ) {
-						// can do T2 transformation by merging ADD into STR
-						// Leave ADRP as-is
-						set32LE(infoB.instructionContent, makeNOP());	
+					else if ( ((infoA.targetAddress % ldrInfoC.size) == 0) && (ldrInfoC.offset == 0) ) {
+						// can do T2 transform
+						set32LE(infoB.instructionContent, makeNOP());
+						ldrInfoC.baseReg = adrpInfoA.destReg;
 						ldrInfoC.offset += addInfoB.addend;
 						set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-add-str at 0x%08llX T2 transformed to ADRP/STR \n", infoC.instructionAddress);
+						if ( _options.verboseOptimizationHints() ) {
+							fprintf(stderr, "adrp-ldr-got-str at 0x%08llX T4 transformed to ADRP/NOP/STR\n", infoC.instructionAddress);
+						}
 					}
 					else {
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-add-str at 0x%08llX could not be transformed, loadSize=%d, inRange=%d, usableSegment=%d, imm12=%d\n", 
-									infoC.instructionAddress, ldrInfoC.size, withinOneMeg(infoC.instructionAddress, infoA.targetAddress+ldrInfoC.offset), usableSegment, ldrInfoC.offset);
+						// T3 transform already done by ld::passes:got:doPass()
+						if ( _options.verboseOptimizationHints() ) {
+							fprintf(stderr, "adrp-ldr-got-str at 0x%08llX T3 transformed to ADRP/ADD/STR\n", infoC.instructionAddress);
+						}
 					}
-					break;
-				case LOH_ARM64_ADRP_LDR_GOT_STR:
-					LOH_ASSERT(alt.info.count == 2);
-					LOH_ASSERT(isPageKind(infoA.fixup, true));
-					LOH_ASSERT(isPageOffsetKind(infoB.fixup, true));
-					LOH_ASSERT(infoC.fixup == NULL);
-					LOH_ASSERT(infoA.target == infoB.target);
-					LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
-					isADRP = parseADRP(infoA.instruction, adrpInfoA);
-					LOH_ASSERT(isADRP);
-					isSTR = (parseLoadOrStore(infoC.instruction, ldrInfoC) && ldrInfoC.isStore);
-					LOH_ASSERT(isSTR);
-					isADD = parseADD(infoB.instruction, addInfoB);
-					isLDR = parseLoadOrStore(infoB.instruction, ldrInfoB);
+				}
+				else {
+					if ( _options.verboseOptimizationHints() ) 							
+						fprintf(stderr, "adrp-ldr-got-str at 0x%08llX not ADD or LDR\n", infoC.instructionAddress);
+				}
+				break;
+			case LOH_ARM64_ADRP_LDR_GOT:
+				LOH_ASSERT(alt.info.count == 1);
+				LOH_ASSERT(isPageKind(infoA.fixup, true));
+				LOH_ASSERT(isPageOffsetKind(infoB.fixup, true));
+				LOH_ASSERT(infoA.target == infoB.target);
+				LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
+				isADRP = parseADRP(infoA.instruction, adrpInfoA);
+				isADD = parseADD(infoB.instruction, addInfoB);
+				isLDR = parseLoadOrStore(infoB.instruction, ldrInfoB);
+				if ( isADRP ) {
 					if ( isLDR ) {
-						// target of GOT is external
-						LOH_ASSERT((_options.architecture() == CPU_TYPE_ARM64 && ldrInfoB.size == 8) ||
-						           (_options.architecture() == CPU_TYPE_ARM64_32 && ldrInfoB.size == 4));
-						LOH_ASSERT(!ldrInfoB.isFloat);
-						LOH_ASSERT(ldrInfoC.baseReg == ldrInfoB.reg);
-						targetFourByteAligned = ( ((infoA.targetAddress + ldrInfoC.offset) & 0x3) == 0 );
-						if ( usableSegment && targetFourByteAligned && withinOneMeg(infoB.instructionAddress, infoA.targetAddress + ldrInfoC.offset) ) {
-							// can do T5 transform
+						if ( usableSegment && withinOneMeg(infoB.instructionAddress, infoA.targetAddress) ) {
+							// can do T5 transform (LDR literal load of GOT)
 							set32LE(infoA.instructionContent, makeNOP());
 							set32LE(infoB.instructionContent, makeLDR_literal(ldrInfoB, infoA.targetAddress, infoB.instructionAddress));
 							if ( _options.verboseOptimizationHints() ) {
-								fprintf(stderr, "adrp-ldr-got-str at 0x%08llX T5 transformed to LDR literal of GOT plus STR\n", infoC.instructionAddress);
+								fprintf(stderr, "adrp-ldr-got at 0x%08llX T5 transformed to NOP/LDR\n", infoC.instructionAddress);
 							}
 						}
-						else {
-							if ( _options.verboseOptimizationHints() ) 
-								fprintf(stderr, "adrp-ldr-got-str at 0x%08llX no optimization done\n", infoC.instructionAddress);
-						}
 					}
 					else if ( isADD ) {
-						// target of GOT is in same linkage unit and B instruction was changed to ADD to compute LEA of target
-						LOH_ASSERT(addInfoB.srcReg == adrpInfoA.destReg);
-						LOH_ASSERT(addInfoB.destReg == ldrInfoC.baseReg);
-						targetFourByteAligned = ( ((infoA.targetAddress) & 0x3) == 0 );
-						literalableSize  = ( (ldrInfoC.size != 1) && (ldrInfoC.size != 2) );
 						if ( usableSegment && withinOneMeg(infoA.instructionAddress, infoA.targetAddress) ) {
-							// can do T4 transform
-							set32LE(infoA.instructionContent, makeADR(ldrInfoC.baseReg, infoA.targetAddress, infoA.instructionAddress));
-							set32LE(infoB.instructionContent, makeNOP());	
-							set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
-							if ( _options.verboseOptimizationHints() ) {
-								fprintf(stderr, "adrp-ldr-got-str at 0x%08llX T4 transformed to ADR/STR\n", infoC.instructionAddress);
-							}
-						}
-						else if ( ((infoA.targetAddress % ldrInfoC.size) == 0) && (ldrInfoC.offset == 0) ) {
-							// can do T2 transform
+							// can do T4 transform (ADR to compute local address)
+							set32LE(infoA.instructionContent, makeADR(addInfoB.destReg, infoA.targetAddress, infoA.instructionAddress));
 							set32LE(infoB.instructionContent, makeNOP());
-							ldrInfoC.baseReg = adrpInfoA.destReg;
-							ldrInfoC.offset += addInfoB.addend;
-							set32LE(infoC.instructionContent, makeLoadOrStore(ldrInfoC));
-							if ( _options.verboseOptimizationHints() ) {
-								fprintf(stderr, "adrp-ldr-got-str at 0x%08llX T4 transformed to ADRP/NOP/STR\n", infoC.instructionAddress);
-							}
-						}
-						else {
-							// T3 transform already done by ld::passes:got:doPass()
 							if ( _options.verboseOptimizationHints() ) {
-								fprintf(stderr, "adrp-ldr-got-str at 0x%08llX T3 transformed to ADRP/ADD/STR\n", infoC.instructionAddress);
-							}
-						}
-					}
-					else {
-						if ( _options.verboseOptimizationHints() ) 							
-							fprintf(stderr, "adrp-ldr-got-str at 0x%08llX not ADD or LDR\n", infoC.instructionAddress);
-					}
-					break;
-				case LOH_ARM64_ADRP_LDR_GOT:
-					LOH_ASSERT(alt.info.count == 1);
-					LOH_ASSERT(isPageKind(infoA.fixup, true));
-					LOH_ASSERT(isPageOffsetKind(infoB.fixup, true));
-					LOH_ASSERT(infoA.target == infoB.target);
-					LOH_ASSERT(infoA.targetAddress == infoB.targetAddress);
-					isADRP = parseADRP(infoA.instruction, adrpInfoA);
-					isADD = parseADD(infoB.instruction, addInfoB);
-					isLDR = parseLoadOrStore(infoB.instruction, ldrInfoB);
-					if ( isADRP ) {
-						if ( isLDR ) {
-							if ( usableSegment && withinOneMeg(infoB.instructionAddress, infoA.targetAddress) ) {
-								// can do T5 transform (LDR literal load of GOT)
-								set32LE(infoA.instructionContent, makeNOP());
-								set32LE(infoB.instructionContent, makeLDR_literal(ldrInfoB, infoA.targetAddress, infoB.instructionAddress));
-								if ( _options.verboseOptimizationHints() ) {
-									fprintf(stderr, "adrp-ldr-got at 0x%08llX T5 transformed to NOP/LDR\n", infoC.instructionAddress);
-								}
-							}
-						}
-						else if ( isADD ) {
-							if ( usableSegment && withinOneMeg(infoA.instructionAddress, infoA.targetAddress) ) {
-								// can do T4 transform (ADR to compute local address)
-								set32LE(infoA.instructionContent, makeADR(addInfoB.destReg, infoA.targetAddress, infoA.instructionAddress));
-								set32LE(infoB.instructionContent, makeNOP());
-								if ( _options.verboseOptimizationHints() ) {
-									fprintf(stderr, "adrp-ldr-got at 0x%08llX T4 transformed to ADR/STR\n", infoC.instructionAddress);
-								}
+								fprintf(stderr, "adrp-ldr-got at 0x%08llX T4 transformed to ADR/STR\n", infoC.instructionAddress);
 							}
 						}
-						else {
-							if ( _options.verboseOptimizationHints() )
-								fprintf(stderr, "adrp-ldr-got at 0x%08llX not LDR or ADD\n", infoB.instructionAddress);
-						}
 					}
 					else {
 						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "adrp-ldr-got at 0x%08llX not ADRP\n", infoA.instructionAddress);
+							fprintf(stderr, "adrp-ldr-got at 0x%08llX not LDR or ADD\n", infoB.instructionAddress);
 					}
-					break;
-				default:
-						if ( _options.verboseOptimizationHints() ) 							
-							fprintf(stderr, "unknown hint kind %d alt.info.kind at 0x%08llX\n", alt.info.kind, infoA.instructionAddress);
-					break;
-			}
+				}
+				else {
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "adrp-ldr-got at 0x%08llX not ADRP\n", infoA.instructionAddress);
+				}
+				break;
+			default:
+					if ( _options.verboseOptimizationHints() ) 							
+						fprintf(stderr, "unknown hint kind %d alt.info.kind at 0x%08llX\n", alt.info.kind, infoA.instructionAddress);
+				break;
 		}
-		// apply hints pass 2
-		for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
-			if ( fit->kind != ld::Fixup::kindLinkerOptimizationHint ) 
-				continue;
-			InstructionInfo infoA;
-			InstructionInfo infoB;
-			ld::Fixup::LOH_arm64 alt;
-			alt.addend = fit->u.addend;
-			setInfo(state, atom, buffer, usedByHints, fit->offsetInAtom, (alt.info.delta1 << 2), &infoA);
-			if ( alt.info.count > 0 ) 
-				setInfo(state, atom, buffer, usedByHints, fit->offsetInAtom, (alt.info.delta2 << 2), &infoB);
-
-			switch ( alt.info.kind ) {
-				case LOH_ARM64_ADRP_ADRP:
-					LOH_ASSERT(isPageKind(infoA.fixup));
-					LOH_ASSERT(isPageKind(infoB.fixup));
-					if ( (infoA.instruction & 0x9F000000) != 0x90000000 ) {
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "may-reused-adrp at 0x%08llX no longer an ADRP, now 0x%08X\n", infoA.instructionAddress, infoA.instruction);
-						sAdrpNA++;
-						break;
-					}
-					if ( (infoB.instruction & 0x9F000000) != 0x90000000 ) {
-						if ( _options.verboseOptimizationHints() )
-							fprintf(stderr, "may-reused-adrp at 0x%08llX no longer an ADRP, now 0x%08X\n", infoB.instructionAddress, infoA.instruction);
-						sAdrpNA++;
-						break;
-					}
-					if ( (infoA.targetAddress & (-4096)) == (infoB.targetAddress & (-4096)) ) {
-						set32LE(infoB.instructionContent, 0xD503201F);
-						sAdrpNoped++;
-					}
-					else {
-						sAdrpNotNoped++;
-					}
+	}
+	// apply hints pass 2
+	for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
+		if ( fit->kind != ld::Fixup::kindLinkerOptimizationHint ) 
+			continue;
+		InstructionInfo infoA;
+		InstructionInfo infoB;
+		ld::Fixup::LOH_arm64 alt;
+		alt.addend = fit->u.addend;
+		setInfo(state, atom, buffer, hintLocations, fit->offsetInAtom, (alt.info.delta1 << 2), &infoA);
+		if ( alt.info.count > 0 ) 
+			setInfo(state, atom, buffer, hintLocations, fit->offsetInAtom, (alt.info.delta2 << 2), &infoB);
+
+		switch ( alt.info.kind ) {
+			case LOH_ARM64_ADRP_ADRP:
+				LOH_ASSERT(isPageKind(infoA.fixup));
+				LOH_ASSERT(isPageKind(infoB.fixup));
+				if ( (infoA.instruction & 0x9F000000) != 0x90000000 ) {
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "may-reused-adrp at 0x%08llX no longer an ADRP, now 0x%08X\n", infoA.instructionAddress, infoA.instruction);
+					sAdrpNA++;
 					break;
-			}				
-		}
+				}
+				if ( (infoB.instruction & 0x9F000000) != 0x90000000 ) {
+					if ( _options.verboseOptimizationHints() )
+						fprintf(stderr, "may-reused-adrp at 0x%08llX no longer an ADRP, now 0x%08X\n", infoB.instructionAddress, infoA.instruction);
+					sAdrpNA++;
+					break;
+				}
+				if ( (infoA.targetAddress & (-4096)) == (infoB.targetAddress & (-4096)) ) {
+					set32LE(infoB.instructionContent, 0xD503201F);
+					sAdrpNoped++;
+				}
+				else {
+					sAdrpNotNoped++;
+				}
+				break;
+		}				
 	}
-#endif // SUPPORT_ARCH_arm64
-
 }
+#endif // SUPPORT_ARCH_arm64
 
 static bool chainedFixupBindAddendFitsInline(uint64_t accumulator, uint16_t chainedPointerFormat) {
 	switch (chainedPointerFormat) {
@@ -3101,33 +3127,83 @@ void OutputFile::writeAtoms(ld::Internal& state, uint8_t* wholeBuffer)
 	uint64_t fileOffsetOfEndOfLastAtom = 0;
 	bool lastAtomUsesNoOps = false;
 	uint64_t baseAddress = _options.baseAddress();
-	for (std::vector<ld::Internal::FinalSection*>::iterator sit = state.sections.begin(); sit != state.sections.end(); ++sit) {
-		ld::Internal::FinalSection* sect = *sit;
-		if ( (sect->type() == ld::Section::typeMachHeader) && (_options.outputKind() != Options::kPreload) )
-			baseAddress = sect->address;
-		if ( takesNoDiskSpace(sect) )
-			continue;
-		const bool sectionUsesNops = (sect->type() == ld::Section::typeCode);
-		//fprintf(stderr, "file offset=0x%08llX, section %s\n", sect->fileOffset, sect->sectionName());
-		std::vector<const ld::Atom*>& atoms = sect->atoms;
-		bool lastAtomWasThumb = false;
-		for (std::vector<const ld::Atom*>::iterator ait = atoms.begin(); ait != atoms.end(); ++ait) {
-			const ld::Atom* atom = *ait;
-			if ( atom->definition() == ld::Atom::definitionProxy )
+	std::exception_ptr writeError;
+#if SUPPORT_ARCH_arm64
+	// hints are applied after all fixups, so fixup warnings are held back to print them in the order
+	// applying each atom's hints right after its fixups would have
+	struct HintedAtom {
+		const ld::Atom*	atom;
+		uint8_t*		buffer;
+		size_t			fixupWarningsBefore;
+	};
+	const bool applyHints = (_options.outputKind() != Options::kObjectFile) && !_options.ignoreOptimizationHints();
+	std::vector<HintedAtom> hintedAtoms;
+	ld::parallel::WarningBuffer fixupWarnings;
+	ld::parallel::WarningBuffer*& currentWarnings = ld::parallel::currentWarnings();
+	ld::parallel::WarningBuffer* outerWarnings = currentWarnings;
+	currentWarnings = &fixupWarnings;
+#endif
+	try {
+		for (std::vector<ld::Internal::FinalSection*>::iterator sit = state.sections.begin(); sit != state.sections.end(); ++sit) {
+			ld::Internal::FinalSection* sect = *sit;
+			if ( (sect->type() == ld::Section::typeMachHeader) && (_options.outputKind() != Options::kPreload) )
+				baseAddress = sect->address;
+			if ( takesNoDiskSpace(sect) )
 				continue;
+			const bool sectionUsesNops = (sect->type() == ld::Section::typeCode);
+			//fprintf(stderr, "file offset=0x%08llX, section %s\n", sect->fileOffset, sect->sectionName());
+			std::vector<const ld::Atom*>& atoms = sect->atoms;
+			bool lastAtomWasThumb = false;
+			for (std::vector<const ld::Atom*>::iterator ait = atoms.begin(); ait != atoms.end(); ++ait) {
+				const ld::Atom* atom = *ait;
+				if ( atom->definition() == ld::Atom::definitionProxy )
+					continue;
+				try {
+					uint64_t fileOffset = atom->finalAddress() - sect->address + sect->fileOffset;
+					// check for alignment padding between atoms
+					if ( (fileOffset != fileOffsetOfEndOfLastAtom) && lastAtomUsesNoOps ) {
+						this->copyNoOps(&wholeBuffer[fileOffsetOfEndOfLastAtom], &wholeBuffer[fileOffset], lastAtomWasThumb);
+					}
+					// copy atom content
+					atom->copyRawContent(&wholeBuffer[fileOffset]);
+					// apply fix ups
+					if ( this->applyFixUps(state, baseAddress, atom, &wholeBuffer[fileOffset]) ) {
+#if SUPPORT_ARCH_arm64
+						if ( applyHints )
+							hintedAtoms.push_back({ atom, &wholeBuffer[fileOffset], fixupWarnings.size() });
+#endif
+					}
+					fileOffsetOfEndOfLastAtom = fileOffset+atom->size();
+					lastAtomUsesNoOps = sectionUsesNops;
+					lastAtomWasThumb = atom->isThumb();
+				}
+				catch (const char* msg) {
+					if ( atom->file() != NULL )
+						throwf("%s in '%s' from %s", msg, atom->name(), atom->safeFilePath());
+					else
+						throwf("%s in '%s'", msg, atom->name());
+				}
+			}
+		}
+	}
+	catch (...) {
+		// hints of the atoms before the failing one still get applied, for their warnings
+		writeError = std::current_exception();
+	}
+	
+#if SUPPORT_ARCH_arm64
+	currentWarnings = outerWarnings;
+	// hints only rewrite instructions within their own atom, so atoms can be optimized in parallel
+	std::vector<ld::parallel::WarningBuffer> hintWarnings(hintedAtoms.size());
+	std::vector<std::exception_ptr> hintErrors(hintedAtoms.size());
+	auto optimizeAtom = [&](size_t index) {
+		const ld::Atom* atom = hintedAtoms[index].atom;
+		ld::parallel::WarningBuffer*& threadWarnings = ld::parallel::currentWarnings();
+		ld::parallel::WarningBuffer* outerThreadWarnings = threadWarnings;
+		threadWarnings = &hintWarnings[index];
+		try {
 			try {
-				uint64_t fileOffset = atom->finalAddress() - sect->address + sect->fileOffset;
-				// check for alignment padding between atoms
-				if ( (fileOffset != fileOffsetOfEndOfLastAtom) && lastAtomUsesNoOps ) {
-					this->copyNoOps(&wholeBuffer[fileOffsetOfEndOfLastAtom], &wholeBuffer[fileOffset], lastAtomWasThumb);
-				}
-				// copy atom content
-				atom->copyRawContent(&wholeBuffer[fileOffset]);
-				// apply fix ups
-				this->applyFixUps(state, baseAddress, atom, &wholeBuffer[fileOffset]);
-				fileOffsetOfEndOfLastAtom = fileOffset+atom->size();
-				lastAtomUsesNoOps = sectionUsesNops;
-				lastAtomWasThumb = atom->isThumb();
+				this->applyOptimizationHints(state, atom, hintedAtoms[index].buffer);
 			}
 			catch (const char* msg) {
 				if ( atom->file() != NULL )
@@ -3136,8 +3212,36 @@ void OutputFile::writeAtoms(ld::Internal& state, uint8_t* wholeBuffer)
 					throwf("%s in '%s'", msg, atom->name());
 			}
 		}
+		catch (...) {
+			hintErrors[index] = std::current_exception();
+		}
+		threadWarnings = outerThreadWarnings;
+	};
+	if ( _options.verboseOptimizationHints() ) {
+		// keep verbose log in atom order
+		for (size_t i=0; i < hintedAtoms.size(); ++i)
+			optimizeAtom(i);
 	}
-	
+	else {
+		ld::parallel::forEach(hintedAtoms.size(), optimizeAtom);
+	}
+	// print each atom's hint warnings after the fixup warnings of the atoms before it, and report the
+	// same error applying hints atom by atom would have stopped at
+	size_t fixupWarningsPrinted = 0;
+	for (size_t i=0; i < hintedAtoms.size(); ++i) {
+		for ( ; fixupWarningsPrinted < hintedAtoms[i].fixupWarningsBefore; ++fixupWarningsPrinted)
+			warning("%s", fixupWarnings[fixupWarningsPrinted].c_str());
+		for (const std::string& message : hintWarnings[i])
+			warning("%s", message.c_str());
+		if ( hintErrors[i] )
+			std::rethrow_exception(hintErrors[i]);
+	}
+	for ( ; fixupWarningsPrinted < fixupWarnings.size(); ++fixupWarningsPrinted)
+		warning("%s", fixupWarnings[fixupWarningsPrinted].c_str());
+#endif
+	if ( writeError )
+		std::rethrow_exception(writeError);
+
 	if ( _options.verboseOptimizationHints() ) {
 		//fprintf(stderr, "ADRP optimized away:   %d\n", sAdrpNA);
 		//fprintf(stderr, "ADRPs changed to NOPs: %d\n", sAdrpNoped);
@@ -3486,9 +3590,9 @@ void OutputFile::writeAtoms(ld::Internal& state, uint8_t* wholeBuffer)
 			}
 		}
 		else {
-			// chain together fixups
-			uint32_t segIndex = 0;
-			for (ChainedFixupSegInfo& segInfo : _chainedFixupSegments) {
+			// chain together fixups, segments are independent so do them in parallel
+			ld::parallel::forEach(_chainedFixupSegments.size(), [&](size_t segIndex) {
+				ChainedFixupSegInfo& segInfo = _chainedFixupSegments[segIndex];
 				//fprintf(stderr, "0x%08llX 0x%08llX %s\n", segInfo.startAddr, segInfo.endAddr-segInfo.startAddr, segInfo.name);
 				uint8_t* segBufferStart = &wholeBuffer[segInfo.fileOffset];
 				uint8_t* pageBufferStart = segBufferStart;
@@ -3556,8 +3660,7 @@ void OutputFile::writeAtoms(ld::Internal& state, uint8_t* wholeBuffer)
 					pageBufferStart += segInfo.pageSize;
 					++pageIndex;
 				}
-				++segIndex;
-			}
+			});
 		}
 	}
 }
@@ -3965,14 +4068,46 @@ private:
 
 void OutputFile::buildSymbolTable(ld::Internal& state)
 {
+	// Sections are split into runs of atoms that are classified concurrently.  The runs' symbol
+	// lists are appended in section and atom order, so the result is the same as a serial pass.
+	struct SymbolTableChunk {
+		ld::Internal::FinalSection*		sect;
+		bool							setMachoSectionIndex;
+		unsigned int					machoSectionIndex;
+		size_t							atomsBegin;
+		size_t							atomsEnd;
+		std::vector<const ld::Atom*>	localAtoms;
+		std::vector<const ld::Atom*>	exportedAtoms;
+		std::vector<const ld::Atom*>	importedAtoms;
+		std::vector<const ld::Atom*>	hiddenResolvers;
+		bool							usesWeakExternalSymbols = false;
+	};
+	const size_t atomsPerChunk = 4096;
+	std::vector<SymbolTableChunk> chunks;
 	unsigned int machoSectionIndex = 0;
 	for (std::vector<ld::Internal::FinalSection*>::iterator sit = state.sections.begin(); sit != state.sections.end(); ++sit) {
 		ld::Internal::FinalSection* sect = *sit;
 		bool setMachoSectionIndex = !sect->isSectionHidden() && (sect->type() != ld::Section::typeTentativeDefs);
 		if ( setMachoSectionIndex ) 
 			++machoSectionIndex;
-		for (std::vector<const ld::Atom*>::iterator ait = sect->atoms.begin(); ait != sect->atoms.end(); ++ait) {
-			const ld::Atom* atom = *ait;
+		for (size_t begin=0; begin < sect->atoms.size(); begin += atomsPerChunk) {
+			chunks.emplace_back();
+			SymbolTableChunk& chunk = chunks.back();
+			chunk.sect					= sect;
+			chunk.setMachoSectionIndex	= setMachoSectionIndex;
+			chunk.machoSectionIndex		= machoSectionIndex;
+			chunk.atomsBegin			= begin;
+			chunk.atomsEnd				= std::min(begin + atomsPerChunk, sect->atoms.size());
+		}
+	}
+
+	ld::parallel::forEach(chunks.size(), [&](size_t chunkIndex) {
+		SymbolTableChunk& chunk = chunks[chunkIndex];
+		ld::Internal::FinalSection* sect = chunk.sect;
+		const bool setMachoSectionIndex = chunk.setMachoSectionIndex;
+		const unsigned int machoSectionIndex = chunk.machoSectionIndex;
+		for (size_t i=chunk.atomsBegin; i < chunk.atomsEnd; ++i) {
+			const ld::Atom* atom = sect->atoms[i];
 			if ( setMachoSectionIndex )
 				(const_cast<ld::Atom*>(atom))->setMachoSection(machoSectionIndex);
 			else if ( sect->type() == ld::Section::typeMachHeader )
@@ -3993,7 +4128,7 @@ void OutputFile::buildSymbolTable(ld::Internal& state)
 					// x86_64 .o files need labels on anonymous literal strings
 					if ( (sect->type() == ld::Section::typeCString) && (atom->combine() == ld::Atom::combineByNameAndContent) ) {
 						(const_cast<ld::Atom*>(atom))->setSymbolTableInclusion(ld::Atom::symbolTableIn);
-						_localAtoms.push_back(atom);
+						chunk.localAtoms.push_back(atom);
 						continue;
 					}
 				}
@@ -4005,7 +4140,7 @@ void OutputFile::buildSymbolTable(ld::Internal& state)
 				}
 				else if ( sect->type() == ld::Section::typeTempAlias ) {
 					assert(_options.outputKind() == Options::kObjectFile);
-					_importedAtoms.push_back(atom);
+					chunk.importedAtoms.push_back(atom);
 					continue;
 				}
 				if ( atom->symbolTableInclusion() == ld::Atom::symbolTableNotInFinalLinkedImages )
@@ -4028,18 +4163,18 @@ void OutputFile::buildSymbolTable(ld::Internal& state)
 			
 			// <rdar://problem/8626058> ld should consistently warn when resolvers are not exported
 			if ( (atom->contentType() == ld::Atom::typeResolver) && (atom->scope() == ld::Atom::scopeLinkageUnit) )
-				warning("resolver functions should be external, but '%s' is hidden", atom->name());
+				chunk.hiddenResolvers.push_back(atom);
 			
 			if ( sect->type() == ld::Section::typeImportProxies ) {
 				if ( atom->combine() == ld::Atom::combineByName )
-					this->usesWeakExternalSymbols = true;
+					chunk.usesWeakExternalSymbols = true;
 				// alias proxy is a re-export with a name change, don't import changed name
 				if ( ! atom->isAlias() )
-					_importedAtoms.push_back(atom);
+					chunk.importedAtoms.push_back(atom);
 				// scope of proxies are usually linkage unit, so done
 				// if scope is global, we need to re-export it too
 				if ( atom->scope() == ld::Atom::scopeGlobal )
-					_exportedAtoms.push_back(atom);
+					chunk.exportedAtoms.push_back(atom);
 				continue;
 			}
 			if ( atom->symbolTableInclusion() == ld::Atom::symbolTableNotInFinalLinkedImages ) {
@@ -4057,11 +4192,11 @@ void OutputFile::buildSymbolTable(ld::Internal& state)
 			if ( (atom->definition() == ld::Atom::definitionTentative) && (_options.outputKind() == Options::kObjectFile) ) {
 				if ( _options.makeTentativeDefinitionsReal() ) {
 					// -r -d turns tentative definitions into real def
-					_exportedAtoms.push_back(atom);
+					chunk.exportedAtoms.push_back(atom);
 				}
 				else {
 					// in mach-o object files tentative definitions are stored like undefined symbols
-					_importedAtoms.push_back(atom);
+					chunk.importedAtoms.push_back(atom);
 				}
 				continue;
 			}
@@ -4069,19 +4204,19 @@ void OutputFile::buildSymbolTable(ld::Internal& state)
 			switch ( atom->scope() ) {
 				case ld::Atom::scopeTranslationUnit:
 					if ( _options.keepLocalSymbol(atom->name()) ) {	
-						_localAtoms.push_back(atom);
+						chunk.localAtoms.push_back(atom);
 					}
 					else {
 						if ( _options.outputKind() == Options::kObjectFile ) {
 							(const_cast<ld::Atom*>(atom))->setSymbolTableInclusion(ld::Atom::symbolTableInWithRandomAutoStripLabel);
-							_localAtoms.push_back(atom);
+							chunk.localAtoms.push_back(atom);
 						}
 						else
 							(const_cast<ld::Atom*>(atom))->setSymbolTableInclusion(ld::Atom::symbolTableNotIn);
 					}	
 					break;
 				case ld::Atom::scopeGlobal:
-					_exportedAtoms.push_back(atom);
+					chunk.exportedAtoms.push_back(atom);
 					break;
 				case ld::Atom::scopeLinkageUnit:
 					if ( _options.outputKind() == Options::kObjectFile ) {
@@ -4089,33 +4224,43 @@ void OutputFile::buildSymbolTable(ld::Internal& state)
 							if ( atom->symbolTableInclusion() == ld::Atom::symbolTableInWithRandomAutoStripLabel ) {
 								// <rdar://problem/42150005> ld -r should not promote static 'l' labels to hidden
 								(const_cast<ld::Atom*>(atom))->setScope(ld::Atom::scopeTranslationUnit);
-								_localAtoms.push_back(atom);
+								chunk.localAtoms.push_back(atom);
 							}
 							else {
-								_exportedAtoms.push_back(atom);
+								chunk.exportedAtoms.push_back(atom);
 							}
 						}
 						else if ( _options.keepLocalSymbol(atom->name()) ) {
-							_localAtoms.push_back(atom);
+							chunk.localAtoms.push_back(atom);
 						}
 						else {
 							(const_cast<ld::Atom*>(atom))->setSymbolTableInclusion(ld::Atom::symbolTableInWithRandomAutoStripLabel);
-							_localAtoms.push_back(atom);
+							chunk.localAtoms.push_back(atom);
 						}
 					}
 					else {
 						if ( _options.keepLocalSymbol(atom->name()) ) 
-							_localAtoms.push_back(atom);
+							chunk.localAtoms.push_back(atom);
 						// <rdar://problem/5804214> ld should never have a symbol in the non-lazy indirect symbol table with index 0
 						// this works by making __mh_execute_header be a local symbol which takes symbol index 0
 						else if ( (atom->symbolTableInclusion() == ld::Atom::symbolTableInAndNeverStrip) && !_options.makeCompressedDyldInfo() && !_options.makeThreadedStartsSection() )
-							_localAtoms.push_back(atom);
+							chunk.localAtoms.push_back(atom);
 						else
 							(const_cast<ld::Atom*>(atom))->setSymbolTableInclusion(ld::Atom::symbolTableNotIn);
 					}
 					break;
 			}
 		}
+	});
+
+	for (SymbolTableChunk& chunk : chunks) {
+		for (const ld::Atom* atom : chunk.hiddenResolvers)
+			warning("resolver functions should be external, but '%s' is hidden", atom->name());
+		_localAtoms.insert(_localAtoms.end(), chunk.localAtoms.begin(), chunk.localAtoms.end());
+		_exportedAtoms.insert(_exportedAtoms.end(), chunk.exportedAtoms.begin(), chunk.exportedAtoms.end());
+		_importedAtoms.insert(_importedAtoms.end(), chunk.importedAtoms.begin(), chunk.importedAtoms.end());
+		if ( chunk.usesWeakExternalSymbols )
+			this->usesWeakExternalSymbols = true;
 	}
 	
 	// <rdar://problem/6978069> ld adds undefined symbol from .exp file to binary
@@ -5044,163 +5189,241 @@ uint64_t OutputFile::lookBackAddend(ld::Fixup::iterator fit)
 
 void OutputFile::generateLinkEditInfo(ld::Internal& state)
 {
+	// Sections are split into runs of atoms that collect their dyld info, relocations and warnings
+	// on their own.  The runs are merged in order, so the output is the same as a serial pass.
+	const size_t atomsPerChunk = 4096;
+	std::vector<LinkEditInfoChunk> chunks;
 	for (std::vector<ld::Internal::FinalSection*>::iterator sit = state.sections.begin(); sit != state.sections.end(); ++sit) {
 		ld::Internal::FinalSection* sect = *sit;
 		// record end of last __TEXT section encrypted iPhoneOS apps.
 		if ( _options.makeEncryptable() && (strcmp(sect->segmentName(), "__TEXT") == 0) && (strcmp(sect->sectionName(), "__oslogstring") != 0) ) {
 			_encryptedTEXTendOffset = pageAlign(sect->fileOffset + sect->size);
 		}
-		for (std::vector<const ld::Atom*>::iterator ait = sect->atoms.begin(); ait != sect->atoms.end(); ++ait) {
-			const ld::Atom*		atom = *ait;
-			
-			// Record regular atoms that override a dylib's weak definitions 
-			if ( (atom->scope() == ld::Atom::scopeGlobal) && atom->overridesDylibsWeakDef() ) {
-				if ( _options.makeCompressedDyldInfo() && !state.cantUseChainedFixups ) {
-					uint8_t wtype = BIND_TYPE_OVERRIDE_OF_WEAKDEF_IN_DYLIB;
-					bool nonWeakDef = (atom->combine() == ld::Atom::combineNever);
-					// Don't push weak binding info for threaded bind.
-					// Instead we use a special ordinal in the regular bind info
-					if ( !_options.useLinkedListBinding() )
-						_weakBindingInfo.push_back(BindingInfo(wtype, atom->name(), nonWeakDef, atom->finalAddress(), 0));
-				}
-				this->overridesWeakExternalSymbols = true;
-				if ( _options.warnWeakExports()	)
-					warning("overrides weak external symbol: %s", atom->name());
-			}
-			
-			ld::Fixup*			fixupWithTarget = NULL;
-			ld::Fixup*			fixupWithMinusTarget = NULL;
-			ld::Fixup*			fixupWithStore = NULL;
-			ld::Fixup*			fixupWithAddend = NULL;
-			const ld::Atom*		target = NULL;
-			const ld::Atom*		minusTarget = NULL;
-			uint64_t			targetAddend = 0;
-			uint64_t			minusTargetAddend = 0;
-#if SUPPORT_ARCH_arm64e
-			ld::Fixup*			fixupWithAuthData = NULL;
-#endif
-			for (ld::Fixup::iterator fit = atom->fixupsBegin(); fit != atom->fixupsEnd(); ++fit) {
-				if ( fit->firstInCluster() ) {
-					fixupWithTarget = NULL;
-					fixupWithMinusTarget = NULL;
-					fixupWithStore = NULL;
-					target = NULL;
-					minusTarget = NULL;
-					targetAddend = 0;
-					minusTargetAddend = 0;
-#if SUPPORT_ARCH_arm64e
-					fixupWithAuthData = NULL;
-#endif
-				}
-				if ( this->setsTarget(*fit) ) {
-					switch ( fit->binding ) {
-						case ld::Fixup::bindingNone:
-						case ld::Fixup::bindingByNameUnbound:
-							break;
-						case ld::Fixup::bindingByContentBound:
-						case ld::Fixup::bindingDirectlyBound:
-							fixupWithTarget = fit;
-							target = fit->u.target;
+		for (size_t begin=0; begin < sect->atoms.size(); begin += atomsPerChunk) {
+			chunks.emplace_back();
+			LinkEditInfoChunk& chunk = chunks.back();
+			chunk.sect       = sect;
+			chunk.atomsBegin = begin;
+			chunk.atomsEnd   = std::min(begin + atomsPerChunk, sect->atoms.size());
+		}
+	}
+
+	ld::parallel::forEach(chunks.size(), [&](size_t chunkIndex) {
+		LinkEditInfoChunk& chunk = chunks[chunkIndex];
+		// errors are reported when merged, after the warnings of the atoms before them
+		try {
+			this->generateLinkEditInfoChunk(state, chunk);
+		}
+		catch (...) {
+			chunk.error = std::current_exception();
+		}
+	});
+	size_t rebaseCount = _rebaseInfo.size();
+	size_t bindingCount = _bindingInfo.size();
+	for (const LinkEditInfoChunk& chunk : chunks) {
+		rebaseCount += chunk.rebaseInfo.size();
+		bindingCount += chunk.bindingInfo.size();
+	}
+	_rebaseInfo.reserve(rebaseCount);
+	_bindingInfo.reserve(bindingCount);
+	for (LinkEditInfoChunk& chunk : chunks)
+		this->mergeLinkEditInfoChunk(chunk);
+
+	if ( _hasUnalignedFixup && (_options.unalignedPointerTreatment() == Options::kUnalignedPointerError) ) {
+		throw "unaligned pointer(s)";
+	}
+}
+
+void OutputFile::generateLinkEditInfoChunk(ld::Internal& state, LinkEditInfoChunk& chunk)
+{
+	ld::Internal::FinalSection* sect = chunk.sect;
+	for (size_t i=chunk.atomsBegin; i < chunk.atomsEnd; ++i) {
+		const ld::Atom*		atom = sect->atoms[i];
+		
+		// Record regular atoms that override a dylib's weak definitions 
+		if ( (atom->scope() == ld::Atom::scopeGlobal) && atom->overridesDylibsWeakDef() ) {
+			if ( _options.makeCompressedDyldInfo() && !state.cantUseChainedFixups ) {
+				uint8_t wtype = BIND_TYPE_OVERRIDE_OF_WEAKDEF_IN_DYLIB;
+				bool nonWeakDef = (atom->combine() == ld::Atom::combineNever);
+				// Don't push weak binding info for threaded bind.
+				// Instead we use a special ordinal in the regular bind info
+				if ( !_options.useLinkedListBinding() )
+					chunk.weakBindingInfo.push_back(BindingInfo(wtype, atom->name(), nonWeakDef, atom->finalAddress(), 0));
+			}
+			chunk.overridesWeakExternalSymbols = true;
+			if ( _options.warnWeakExports()	)
+				chunk.diagnostics.push_back([=]() { warning("overrides weak external symbol: %s", atom->name()); });
+		}
+		
+		ld::Fixup*			fixupWithTarget = NULL;
+		ld::Fixup*			fixupWithMinusTarget = NULL;
+		ld::Fixup*			fixupWithStore = NULL;
+		ld::Fixup*			fixupWithAddend = NULL;
+		const ld::Atom*		target = NULL;
+		const ld::Atom*		minusTarget = NULL;
+		uint64_t			targetAddend = 0;
+		uint64_t			minusTargetAddend = 0;
+#if SUPPORT_ARCH_arm64e
+		ld::Fixup*			fixupWithAuthData = NULL;
+#endif
+		for (ld::Fixup::iterator fit = atom->fixupsBegin(); fit != atom->fixupsEnd(); ++fit) {
+			if ( fit->firstInCluster() ) {
+				fixupWithTarget = NULL;
+				fixupWithMinusTarget = NULL;
+				fixupWithStore = NULL;
+				target = NULL;
+				minusTarget = NULL;
+				targetAddend = 0;
+				minusTargetAddend = 0;
+#if SUPPORT_ARCH_arm64e
+				fixupWithAuthData = NULL;
+#endif
+			}
+			if ( this->setsTarget(*fit) ) {
+				switch ( fit->binding ) {
+					case ld::Fixup::bindingNone:
+					case ld::Fixup::bindingByNameUnbound:
+						break;
+					case ld::Fixup::bindingByContentBound:
+					case ld::Fixup::bindingDirectlyBound:
+						fixupWithTarget = fit;
+						target = fit->u.target;
+						break;
+					case ld::Fixup::bindingsIndirectlyBound:
+						fixupWithTarget = fit;
+						target = state.indirectBindingTable[fit->u.bindingIndex];
+						break;
+				}
+				assert(target != NULL);
+			}
+			switch ( fit->kind ) {
+				case ld::Fixup::kindAddAddend:
+					targetAddend = fit->u.addend;
+					fixupWithAddend = fit;
+					break;
+				case ld::Fixup::kindSubtractAddend:
+					minusTargetAddend = fit->u.addend;
+					fixupWithAddend = fit;
+					break;
+				case ld::Fixup::kindSubtractTargetAddress:
+					switch ( fit->binding ) {
+						case ld::Fixup::bindingNone:
+						case ld::Fixup::bindingByNameUnbound:
+							break;
+						case ld::Fixup::bindingByContentBound:
+						case ld::Fixup::bindingDirectlyBound:
+							fixupWithMinusTarget = fit;
+							minusTarget = fit->u.target;
 							break;
 						case ld::Fixup::bindingsIndirectlyBound:
-							fixupWithTarget = fit;
-							target = state.indirectBindingTable[fit->u.bindingIndex];
+							fixupWithMinusTarget = fit;
+							minusTarget = state.indirectBindingTable[fit->u.bindingIndex];
 							break;
 					}
-					assert(target != NULL);
-				}
-				switch ( fit->kind ) {
-					case ld::Fixup::kindAddAddend:
-						targetAddend = fit->u.addend;
-						fixupWithAddend = fit;
-						break;
-					case ld::Fixup::kindSubtractAddend:
-						minusTargetAddend = fit->u.addend;
-						fixupWithAddend = fit;
-						break;
-					case ld::Fixup::kindSubtractTargetAddress:
-						switch ( fit->binding ) {
-							case ld::Fixup::bindingNone:
-							case ld::Fixup::bindingByNameUnbound:
-								break;
-							case ld::Fixup::bindingByContentBound:
-							case ld::Fixup::bindingDirectlyBound:
-								fixupWithMinusTarget = fit;
-								minusTarget = fit->u.target;
-								break;
-							case ld::Fixup::bindingsIndirectlyBound:
-								fixupWithMinusTarget = fit;
-								minusTarget = state.indirectBindingTable[fit->u.bindingIndex];
-								break;
-						}
-						assert(minusTarget != NULL);
-						break;
-					case ld::Fixup::kindDataInCodeStartData:
-					case ld::Fixup::kindDataInCodeStartJT8:
-					case ld::Fixup::kindDataInCodeStartJT16:
-					case ld::Fixup::kindDataInCodeStartJT32:
-					case ld::Fixup::kindDataInCodeStartJTA32:
-					case ld::Fixup::kindDataInCodeEnd:
-						hasDataInCode = true;
-						break;
+					assert(minusTarget != NULL);
+					break;
+				case ld::Fixup::kindDataInCodeStartData:
+				case ld::Fixup::kindDataInCodeStartJT8:
+				case ld::Fixup::kindDataInCodeStartJT16:
+				case ld::Fixup::kindDataInCodeStartJT32:
+				case ld::Fixup::kindDataInCodeStartJTA32:
+				case ld::Fixup::kindDataInCodeEnd:
+					chunk.hasDataInCode = true;
+					break;
 #if SUPPORT_ARCH_arm64e
-					case ld::Fixup::kindSetAuthData:
-						fixupWithAuthData = fit;
-						break;
+				case ld::Fixup::kindSetAuthData:
+					fixupWithAuthData = fit;
+					break;
 #endif
-					default:
+				default:
                         break;    
-				}
-				if ( fit->isStore() ) {
-					fixupWithStore = fit;
-				}
-				if ( fit->lastInCluster() ) {
-					if ( (fixupWithStore != NULL) && (target != NULL) ) {
-						if ( _options.outputKind() == Options::kObjectFile ) {
-							this->addSectionRelocs(state, sect, atom, fixupWithTarget, fixupWithMinusTarget, fixupWithAddend, fixupWithStore,
+			}
+			if ( fit->isStore() ) {
+				fixupWithStore = fit;
+			}
+			if ( fit->lastInCluster() ) {
+				if ( (fixupWithStore != NULL) && (target != NULL) ) {
+					if ( _options.outputKind() == Options::kObjectFile ) {
+						this->addSectionRelocs(state, sect, atom, fixupWithTarget, fixupWithMinusTarget, fixupWithAddend, fixupWithStore,
 #if SUPPORT_ARCH_arm64e
-												   fixupWithAuthData,
+											   fixupWithAuthData,
 #endif
-													target, minusTarget, targetAddend, minusTargetAddend);
+												target, minusTarget, targetAddend, minusTargetAddend, chunk);
+					}
+					else {
+						if ( _options.makeChainedFixups() && !state.cantUseChainedFixups ) {
+							addChainedFixupLocation(state, sect, atom, fixupWithTarget, fixupWithMinusTarget, fixupWithStore,
+													target, minusTarget, targetAddend, minusTargetAddend, chunk);
 						}
-						else {
-							if ( _options.makeChainedFixups() && !state.cantUseChainedFixups ) {
-								addChainedFixupLocation(state, sect, atom, fixupWithTarget, fixupWithMinusTarget, fixupWithStore,
-														target, minusTarget, targetAddend, minusTargetAddend);
-							}
-							else if ( _options.makeCompressedDyldInfo() || state.cantUseChainedFixups ) {
+						else if ( _options.makeCompressedDyldInfo() || state.cantUseChainedFixups ) {
 #if SUPPORT_ARCH_arm64e
-								if ( _options.sharedRegionEligible() && (fixupWithAuthData != NULL) ) {
-									switch ( fixupWithAuthData->u.authData.key ) {
-										case ld::Fixup::AuthData::ptrauth_key_asib:
-										case ld::Fixup::AuthData::ptrauth_key_asdb:
-											throwf("dylibs for dyld cache cannot use B key of auth-pointer, found in %s", atom->name());
-										case ld::Fixup::AuthData::ptrauth_key_asia:
-										case ld::Fixup::AuthData::ptrauth_key_asda:
-											break;
-									}
+							if ( _options.sharedRegionEligible() && (fixupWithAuthData != NULL) ) {
+								switch ( fixupWithAuthData->u.authData.key ) {
+									case ld::Fixup::AuthData::ptrauth_key_asib:
+									case ld::Fixup::AuthData::ptrauth_key_asdb:
+										throwf("dylibs for dyld cache cannot use B key of auth-pointer, found in %s", atom->name());
+									case ld::Fixup::AuthData::ptrauth_key_asia:
+									case ld::Fixup::AuthData::ptrauth_key_asda:
+										break;
 								}
-#endif
-								this->addDyldInfo(state, sect, atom, fixupWithTarget, fixupWithMinusTarget, fixupWithStore,
-												  target, minusTarget, targetAddend, minusTargetAddend);
-							}
-							else if ( _options.makeThreadedStartsSection() ) {
-								this->addThreadedRebaseInfo(state, sect, atom, fixupWithTarget, fixupWithMinusTarget, fixupWithStore,
-															target, minusTarget, targetAddend, minusTargetAddend);
-							}
-							else { 
-								this->addClassicRelocs(state, sect, atom, fixupWithTarget, fixupWithMinusTarget, fixupWithStore,
-													target, minusTarget, targetAddend, minusTargetAddend);
 							}
+#endif
+							this->addDyldInfo(state, sect, atom, fixupWithTarget, fixupWithMinusTarget, fixupWithStore,
+											  target, minusTarget, targetAddend, minusTargetAddend, chunk);
+						}
+						else if ( _options.makeThreadedStartsSection() ) {
+							this->addThreadedRebaseInfo(state, sect, atom, fixupWithTarget, fixupWithMinusTarget, fixupWithStore,
+														target, minusTarget, targetAddend, minusTargetAddend, chunk);
+						}
+						else { 
+							this->addClassicRelocs(state, sect, atom, fixupWithTarget, fixupWithMinusTarget, fixupWithStore,
+												target, minusTarget, targetAddend, minusTargetAddend, chunk);
 						}
 					}
 				}
 			}
 		}
 	}
-	if ( _hasUnalignedFixup && (_options.unalignedPointerTreatment() == Options::kUnalignedPointerError) ) {
-		throw "unaligned pointer(s)";
-	}
+}
+
+void OutputFile::mergeLinkEditInfoChunk(LinkEditInfoChunk& chunk)
+{
+	for (const std::function<void()>& diagnostic : chunk.diagnostics)
+		diagnostic();
+	if ( chunk.error )
+		std::rethrow_exception(chunk.error);
+
+	_rebaseInfo.insert(_rebaseInfo.end(), chunk.rebaseInfo.begin(), chunk.rebaseInfo.end());
+	_bindingInfo.insert(_bindingInfo.end(), chunk.bindingInfo.begin(), chunk.bindingInfo.end());
+	_lazyBindingInfo.insert(_lazyBindingInfo.end(), chunk.lazyBindingInfo.begin(), chunk.lazyBindingInfo.end());
+	_weakBindingInfo.insert(_weakBindingInfo.end(), chunk.weakBindingInfo.begin(), chunk.weakBindingInfo.end());
+	for (const LinkEditInfoChunk::LocalReloc& reloc : chunk.localRelocs)
+		_localRelocsAtom->addPointerReloc(reloc.address, reloc.sectionNumber, reloc.length);
+	for (const LinkEditInfoChunk::ExternalReloc& reloc : chunk.externalPointerRelocs)
+		_externalRelocsAtom->addExternalPointerReloc(reloc.address, reloc.target);
+	for (const LinkEditInfoChunk::ExternalReloc& reloc : chunk.externalCallSiteRelocs)
+		_externalRelocsAtom->addExternalCallSiteReloc(reloc.address, reloc.target);
+	for (const LinkEditInfoChunk::SectionReloc& reloc : chunk.sectionRelocs) {
+		_sectionsRelocationsAtom->addSectionReloc(chunk.sect, reloc.kind, reloc.atom, reloc.offsetInAtom,
+												  reloc.targetUsesExternalReloc, reloc.minusTargetUsesExternalReloc,
+#if SUPPORT_ARCH_arm64e
+												  reloc.fixupWithAuthData,
+#endif
+												  reloc.target, reloc.targetAddend, reloc.minusTarget, reloc.minusTargetAddend);
+	}
+	if ( chunk.hasLocalRelocs )
+		chunk.sect->hasLocalRelocs = true;
+	if ( chunk.hasExternalRelocs )
+		chunk.sect->hasExternalRelocs = true;
+	if ( chunk.hasUnalignedFixup )
+		_hasUnalignedFixup = true;
+	if ( chunk.hasDataInCode )
+		this->hasDataInCode = true;
+	if ( chunk.overridesWeakExternalSymbols )
+		this->overridesWeakExternalSymbols = true;
+
+	// release the chunk's memory as soon as it is merged
+	chunk = LinkEditInfoChunk();
 }
 
 bool OutputFile::isFixupForChain(ld::Fixup::iterator fit)
@@ -5275,7 +5498,7 @@ void OutputFile::buildChainedFixupInfo(ld::Internal& state)
 			_importedSymbolsCount = sect->atoms.size();
 	}
 
-	// build table of segments, fixup locations, and symbol targets
+	// build table of segments
 	uint32_t							pageSize     = _options.segmentAlignment();
 	// The kernel and kexts need to support unaligned fixups, so just always force 4k alignment on them
 	if ( _options.isKernel() || (_options.outputKind() == Options::kKextBundle) )
@@ -5283,6 +5506,8 @@ void OutputFile::buildChainedFixupInfo(ld::Internal& state)
 	const char* 						curSegName   = "";
 	const ld::Internal::FinalSection* 	firstSegSect = nullptr;
 	const ld::Internal::FinalSection* 	lastSect     = nullptr;
+	std::vector<uint32_t>				sectionSegIndexes;
+	sectionSegIndexes.reserve(state.sections.size());
 	for (ld::Internal::FinalSection* sect : state.sections) {
 		if ( strcmp(sect->segmentName(), curSegName) != 0 ) {
 			if ( firstSegSect != nullptr ) {
@@ -5300,6 +5525,24 @@ void OutputFile::buildChainedFixupInfo(ld::Internal& state)
 			seg.pointerFormat = chainedPointerFormat();
 			_chainedFixupSegments.push_back(seg);
 		}
+		sectionSegIndexes.push_back((uint32_t)(_chainedFixupSegments.size()-1));
+		lastSect = sect;
+	}
+
+	// find fixup locations and symbol targets, each section in parallel
+	struct FixupLocation { uint32_t pageIndex; uint16_t pageOffset; };
+	struct BindTarget { const ld::Atom* target; uint64_t addend; bool isAuthPtr; };
+	struct UnalignedFixup { const ld::Atom* atom; uint32_t offsetInAtom; uint64_t address; };
+	struct SectionFixups {
+		std::vector<FixupLocation>	locations;
+		std::vector<BindTarget>		binds;
+		std::vector<UnalignedFixup>	unaligned;
+	};
+	std::vector<SectionFixups> sectionFixups(state.sections.size());
+	ld::parallel::forEach(state.sections.size(), [&](size_t sectIndex) {
+		const ld::Internal::FinalSection* sect = state.sections[sectIndex];
+		const ChainedFixupSegInfo& segInfo = _chainedFixupSegments[sectionSegIndexes[sectIndex]];
+		SectionFixups& result = sectionFixups[sectIndex];
 		for (const ld::Atom* atom : sect->atoms) {
 			const ld::Atom* target;
 			const ld::Atom* fromTarget;
@@ -5409,15 +5652,12 @@ void OutputFile::buildChainedFixupInfo(ld::Internal& state)
 						//fprintf(stderr, "fixUpAddr=0x%0llX\n",fixUpAddr);
 
 						// Diagnose unaligned pointers
-						switch (_chainedFixupSegments.back().pointerFormat) {
+						switch (segInfo.pointerFormat) {
 							case DYLD_CHAINED_PTR_ARM64E:
 							case DYLD_CHAINED_PTR_ARM64E_USERLAND:
 							case DYLD_CHAINED_PTR_ARM64E_USERLAND24:
-								if ( fixUpAddr % 8 ) {
-									warning("pointer not aligned at address 0x%llX (%s + %u from %s)",
-											fixUpAddr, atom->name(), fit->offsetInAtom, atom->safeFilePath());
-									_hasUnalignedFixup = true;
-								}
+								if ( fixUpAddr % 8 )
+									result.unaligned.push_back({ atom, fit->offsetInAtom, fixUpAddr });
 								break;
 							case DYLD_CHAINED_PTR_ARM64E_KERNEL:
 							case DYLD_CHAINED_PTR_64:
@@ -5425,41 +5665,56 @@ void OutputFile::buildChainedFixupInfo(ld::Internal& state)
 							case DYLD_CHAINED_PTR_ARM64E_FIRMWARE:
 							case DYLD_CHAINED_PTR_32:
 							case DYLD_CHAINED_PTR_32_FIRMWARE:
-								if ( fixUpAddr % 4 ) {
-									warning("pointer not aligned at address 0x%llX (%s + %u from %s)",
-										   fixUpAddr, atom->name(), fit->offsetInAtom, atom->safeFilePath());
-									_hasUnalignedFixup = true;
-								}
+								if ( fixUpAddr % 4 )
+									result.unaligned.push_back({ atom, fit->offsetInAtom, fixUpAddr });
 								break;
 							default:
 								assert(0 && "unknown pointer format");
 						}
 
-						unsigned pageIndex = (fixUpAddr - _chainedFixupSegments.back().startAddr)/pageSize;
-						while ( pageIndex >= _chainedFixupSegments.back().pages.size() ) {
-							ChainedFixupPageInfo emptyPage;
-							_chainedFixupSegments.back().pages.push_back(emptyPage);
-						}
-						uint16_t pageOffset = fixUpAddr - (_chainedFixupSegments.back().startAddr + pageIndex*pageSize);
-						_chainedFixupSegments.back().pages[pageIndex].fixupOffsets.push_back(pageOffset);
+						uint32_t pageIndex = (uint32_t)((fixUpAddr - segInfo.startAddr)/pageSize);
+						uint16_t pageOffset = fixUpAddr - (segInfo.startAddr + pageIndex*pageSize);
+						result.locations.push_back({ pageIndex, pageOffset });
 						// build map for binds
 						if ( needsBind(target, isAuthPtr, &accumulator) )
-							_chainedFixupBinds.ensureTarget(target, isAuthPtr, accumulator);
+							result.binds.push_back({ target, accumulator, isAuthPtr });
 					}
 				}
 			}
 		}
-		lastSect = sect;
+	});
+
+	// report problems and assign bind ordinals in section order, so ordinals do not depend on scheduling
+	for (const SectionFixups& fixups : sectionFixups) {
+		for (const UnalignedFixup& unaligned : fixups.unaligned) {
+			warning("pointer not aligned at address 0x%llX (%s + %u from %s)",
+					unaligned.address, unaligned.atom->name(), unaligned.offsetInAtom, unaligned.atom->safeFilePath());
+			_hasUnalignedFixup = true;
+		}
+		for (const BindTarget& bind : fixups.binds)
+			_chainedFixupBinds.ensureTarget(bind.target, bind.isAuthPtr, bind.addend);
 	}
 	if ( _hasUnalignedFixup )
 		throw "unaligned pointer(s)";
 
-	// sort all fixups on each page, so chain can be built
-	for (ChainedFixupSegInfo& segInfo : _chainedFixupSegments) {
+	// distribute fixups to pages and sort all fixups on each page, so chain can be built, each segment in parallel
+	std::vector<std::vector<uint32_t>> segmentSections(_chainedFixupSegments.size());
+	for (uint32_t sectIndex=0; sectIndex < sectionSegIndexes.size(); ++sectIndex)
+		segmentSections[sectionSegIndexes[sectIndex]].push_back(sectIndex);
+	ld::parallel::forEach(_chainedFixupSegments.size(), [&](size_t segIndex) {
+		ChainedFixupSegInfo& segInfo = _chainedFixupSegments[segIndex];
+		for (uint32_t sectIndex : segmentSections[segIndex]) {
+			for (const FixupLocation& location : sectionFixups[sectIndex].locations) {
+				if ( location.pageIndex >= segInfo.pages.size() )
+					segInfo.pages.resize(location.pageIndex+1);
+				segInfo.pages[location.pageIndex].fixupOffsets.push_back(location.pageOffset);
+			}
+		}
 		for (ChainedFixupPageInfo& pageInfo : segInfo.pages) {
 			std::sort(pageInfo.fixupOffsets.begin(), pageInfo.fixupOffsets.end());
 		}
-	}
+	});
+
 	// remember largest legal rebase target
 	uint64_t baseAddress = 0;
 	uint64_t maxRebaseAddress = 0;
@@ -5523,7 +5778,8 @@ void OutputFile::noteTextReloc(const ld::Atom* atom, const ld::Atom* target)
 void OutputFile::addDyldInfo(ld::Internal& state,  ld::Internal::FinalSection* sect, const ld::Atom* atom,  
 								ld::Fixup* fixupWithTarget, ld::Fixup* fixupWithMinusTarget, ld::Fixup* fixupWithStore,
 								const ld::Atom* target, const ld::Atom* minusTarget, 
-								uint64_t targetAddend, uint64_t minusTargetAddend)
+								uint64_t targetAddend, uint64_t minusTargetAddend,
+								LinkEditInfoChunk& chunk)
 {
 	if ( sect->isSectionHidden() )
 		return;
@@ -5546,10 +5802,12 @@ void OutputFile::addDyldInfo(ld::Internal& state,  ld::Internal::FinalSection* s
 					return;
 				}
 				// Have direct reference to weak-global.  This should be an indrect reference
-				const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
-				warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
-						"This was likely caused by different translation units being compiled with different visibility settings.",
-						  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+				chunk.diagnostics.push_back([=]() {
+					const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
+					warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
+							"This was likely caused by different translation units being compiled with different visibility settings.",
+							  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+				});
 			}
 			return;
 		}
@@ -5575,10 +5833,12 @@ void OutputFile::addDyldInfo(ld::Internal& state,  ld::Internal::FinalSection* s
 				return;
 			}
 			// Have direct reference to weak-global.  This should be an indrect reference
-			const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
-			warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
-					"This was likely caused by different translation units being compiled with different visibility settings.",
-					  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+			chunk.diagnostics.push_back([=]() {
+				const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
+				warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
+						"This was likely caused by different translation units being compiled with different visibility settings.",
+						  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+			});
 		}
 		return;
 	}
@@ -5725,8 +5985,8 @@ void OutputFile::addDyldInfo(ld::Internal& state,  ld::Internal::FinalSection* s
 	// record dyld info for this cluster
 	if ( needsRebase ) {
 		if ( inReadOnlySeg ) {
-			noteTextReloc(atom, target);
-			sect->hasLocalRelocs = true;  // so dyld knows to change permissions on __TEXT segment
+			chunk.diagnostics.push_back([=]() { this->noteTextReloc(atom, target); });
+			chunk.hasLocalRelocs = true;  // so dyld knows to change permissions on __TEXT segment
 			rebaseType = REBASE_TYPE_TEXT_ABSOLUTE32;
 		}
 		if ( _options.sharedRegionEligible() ) {
@@ -5746,9 +6006,11 @@ void OutputFile::addDyldInfo(ld::Internal& state,  ld::Internal::FinalSection* s
 					uint64_t sctEnd = (sct->address+sct->size);
 					if ( (sct->address <= targetAddress) && (targetAddress < sctEnd) ) {
 						if ( (targetAddress+addend) > sctEnd ) {
-							warning("data symbol %s from %s has pointer to %s + 0x%08llX. "  
-									"That large of an addend may disable %s from being put in the dyld shared cache.", 
-									atom->name(), atom->safeFilePath(), target->name(), addend, _options.installPath() );
+							chunk.diagnostics.push_back([=]() {
+								warning("data symbol %s from %s has pointer to %s + 0x%08llX. "  
+										"That large of an addend may disable %s from being put in the dyld shared cache.", 
+										atom->name(), atom->safeFilePath(), target->name(), addend, _options.installPath() );
+							});
 						}
 					}
 				}
@@ -5756,39 +6018,43 @@ void OutputFile::addDyldInfo(ld::Internal& state,  ld::Internal::FinalSection* s
 		}
 		if ( ((address & (pointerSize-1)) != 0) && (rebaseType == REBASE_TYPE_POINTER) ) {
 			if ( _options.unalignedPointerTreatment() != Options::kUnalignedPointerIgnore ) {
-				warning("pointer not aligned at address 0x%llX (%s + %lld from %s)",
-						address, atom->name(), (address - atom->finalAddress()), atom->safeFilePath());
+				chunk.diagnostics.push_back([=]() {
+					warning("pointer not aligned at address 0x%llX (%s + %lld from %s)",
+							address, atom->name(), (address - atom->finalAddress()), atom->safeFilePath());
+				});
 			}
-			_hasUnalignedFixup = true;
+			chunk.hasUnalignedFixup = true;
 		}
-		_rebaseInfo.push_back(RebaseInfo(rebaseType, address));
+		chunk.rebaseInfo.push_back(RebaseInfo(rebaseType, address));
 	}
 
 	if ( (needsBinding || needsWeakBinding) && _options.sharedRegionEligible() && (addend > 31) )
-		warning("addend too large. '%s' contains a pointer to %s+%llu. Dylibs in dyld shared cache can have max addend of 31", atom->name(), target->name(), addend);
+		chunk.diagnostics.push_back([=]() { warning("addend too large. '%s' contains a pointer to %s+%llu. Dylibs in dyld shared cache can have max addend of 31", atom->name(), target->name(), addend); });
 
 	if ( needsBinding ) {
 		if ( inReadOnlySeg ) {
-			noteTextReloc(atom, target);
-			sect->hasExternalRelocs = true; // so dyld knows to change permissions on __TEXT segment
+			chunk.diagnostics.push_back([=]() { this->noteTextReloc(atom, target); });
+			chunk.hasExternalRelocs = true; // so dyld knows to change permissions on __TEXT segment
 		}
 		if ( ((address & (pointerSize-1)) != 0) && (type == BIND_TYPE_POINTER) ) {
 			if ( _options.unalignedPointerTreatment() != Options::kUnalignedPointerIgnore ) {
-				warning("pointer not aligned at address 0x%llX (%s + %lld from %s)",
-						address, atom->name(), (address - atom->finalAddress()), atom->safeFilePath());
+				chunk.diagnostics.push_back([=]() {
+					warning("pointer not aligned at address 0x%llX (%s + %lld from %s)",
+							address, atom->name(), (address - atom->finalAddress()), atom->safeFilePath());
+				});
 			}
-			_hasUnalignedFixup = true;
+			chunk.hasUnalignedFixup = true;
 		}
-		_bindingInfo.push_back(BindingInfo(type, compressedOrdinal, target->name(), weak_import, address, addend));
+		chunk.bindingInfo.push_back(BindingInfo(type, compressedOrdinal, target->name(), weak_import, address, addend));
 	}
 	if ( needsLazyBinding ) {
 		if ( _options.bindAtLoad() )
-			_bindingInfo.push_back(BindingInfo(type, compressedOrdinal, target->name(), weak_import, address, addend));
+			chunk.bindingInfo.push_back(BindingInfo(type, compressedOrdinal, target->name(), weak_import, address, addend));
 		else
-			_lazyBindingInfo.push_back(BindingInfo(type, compressedOrdinal, target->name(), weak_import, address, addend));
+			chunk.lazyBindingInfo.push_back(BindingInfo(type, compressedOrdinal, target->name(), weak_import, address, addend));
 	}
 	if ( needsWeakBinding )
-		_weakBindingInfo.push_back(BindingInfo(type, 0, target->name(), false, address, addend));
+		chunk.weakBindingInfo.push_back(BindingInfo(type, 0, target->name(), false, address, addend));
 }
 
 
@@ -5796,7 +6062,8 @@ void OutputFile::addChainedFixupLocation(ld::Internal& state, ld::Internal::Fina
 										  const ld::Atom* atom, ld::Fixup* fixupWithTarget,
 										  ld::Fixup* fixupWithMinusTarget, ld::Fixup* fixupWithStore,
 										  const ld::Atom* target, const ld::Atom* minusTarget,
-										  uint64_t targetAddend, uint64_t minusTargetAddend)
+										  uint64_t targetAddend, uint64_t minusTargetAddend,
+										LinkEditInfoChunk& chunk)
 {
 	if ( sect->isSectionHidden() )
 		return;
@@ -5822,10 +6089,12 @@ void OutputFile::addChainedFixupLocation(ld::Internal& state, ld::Internal::Fina
 				if ( !_options.dyldOrKernelLoadsOutput() )
 					return;
 				// Have direct reference to weak-global.  This should be an indrect reference
-				const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
-				warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
-						"This was likely caused by different translation units being compiled with different visibility settings.",
-						  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+				chunk.diagnostics.push_back([=]() {
+					const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
+					warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
+							"This was likely caused by different translation units being compiled with different visibility settings.",
+							  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+				});
 			}
 			return;
 		}
@@ -5854,10 +6123,12 @@ void OutputFile::addChainedFixupLocation(ld::Internal& state, ld::Internal::Fina
 			if ( !_options.dyldOrKernelLoadsOutput() )
 				return;
 			// Have direct reference to weak-global.  This should be an indrect reference
-			const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
-			warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
-					"This was likely caused by different translation units being compiled with different visibility settings.",
-					  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+			chunk.diagnostics.push_back([=]() {
+				const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
+				warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
+						"This was likely caused by different translation units being compiled with different visibility settings.",
+						  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+			});
 		}
 		return;
 	}
@@ -5869,7 +6140,8 @@ void OutputFile::addChainedFixupLocation(ld::Internal& state, ld::Internal::Fina
 void OutputFile::addThreadedRebaseInfo(ld::Internal& state,  ld::Internal::FinalSection* sect, const ld::Atom* atom,
 									   ld::Fixup* fixupWithTarget, ld::Fixup* fixupWithMinusTarget, ld::Fixup* fixupWithStore,
 									   const ld::Atom* target, const ld::Atom* minusTarget,
-									   uint64_t targetAddend, uint64_t minusTargetAddend)
+									   uint64_t targetAddend, uint64_t minusTargetAddend,
+								LinkEditInfoChunk& chunk)
 {
 	if ( sect->isSectionHidden() )
 		return;
@@ -5895,10 +6167,12 @@ void OutputFile::addThreadedRebaseInfo(ld::Internal& state,  ld::Internal::Final
 				if ( !_options.dyldOrKernelLoadsOutput() )
 					return;
 				// Have direct reference to weak-global.  This should be an indrect reference
-				const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
-				warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
-						"This was likely caused by different translation units being compiled with different visibility settings.",
-						  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+				chunk.diagnostics.push_back([=]() {
+					const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
+					warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
+							"This was likely caused by different translation units being compiled with different visibility settings.",
+							  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+				});
 			}
 			return;
 		}
@@ -5927,10 +6201,12 @@ void OutputFile::addThreadedRebaseInfo(ld::Internal& state,  ld::Internal::Final
 			if ( !_options.dyldOrKernelLoadsOutput() )
 				return;
 			// Have direct reference to weak-global.  This should be an indrect reference
-			const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
-			warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
-					"This was likely caused by different translation units being compiled with different visibility settings.",
-					  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+			chunk.diagnostics.push_back([=]() {
+				const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
+				warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
+						"This was likely caused by different translation units being compiled with different visibility settings.",
+						  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+			});
 		}
 		return;
 	}
@@ -5965,14 +6241,14 @@ void OutputFile::addThreadedRebaseInfo(ld::Internal& state,  ld::Internal::Final
 	// record dyld info for this cluster
 	if ( needsRebase ) {
 		if ( inReadOnlySeg ) {
-			noteTextReloc(atom, target);
-			sect->hasLocalRelocs = true;  // so dyld knows to change permissions on __TEXT segment
+			chunk.diagnostics.push_back([=]() { this->noteTextReloc(atom, target); });
+			chunk.hasLocalRelocs = true;  // so dyld knows to change permissions on __TEXT segment
 		}
 		if ( ((address & (minAlignment-1)) != 0) ) {
 			throwf("pointer not aligned to at least 4-bytes at address 0x%llX (%s + %lld from %s)",
 				   address, atom->name(), (address - atom->finalAddress()), atom->safeFilePath());
 		}
-		_rebaseInfo.push_back(RebaseInfo(rebaseType, address));
+		chunk.rebaseInfo.push_back(RebaseInfo(rebaseType, address));
 	}
 }
 
@@ -5980,7 +6256,8 @@ void OutputFile::addThreadedRebaseInfo(ld::Internal& state,  ld::Internal::Final
 void OutputFile::addClassicRelocs(ld::Internal& state, ld::Internal::FinalSection* sect, const ld::Atom* atom, 
 								ld::Fixup* fixupWithTarget, ld::Fixup* fixupWithMinusTarget, ld::Fixup* fixupWithStore,
 								const ld::Atom* target, const ld::Atom* minusTarget, 
-								uint64_t targetAddend, uint64_t minusTargetAddend)
+								uint64_t targetAddend, uint64_t minusTargetAddend,
+								LinkEditInfoChunk& chunk)
 {
 	if ( sect->isSectionHidden() )
 		return;
@@ -6024,10 +6301,12 @@ void OutputFile::addClassicRelocs(ld::Internal& state, ld::Internal::FinalSectio
 				return;
 			}
 			// Have direct reference to weak-global.  This should be an indrect reference
-			const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
-			warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
-					"This was likely caused by different translation units being compiled with different visibility settings.",
-					  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+			chunk.diagnostics.push_back([=]() {
+				const char* demangledName = strdup(_options.demangleSymbol(atom->name()));
+				warning("direct access in function '%s' from file '%s' to global weak symbol '%s' from file '%s' means the weak symbol cannot be overridden at runtime. "
+						"This was likely caused by different translation units being compiled with different visibility settings.",
+						  demangledName, atom->safeFilePath(), _options.demangleSymbol(target->name()), target->safeFilePath());
+			});
 		}
 		return;
 	}
@@ -6103,15 +6382,15 @@ void OutputFile::addClassicRelocs(ld::Internal& state, ld::Internal::FinalSectio
 			}
 			if ( needsExternReloc ) {
 				if ( inReadOnlySeg )
-					noteTextReloc(atom, target);
-				_externalRelocsAtom->addExternalPointerReloc(relocAddress, target);
-				sect->hasExternalRelocs = true;
+					chunk.diagnostics.push_back([=]() { this->noteTextReloc(atom, target); });
+				chunk.externalPointerRelocs.push_back({ relocAddress, target });
+				chunk.hasExternalRelocs = true;
 				fixupWithTarget->contentAddendOnly = true;
 			}
 			else if ( needsLocalReloc ) {
 				assert(target != NULL);
 				if ( inReadOnlySeg )
-					noteTextReloc(atom, target);
+					chunk.diagnostics.push_back([=]() { this->noteTextReloc(atom, target); });
 				// The x86_64 kernel will continue to use classic relocs in the kernel linker, not chained fixups
 				// so we don't need to diagnose unaligned fixups there
 				if ( _options.isKernel() && (relocAddress % 4) && (_options.architecture() != CPU_TYPE_X86_64) ) {
@@ -6144,8 +6423,8 @@ void OutputFile::addClassicRelocs(ld::Internal& state, ld::Internal::FinalSectio
 				// The kernel is special as it has i386 code in an x86_64 binary
 				if ( !_options.isKernel() )
 					relocLength = _localRelocsAtom->pointerSize();
-				_localRelocsAtom->addPointerReloc(relocAddress, target->machoSection(), relocLength);
-				sect->hasLocalRelocs = true;
+				chunk.localRelocs.push_back({ relocAddress, target->machoSection(), relocLength });
+				chunk.hasLocalRelocs = true;
 			}
 			break;
 		case ld::Fixup::kindStoreTargetAddressX86BranchPCRel32:
@@ -6155,7 +6434,7 @@ void OutputFile::addClassicRelocs(ld::Internal& state, ld::Internal::FinalSectio
 			if ( _options.outputKind() == Options::kKextBundle ) {
 				assert(target != NULL);
 				if ( target->definition() == ld::Atom::definitionProxy ) {
-					_externalRelocsAtom->addExternalCallSiteReloc(relocAddress, target);
+					chunk.externalCallSiteRelocs.push_back({ relocAddress, target });
 					fixupWithStore->contentAddendOnly = true;
 				}
 			}
@@ -6179,13 +6458,13 @@ void OutputFile::addClassicRelocs(ld::Internal& state, ld::Internal::FinalSectio
 		case ld::Fixup::kindStoreLittleEndianAuth64:
 			if ( _options.outputKind() == Options::kKextBundle ) {
 				if ( target->definition() == ld::Atom::definitionProxy ) {
-					_externalRelocsAtom->addExternalPointerReloc(relocAddress, target);
-					sect->hasExternalRelocs = true;
+					chunk.externalPointerRelocs.push_back({ relocAddress, target });
+					chunk.hasExternalRelocs = true;
 					fixupWithTarget->contentAddendOnly = true;
 				}
 				else {
-					_localRelocsAtom->addPointerReloc(relocAddress, target->machoSection(), _localRelocsAtom->pointerSize());
-					sect->hasLocalRelocs = true;
+					chunk.localRelocs.push_back({ relocAddress, target->machoSection(), _localRelocsAtom->pointerSize() });
+					chunk.hasLocalRelocs = true;
 				}
 			}
 			else {
@@ -6284,7 +6563,8 @@ void OutputFile::addSectionRelocs(ld::Internal& state, ld::Internal::FinalSectio
 								  ld::Fixup* fixupWithAuthData,
 #endif
 								const ld::Atom* target, const ld::Atom* minusTarget, 
-								uint64_t targetAddend, uint64_t minusTargetAddend)
+								uint64_t targetAddend, uint64_t minusTargetAddend,
+								LinkEditInfoChunk& chunk)
 {
 	if ( sect->isSectionHidden() )
 		return;
@@ -6347,12 +6627,20 @@ void OutputFile::addSectionRelocs(ld::Internal& state, ld::Internal::FinalSectio
 	}
 	
 	if ( fixupWithStore != NULL ) {
-		_sectionsRelocationsAtom->addSectionReloc(sect, fixupWithStore->kind, atom, fixupWithStore->offsetInAtom, 
-													targetUsesExternalReloc, minusTargetUsesExternalReloc,
+		LinkEditInfoChunk::SectionReloc reloc;
+		reloc.kind							= fixupWithStore->kind;
+		reloc.atom							= atom;
+		reloc.offsetInAtom					= fixupWithStore->offsetInAtom;
+		reloc.targetUsesExternalReloc		= targetUsesExternalReloc;
+		reloc.minusTargetUsesExternalReloc	= minusTargetUsesExternalReloc;
 #if SUPPORT_ARCH_arm64e
-												  fixupWithAuthData,
+		reloc.fixupWithAuthData				= fixupWithAuthData;
 #endif
-													target, targetAddend, minusTarget, minusTargetAddend);
+		reloc.target						= target;
+		reloc.targetAddend					= targetAddend;
+		reloc.minusTarget					= minusTarget;
+		reloc.minusTargetAddend				= minusTargetAddend;
+		chunk.sectionRelocs.push_back(reloc);
 	}
 
 }
@@ -6667,211 +6955,381 @@ void OutputFile::makeSplitSegInfoV2(ld::Internal& state)
 }
 
 
-void OutputFile::writeMapFile(ld::Internal& state)
-{
-	if ( _options.generatedMapPath() != NULL ) {
-		FILE* mapFile = fopen(_options.generatedMapPath(), "w");
-		if ( mapFile != NULL ) {
-			// write output path
-			fprintf(mapFile, "# Path: %s\n", _options.outputFilePath());
-			// write output architecure
-			fprintf(mapFile, "# Arch: %s\n", _options.architectureName());
-			// write UUID
-			//if ( fUUIDAtom != NULL ) {
-			//	const uint8_t* uuid = fUUIDAtom->getUUID();
-			//	fprintf(mapFile, "# UUID: %2X %2X %2X %2X %2X %2X %2X %2X %2X %2X %2X %2X %2X %2X %2X %2X \n",
-			//		uuid[0], uuid[1], uuid[2],  uuid[3],  uuid[4],  uuid[5],  uuid[6],  uuid[7],
-			//		uuid[8], uuid[9], uuid[10], uuid[11], uuid[12], uuid[13], uuid[14], uuid[15]);
-			//}
-			// write table of object files
-			std::map<const ld::File*, ld::File::Ordinal> readerToOrdinal;
-			std::map<ld::File::Ordinal, const ld::File*> ordinalToReader;
-			std::map<const ld::File*, uint32_t> readerToFileOrdinal;
-			for (std::vector<ld::Internal::FinalSection*>::iterator sit = state.sections.begin(); sit != state.sections.end(); ++sit) {
-				ld::Internal::FinalSection* sect = *sit;
-				if ( sect->isSectionHidden() ) 
-					continue;
-				for (std::vector<const ld::Atom*>::iterator ait = sect->atoms.begin(); ait != sect->atoms.end(); ++ait) {
-					const ld::Atom* atom = *ait;
-					const ld::File* reader = atom->originalFile();
-					if ( reader == NULL )
-						continue;
-					ld::File::Ordinal readerOrdinal = reader->ordinal();
-					std::map<const ld::File*, ld::File::Ordinal>::iterator pos = readerToOrdinal.find(reader);
-					if ( pos == readerToOrdinal.end() ) {
-						readerToOrdinal[reader] = readerOrdinal;
-						ordinalToReader[readerOrdinal] = reader;
-					}
+// object file table shared by the text and binary map files
+struct MapFileObjectFiles {
+	std::vector<const ld::File*>						files;				// in map file order, after the linker itself
+	std::unordered_map<const ld::File*, uint32_t>		indexes;
+	std::unordered_map<std::string, const ld::File*>	ltoSymbols;			// for LTO, map of symbols back to original .o file
+
+	uint32_t	indexOf(const ld::File* file) const {
+					auto pos = indexes.find(file);
+					return (pos != indexes.end()) ? pos->second : 0;
 				}
+	uint32_t	indexOfAtom(const ld::Atom* atom) const;
+};
+
+uint32_t MapFileObjectFiles::indexOfAtom(const ld::Atom* atom) const
+{
+	// <rdar://problem/50031245> LTO: preserve the original file reference for symbols in link map
+	uint32_t fromFileOrdinal = indexOf(atom->originalFile());
+	const ld::relocatable::File* objFile = dynamic_cast<const ld::relocatable::File*>(atom->originalFile());
+	if ( (objFile != nullptr) && (objFile->sourceKind() == ld::relocatable::File::kSourceLTO) ) {
+		const auto& pos = ltoSymbols.find(atom->name());
+		if ( pos != ltoSymbols.end() ) {
+			const ld::File* betterFile = pos->second;
+			if ( betterFile != nullptr ) {
+				const auto& pos2 = indexes.find(betterFile);
+				if ( pos2 != indexes.end() )
+					fromFileOrdinal = pos2->second;
 			}
-			// for LTO build map of symbols back to original .o file
-			__block std::map<std::string, const ld::File*> ltoSymbolsMap;
-			for (const ld::relocatable::File* ltoFile : state.filesForLTO) {
-				ltoFile->forEachLtoSymbol(^(const char* symName) {
-					auto pos = ltoSymbolsMap.find(symName);
-					if ( pos == ltoSymbolsMap.end() ) {
-						ltoSymbolsMap[symName] = ltoFile;
-					}
-					else {
-						// same symbol in multiple files, map will show lto.o
-						pos->second = nullptr;
-					}
-				});
-				// add to object file table even if nothing used from it
-				if ( readerToOrdinal.count(ltoFile) == 0 ) {
-					ld::File::Ordinal readerOrdinal = ltoFile->ordinal();
-					readerToOrdinal[ltoFile] = readerOrdinal;
-					ordinalToReader[readerOrdinal] = ltoFile;
-				}
+		}
+	}
+	return fromFileOrdinal;
+}
+
+static void buildMapFileObjectFiles(ld::Internal& state, MapFileObjectFiles& objectFiles)
+{
+	std::unordered_set<const ld::File*> readersSeen;
+	std::map<ld::File::Ordinal, const ld::File*> ordinalToReader;
+	for (std::vector<ld::Internal::FinalSection*>::iterator sit = state.sections.begin(); sit != state.sections.end(); ++sit) {
+		ld::Internal::FinalSection* sect = *sit;
+		if ( sect->isSectionHidden() ) 
+			continue;
+		for (std::vector<const ld::Atom*>::iterator ait = sect->atoms.begin(); ait != sect->atoms.end(); ++ait) {
+			const ld::Atom* atom = *ait;
+			const ld::File* reader = atom->originalFile();
+			if ( reader == NULL )
+				continue;
+			if ( readersSeen.insert(reader).second )
+				ordinalToReader[reader->ordinal()] = reader;
+		}
+	}
+	// for LTO build map of symbols back to original .o file
+	std::unordered_map<std::string, const ld::File*>* ltoSymbolsMap = &objectFiles.ltoSymbols;
+	for (const ld::relocatable::File* ltoFile : state.filesForLTO) {
+		ltoFile->forEachLtoSymbol(^(const char* symName) {
+			auto pos = ltoSymbolsMap->find(symName);
+			if ( pos == ltoSymbolsMap->end() ) {
+				(*ltoSymbolsMap)[symName] = ltoFile;
+			}
+			else {
+				// same symbol in multiple files, map will show lto.o
+				pos->second = nullptr;
 			}
+		});
+		// add to object file table even if nothing used from it
+		if ( readersSeen.insert(ltoFile).second )
+			ordinalToReader[ltoFile->ordinal()] = ltoFile;
+	}
 
-			for (const ld::Atom* atom : state.deadAtoms) {
-				const ld::File* reader = atom->originalFile();
-				if ( reader == NULL )
-					continue;
-				ld::File::Ordinal readerOrdinal = reader->ordinal();
-				std::map<const ld::File*, ld::File::Ordinal>::iterator pos = readerToOrdinal.find(reader);
-				if ( pos == readerToOrdinal.end() ) {
-					readerToOrdinal[reader] = readerOrdinal;
-					ordinalToReader[readerOrdinal] = reader;
-				}
-			}
-			fprintf(mapFile, "# Object files:\n");
-			fprintf(mapFile, "[%3u] %s\n", 0, "linker synthesized");
-			uint32_t fileIndex = 1;
-			for(std::map<ld::File::Ordinal, const ld::File*>::iterator it = ordinalToReader.begin(); it != ordinalToReader.end(); ++it) {
-				fprintf(mapFile, "[%3u] %s\n", fileIndex, it->second->path());
-				readerToFileOrdinal[it->second] = fileIndex++;
-			}
-			// write table of sections
-			fprintf(mapFile, "# Sections:\n");
-			fprintf(mapFile, "# Address\tSize    \tSegment\tSection\n"); 
-			for (std::vector<ld::Internal::FinalSection*>::iterator sit = state.sections.begin(); sit != state.sections.end(); ++sit) {
-				ld::Internal::FinalSection* sect = *sit;
-				if ( sect->isSectionHidden() ) 
-					continue;
-				fprintf(mapFile, "0x%08llX\t0x%08llX\t%s\t%s\n", sect->address, sect->size, 
-							sect->segmentName(), sect->sectionName());
+	for (const ld::Atom* atom : state.deadAtoms) {
+		const ld::File* reader = atom->originalFile();
+		if ( reader == NULL )
+			continue;
+		if ( readersSeen.insert(reader).second )
+			ordinalToReader[reader->ordinal()] = reader;
+	}
+	uint32_t fileIndex = 1;
+	for (std::map<ld::File::Ordinal, const ld::File*>::iterator it = ordinalToReader.begin(); it != ordinalToReader.end(); ++it) {
+		objectFiles.files.push_back(it->second);
+		objectFiles.indexes[it->second] = fileIndex++;
+	}
+}
+
+// a run of atoms from one section (or the dead stripped atoms) that is formatted as a unit
+struct MapFileChunk {
+	const std::vector<const ld::Atom*>*		atoms;
+	size_t									begin;
+	size_t									end;
+	uint32_t								sectionIndex;		// BINARY_MAP_DEAD_STRIPPED for dead stripped atoms
+};
+
+static void appendMapFileChunks(std::vector<MapFileChunk>& chunks, const std::vector<const ld::Atom*>& atoms, uint32_t sectionIndex)
+{
+	const size_t atomsPerChunk = 8192;
+	for (size_t begin=0; begin < atoms.size(); begin += atomsPerChunk)
+		chunks.push_back({ &atoms, begin, std::min(begin+atomsPerChunk, atoms.size()), sectionIndex });
+}
+
+static bool inMapFile(const ld::Atom* atom)
+{
+	// don't add auto-stripped aliases to .map file
+	return !( (atom->size() == 0) && (atom->symbolTableInclusion() == ld::Atom::symbolTableNotInFinalLinkedImages) );
+}
+
+// returns the name to show for an atom in a map file, made up in buffer for atoms whose names say little
+static const char* mapFileAtomName(ld::Internal& state, const ld::Atom* atom, bool deadStripped, char buffer[4096])
+{
+	const char* name = atom->name();
+	if ( atom->contentType() == ld::Atom::typeCString ) {
+		strcpy(buffer, "literal string: ");
+		const char* s = (char*)atom->rawContentPointer();
+		char* e = &buffer[4094];
+		for (char* b = &buffer[strlen(buffer)]; b < e;) {
+			char c = *s++;
+			if ( c == '\n' ) {
+				*b++ = '\\';
+				*b++ = 'n';
 			}
-			// write table of symbols
-			fprintf(mapFile, "# Symbols:\n");
-			fprintf(mapFile, "# Address\tSize    \tFile  Name\n"); 
-			for (std::vector<ld::Internal::FinalSection*>::iterator sit = state.sections.begin(); sit != state.sections.end(); ++sit) {
-				ld::Internal::FinalSection* sect = *sit;
-				if ( sect->isSectionHidden() ) 
-					continue;
-				//bool isCstring = (sect->type() == ld::Section::typeCString);
-				for (std::vector<const ld::Atom*>::iterator ait = sect->atoms.begin(); ait != sect->atoms.end(); ++ait) {
-					char buffer[4096];
-					const ld::Atom* atom = *ait;
-					const char* name = atom->name();
-					// don't add auto-stripped aliases to .map file
-					if ( (atom->size() == 0) && (atom->symbolTableInclusion() == ld::Atom::symbolTableNotInFinalLinkedImages) )
-						continue;
-					if ( atom->contentType() == ld::Atom::typeCString ) {
-						strcpy(buffer, "literal string: ");
-						const char* s = (char*)atom->rawContentPointer();
-						char* e = &buffer[4094];
-						for (char* b = &buffer[strlen(buffer)]; b < e;) {
-							char c = *s++;
-							if ( c == '\n' ) {
-								*b++ = '\\';
-								*b++ = 'n';
-							}
-							else {
-								*b++ = c;
-							}
-							if ( c == '\0' )
-								break;
-						}
-						buffer[4095] = '\0';
-						name = buffer;
-					}
-					else if ( (atom->contentType() == ld::Atom::typeCFI) && (strcmp(name, "FDE") == 0) ) {
-						for (ld::Fixup::iterator fit = atom->fixupsBegin(); fit != atom->fixupsEnd(); ++fit) {
-							if ( (fit->kind == ld::Fixup::kindSetTargetAddress) && (fit->clusterSize == ld::Fixup::k1of4) ) {
-								if ( (fit->binding == ld::Fixup::bindingDirectlyBound)
-								 &&  (fit->u.target->section().type() == ld::Section::typeCode) ) {
-									strcpy(buffer, "FDE for: ");
-									strlcat(buffer, fit->u.target->name(), 4096);
-									name = buffer;
-								}
-							}
-						}
-					}
-					else if ( atom->contentType() == ld::Atom::typeNonLazyPointer ) {
-						strcpy(buffer, "non-lazy-pointer");
-						for (ld::Fixup::iterator fit = atom->fixupsBegin(); fit != atom->fixupsEnd(); ++fit) {
-							if ( fit->binding == ld::Fixup::bindingsIndirectlyBound ) {
-								strcpy(buffer, "non-lazy-pointer-to: ");
-								strlcat(buffer, state.indirectBindingTable[fit->u.bindingIndex]->name(), 4096);
-								break;
-							}
-							else if ( fit->binding == ld::Fixup::bindingDirectlyBound ) {
-								strcpy(buffer, "non-lazy-pointer-to-local: ");
-								strlcat(buffer, fit->u.target->name(), 4096);
-								break;
-							}
-						}
-						name = buffer;
-					}
-					// <rdar://problem/50031245> LTO: preserve the original file reference for symbols in link map
-					unsigned fromFileOrdinal = readerToFileOrdinal[atom->originalFile()];
-					const ld::relocatable::File* objFile = dynamic_cast<const ld::relocatable::File*>(atom->originalFile());
-					if ( (objFile != nullptr) && (objFile->sourceKind() == ld::relocatable::File::kSourceLTO) ) {
-						const auto& pos = ltoSymbolsMap.find(atom->name());
-						if ( pos != ltoSymbolsMap.end() ) {
-							const ld::File* betterFile = pos->second;
-							if ( betterFile != nullptr ) {
-								const auto& pos2 = readerToFileOrdinal.find(betterFile);
-								if ( pos2 != readerToFileOrdinal.end() )
-									fromFileOrdinal = pos2->second;
-							}
-						}
-					}
-					fprintf(mapFile, "0x%08llX\t0x%08llX\t[%3u] %s\n", atom->finalAddress(), atom->size(), fromFileOrdinal, name);
-				}
-			}
-			// preload check is hack until 26613948 is fixed
-			if ( _options.deadCodeStrip() && (_options.outputKind() != Options::kPreload) ) {
-				fprintf(mapFile, "\n");
-				fprintf(mapFile, "# Dead Stripped Symbols:\n");
-				fprintf(mapFile, "#        \tSize    \tFile  Name\n");
-				for (const ld::Atom* atom : state.deadAtoms) {
-					char buffer[4096];
-					const char* name = atom->name();
-					// don't add auto-stripped aliases to .map file
-					if ( (atom->size() == 0) && (atom->symbolTableInclusion() == ld::Atom::symbolTableNotInFinalLinkedImages) )
-						continue;
-					if ( atom->contentType() == ld::Atom::typeCString ) {
-						strcpy(buffer, "literal string: ");
-						const char* s = (char*)atom->rawContentPointer();
-						char* e = &buffer[4094];
-						for (char* b = &buffer[strlen(buffer)]; b < e;) {
-							char c = *s++;
-							if ( c == '\n' ) {
-								*b++ = '\\';
-								*b++ = 'n';
-							}
-							else {
-								*b++ = c;
-							}
-							if ( c == '\0' )
-								break;
-						}
-						buffer[4095] = '\0';
-						name = buffer;
-					}
-					fprintf(mapFile, "<<dead>> \t0x%08llX\t[%3u] %s\n",  atom->size(),
-							readerToFileOrdinal[atom->originalFile()], name);
+			else {
+				*b++ = c;
+			}
+			if ( c == '\0' )
+				break;
+		}
+		buffer[4095] = '\0';
+		name = buffer;
+	}
+	else if ( deadStripped ) {
+		// dead stripped atoms were never bound, so there is nothing to say about what they point to
+	}
+	else if ( (atom->contentType() == ld::Atom::typeCFI) && (strcmp(name, "FDE") == 0) ) {
+		for (ld::Fixup::iterator fit = atom->fixupsBegin(); fit != atom->fixupsEnd(); ++fit) {
+			if ( (fit->kind == ld::Fixup::kindSetTargetAddress) && (fit->clusterSize == ld::Fixup::k1of4) ) {
+				if ( (fit->binding == ld::Fixup::bindingDirectlyBound)
+				 &&  (fit->u.target->section().type() == ld::Section::typeCode) ) {
+					strcpy(buffer, "FDE for: ");
+					strlcat(buffer, fit->u.target->name(), 4096);
+					name = buffer;
 				}
 			}
-			fclose(mapFile);
 		}
-		else {
-			warning("could not write map file: %s\n", _options.generatedMapPath());
+	}
+	else if ( atom->contentType() == ld::Atom::typeNonLazyPointer ) {
+		strcpy(buffer, "non-lazy-pointer");
+		for (ld::Fixup::iterator fit = atom->fixupsBegin(); fit != atom->fixupsEnd(); ++fit) {
+			if ( fit->binding == ld::Fixup::bindingsIndirectlyBound ) {
+				strcpy(buffer, "non-lazy-pointer-to: ");
+				strlcat(buffer, state.indirectBindingTable[fit->u.bindingIndex]->name(), 4096);
+				break;
+			}
+			else if ( fit->binding == ld::Fixup::bindingDirectlyBound ) {
+				strcpy(buffer, "non-lazy-pointer-to-local: ");
+				strlcat(buffer, fit->u.target->name(), 4096);
+				break;
+			}
 		}
+		name = buffer;
 	}
+	return name;
+}
+
+static void writeTextMapFile(const Options& options, ld::Internal& state, const MapFileObjectFiles& objectFiles,
+							 const std::vector<MapFileChunk>& chunks)
+{
+	FILE* mapFile = fopen(options.generatedMapPath(), "w");
+	if ( mapFile == NULL ) {
+		warning("could not write map file: %s\n", options.generatedMapPath());
+		return;
+	}
+	// write output path
+	fprintf(mapFile, "# Path: %s\n", options.outputFilePath());
+	// write output architecure
+	fprintf(mapFile, "# Arch: %s\n", options.architectureName());
+	// write table of object files
+	fprintf(mapFile, "# Object files:\n");
+	fprintf(mapFile, "[%3u] %s\n", 0, "linker synthesized");
+	for (const ld::File* file : objectFiles.files)
+		fprintf(mapFile, "[%3u] %s\n", objectFiles.indexOf(file), file->path());
+	// write table of sections
+	fprintf(mapFile, "# Sections:\n");
+	fprintf(mapFile, "# Address\tSize    \tSegment\tSection\n"); 
+	for (std::vector<ld::Internal::FinalSection*>::iterator sit = state.sections.begin(); sit != state.sections.end(); ++sit) {
+		ld::Internal::FinalSection* sect = *sit;
+		if ( sect->isSectionHidden() ) 
+			continue;
+		fprintf(mapFile, "0x%08llX\t0x%08llX\t%s\t%s\n", sect->address, sect->size, 
+					sect->segmentName(), sect->sectionName());
+	}
+
+	// format the symbol lines of each chunk in parallel, then write them in order
+	std::vector<std::string> chunkLines(chunks.size());
+	ld::parallel::forEach(chunks.size(), [&](size_t chunkIndex) {
+		const MapFileChunk& chunk = chunks[chunkIndex];
+		const bool deadStripped = (chunk.sectionIndex == BINARY_MAP_DEAD_STRIPPED);
+		std::string& lines = chunkLines[chunkIndex];
+		lines.reserve((chunk.end - chunk.begin) * 64);
+		char buffer[4096];
+		char columns[64];
+		for (size_t i=chunk.begin; i < chunk.end; ++i) {
+			const ld::Atom* atom = (*chunk.atoms)[i];
+			if ( !inMapFile(atom) )
+				continue;
+			const char* name = mapFileAtomName(state, atom, deadStripped, buffer);
+			if ( deadStripped )
+				snprintf(columns, sizeof(columns), "<<dead>> \t0x%08llX\t[%3u] ", atom->size(), objectFiles.indexOf(atom->originalFile()));
+			else
+				snprintf(columns, sizeof(columns), "0x%08llX\t0x%08llX\t[%3u] ", atom->finalAddress(), atom->size(), objectFiles.indexOfAtom(atom));
+			lines.append(columns);
+			lines.append(name);
+			lines.push_back('\n');
+		}
+	});
+
+	// write table of symbols
+	fprintf(mapFile, "# Symbols:\n");
+	fprintf(mapFile, "# Address\tSize    \tFile  Name\n"); 
+	bool wroteDeadHeader = false;
+	for (size_t chunkIndex=0; chunkIndex < chunks.size(); ++chunkIndex) {
+		if ( (chunks[chunkIndex].sectionIndex == BINARY_MAP_DEAD_STRIPPED) && !wroteDeadHeader ) {
+			fprintf(mapFile, "\n");
+			fprintf(mapFile, "# Dead Stripped Symbols:\n");
+			fprintf(mapFile, "#        \tSize    \tFile  Name\n");
+			wroteDeadHeader = true;
+		}
+		fwrite(chunkLines[chunkIndex].data(), 1, chunkLines[chunkIndex].size(), mapFile);
+		// free memory as we go
+		std::string().swap(chunkLines[chunkIndex]);
+	}
+	// preload check is hack until 26613948 is fixed
+	if ( options.deadCodeStrip() && (options.outputKind() != Options::kPreload) && !wroteDeadHeader ) {
+		fprintf(mapFile, "\n");
+		fprintf(mapFile, "# Dead Stripped Symbols:\n");
+		fprintf(mapFile, "#        \tSize    \tFile  Name\n");
+	}
+	fclose(mapFile);
+}
+
+static void writeBinaryMapFile(const Options& options, ld::Internal& state, const MapFileObjectFiles& objectFiles,
+							   const std::vector<MapFileChunk>& chunks)
+{
+	FILE* mapFile = fopen(options.generatedBinaryMapPath(), "w");
+	if ( mapFile == NULL ) {
+		warning("could not write binary map file: %s\n", options.generatedBinaryMapPath());
+		return;
+	}
+
+	std::string strings;
+	auto addString = [&](const char* str) -> uint64_t {
+		uint64_t offset = strings.size();
+		strings.append(str);
+		strings.push_back('\0');
+		return offset;
+	};
+	struct binary_map_header header;
+	bzero(&header, sizeof(header));
+	strlcpy(header.magic, BINARY_MAP_MAGIC, sizeof(header.magic));
+	header.version = BINARY_MAP_VERSION;
+	header.cputype = options.architecture();
+	header.outputPathOffset = addString(options.outputFilePath());
+	std::vector<uint64_t> fileNameOffsets;
+	fileNameOffsets.push_back(addString("linker synthesized"));
+	for (const ld::File* file : objectFiles.files)
+		fileNameOffsets.push_back(addString(file->path()));
+	std::vector<struct binary_map_section> sections;
+	for (const ld::Internal::FinalSection* sect : state.sections) {
+		if ( sect->isSectionHidden() ) 
+			continue;
+		struct binary_map_section entry;
+		entry.address			= sect->address;
+		entry.size				= sect->size;
+		entry.segmentNameOffset	= addString(sect->segmentName());
+		entry.sectionNameOffset	= addString(sect->sectionName());
+		sections.push_back(entry);
+	}
+
+	// fill in the columns for each chunk in parallel, with name offsets relative to the chunk's names
+	struct ChunkColumns {
+		std::vector<uint64_t>	addresses;
+		std::vector<uint64_t>	sizes;
+		std::vector<uint64_t>	nameOffsets;
+		std::vector<uint32_t>	fileIndexes;
+		std::string				names;
+	};
+	std::vector<ChunkColumns> chunkColumns(chunks.size());
+	ld::parallel::forEach(chunks.size(), [&](size_t chunkIndex) {
+		const MapFileChunk& chunk = chunks[chunkIndex];
+		const bool deadStripped = (chunk.sectionIndex == BINARY_MAP_DEAD_STRIPPED);
+		ChunkColumns& columns = chunkColumns[chunkIndex];
+		char buffer[4096];
+		for (size_t i=chunk.begin; i < chunk.end; ++i) {
+			const ld::Atom* atom = (*chunk.atoms)[i];
+			if ( !inMapFile(atom) )
+				continue;
+			columns.addresses.push_back(deadStripped ? 0 : atom->finalAddress());
+			columns.sizes.push_back(atom->size());
+			columns.nameOffsets.push_back(columns.names.size());
+			columns.fileIndexes.push_back(deadStripped ? objectFiles.indexOf(atom->originalFile()) : objectFiles.indexOfAtom(atom));
+			columns.names.append(mapFileAtomName(state, atom, deadStripped, buffer));
+			columns.names.push_back('\0');
+		}
+	});
+	std::vector<uint64_t> addresses;
+	std::vector<uint64_t> sizes;
+	std::vector<uint64_t> nameOffsets;
+	std::vector<uint32_t> sectionIndexes;
+	std::vector<uint32_t> fileIndexes;
+	for (size_t chunkIndex=0; chunkIndex < chunks.size(); ++chunkIndex) {
+		ChunkColumns& columns = chunkColumns[chunkIndex];
+		const uint64_t namesBase = strings.size();
+		addresses.insert(addresses.end(), columns.addresses.begin(), columns.addresses.end());
+		sizes.insert(sizes.end(), columns.sizes.begin(), columns.sizes.end());
+		for (uint64_t nameOffset : columns.nameOffsets)
+			nameOffsets.push_back(namesBase + nameOffset);
+		sectionIndexes.insert(sectionIndexes.end(), columns.addresses.size(), chunks[chunkIndex].sectionIndex);
+		fileIndexes.insert(fileIndexes.end(), columns.fileIndexes.begin(), columns.fileIndexes.end());
+		strings.append(columns.names);
+		columns = ChunkColumns();
+	}
+
+	// lay out the file, the uint32_t arrays are padded so every array is 8-byte aligned
+	auto paddingTo8 = [](uint64_t size) -> uint64_t { return (8 - (size % 8)) % 8; };
+	const uint64_t sectionIndexesPadding = paddingTo8(sectionIndexes.size() * sizeof(uint32_t));
+	const uint64_t fileIndexesPadding = paddingTo8(fileIndexes.size() * sizeof(uint32_t));
+	uint64_t offset = sizeof(header);
+	header.fileCount			= (uint32_t)fileNameOffsets.size();
+	header.sectionCount			= (uint32_t)sections.size();
+	header.atomCount			= addresses.size();
+	header.filesOffset			= offset;	offset += fileNameOffsets.size() * sizeof(uint64_t);
+	header.sectionsOffset		= offset;	offset += sections.size() * sizeof(struct binary_map_section);
+	header.addressesOffset		= offset;	offset += addresses.size() * sizeof(uint64_t);
+	header.sizesOffset			= offset;	offset += sizes.size() * sizeof(uint64_t);
+	header.nameOffsetsOffset	= offset;	offset += nameOffsets.size() * sizeof(uint64_t);
+	header.sectionIndexesOffset	= offset;	offset += sectionIndexes.size() * sizeof(uint32_t) + sectionIndexesPadding;
+	header.fileIndexesOffset	= offset;	offset += fileIndexes.size() * sizeof(uint32_t) + fileIndexesPadding;
+	header.stringsOffset		= offset;
+	header.stringsSize			= strings.size();
+	const uint64_t zero = 0;
+	bool ok = (fwrite(&header, sizeof(header), 1, mapFile) == 1);
+	ok = ok && (fwrite(fileNameOffsets.data(), sizeof(uint64_t), fileNameOffsets.size(), mapFile) == fileNameOffsets.size());
+	ok = ok && (fwrite(sections.data(), sizeof(struct binary_map_section), sections.size(), mapFile) == sections.size());
+	ok = ok && (fwrite(addresses.data(), sizeof(uint64_t), addresses.size(), mapFile) == addresses.size());
+	ok = ok && (fwrite(sizes.data(), sizeof(uint64_t), sizes.size(), mapFile) == sizes.size());
+	ok = ok && (fwrite(nameOffsets.data(), sizeof(uint64_t), nameOffsets.size(), mapFile) == nameOffsets.size());
+	ok = ok && (fwrite(sectionIndexes.data(), sizeof(uint32_t), sectionIndexes.size(), mapFile) == sectionIndexes.size());
+	ok = ok && (fwrite(&zero, 1, sectionIndexesPadding, mapFile) == sectionIndexesPadding);
+	ok = ok && (fwrite(fileIndexes.data(), sizeof(uint32_t), fileIndexes.size(), mapFile) == fileIndexes.size());
+	ok = ok && (fwrite(&zero, 1, fileIndexesPadding, mapFile) == fileIndexesPadding);
+	ok = ok && (fwrite(strings.data(), 1, strings.size(), mapFile) == strings.size());
+	if ( (fclose(mapFile) != 0) || !ok )
+		warning("could not write binary map file: %s\n", options.generatedBinaryMapPath());
+}
+
+void OutputFile::writeMapFile(ld::Internal& state)
+{
+	if ( (_options.generatedMapPath() == NULL) && (_options.generatedBinaryMapPath() == NULL) )
+		return;
+
+	MapFileObjectFiles objectFiles;
+	buildMapFileObjectFiles(state, objectFiles);
+
+	// split symbols into chunks that can be formatted in parallel
+	std::vector<MapFileChunk> chunks;
+	uint32_t sectionIndex = 0;
+	for (std::vector<ld::Internal::FinalSection*>::iterator sit = state.sections.begin(); sit != state.sections.end(); ++sit) {
+		ld::Internal::FinalSection* sect = *sit;
+		if ( sect->isSectionHidden() ) 
+			continue;
+		appendMapFileChunks(chunks, sect->atoms, sectionIndex++);
+	}
+	// preload check is hack until 26613948 is fixed
+	if ( _options.deadCodeStrip() && (_options.outputKind() != Options::kPreload) )
+		appendMapFileChunks(chunks, state.deadAtoms, BINARY_MAP_DEAD_STRIPPED);
+
+	if ( _options.generatedMapPath() != NULL )
+		writeTextMapFile(_options, state, objectFiles, chunks);
+	if ( _options.generatedBinaryMapPath() != NULL )
+		writeBinaryMapFile(_options, state, objectFiles, chunks);
 }
 
 static std::string realPathString(const char* path)
@@ -7066,8 +7524,8 @@ void OutputFile::synthesizeDebugNotes(ld::Internal& state)
 		return;
 	// make a vector of atoms that come from files compiled with dwarf debug info
 	std::vector<const ld::Atom*> atomsNeedingDebugNotes;
-	std::set<const ld::Atom*> atomsWithStabs;
-	std::set<const ld::relocatable::File*> filesSeenWithStabs;
+	std::vector<const ld::Atom*> atomsWithStabs;
+	std::vector<const ld::relocatable::File*> filesSeenWithStabs;
 	atomsNeedingDebugNotes.reserve(1024);
 	const ld::relocatable::File* objFile = NULL;
 	bool objFileHasDwarf = false;
@@ -7118,9 +7576,9 @@ void OutputFile::synthesizeDebugNotes(ld::Internal& state)
 				if ( objFileHasDwarf )
 					atomsNeedingDebugNotes.push_back(atom);
 				if ( objFileHasStabs ) {
-					atomsWithStabs.insert(atom);
-					if ( objFile != NULL )
-						filesSeenWithStabs.insert(objFile);
+					atomsWithStabs.push_back(atom);
+					if ( (objFile != NULL) && (filesSeenWithStabs.empty() || (filesSeenWithStabs.back() != objFile)) )
+						filesSeenWithStabs.push_back(objFile);
 				}
 			}
 		}
@@ -7128,6 +7586,75 @@ void OutputFile::synthesizeDebugNotes(ld::Internal& state)
 	
 	// sort by file ordinal then atom ordinal
 	std::sort(atomsNeedingDebugNotes.begin(), atomsNeedingDebugNotes.end(), DebugNoteSorter());
+	std::sort(atomsWithStabs.begin(), atomsWithStabs.end());
+
+	// Everything about an atom's debug notes that does not depend on the notes before it (source path split,
+	// names of files in its line info, symbol name) is worked out in parallel, one input file at a time.
+	// The notes themselves are then emitted serially in the same order as always.
+	struct AtomDebugNoteInfo {
+		const char*		dirPath;			// NULL if atom has no usable translation unit path
+		const char*		filename;
+		const char*		name;				// for data atoms
+		uint32_t		fileIndex;
+		uint32_t		lineFilesStart;
+		uint32_t		lineFilesEnd;
+	};
+	std::vector<AtomDebugNoteInfo> noteInfos(atomsNeedingDebugNotes.size());
+	std::vector<std::pair<size_t, size_t> > fileRanges;
+	for (size_t i=0; i < atomsNeedingDebugNotes.size(); ) {
+		size_t end = i+1;
+		while ( (end < atomsNeedingDebugNotes.size()) && (atomsNeedingDebugNotes[end]->file() == atomsNeedingDebugNotes[i]->file()) )
+			++end;
+		fileRanges.push_back(std::make_pair(i, end));
+		i = end;
+	}
+	std::vector<std::vector<const char*> > lineFiles(fileRanges.size());
+	ld::parallel::forEach(fileRanges.size(), [&](size_t fileIndex) {
+		std::vector<const char*>& fileNames = lineFiles[fileIndex];
+		const char* lastPath = NULL;
+		const char* lastDirPath = NULL;
+		for (size_t i=fileRanges[fileIndex].first; i < fileRanges[fileIndex].second; ++i) {
+			const ld::Atom* atom = atomsNeedingDebugNotes[i];
+			AtomDebugNoteInfo& info = noteInfos[i];
+			info.dirPath		= NULL;
+			info.filename		= NULL;
+			info.name			= NULL;
+			info.fileIndex		= (uint32_t)fileIndex;
+			info.lineFilesStart = (uint32_t)fileNames.size();
+			info.lineFilesEnd	= (uint32_t)fileNames.size();
+			const char* newPath = atom->translationUnitSource();
+			if ( newPath == NULL ) 
+				continue;
+			const char* lastSlash = strrchr(newPath, '/');
+			if ( lastSlash == NULL ) 
+				continue;
+			// atoms from one translation unit share its path, so only split it once
+			if ( newPath != lastPath ) {
+				char* temp = strdup(newPath);
+				// gdb like directory SO's to end in '/', but dwarf DW_AT_comp_dir usually does not have trailing '/'
+				temp[lastSlash-newPath+1] = '\0';
+				lastDirPath = temp;
+				lastPath = newPath;
+			}
+			info.dirPath  = lastDirPath;
+			info.filename = lastSlash+1;
+			if ( atom->section().type() == ld::Section::typeCode ) {
+				// record each change of file in the line info, which is where SOL stabs may be needed
+				const char* curFile = NULL;
+				for (ld::Atom::LineInfo::iterator lit = atom->beginLineInfo(); lit != atom->endLineInfo(); ++lit) {
+					if ( lit->fileName != curFile ) {
+						fileNames.push_back(lit->fileName);
+						curFile = lit->fileName;
+					}
+				}
+				info.lineFilesEnd = (uint32_t)fileNames.size();
+			}
+			else {
+				std::string namestr = std::string(atom->getUserVisibleName());
+				info.name = strdup(namestr.c_str());
+			}
+		}
+	});
 
 	// <rdar://problem/17689030> Add -add_ast_path option to linker which add N_AST stab entry to output
 	std::set<std::string> seenAstPaths;
@@ -7157,23 +7684,15 @@ void OutputFile::synthesizeDebugNotes(ld::Internal& state)
 	bool wroteStartSO = false;
 	state.stabs.reserve(atomsNeedingDebugNotes.size()*4);
 	std::unordered_set<const char*, CStringHash, CStringEquals>  seenFiles;
-	for (std::vector<const ld::Atom*>::iterator it=atomsNeedingDebugNotes.begin(); it != atomsNeedingDebugNotes.end(); it++) {
-		const ld::Atom* atom = *it;
+	for (size_t i=0; i < atomsNeedingDebugNotes.size(); ++i) {
+		const ld::Atom* atom = atomsNeedingDebugNotes[i];
+		const AtomDebugNoteInfo& info = noteInfos[i];
 		const ld::File* atomFile = atom->file();
 		const ld::relocatable::File* atomObjFile = dynamic_cast<const ld::relocatable::File*>(atomFile);
 		//fprintf(stderr, "debug note for %s\n", atom->name());
-		const char* newPath = atom->translationUnitSource();
-		if ( newPath != NULL ) {
-			const char* newDirPath;
-			const char* newFilename;
-			const char* lastSlash = strrchr(newPath, '/');
-			if ( lastSlash == NULL ) 
-				continue;
-			newFilename = lastSlash+1;
-			char* temp = strdup(newPath);
-			newDirPath = temp;
-			// gdb like directory SO's to end in '/', but dwarf DW_AT_comp_dir usually does not have trailing '/'
-			temp[lastSlash-newPath+1] = '\0';
+		if ( info.dirPath != NULL ) {
+			const char* newDirPath = info.dirPath;
+			const char* newFilename = info.filename;
 			// need SO's whenever the translation unit source file changes
 			if ( (filename == NULL) || (strcmp(newFilename,filename) != 0) || (strcmp(newDirPath,dirPath) != 0)) {
 				if ( filename != NULL ) {
@@ -7274,21 +7793,19 @@ void OutputFile::synthesizeDebugNotes(ld::Internal& state)
 				startFun.string		= atom->name();
 				state.stabs.push_back(startFun);
 				// Synthesize any SOL stabs needed
-				const char* curFile = NULL;
-				for (ld::Atom::LineInfo::iterator lit = atom->beginLineInfo(); lit != atom->endLineInfo(); ++lit) {
-					if ( lit->fileName != curFile ) {
-						if ( seenFiles.count(lit->fileName) == 0 ) {
-							seenFiles.insert(lit->fileName);
-							ld::relocatable::File::Stab sol;
-							sol.atom		= 0;
-							sol.type		= N_SOL;
-							sol.other		= 0;
-							sol.desc		= 0;
-							sol.value		= 0;
-							sol.string		= lit->fileName;
-							state.stabs.push_back(sol);
-						}
-						curFile = lit->fileName;
+				const std::vector<const char*>& fileNames = lineFiles[info.fileIndex];
+				for (uint32_t f=info.lineFilesStart; f < info.lineFilesEnd; ++f) {
+					const char* lineFileName = fileNames[f];
+					if ( seenFiles.count(lineFileName) == 0 ) {
+						seenFiles.insert(lineFileName);
+						ld::relocatable::File::Stab sol;
+						sol.atom		= 0;
+						sol.type		= N_SOL;
+						sol.other		= 0;
+						sol.desc		= 0;
+						sol.value		= 0;
+						sol.string		= lineFileName;
+						state.stabs.push_back(sol);
 					}
 				}
 				// Synthesize end FUN and ENSYM stabs
@@ -7311,8 +7828,7 @@ void OutputFile::synthesizeDebugNotes(ld::Internal& state)
 			}
 			else {
 				ld::relocatable::File::Stab globalsStab;
-				std::string namestr = std::string(atom->getUserVisibleName());
-				const char* name = strdup(namestr.c_str());
+				const char* name = info.name;
 				if ( atom->scope() == ld::Atom::scopeTranslationUnit ) {
 					// Synthesize STSYM stab for statics
 					globalsStab.atom		= atom;
@@ -7350,26 +7866,33 @@ void OutputFile::synthesizeDebugNotes(ld::Internal& state)
 	}
 
 	// <rdar://66170674> sort .o files into canonical order
-	std::vector<const ld::relocatable::File*> orderedFilesSeen;
-	for (const ld::relocatable::File* obj : filesSeenWithStabs)
-		orderedFilesSeen.push_back(obj);
+	std::vector<const ld::relocatable::File*>& orderedFilesSeen = filesSeenWithStabs;
 	std::sort(orderedFilesSeen.begin(), orderedFilesSeen.end(), [](const ld::relocatable::File* lhs, const ld::relocatable::File* rhs) {
-		return (lhs->ordinal() < rhs->ordinal());
+		if ( lhs->ordinal() != rhs->ordinal() )
+			return (lhs->ordinal() < rhs->ordinal());
+		return (lhs < rhs);
 	});
+	orderedFilesSeen.erase(std::unique(orderedFilesSeen.begin(), orderedFilesSeen.end()), orderedFilesSeen.end());
 
-	// copy any stabs from .o files
+	// copy any stabs from .o files, each file's stabs are filtered in parallel then appended in file order
 	bool deadStripping = _options.deadCodeStrip();
-	for (const ld::relocatable::File* obj : orderedFilesSeen) {
-		const std::vector<ld::relocatable::File::Stab>* filesStabs = obj->stabs();
-		if ( filesStabs != NULL ) {
-			for (const ld::relocatable::File::Stab& stab : *filesStabs ) {
-				// ignore stabs associated with atoms that were dead stripped or coalesced away
-				if ( (stab.atom != NULL) && (atomsWithStabs.count(stab.atom) == 0) )
-					continue;
-				// <rdar://problem/8284718> Value of N_SO stabs should be address of first atom from translation unit
-				if ( (stab.type == N_SO) && (stab.string != NULL) && (stab.string[0] != '\0') ) {
+	std::vector<std::vector<ld::relocatable::File::Stab> > copiedStabs(orderedFilesSeen.size());
+	ld::parallel::forEach(orderedFilesSeen.size(), [&](size_t index) {
+		const std::vector<ld::relocatable::File::Stab>* filesStabs = orderedFilesSeen[index]->stabs();
+		if ( filesStabs == NULL )
+			return;
+		std::vector<ld::relocatable::File::Stab>& fileCopiedStabs = copiedStabs[index];
+		bool foundLowestAddressAtom = false;
+		const ld::Atom* lowestAddressAtom = NULL;
+		for (const ld::relocatable::File::Stab& stab : *filesStabs ) {
+			// ignore stabs associated with atoms that were dead stripped or coalesced away
+			if ( (stab.atom != NULL) && !std::binary_search(atomsWithStabs.begin(), atomsWithStabs.end(), stab.atom) )
+				continue;
+			// <rdar://problem/8284718> Value of N_SO stabs should be address of first atom from translation unit
+			if ( (stab.type == N_SO) && (stab.string != NULL) && (stab.string[0] != '\0') ) {
+				// the first atom is the same for every N_SO in the file, so only look for it once
+				if ( !foundLowestAddressAtom ) {
 					uint64_t lowestAtomAddress = 0;
-					const ld::Atom* lowestAddressAtom = NULL;
 					for (const ld::relocatable::File::Stab& stab2 : *filesStabs ) {
 						if ( stab2.atom == NULL )
 							continue;
@@ -7384,16 +7907,19 @@ void OutputFile::synthesizeDebugNotes(ld::Internal& state)
 							lowestAtomAddress = atomAddr;
 						}
 					}
-					ld::relocatable::File::Stab altStab = stab;
-					altStab.atom = lowestAddressAtom;
-					state.stabs.push_back(altStab);
-				}
-				else {
-					state.stabs.push_back(stab);
+					foundLowestAddressAtom = true;
 				}
+				ld::relocatable::File::Stab altStab = stab;
+				altStab.atom = lowestAddressAtom;
+				fileCopiedStabs.push_back(altStab);
+			}
+			else {
+				fileCopiedStabs.push_back(stab);
 			}
 		}
-	}
+	});
+	for (const std::vector<ld::relocatable::File::Stab>& fileCopiedStabs : copiedStabs)
+		state.stabs.insert(state.stabs.end(), fileCopiedStabs.begin(), fileCopiedStabs.end());
 
 }
 
@@ -7407,12 +7933,9 @@ void OutputFile::ChainedFixupBinds::ensureTarget(const ld::Atom* atom, bool auth
 		_bindsTargets.push_back({atom, 0});
 		return;
 	}
-	unsigned index = 0;
-	for (const AtomAndAddend& entry : _bindsTargets) {
-		if ( entry.atom == atom && entry.addend == addend )
-			return;
-		++index;
-	}
+	if ( _bindOrdinalsWithAddend.count({atom, addend}) )
+		return;
+	_bindOrdinalsWithAddend[{atom, addend}] = _bindsTargets.size();
 	_bindsTargets.push_back({atom, addend});
 	if ( authPtr )  {
 		// arm64e auth-pointer binds have no bit for addend, so any addend means wide import table
@@ -7473,13 +7996,9 @@ uint32_t OutputFile::ChainedFixupBinds::ordinal(const ld::Atom* atom, uint64_t a
 		assert(it != _bindOrdinalsWithNoAddend.end());
 		return it->second;
 	}
-	unsigned index = 0;
-	for (const AtomAndAddend& entry : _bindsTargets) {
-		if ( entry.atom == atom  && entry.addend == addend )
-			return index;
-		++index;
-	}
-	assert(0 && "bind ordinal missing");
+	auto it = _bindOrdinalsWithAddend.find({atom, addend});
+	assert(it != _bindOrdinalsWithAddend.end() && "bind ordinal missing");
+	return it->second;
 }
 
 
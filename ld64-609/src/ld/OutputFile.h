@@ -42,6 +42,8 @@
 #include <mach-o/dyld.h>
 
 #include <vector>
+#include <functional>
+#include <exception>
 
 #include "Options.h"
 #include "ld.hpp"
@@ -178,6 +180,8 @@ public:
 	};
 
 private:
+	struct LinkEditInfoChunk;
+
 	void						writeAtoms(ld::Internal& state, uint8_t* wholeBuffer);
 	void						computeContentUUID(ld::Internal& state, uint8_t* wholeBuffer);
 	void						buildDylibOrdinalMapping(ld::Internal&);
@@ -186,6 +190,8 @@ private:
 	void						addLinkEdit(ld::Internal& state);
 	void						addPreloadLinkEdit(ld::Internal& state);
 	void						generateLinkEditInfo(ld::Internal& state);
+	void						generateLinkEditInfoChunk(ld::Internal& state, LinkEditInfoChunk& chunk);
+	void						mergeLinkEditInfoChunk(LinkEditInfoChunk& chunk);
 	void						buildSymbolTable(ld::Internal& state);
 	void						writeOutputFile(ld::Internal& state);
 	void						addSectionRelocs(ld::Internal& state, ld::Internal::FinalSection* sect,  
@@ -196,27 +202,32 @@ private:
 												 ld::Fixup* fixupWithAuthData,
 #endif
 												const ld::Atom* target, const ld::Atom* minusTarget, 
-												uint64_t targetAddend, uint64_t minusTargetAddend);
+												uint64_t targetAddend, uint64_t minusTargetAddend,
+												LinkEditInfoChunk& chunk);
 	void						addDyldInfo(ld::Internal& state, ld::Internal::FinalSection* sect,  
 												const ld::Atom* atom, ld::Fixup* fixupWithTarget,
 												ld::Fixup* fixupWithMinusTarget, ld::Fixup* fixupWithStore,
 												const ld::Atom* target, const ld::Atom* minusTarget, 
-												uint64_t targetAddend, uint64_t minusTargetAddend);
+												uint64_t targetAddend, uint64_t minusTargetAddend,
+												LinkEditInfoChunk& chunk);
 	void						addThreadedRebaseInfo(ld::Internal& state, ld::Internal::FinalSection* sect,
 													  const ld::Atom* atom, ld::Fixup* fixupWithTarget,
 													  ld::Fixup* fixupWithMinusTarget, ld::Fixup* fixupWithStore,
 													  const ld::Atom* target, const ld::Atom* minusTarget,
-													  uint64_t targetAddend, uint64_t minusTargetAddend);
+													  uint64_t targetAddend, uint64_t minusTargetAddend,
+													  LinkEditInfoChunk& chunk);
 	void						addChainedFixupLocation(ld::Internal& state, ld::Internal::FinalSection* sect,
 													  const ld::Atom* atom, ld::Fixup* fixupWithTarget,
 													  ld::Fixup* fixupWithMinusTarget, ld::Fixup* fixupWithStore,
 													  const ld::Atom* target, const ld::Atom* minusTarget,
-													  uint64_t targetAddend, uint64_t minusTargetAddend);
+													  uint64_t targetAddend, uint64_t minusTargetAddend,
+													  LinkEditInfoChunk& chunk);
 	void						addClassicRelocs(ld::Internal& state, ld::Internal::FinalSection* sect,
 												const ld::Atom* atom, ld::Fixup* fixupWithTarget, 
 												ld::Fixup* fixupWithMinusTarget, ld::Fixup* fixupWithStore,
 												const ld::Atom* target, const ld::Atom* minusTarget, 
-												uint64_t targetAddend, uint64_t minusTargetAddend);
+												uint64_t targetAddend, uint64_t minusTargetAddend,
+												LinkEditInfoChunk& chunk);
 	bool						useExternalSectionReloc(const ld::Atom* atom, const ld::Atom* target, 
 															ld::Fixup* fixupWithTarget);
 	bool						useSectionRelocAddend(ld::Fixup* fixupWithTarget);
@@ -228,7 +239,7 @@ private:
 	void						makeRebasingInfo(ld::Internal& state);
 	void						makeBindingInfo(ld::Internal& state);
 	void						updateLINKEDITAddresses(ld::Internal& state);
-	void						applyFixUps(ld::Internal& state, uint64_t mhAddress, const ld::Atom*  atom, uint8_t* buffer);
+	bool						applyFixUps(ld::Internal& state, uint64_t mhAddress, const ld::Atom*  atom, uint8_t* buffer);
 	uint64_t					addressOf(const ld::Internal& state, const ld::Fixup* fixup, const ld::Atom** target);
 	uint64_t					addressAndTarget(const ld::Internal& state, const ld::Fixup* fixup, const ld::Atom** target);
 	bool						targetIsThumb(ld::Internal& state, const ld::Fixup* fixup);
@@ -301,6 +312,52 @@ private:
 															ChainedFixupSegInfo& segInfo, uint8_t* pageBufferStart, uint32_t pageIndex);
 	dyld_chained_ptr_32_firmware_rebase* farthestChainableLocation(dyld_chained_ptr_32_firmware_rebase* start);
 
+	// dyld info, classic relocations and diagnostics found in a run of atoms in one section.
+	// Chunks are filled in in parallel, then merged into the output in order.
+	struct LinkEditInfoChunk {
+		struct LocalReloc {
+			uint64_t			address;
+			uint32_t			sectionNumber;
+			uint32_t			length;
+		};
+		struct ExternalReloc {
+			uint64_t			address;
+			const ld::Atom*		target;
+		};
+		struct SectionReloc {
+			ld::Fixup::Kind		kind;
+			const ld::Atom*		atom;
+			uint32_t			offsetInAtom;
+			bool				targetUsesExternalReloc;
+			bool				minusTargetUsesExternalReloc;
+#if SUPPORT_ARCH_arm64e
+			ld::Fixup*			fixupWithAuthData;
+#endif
+			const ld::Atom*		target;
+			uint64_t			targetAddend;
+			const ld::Atom*		minusTarget;
+			uint64_t			minusTargetAddend;
+		};
+		ld::Internal::FinalSection*			sect;
+		size_t								atomsBegin;
+		size_t								atomsEnd;
+		std::vector<RebaseInfo>				rebaseInfo;
+		std::vector<BindingInfo>			bindingInfo;
+		std::vector<BindingInfo>			lazyBindingInfo;
+		std::vector<BindingInfo>			weakBindingInfo;
+		std::vector<LocalReloc>				localRelocs;
+		std::vector<ExternalReloc>			externalPointerRelocs;
+		std::vector<ExternalReloc>			externalCallSiteRelocs;
+		std::vector<SectionReloc>			sectionRelocs;		// -r only
+		std::vector<std::function<void()>>	diagnostics;	// warnings and text reloc checks, run when merged
+		std::exception_ptr					error;
+		bool								hasLocalRelocs = false;
+		bool								hasExternalRelocs = false;
+		bool								hasUnalignedFixup = false;
+		bool								hasDataInCode = false;
+		bool								overridesWeakExternalSymbols = false;
+	};
+
 	struct InstructionInfo {
 		uint32_t			offsetInAtom;
 		const ld::Fixup*	fixup; 
@@ -330,7 +387,14 @@ private:
 			const ld::Atom*		atom;
 			uint64_t			addend;
 		};
+		typedef std::pair<const ld::Atom*, uint64_t> AtomAddendKey;
+		struct AtomAddendKeyHash {
+			size_t operator()(const AtomAddendKey& key) const {
+				return std::hash<const ld::Atom*>()(key.first) ^ (std::hash<uint64_t>()(key.second) * 31);
+			}
+		};
 		std::unordered_map<const ld::Atom*, uint32_t> 	_bindOrdinalsWithNoAddend;
+		std::unordered_map<AtomAddendKey, uint32_t, AtomAddendKeyHash> _bindOrdinalsWithAddend;
 		std::vector<AtomAndAddend>						_bindsTargets;
 		uint64_t										_maxRebase = 0;
 		bool											_hasLargeAddends = false;
@@ -338,8 +402,19 @@ private:
 	};
 
 
-	void setInfo(ld::Internal& state, const ld::Atom* atom, uint8_t* buffer, const std::map<uint32_t, const Fixup*>& usedHints, 
+	// instruction offset used by a linker optimization hint, and the fixup at that offset (if any)
+	struct HintLocation {
+		uint32_t			offsetInAtom;
+		const ld::Fixup*	fixup;
+		static bool lessOffset(const HintLocation& a, const HintLocation& b) { return a.offsetInAtom < b.offsetInAtom; }
+	};
+
+	static HintLocation*		findHintLocation(std::vector<HintLocation>& hintLocations, uint32_t offsetInAtom);
+	void setInfo(ld::Internal& state, const ld::Atom* atom, uint8_t* buffer, std::vector<HintLocation>& hintLocations, 
 						uint32_t offsetInAtom, uint32_t delta, InstructionInfo* info);
+#if SUPPORT_ARCH_arm64
+	void						applyOptimizationHints(ld::Internal& state, const ld::Atom* atom, uint8_t* buffer);
+#endif
 
 	static uint16_t				get16LE(uint8_t* loc);
 	static void					set16LE(uint8_t* loc, uint16_t value);
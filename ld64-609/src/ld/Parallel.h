@@ -0,0 +1,309 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#if __APPLE__
+#include <sys/sysctl.h>
+#endif
+#if __linux__
+#include <sched.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#include <atomic>
+#include <exception>
+#include <string>
+#include <vector>
+
+
+namespace ld {
+namespace parallel {
+
+//
+// Small fork/join helpers used by the passes and the writer to spread independent work
+// across cores.  Work items must not depend on each other, and results must be written to
+// per-index slots and merged by the caller in index order, so output does not depend on
+// scheduling.  If work items throw, the exception from the lowest index is re-thrown on the
+// calling thread, the same one a serial loop would have stopped at.
+//
+// Calls made from inside a work item run serially, and forEach() only starts threads for cores
+// no other thread has claimed, so nesting never oversubscribes the machine.  Threads that do
+// work outside forEach(), such as the input file parsing threads, claim a core with BusyScope.
+//
+
+namespace internal {
+
+#if __linux__
+// cpus allowed by a cgroup cpu quota (v2 cpu.max, or v1 cfs quota/period), 0 if unlimited or unknown
+inline unsigned int cgroupCPULimit()
+{
+	long long quota = -1;
+	long long period = 0;
+	// cgroup v2: the process's own group is named in /proc/self/cgroup as "0::<path>"
+	char groupPath[1024] = "";
+	if ( FILE* cgroups = fopen("/proc/self/cgroup", "r") ) {
+		char line[1024];
+		while ( fgets(line, sizeof(line), cgroups) != NULL ) {
+			if ( strncmp(line, "0::", 3) == 0 ) {
+				snprintf(groupPath, sizeof(groupPath), "%s", &line[3]);
+				groupPath[strcspn(groupPath, "\n")] = '\0';
+				break;
+			}
+		}
+		fclose(cgroups);
+	}
+	const char* const v2Paths[] = { groupPath, "" };
+	for (const char* group : v2Paths) {
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "/sys/fs/cgroup%s/cpu.max", (strcmp(group, "/") == 0) ? "" : group);
+		if ( FILE* cpuMax = fopen(path, "r") ) {
+			char quotaString[32];
+			if ( fscanf(cpuMax, "%31s %lld", quotaString, &period) == 2 )
+				quota = (strcmp(quotaString, "max") == 0) ? -1 : atoll(quotaString);
+			fclose(cpuMax);
+			break;
+		}
+	}
+	if ( period == 0 ) {
+		if ( FILE* quotaFile = fopen("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "r") ) {
+			if ( fscanf(quotaFile, "%lld", &quota) != 1 )
+				quota = -1;
+			fclose(quotaFile);
+		}
+		if ( FILE* periodFile = fopen("/sys/fs/cgroup/cpu/cpu.cfs_period_us", "r") ) {
+			if ( fscanf(periodFile, "%lld", &period) != 1 )
+				period = 0;
+			fclose(periodFile);
+		}
+	}
+	if ( (quota <= 0) || (period <= 0) )
+		return 0;
+	return (unsigned int)((quota + period - 1) / period);
+}
+#endif
+
+} // namespace internal
+
+// number of threads worth running, honoring cpu affinity and container cpu limits
+inline unsigned int workerCount()
+{
+	static const unsigned int sCount = []() -> unsigned int {
+		unsigned int ncpus = 0;
+#if __APPLE__
+		int mib[2];
+		size_t len = sizeof(ncpus);
+		mib[0] = CTL_HW;
+		mib[1] = HW_NCPU;
+		if ( sysctl(mib, 2, &ncpus, &len, NULL, 0) != 0 )
+			ncpus = 0;
+#elif __linux__
+		cpu_set_t allowed;
+		if ( sched_getaffinity(0, sizeof(allowed), &allowed) == 0 )
+			ncpus = CPU_COUNT(&allowed);
+		if ( ncpus == 0 ) {
+			long online = sysconf(_SC_NPROCESSORS_ONLN);
+			if ( online > 0 )
+				ncpus = (unsigned int)online;
+		}
+		// containers are usually limited by a cpu quota rather than by affinity
+		unsigned int limit = internal::cgroupCPULimit();
+		if ( (limit != 0) && (limit < ncpus) )
+			ncpus = limit;
+#else
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		if ( online > 0 )
+			ncpus = (unsigned int)online;
+#endif
+		return (ncpus != 0) ? ncpus : 1;
+	}();
+	return sCount;
+}
+
+namespace internal {
+
+inline bool& inWorker()
+{
+	static thread_local bool sInWorker = false;
+	return sInWorker;
+}
+
+// threads doing work, other than the thread that called forEach()
+inline std::atomic<unsigned int>& busyThreads()
+{
+	static std::atomic<unsigned int> sBusy(0);
+	return sBusy;
+}
+
+// claims up to wanted of the cores no thread is busy on, returns how many it got
+inline size_t claimThreads(size_t wanted)
+{
+	std::atomic<unsigned int>& busy = busyThreads();
+	unsigned int current = busy.load();
+	for (;;) {
+		const size_t available = (current < workerCount()) ? (workerCount() - current) : 0;
+		const size_t claimed = (wanted < available) ? wanted : available;
+		if ( busy.compare_exchange_weak(current, current + (unsigned int)claimed) )
+			return claimed;
+	}
+}
+
+inline void releaseThreads(size_t count)
+{
+	busyThreads() -= (unsigned int)count;
+}
+
+template <typename F>
+class Job {
+public:
+						Job(F& body, size_t count) : _body(body), _count(count), _next(0), _errorIndex(SIZE_MAX) {
+							pthread_mutex_init(&_lock, NULL);
+						}
+						~Job() { pthread_mutex_destroy(&_lock); }
+
+	void				run() {
+							bool& inWorker = internal::inWorker();
+							const bool wasInWorker = inWorker;
+							inWorker = true;
+							// items are claimed in index order, so every item below a failure still runs and
+							// a lower failing item replaces it, only items above the lowest failure are skipped
+							for (size_t i = _next++; (i < _count) && (i < _errorIndex.load(std::memory_order_relaxed)); i = _next++) {
+								try {
+									_body(i);
+								}
+								catch (...) {
+									pthread_mutex_lock(&_lock);
+									if ( i < _errorIndex ) {
+										_error = std::current_exception();
+										_errorIndex = i;
+									}
+									pthread_mutex_unlock(&_lock);
+								}
+							}
+							inWorker = wasInWorker;
+						}
+	void				rethrowIfFailed() const { if ( _error ) std::rethrow_exception(_error); }
+
+	static void*		threadMain(void* job) { ((Job*)job)->run(); return NULL; }
+
+private:
+	F&					_body;
+	const size_t		_count;
+	std::atomic<size_t>	_next;
+	std::atomic<size_t>	_errorIndex;		// lowest index that threw, SIZE_MAX if none
+	pthread_mutex_t		_lock;
+	std::exception_ptr	_error;
+};
+
+} // namespace internal
+
+
+// While a thread has a warning buffer, warning() appends messages to it instead of printing them,
+// so work items can hand their warnings back to be printed in item order.
+typedef std::vector<std::string> WarningBuffer;
+
+inline WarningBuffer*& currentWarnings()
+{
+	static thread_local WarningBuffer* sCurrent = NULL;
+	return sCurrent;
+}
+
+
+// marks the calling thread busy for its lifetime, so forEach() calls don't start threads for its core
+class BusyScope {
+public:
+						BusyScope()  { ++internal::busyThreads(); }
+						~BusyScope() { internal::releaseThreads(1); }
+};
+
+
+// calls body(i) for each i in [0, count), on up to workerCount() threads
+template <typename F>
+void forEach(size_t count, F body)
+{
+	size_t threadCount = workerCount();
+	if ( threadCount > count )
+		threadCount = count;
+	if ( (threadCount <= 1) || internal::inWorker() ) {
+		for (size_t i = 0; i < count; ++i)
+			body(i);
+		return;
+	}
+
+	// only use the cores other threads (such as other input file parsers) are not busy on
+	const size_t extraThreads = internal::claimThreads(threadCount-1);
+	internal::Job<F> job(body, count);
+	std::vector<pthread_t> threads;
+	threads.reserve(extraThreads);
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	// set a nice big stack (same as main thread) because some code uses potentially large stack buffers
+	pthread_attr_setstacksize(&attr, 16 * 1024 * 1024);
+	for (size_t t = 0; t < extraThreads; ++t) {
+		pthread_t thread;
+		// if a thread cannot be created, the ones that were (and this one) just do more of the work
+		if ( pthread_create(&thread, &attr, &internal::Job<F>::threadMain, &job) == 0 )
+			threads.push_back(thread);
+	}
+	pthread_attr_destroy(&attr);
+	internal::releaseThreads(extraThreads - threads.size());
+	job.run();
+	for (pthread_t thread : threads)
+		pthread_join(thread, NULL);
+	internal::releaseThreads(threads.size());
+	job.rethrowIfFailed();
+}
+
+
+// number of chunks forEachChunk() splits count items into, for sizing per-chunk results
+inline size_t chunkCount(size_t count, size_t minChunk)
+{
+	if ( minChunk == 0 )
+		minChunk = 1;
+	// a few chunks per worker lets fast workers pick up the slack of slow ones
+	size_t result = workerCount() * 4;
+	if ( result > (count + minChunk - 1) / minChunk )
+		result = (count + minChunk - 1) / minChunk;
+	return result;
+}
+
+// splits [0, count) into chunkCount(count, minChunk) contiguous ranges and calls body(chunkIndex, begin, end) for each
+template <typename F>
+void forEachChunk(size_t count, size_t minChunk, F body)
+{
+	const size_t chunks = chunkCount(count, minChunk);
+	if ( chunks == 0 )
+		return;
+	const size_t chunkSize = (count + chunks - 1) / chunks;
+	forEach(chunks, [&](size_t chunk) {
+		// trailing chunks may be empty when count does not divide evenly
+		const size_t begin = (chunk * chunkSize < count) ? (chunk * chunkSize) : count;
+		const size_t end   = (begin + chunkSize < count) ? (begin + chunkSize) : count;
+		body(chunk, begin, end);
+	});
+}
+
+
+} // namespace parallel
+} // namespace ld
+
+#endif // __PARALLEL_H__
@@ -0,0 +1,434 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <mach-o/fat.h>
+#include <libkern/OSByteOrder.h>
+#include <tapi/tapi.h>
+
+#include <deque>
+#include <iterator>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "ResidentInputs.h"
+#include "archive_file.h"
+
+namespace ld {
+
+typedef std::tuple<std::string, cpu_type_t, cpu_subtype_t, uint32_t, uint32_t> TextStubKey;
+typedef std::tuple<std::string, cpu_type_t, cpu_subtype_t, uint64_t> ArchiveKey;
+
+struct ResidentTextStub {
+	time_t						modTime;
+	uint64_t					fileLength;
+	tapi::LinkerInterfaceFile*	interface;
+	uint64_t					loadOrder;
+};
+
+struct ResidentArchive {
+	time_t						modTime;
+	uint64_t					sliceLength;
+	uint8_t*					mapping;
+	uint64_t					mappingLength;			// whole file
+	uint64_t					loadOrder;
+	ResidentInputs::ArchiveIndex index;		// names point into mapping
+};
+
+// the server drops the earliest loaded entries beyond these
+static const size_t		kMaxResidentTextStubs		= 4096;
+static const uint64_t	kMaxResidentArchiveBytes	= 4ULL << 30;
+
+// only changed by installPreloaded() on the link server thread that forks links, never while
+// a fork is in progress, so forked links can read them without locking
+static std::map<TextStubKey, ResidentTextStub>	sTextStubs;
+static std::map<ArchiveKey, ResidentArchive*>	sArchives;
+
+static uint64_t								sLoadCount = 0;
+static uint64_t								sResidentArchiveBytes = 0;
+
+static int										sMissFD = -1;
+static pthread_mutex_t							sMissLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void reportMiss(const char* format, ...) __attribute__((format(printf, 1, 2)));
+static void reportMiss(const char* format, ...)
+{
+	char line[PATH_MAX+128];
+	va_list list;
+	va_start(list, format);
+	int len = vsnprintf(line, sizeof(line), format, list);
+	va_end(list);
+	// paths with tabs or newlines can't be reported, they just don't become resident
+	if ( (len <= 0) || (len >= (int)sizeof(line)) || (strchr(line, '\n') != &line[len-1]) )
+		return;
+	pthread_mutex_lock(&sMissLock);
+	(void)::write(sMissFD, line, len);
+	pthread_mutex_unlock(&sMissLock);
+}
+
+// Inputs are keyed and reported by real path: the link may name them relative to its own
+// working directory, or through symlinks, but the server loads them from its own.
+static bool residentPath(const char* path, char realPath[PATH_MAX])
+{
+	return (::realpath(path, realPath) != NULL);
+}
+
+tapi::LinkerInterfaceFile* ResidentInputs::textStub(const char* path, time_t modTime, uint64_t fileLength, cpu_type_t cpuType,
+													 cpu_subtype_t cpuSubType, uint32_t parsingFlags, uint32_t minOSVersion)
+{
+	char realPath[PATH_MAX];
+	if ( (sMissFD == -1) || !residentPath(path, realPath) )
+		return NULL;
+	const auto pos = sTextStubs.find(TextStubKey(realPath, cpuType, cpuSubType, parsingFlags, minOSVersion));
+	if ( (pos != sTextStubs.end()) && (pos->second.modTime == modTime) && (pos->second.fileLength == fileLength) )
+		return pos->second.interface;
+	if ( strchr(realPath, '\t') == NULL )
+		reportMiss("tbd\t%s\t%d\t%d\t%u\t%u\n", realPath, cpuType, cpuSubType, parsingFlags, minOSVersion);
+	return NULL;
+}
+
+const ResidentInputs::ArchiveIndex* ResidentInputs::archiveIndex(const char* path, time_t modTime, uint64_t sliceOffset, uint64_t sliceLength,
+																 cpu_type_t cpuType, cpu_subtype_t cpuSubType)
+{
+	char realPath[PATH_MAX];
+	if ( (sMissFD == -1) || !residentPath(path, realPath) )
+		return NULL;
+	const auto pos = sArchives.find(ArchiveKey(realPath, cpuType, cpuSubType, sliceOffset));
+	if ( (pos != sArchives.end()) && (pos->second->modTime == modTime) && (pos->second->sliceLength == sliceLength) )
+		return &pos->second->index;
+	if ( strchr(realPath, '\t') == NULL )
+		reportMiss("archive\t%s\t%d\t%d\t%llu\t%llu\n", realPath, cpuType, cpuSubType,
+				   (unsigned long long)sliceOffset, (unsigned long long)sliceLength);
+	return NULL;
+}
+
+void ResidentInputs::reportMissesTo(int fd)
+{
+	sMissFD = fd;
+}
+
+
+// A miss reported by a link, parsed into a resident entry on the preload thread
+struct Preload {
+	bool						isArchive;
+	std::string					path;
+	cpu_type_t					cpuType;
+	cpu_subtype_t				cpuSubType;
+	uint32_t					parsingFlags;
+	uint32_t					minOSVersion;
+	uint64_t					sliceOffset;
+	uint64_t					sliceLength;
+	ResidentTextStub			textStub;
+	ResidentArchive*			archive;
+};
+
+// misses wait in the queue to be parsed, then in sPreloaded until installPreloaded() makes them resident
+static pthread_mutex_t							sPreloadLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t							sPreloadQueued = PTHREAD_COND_INITIALIZER;
+static std::deque<Preload*>						sPreloadQueue;
+static std::vector<Preload*>					sPreloaded;
+static bool										sPreloadThreadStarted = false;
+
+
+static bool loadTextStub(Preload& preload)
+{
+	const char* path = preload.path.c_str();
+	struct stat before;
+	if ( ::stat(path, &before) != 0 )
+		return false;
+	if ( !tapi::APIVersion::isAtLeast(1, 3) )
+		return false;
+	std::string errorMessage;
+	tapi::LinkerInterfaceFile* interface = tapi::LinkerInterfaceFile::create(path, preload.cpuType, preload.cpuSubType,
+																			 (tapi::ParsingFlags)preload.parsingFlags,
+																			 tapi::PackedVersion32(preload.minOSVersion), errorMessage);
+	if ( interface == NULL )
+		return false;
+	// don't keep it if the file changed while being parsed
+	struct stat after;
+	if ( (::stat(path, &after) != 0) || (after.st_mtime != before.st_mtime) || (after.st_size != before.st_size) ) {
+		delete interface;
+		return false;
+	}
+	preload.textStub.modTime    = after.st_mtime;
+	preload.textStub.fileLength = after.st_size;
+	preload.textStub.interface  = interface;
+	return true;
+}
+
+static bool loadArchive(Preload& preload)
+{
+	int fd = ::open(preload.path.c_str(), O_RDONLY, 0);
+	if ( fd == -1 )
+		return false;
+	struct stat statBuffer;
+	if ( (::fstat(fd, &statBuffer) != 0) || (statBuffer.st_size < 8) ) {
+		::close(fd);
+		return false;
+	}
+	uint8_t* p = (uint8_t*)::mmap(NULL, statBuffer.st_size, PROT_READ, MAP_FILE | MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if ( p == (uint8_t*)(-1) )
+		return false;
+
+	// find the slice the link used
+	const uint64_t sliceOffset = preload.sliceOffset;
+	const uint64_t sliceLength = preload.sliceLength;
+	const uint8_t* slice = NULL;
+	const fat_header* fh = (fat_header*)p;
+	if ( fh->magic == OSSwapBigToHostInt32(FAT_MAGIC) ) {
+		const struct fat_arch* archs = (struct fat_arch*)(p + sizeof(struct fat_header));
+		const uint32_t sliceCount = OSSwapBigToHostInt32(fh->nfat_arch);
+		for (uint32_t i=0; (i < sliceCount) && ((uint8_t*)&archs[i+1] <= &p[statBuffer.st_size]); ++i) {
+			if ( ((cpu_type_t)OSSwapBigToHostInt32(archs[i].cputype) == preload.cpuType) && (OSSwapBigToHostInt32(archs[i].offset) == sliceOffset)
+				&& (OSSwapBigToHostInt32(archs[i].size) == sliceLength) && (sliceOffset + sliceLength <= (uint64_t)statBuffer.st_size) ) {
+				slice = &p[sliceOffset];
+				break;
+			}
+		}
+	}
+	else if ( fh->magic == OSSwapBigToHostInt32(FAT_MAGIC_64) ) {
+		const struct fat_arch_64* archs = (struct fat_arch_64*)(p + sizeof(struct fat_header));
+		const uint32_t sliceCount = OSSwapBigToHostInt32(fh->nfat_arch);
+		for (uint32_t i=0; (i < sliceCount) && ((uint8_t*)&archs[i+1] <= &p[statBuffer.st_size]); ++i) {
+			if ( ((cpu_type_t)OSSwapBigToHostInt32(archs[i].cputype) == preload.cpuType) && (OSSwapBigToHostInt64(archs[i].offset) == sliceOffset)
+				&& (OSSwapBigToHostInt64(archs[i].size) == sliceLength) && (sliceOffset + sliceLength <= (uint64_t)statBuffer.st_size) ) {
+				slice = &p[sliceOffset];
+				break;
+			}
+		}
+	}
+	else if ( (sliceOffset == 0) && ((uint64_t)statBuffer.st_size == sliceLength) ) {
+		slice = p;
+	}
+
+	ResidentArchive* archive = new ResidentArchive();
+	archive->modTime       = statBuffer.st_mtime;
+	archive->sliceLength   = sliceLength;
+	archive->mapping       = p;
+	archive->mappingLength = statBuffer.st_size;
+	bool indexed = false;
+	try {
+		indexed = (slice != NULL) && ::archive::indexTableOfContents(slice, sliceLength, archive->index);
+	}
+	catch (...) {
+		// malformed archives are diagnosed by the links that use them
+	}
+	if ( !indexed ) {
+		::munmap(p, statBuffer.st_size);
+		delete archive;
+		return false;
+	}
+	preload.archive = archive;
+	return true;
+}
+
+static void* preloadThreadMain(void*)
+{
+	pthread_mutex_lock(&sPreloadLock);
+	for (;;) {
+		while ( sPreloadQueue.empty() )
+			pthread_cond_wait(&sPreloadQueued, &sPreloadLock);
+		Preload* preload = sPreloadQueue.front();
+		sPreloadQueue.pop_front();
+		pthread_mutex_unlock(&sPreloadLock);
+		bool loaded = preload->isArchive ? loadArchive(*preload) : loadTextStub(*preload);
+		pthread_mutex_lock(&sPreloadLock);
+		if ( loaded )
+			sPreloaded.push_back(preload);
+		else
+			delete preload;
+	}
+	return NULL;
+}
+
+// true if what the link missed has become resident since, because another link reported it too
+static bool alreadyResident(const Preload& preload)
+{
+	struct stat statBuffer;
+	if ( ::stat(preload.path.c_str(), &statBuffer) != 0 )
+		return true;
+	if ( preload.isArchive ) {
+		const auto pos = sArchives.find(ArchiveKey(preload.path, preload.cpuType, preload.cpuSubType, preload.sliceOffset));
+		return ( (pos != sArchives.end()) && (pos->second->modTime == statBuffer.st_mtime) && (pos->second->sliceLength == preload.sliceLength) );
+	}
+	const auto pos = sTextStubs.find(TextStubKey(preload.path, preload.cpuType, preload.cpuSubType, preload.parsingFlags, preload.minOSVersion));
+	return ( (pos != sTextStubs.end()) && (pos->second.modTime == statBuffer.st_mtime) && (pos->second.fileLength == (uint64_t)statBuffer.st_size) );
+}
+
+void ResidentInputs::preload(const char* missLine)
+{
+	// fields are: kind, path, then the numbers that were part of the lookup
+	std::vector<std::string> fields;
+	for (const char* s = missLine; ; ) {
+		const char* tab = strchr(s, '\t');
+		if ( tab == NULL ) {
+			fields.push_back(s);
+			break;
+		}
+		fields.push_back(std::string(s, tab-s));
+		s = tab+1;
+	}
+	Preload* preload = new Preload();
+	if ( (fields[0] == "tbd") && (fields.size() == 6) ) {
+		preload->isArchive    = false;
+		preload->path         = fields[1];
+		preload->cpuType      = (cpu_type_t)strtol(fields[2].c_str(), NULL, 10);
+		preload->cpuSubType   = (cpu_subtype_t)strtol(fields[3].c_str(), NULL, 10);
+		preload->parsingFlags = (uint32_t)strtoul(fields[4].c_str(), NULL, 10);
+		preload->minOSVersion = (uint32_t)strtoul(fields[5].c_str(), NULL, 10);
+	}
+	else if ( (fields[0] == "archive") && (fields.size() == 6) ) {
+		preload->isArchive    = true;
+		preload->path         = fields[1];
+		preload->cpuType      = (cpu_type_t)strtol(fields[2].c_str(), NULL, 10);
+		preload->cpuSubType   = (cpu_subtype_t)strtol(fields[3].c_str(), NULL, 10);
+		preload->sliceOffset  = strtoull(fields[4].c_str(), NULL, 10);
+		preload->sliceLength  = strtoull(fields[5].c_str(), NULL, 10);
+	}
+	else {
+		delete preload;
+		return;
+	}
+	if ( alreadyResident(*preload) ) {
+		delete preload;
+		return;
+	}
+
+	// parsing can take a while, so it is done on a thread while the server goes on accepting links
+	pthread_mutex_lock(&sPreloadLock);
+	if ( !sPreloadThreadStarted ) {
+		pthread_t thread;
+		sPreloadThreadStarted = (pthread_create(&thread, NULL, &preloadThreadMain, NULL) == 0);
+		if ( sPreloadThreadStarted )
+			pthread_detach(thread);
+	}
+	if ( sPreloadThreadStarted ) {
+		sPreloadQueue.push_back(preload);
+		pthread_cond_signal(&sPreloadQueued);
+		pthread_mutex_unlock(&sPreloadLock);
+		return;
+	}
+	pthread_mutex_unlock(&sPreloadLock);
+	// no thread could be started, parse it now
+	if ( preload->isArchive ? loadArchive(*preload) : loadTextStub(*preload) ) {
+		pthread_mutex_lock(&sPreloadLock);
+		sPreloaded.push_back(preload);
+		pthread_mutex_unlock(&sPreloadLock);
+	}
+	else {
+		delete preload;
+	}
+}
+
+static void evictTextStub(std::map<TextStubKey, ResidentTextStub>::iterator pos)
+{
+	delete pos->second.interface;
+	sTextStubs.erase(pos);
+}
+
+static void evictArchive(std::map<ArchiveKey, ResidentArchive*>::iterator pos)
+{
+	sResidentArchiveBytes -= pos->second->mappingLength;
+	::munmap(pos->second->mapping, pos->second->mappingLength);
+	delete pos->second;
+	sArchives.erase(pos);
+}
+
+// entries parsed from an earlier version of a file that has since changed can't be used again
+static void evictStale(const std::string& path, time_t modTime, uint64_t fileLength)
+{
+	for (auto pos = sTextStubs.begin(); pos != sTextStubs.end(); ) {
+		auto next = std::next(pos);
+		if ( (std::get<0>(pos->first) == path) && ((pos->second.modTime != modTime) || (pos->second.fileLength != fileLength)) )
+			evictTextStub(pos);
+		pos = next;
+	}
+	for (auto pos = sArchives.begin(); pos != sArchives.end(); ) {
+		auto next = std::next(pos);
+		if ( (std::get<0>(pos->first) == path) && ((pos->second->modTime != modTime) || (pos->second->mappingLength != fileLength)) )
+			evictArchive(pos);
+		pos = next;
+	}
+}
+
+// keep what the server holds bounded, dropping the entries loaded earliest
+static void evictOverLimits()
+{
+	while ( sTextStubs.size() > kMaxResidentTextStubs ) {
+		auto oldest = sTextStubs.begin();
+		for (auto pos = sTextStubs.begin(); pos != sTextStubs.end(); ++pos) {
+			if ( pos->second.loadOrder < oldest->second.loadOrder )
+				oldest = pos;
+		}
+		evictTextStub(oldest);
+	}
+	while ( (sResidentArchiveBytes > kMaxResidentArchiveBytes) && (sArchives.size() > 1) ) {
+		auto oldest = sArchives.begin();
+		for (auto pos = sArchives.begin(); pos != sArchives.end(); ++pos) {
+			if ( pos->second->loadOrder < oldest->second->loadOrder )
+				oldest = pos;
+		}
+		evictArchive(oldest);
+	}
+}
+
+void ResidentInputs::installPreloaded()
+{
+	std::vector<Preload*> preloaded;
+	pthread_mutex_lock(&sPreloadLock);
+	preloaded.swap(sPreloaded);
+	pthread_mutex_unlock(&sPreloadLock);
+
+	for (Preload* preload : preloaded) {
+		if ( preload->isArchive ) {
+			ResidentArchive* archive = preload->archive;
+			evictStale(preload->path, archive->modTime, archive->mappingLength);
+			const ArchiveKey key(preload->path, preload->cpuType, preload->cpuSubType, preload->sliceOffset);
+			const auto pos = sArchives.find(key);
+			if ( pos != sArchives.end() )
+				evictArchive(pos);
+			archive->loadOrder = ++sLoadCount;
+			sArchives[key] = archive;
+			sResidentArchiveBytes += archive->mappingLength;
+		}
+		else {
+			evictStale(preload->path, preload->textStub.modTime, preload->textStub.fileLength);
+			const TextStubKey key(preload->path, preload->cpuType, preload->cpuSubType, preload->parsingFlags, preload->minOSVersion);
+			const auto pos = sTextStubs.find(key);
+			if ( pos != sTextStubs.end() )
+				evictTextStub(pos);
+			preload->textStub.loadOrder = ++sLoadCount;
+			sTextStubs[key] = preload->textStub;
+		}
+		delete preload;
+	}
+	evictOverLimits();
+}
+
+} // namespace ld
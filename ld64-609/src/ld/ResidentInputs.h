@@ -0,0 +1,66 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __RESIDENT_INPUTS_H__
+#define __RESIDENT_INPUTS_H__
+
+#include <stdint.h>
+#include <time.h>
+#include <mach/machine.h>
+
+#include <unordered_map>
+
+#include "ld.hpp"
+
+namespace tapi {
+	class LinkerInterfaceFile;
+}
+
+namespace ld {
+
+//
+// Parsed inputs a link server (ld -link_server) keeps in memory between links.  The server
+// process fills these in, and each link it forks inherits them, so links against the same
+// SDK and libraries skip re-parsing text-based dylibs and archive tables of contents.
+// Entries are keyed by real path plus everything the parse depended on, and are only used if the
+// file's modification time and size still match.  Entries for earlier versions of a file are
+// dropped when a newer one is loaded, and the earliest loaded are dropped beyond a fixed budget.
+//
+// A link that is not run by a link server never finds anything here.  A link run by one
+// reports each input it had to parse itself, and the server parses those in the background
+// for the links it starts later.
+//
+class ResidentInputs {
+public:
+	typedef std::unordered_map<const char*, uint64_t, ld::CStringHash, ld::CStringEquals> ArchiveIndex;
+
+	// returns resident tbd interface for arguments given to tapi::LinkerInterfaceFile::create(), or NULL
+	static tapi::LinkerInterfaceFile*	textStub(const char* path, time_t modTime, uint64_t fileLength, cpu_type_t cpuType,
+												 cpu_subtype_t cpuSubType, uint32_t parsingFlags, uint32_t minOSVersion);
+	// returns resident table of contents (symbol name to member offset) of the archive slice at sliceOffset, or NULL
+	static const ArchiveIndex*			archiveIndex(const char* path, time_t modTime, uint64_t sliceOffset, uint64_t sliceLength,
+													 cpu_type_t cpuType, cpu_subtype_t cpuSubType);
+
+	// used by the link server: misses are reported as lines written to fd.  The server passes them
+	// to preload(), which parses them on a background thread, and calls installPreloaded() before
+	// forking each link to make what has been parsed so far resident.
+	static void							reportMissesTo(int fd);
+	static void							preload(const char* missLine);
+	static void							installPreloaded();
+};
+
+} // namespace ld
+
+#endif // __RESIDENT_INPUTS_H__
@@ -807,7 +807,7 @@ void Resolver::doAtom(const ld::Atom& atom)
 	if ( _options.deadCodeStrip() ) {
 		// add to set of dead-strip-roots, all symbols that the compiler marks as don't strip
 		if ( atom.dontDeadStrip() )
-			_deadStripRoots.insert(&atom);
+			this->addDeadStripRoot(&atom);
 		else if ( atom.dontDeadStripIfReferencesLive() )
 			_dontDeadStripIfReferencesLive.push_back(&atom);
 			
@@ -816,7 +816,7 @@ void Resolver::doAtom(const ld::Atom& atom)
 			// in dylibs, every global atom in initial .o files is a root
 			if ( _options.hasWildCardExportRestrictList() || _options.allGlobalsAreDeadStripRoots() ) {
 				if ( _options.shouldExport(atom.name()) )
-					_deadStripRoots.insert(&atom);
+					this->addDeadStripRoot(&atom);
 			}
 		}
 	}
@@ -1011,128 +1011,159 @@ void Resolver::resolveUndefines()
 }
 
 
-void Resolver::markLive(const ld::Atom& atom, WhyLiveBackChain* previous)
+void Resolver::printWhyLive(const ld::Atom& target, const std::vector<MarkLiveFrame>& stack, const ld::Atom& root)
 {
-	//fprintf(stderr, "markLive(%p) %s\n", &atom, atom.name());
 	// if -why_live cares about this symbol, then dump chain
-	if ( (previous->referer != NULL) && _options.printWhyLive(atom.name()) ) {
-		fprintf(stderr, "%s from %s\n", atom.name(), atom.safeFilePath());
-		int depth = 1;
-		for(WhyLiveBackChain* p = previous; p != NULL; p = p->previous, ++depth) {
-			for(int i=depth; i > 0; --i)
-				fprintf(stderr, "  ");
-			fprintf(stderr, "%s from %s\n", p->referer->name(), p->referer->safeFilePath());
-		}
-	}
-	
-	// if already marked live, then done (stop recursion)
-	if ( atom.live() )
+	if ( !_options.printWhyLive(target.name()) )
 		return;
-		
-	// mark this atom is live
-	(const_cast<ld::Atom*>(&atom))->setLive();
-	
-	// mark all atoms it references as live
-	WhyLiveBackChain thisChain;
-	thisChain.previous = previous;
-	thisChain.referer = &atom;
-	for (ld::Fixup::iterator fit = atom.fixupsBegin(), end=atom.fixupsEnd(); fit != end; ++fit) {
-		const ld::Atom* target;
-		switch ( fit->kind ) {
-			case ld::Fixup::kindNone:
-			case ld::Fixup::kindNoneFollowOn:
-			case ld::Fixup::kindNoneGroupSubordinate:
-			case ld::Fixup::kindNoneGroupSubordinateFDE:
-			case ld::Fixup::kindNoneGroupSubordinateLSDA:
-			case ld::Fixup::kindNoneGroupSubordinatePersonality:
-			case ld::Fixup::kindSetTargetAddress:
-			case ld::Fixup::kindSubtractTargetAddress:
-			case ld::Fixup::kindStoreTargetAddressLittleEndian32:
-			case ld::Fixup::kindStoreTargetAddressLittleEndian64:
+	fprintf(stderr, "%s from %s\n", target.name(), target.safeFilePath());
+	int depth = 1;
+	auto printReferer = [&](const ld::Atom* referer) {
+		for(int i=depth; i > 0; --i)
+			fprintf(stderr, "  ");
+		fprintf(stderr, "%s from %s\n", referer->name(), referer->safeFilePath());
+		++depth;
+	};
+	for (auto it=stack.rbegin(); it != stack.rend(); ++it)
+		printReferer(it->atom);
+	printReferer(&root);
+}
+
+// Returns the atom a live atom's fixup references, binding it and searching libraries if needed.
+// Returns NULL if the fixup references nothing, or its target is still undefined.
+const ld::Atom* Resolver::liveTarget(const ld::Atom& atom, ld::Fixup* fit)
+{
+	const ld::Atom* target = NULL;
+	switch ( fit->kind ) {
+		case ld::Fixup::kindNone:
+		case ld::Fixup::kindNoneFollowOn:
+		case ld::Fixup::kindNoneGroupSubordinate:
+		case ld::Fixup::kindNoneGroupSubordinateFDE:
+		case ld::Fixup::kindNoneGroupSubordinateLSDA:
+		case ld::Fixup::kindNoneGroupSubordinatePersonality:
+		case ld::Fixup::kindSetTargetAddress:
+		case ld::Fixup::kindSubtractTargetAddress:
+		case ld::Fixup::kindStoreTargetAddressLittleEndian32:
+		case ld::Fixup::kindStoreTargetAddressLittleEndian64:
 #if SUPPORT_ARCH_arm64e
-			case ld::Fixup::kindStoreTargetAddressLittleEndianAuth64:
+		case ld::Fixup::kindStoreTargetAddressLittleEndianAuth64:
 #endif
-			case ld::Fixup::kindStoreTargetAddressBigEndian32:
-			case ld::Fixup::kindStoreTargetAddressBigEndian64:
-			case ld::Fixup::kindStoreTargetAddressX86PCRel32:
-			case ld::Fixup::kindStoreTargetAddressX86BranchPCRel32:
-			case ld::Fixup::kindStoreTargetAddressX86PCRel32GOTLoad:
-			case ld::Fixup::kindStoreTargetAddressX86PCRel32GOTLoadNowLEA:
-			case ld::Fixup::kindStoreTargetAddressX86PCRel32TLVLoad:
-			case ld::Fixup::kindStoreTargetAddressX86PCRel32TLVLoadNowLEA:
-			case ld::Fixup::kindStoreTargetAddressX86Abs32TLVLoad:
-			case ld::Fixup::kindStoreTargetAddressX86Abs32TLVLoadNowLEA:
-			case ld::Fixup::kindStoreTargetAddressARMBranch24:
-			case ld::Fixup::kindStoreTargetAddressThumbBranch22:
+		case ld::Fixup::kindStoreTargetAddressBigEndian32:
+		case ld::Fixup::kindStoreTargetAddressBigEndian64:
+		case ld::Fixup::kindStoreTargetAddressX86PCRel32:
+		case ld::Fixup::kindStoreTargetAddressX86BranchPCRel32:
+		case ld::Fixup::kindStoreTargetAddressX86PCRel32GOTLoad:
+		case ld::Fixup::kindStoreTargetAddressX86PCRel32GOTLoadNowLEA:
+		case ld::Fixup::kindStoreTargetAddressX86PCRel32TLVLoad:
+		case ld::Fixup::kindStoreTargetAddressX86PCRel32TLVLoadNowLEA:
+		case ld::Fixup::kindStoreTargetAddressX86Abs32TLVLoad:
+		case ld::Fixup::kindStoreTargetAddressX86Abs32TLVLoadNowLEA:
+		case ld::Fixup::kindStoreTargetAddressARMBranch24:
+		case ld::Fixup::kindStoreTargetAddressThumbBranch22:
 #if SUPPORT_ARCH_arm64
-			case ld::Fixup::kindStoreTargetAddressARM64Branch26:
-			case ld::Fixup::kindStoreTargetAddressARM64Page21:
-			case ld::Fixup::kindStoreTargetAddressARM64GOTLoadPage21:
-			case ld::Fixup::kindStoreTargetAddressARM64GOTLeaPage21:
-			case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadPage21:
-			case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadNowLeaPage21:
+		case ld::Fixup::kindStoreTargetAddressARM64Branch26:
+		case ld::Fixup::kindStoreTargetAddressARM64Page21:
+		case ld::Fixup::kindStoreTargetAddressARM64GOTLoadPage21:
+		case ld::Fixup::kindStoreTargetAddressARM64GOTLeaPage21:
+		case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadPage21:
+		case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadNowLeaPage21:
 #endif
-				if ( fit->binding == ld::Fixup::bindingByContentBound ) {
-					// normally this was done in convertReferencesToIndirect()
-					// but a archive loaded .o file may have a forward reference
-					SymbolTable::IndirectBindingSlot slot;
-					const ld::Atom* dummy;
-					switch ( fit->u.target->combine() ) {
-						case ld::Atom::combineNever:
-						case ld::Atom::combineByName:
-							assert(0 && "wrong combine type for bind by content");
-							break;
-						case ld::Atom::combineByNameAndContent:
-							slot = _symbolTable.findSlotForContent(fit->u.target, &dummy);
-							fit->binding = ld::Fixup::bindingsIndirectlyBound;
-							fit->u.bindingIndex = slot;
-							break;
-						case ld::Atom::combineByNameAndReferences:
-							slot = _symbolTable.findSlotForReferences(fit->u.target, &dummy);
-							fit->binding = ld::Fixup::bindingsIndirectlyBound;
-							fit->u.bindingIndex = slot;
-							break;
-					}
-				}
-				switch ( fit->binding ) {
-					case ld::Fixup::bindingDirectlyBound:
-						markLive(*(fit->u.target), &thisChain);
+			if ( fit->binding == ld::Fixup::bindingByContentBound ) {
+				// normally this was done in convertReferencesToIndirect()
+				// but a archive loaded .o file may have a forward reference
+				SymbolTable::IndirectBindingSlot slot;
+				const ld::Atom* dummy;
+				switch ( fit->u.target->combine() ) {
+					case ld::Atom::combineNever:
+					case ld::Atom::combineByName:
+						assert(0 && "wrong combine type for bind by content");
 						break;
-					case ld::Fixup::bindingByNameUnbound:
-						// doAtom() did not convert to indirect in dead-strip mode, so that now
-						fit->u.bindingIndex = _symbolTable.findSlotForName(fit->u.name);
+					case ld::Atom::combineByNameAndContent:
+						slot = _symbolTable.findSlotForContent(fit->u.target, &dummy);
 						fit->binding = ld::Fixup::bindingsIndirectlyBound;
-						// fall into next case
-					case ld::Fixup::bindingsIndirectlyBound:
+						fit->u.bindingIndex = slot;
+						break;
+					case ld::Atom::combineByNameAndReferences:
+						slot = _symbolTable.findSlotForReferences(fit->u.target, &dummy);
+						fit->binding = ld::Fixup::bindingsIndirectlyBound;
+						fit->u.bindingIndex = slot;
+						break;
+				}
+			}
+			switch ( fit->binding ) {
+				case ld::Fixup::bindingDirectlyBound:
+					target = fit->u.target;
+					break;
+				case ld::Fixup::bindingByNameUnbound:
+					// doAtom() did not convert to indirect in dead-strip mode, so that now
+					fit->u.bindingIndex = _symbolTable.findSlotForName(fit->u.name);
+					fit->binding = ld::Fixup::bindingsIndirectlyBound;
+					// fall into next case
+				case ld::Fixup::bindingsIndirectlyBound:
+					target = _internal.indirectBindingTable[fit->u.bindingIndex];
+					if ( target == NULL ) {
+						const char* targetName = _symbolTable.indirectName(fit->u.bindingIndex);
+						_inputFiles.searchLibraries(targetName, true, true, false, *this);
 						target = _internal.indirectBindingTable[fit->u.bindingIndex];
-						if ( target == NULL ) {
-							const char* targetName = _symbolTable.indirectName(fit->u.bindingIndex);
-							_inputFiles.searchLibraries(targetName, true, true, false, *this);
+					}
+					if ( target != NULL ) {
+						if ( target->definition() == ld::Atom::definitionTentative ) {
+							// <rdar://problem/5894163> need to search archives for overrides of common symbols 
+							bool searchDylibs = (_options.commonsMode() == Options::kCommonsOverriddenByDylibs);
+							_inputFiles.searchLibraries(target->name(), searchDylibs, true, true, *this);
+							// recompute target since it may have been overridden by searchLibraries()
 							target = _internal.indirectBindingTable[fit->u.bindingIndex];
 						}
-						if ( target != NULL ) {
-							if ( target->definition() == ld::Atom::definitionTentative ) {
-								// <rdar://problem/5894163> need to search archives for overrides of common symbols 
-								bool searchDylibs = (_options.commonsMode() == Options::kCommonsOverriddenByDylibs);
-								_inputFiles.searchLibraries(target->name(), searchDylibs, true, true, *this);
-								// recompute target since it may have been overridden by searchLibraries()
-								target = _internal.indirectBindingTable[fit->u.bindingIndex];
-							}
-							this->markLive(*target, &thisChain);
-						}
-						else {
-							_atomsWithUnresolvedReferences.push_back(&atom);
-						}
-						break;
-					default:
-						assert(0 && "bad binding during dead stripping");
-				}
-				break;
-            default:
-                break;    
+					}
+					else {
+						_atomsWithUnresolvedReferences.push_back(&atom);
+					}
+					break;
+				default:
+					assert(0 && "bad binding during dead stripping");
+			}
+			break;
+		default:
+			break;
+	}
+	return target;
+}
+
+// Marks root and everything it references as live.  References are followed depth first, in the same
+// order as recursing on each one would, so libraries are searched in the same order.  The stack of atoms
+// being followed is kept in a vector instead of on the call stack, and is also the -why_live chain.
+void Resolver::markLive(const ld::Atom& root)
+{
+	//fprintf(stderr, "markLive(%p) %s\n", &root, root.name());
+	const bool whyLive = _options.hasWhyLive();
+	std::vector<MarkLiveFrame> stack;
+	auto visit = [&](const ld::Atom& atom) {
+		if ( whyLive )
+			this->printWhyLive(atom, stack, root);
+		// if already marked live, then done
+		if ( atom.live() )
+			return;
+		(const_cast<ld::Atom*>(&atom))->setLive();
+		stack.push_back({ &atom, atom.fixupsBegin() });
+	};
+	visit(root);
+	while ( !stack.empty() ) {
+		MarkLiveFrame& frame = stack.back();
+		if ( frame.nextFixup == frame.atom->fixupsEnd() ) {
+			stack.pop_back();
+			continue;
 		}
+		ld::Fixup* fit = frame.nextFixup++;
+		const ld::Atom* target = this->liveTarget(*frame.atom, fit);
+		if ( target != NULL )
+			visit(*target);
 	}
+}
 
+void Resolver::addDeadStripRoot(const ld::Atom* atom)
+{
+	if ( _deadStripRootSet.insert(atom).second )
+		_deadStripRoots.push_back(atom);
 }
 
 class NotLiveLTO {
@@ -1160,7 +1191,7 @@ void Resolver::deadStripOptimize(bool force)
 	// add entry point (main) to live roots
 	const ld::Atom* entry = this->entryPoint(true);
 	if ( entry != NULL )
-		_deadStripRoots.insert(entry);
+		this->addDeadStripRoot(entry);
 		
 	// add -exported_symbols_list, -init, and -u entries to live roots
 	for (Options::UndefinesIterator uit=_options.initialUndefinesBegin(); uit != _options.initialUndefinesEnd(); ++uit) {
@@ -1169,50 +1200,48 @@ void Resolver::deadStripOptimize(bool force)
 			_inputFiles.searchLibraries(*uit, false, true, false, *this);
 		}
 		if ( _internal.indirectBindingTable[slot] != NULL )
-			_deadStripRoots.insert(_internal.indirectBindingTable[slot]);
+			this->addDeadStripRoot(_internal.indirectBindingTable[slot]);
 	}
 	
 	// this helper is only referenced by synthesize stubs, assume it will be used
 	if ( _internal.classicBindingHelper != NULL ) 
-		_deadStripRoots.insert(_internal.classicBindingHelper);
+		this->addDeadStripRoot(_internal.classicBindingHelper);
 
 	// this helper is only referenced by synthesize stubs, assume it will be used
 	if ( _internal.compressedFastBinderProxy != NULL ) 
-		_deadStripRoots.insert(_internal.compressedFastBinderProxy);
+		this->addDeadStripRoot(_internal.compressedFastBinderProxy);
 
 	// this helper is only referenced by synthesized lazy stubs, assume it will be used
 	if ( _internal.lazyBindingHelper != NULL )
-		_deadStripRoots.insert(_internal.lazyBindingHelper);
+		this->addDeadStripRoot(_internal.lazyBindingHelper);
 
 	// add all dont-dead-strip atoms as roots
 	for (std::vector<const ld::Atom*>::const_iterator it=_atoms.begin(); it != _atoms.end(); ++it) {
 		const ld::Atom* atom = *it;
 		if ( atom->dontDeadStrip() ) {
 			//fprintf(stderr, "dont dead strip: %p %s %s\n", atom, atom->section().sectionName(), atom->name());
-			_deadStripRoots.insert(atom);
-			// unset liveness, so markLive() will recurse
+			this->addDeadStripRoot(atom);
+			// unset liveness, so markLive() will follow its references
 			(const_cast<ld::Atom*>(atom))->setLive(0);
 		}
 		// <rdar://problem/49468634> if doing LTO, mark all libclang_rt* mach-o atoms as live since the backend may suddenly codegen uses of them
 		else if ( _haveLLVMObjs && !force && (atom->contentType() !=  ld::Atom::typeLTOtemporary) ) {
 			if ( isCompilerSupportLib(atom->safeFilePath()) ) {
-				_deadStripRoots.insert(atom);
+				this->addDeadStripRoot(atom);
 			}
 		}
 	}
 
 	// mark all roots as live, and all atoms they reference
-	for (std::set<const ld::Atom*>::iterator it=_deadStripRoots.begin(); it != _deadStripRoots.end(); ++it) {
-		const ld::Atom* anAtom = *it;
-		WhyLiveBackChain rootChain;
-		rootChain.previous = NULL;
-		rootChain.referer = anAtom;
+	// (libraries searched while marking can add more roots, so keep going until there are no new ones)
+	for (size_t rootIndex=0; rootIndex < _deadStripRoots.size(); ++rootIndex) {
+		const ld::Atom* anAtom = _deadStripRoots[rootIndex];
 		if ( force && (anAtom->contentType() == ld::Atom::typeLTOtemporary) && (strcmp((anAtom)->name(), "import-atom") == 0) ) {
 			// <rdar://problem/57667716> LTO code-gen is done, doing second dead strip pass.  Don't use import-atom any more
 		}
 		else {
 			//fprintf(stderr, "dont-dead-strip: %p %s\n", anAtom, (anAtom)->name());
-			this->markLive(*anAtom, &rootChain);
+			this->markLive(*anAtom);
 		}
 	}
 	
@@ -1240,10 +1269,7 @@ void Resolver::deadStripOptimize(bool force)
 					hasLiveRef = true;
 			}
 			if ( hasLiveRef ) {
-				WhyLiveBackChain rootChain;
-				rootChain.previous = NULL;
-				rootChain.referer = liveIfRefLiveAtom;
-				this->markLive(*liveIfRefLiveAtom, &rootChain);
+				this->markLive(*liveIfRefLiveAtom);
 			}
 		}
 	}
@@ -1691,9 +1717,7 @@ void Resolver::fillInHelpersInInternalState()
 void Resolver::fillInInternalState()
 {
 	// store atoms into their final section
-	for (std::vector<const ld::Atom*>::iterator it = _atoms.begin(); it != _atoms.end(); ++it) {
-		_internal.addAtom(**it);
-	}
+	_internal.addAtoms(_atoms);
 	
 	// <rdar://problem/7783918> make sure there is a __text section so that codesigning works
 	if ( (_options.outputKind() == Options::kDynamicLibrary) || (_options.outputKind() == Options::kDynamicBundle) )
@@ -74,10 +74,11 @@ public:
 
 
 private:
-	struct WhyLiveBackChain
+	// an atom markLive() is following the references of, and its next fixup to follow
+	struct MarkLiveFrame
 	{
-		WhyLiveBackChain*	previous;
-		const ld::Atom*		referer;
+		const ld::Atom*		atom;
+		ld::Fixup*			nextFixup;
 	};
 
 	void					initializeState();
@@ -96,7 +97,10 @@ private:
 	void					linkTimeOptimize();
 	void					convertReferencesToIndirect(const ld::Atom& atom);
 	const ld::Atom*			entryPoint(bool searchArchives);
-	void					markLive(const ld::Atom& atom, WhyLiveBackChain* previous);
+	void					markLive(const ld::Atom& root);
+	const ld::Atom*			liveTarget(const ld::Atom& atom, ld::Fixup* fit);
+	void					printWhyLive(const ld::Atom& target, const std::vector<MarkLiveFrame>& stack, const ld::Atom& root);
+	void					addDeadStripRoot(const ld::Atom* atom);
 	bool					isDtraceProbe(ld::Fixup::Kind kind);
 	void					liveUndefines(std::vector<const char*>&);
 	void					remainingUndefines(std::vector<const char*>&);
@@ -127,7 +131,8 @@ private:
 	InputFiles&						_inputFiles;
 	ld::Internal&					_internal;
 	std::vector<const ld::Atom*>	_atoms;
-	std::set<const ld::Atom*>		_deadStripRoots;
+	std::vector<const ld::Atom*>	_deadStripRoots;
+	std::unordered_set<const ld::Atom*>	_deadStripRootSet;		// to keep _deadStripRoots free of duplicates
 	std::vector<const ld::Atom*>	_dontDeadStripIfReferencesLive;
 	std::vector<const ld::Atom*>	_atomsWithUnresolvedReferences;
 	std::vector<const class AliasAtom*>	_aliasesFromCmdLine;
@@ -14,12 +14,26 @@
 #include <fcntl.h>
 #include <ctype.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <libgen.h>
 #include <time.h>
+#include <pthread.h>
 #include <Block.h>
+#if __APPLE__
+#include <sys/clonefile.h>
+#include <copyfile.h>
+#endif
+#if __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+#include <CommonCrypto/CommonDigest.h>
+
+#include <algorithm>
 
 #include "Snapshot.h"
 #include "Options.h"
+#include "Parallel.h"
 
 #include "compile_stubs.h"
 
@@ -42,17 +56,33 @@ static const char *compileFileString        = "compile_stubs";      // text file
 
 Snapshot *Snapshot::globalSnapshot = NULL;
 
-Snapshot::Snapshot(const Options * opts) : fOptions(opts), fRecordArgs(false), fRecordObjects(false), fRecordDylibSymbols(false), fRecordArchiveFiles(false), fRecordUmbrellaFiles(false), fRecordDataFiles(false), fFrameworkArgAdded(false), fRecordKext(false), fSnapshotLocation(NULL), fSnapshotName(NULL), fRootDir(NULL), fFilelistFile(-1), fCopiedArchives(NULL)
+Snapshot::Snapshot(const Options * opts) : fOptions(opts), fRecordArgs(false), fRecordObjects(false), fRecordDylibSymbols(false), fRecordArchiveFiles(false), fRecordUmbrellaFiles(false), fRecordDataFiles(false), fFrameworkArgAdded(false), fRecordKext(false), fSnapshotLocation(NULL), fSnapshotName(NULL), fRootDir(NULL), fFilelistFile(-1), fCopiesPending(0), fIdleCopyThreads(0), fCopyThreadsExit(false)
 {
     if (globalSnapshot != NULL)
         throw "only one snapshot supported";
     globalSnapshot = this;
+    pthread_mutex_init(&fCopyLock, NULL);
+    pthread_cond_init(&fCopyQueued, NULL);
+    pthread_cond_init(&fCopyDone, NULL);
 }
 
 
 Snapshot::~Snapshot() 
 {
     // Lots of things leak under the assumption the linker is about to exit.
+    // But the copy threads use this object, so they must be done before it goes away.
+    flush();
+    pthread_mutex_lock(&fCopyLock);
+    fCopyThreadsExit = true;
+    pthread_cond_broadcast(&fCopyQueued);
+    pthread_mutex_unlock(&fCopyLock);
+    for (pthread_t thread : fCopyThreads)
+        pthread_join(thread, NULL);
+    pthread_cond_destroy(&fCopyDone);
+    pthread_cond_destroy(&fCopyQueued);
+    pthread_mutex_destroy(&fCopyLock);
+    if (globalSnapshot == this)
+        globalSnapshot = NULL;
 }
 
 
@@ -185,8 +215,6 @@ const char * Snapshot::subdir(const char *subdir)
 // where the file was copied
 void Snapshot::copyFileToSnapshot(const char *sourcePath, const char *subdir, char *path) 
 {
-    const int copyBufSize=(1<<14); // 16kb buffer
-    static void *copyBuf = NULL;
     bool inSdk;
 
     if (fRecordKext) {
@@ -204,30 +232,245 @@ void Snapshot::copyFileToSnapshot(const char *sourcePath, const char *subdir, ch
         }
     }
 
-    if (copyBuf == NULL)
-        copyBuf = malloc(copyBufSize);
-    
     char *file=basename((char *)sourcePath);
     char buf[PATH_MAX];
     if (path == NULL) path = buf;
     buildUniquePath(path, subdir, file);
     mode_t mode = fRecordKext ? (S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH) : (S_IRUSR|S_IWUSR);
+    // create the file now, so the next file with the same name gets a different one
     int out_fd = open(path, O_WRONLY|O_CREAT|O_TRUNC, mode);
-    int in_fd = open(sourcePath, O_RDONLY);
-    int len;
-    if (out_fd != -1 && in_fd != -1) {
-        do {
-            len = read(in_fd, copyBuf, copyBufSize);
-            if (len > 0) write(out_fd, copyBuf, len);
-        } while (len == copyBufSize);
+    if (out_fd != -1) {
+        close(out_fd);
+        queueCopy(sourcePath, path, mode);
     }
-    close(in_fd);
-    close(out_fd);
 
     const char * relPath = snapshotRelativePath(path);
     memmove(path, relPath, 1+strlen(relPath));
 }
 
+
+// Hand a file to the copy threads, starting another one if they are all busy.
+void Snapshot::queueCopy(const char *sourcePath, const char *snapshotPath, mode_t mode)
+{
+    // copying is mostly waiting on the file system, a few threads keep it busy
+    const unsigned maxCopyThreads = std::min(ld::parallel::workerCount(), 8U);
+    pthread_mutex_lock(&fCopyLock);
+    fCopyQueue.push_back({ strdup(sourcePath), strdup(snapshotPath), mode });
+    ++fCopiesPending;
+    if ((fIdleCopyThreads == 0) && (fCopyThreads.size() < maxCopyThreads)) {
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if (pthread_create(&thread, &attr, &Snapshot::copyThreadMain, this) == 0)
+            fCopyThreads.push_back(thread);
+        pthread_attr_destroy(&attr);
+    }
+    pthread_cond_signal(&fCopyQueued);
+    pthread_mutex_unlock(&fCopyLock);
+    // no thread could be started, copy it now
+    if (fCopyThreads.empty())
+        flush();
+}
+
+void *Snapshot::copyThreadMain(void *snapshot)
+{
+    ((Snapshot *)snapshot)->copyThread();
+    return NULL;
+}
+
+void Snapshot::copyThread()
+{
+    pthread_mutex_lock(&fCopyLock);
+    for (;;) {
+        while (fCopyQueue.empty() && !fCopyThreadsExit) {
+            ++fIdleCopyThreads;
+            pthread_cond_wait(&fCopyQueued, &fCopyLock);
+            --fIdleCopyThreads;
+        }
+        if (fCopyQueue.empty())
+            break;
+        CopyRequest request = fCopyQueue.front();
+        fCopyQueue.pop_front();
+        pthread_mutex_unlock(&fCopyLock);
+        copyFile(request);
+        pthread_mutex_lock(&fCopyLock);
+        if (--fCopiesPending == 0)
+            pthread_cond_broadcast(&fCopyDone);
+    }
+    pthread_mutex_unlock(&fCopyLock);
+}
+
+// Replace the (empty) file at snapshotPath with a hard link to a copy already in the snapshot.
+bool Snapshot::linkToCopy(const char *existingPath, const char *snapshotPath)
+{
+    // link under a temporary name and rename over the reserved file, so its name is never free for
+    // buildUniquePath() to hand out again
+    char tempPath[PATH_MAX];
+    snprintf(tempPath, sizeof(tempPath), "%s.link", snapshotPath);
+    if (link(existingPath, tempPath) != 0)
+        return false;
+    if (rename(tempPath, snapshotPath) != 0) {
+        unlink(tempPath);
+        return false;
+    }
+    return true;
+}
+
+// Fill in a reserved file in the snapshot, on a copy thread.  The same input recorded twice,
+// or inputs with identical content, become hard links to one copy.  Otherwise file systems that
+// can share extents (APFS, btrfs, XFS) clone the file, and others copy it in the kernel.
+// A copy is only offered to later duplicates once it is complete: a clone replaces the reserved
+// file's inode, so a link made to it earlier would be left pointing at the empty original.
+void Snapshot::copyFile(const CopyRequest &request)
+{
+    int in_fd = open(request.sourcePath, O_RDONLY);
+    if (in_fd == -1)
+        return;
+    struct stat st;
+    if (fstat(in_fd, &st) != 0) {
+        close(in_fd);
+        return;
+    }
+
+    const FileID fileID(st.st_dev, st.st_ino);
+    const char *existing = NULL;
+    pthread_mutex_lock(&fCopyLock);
+    auto idPos = fCopiedFiles.find(fileID);
+    if (idPos != fCopiedFiles.end())
+        existing = idPos->second;
+    pthread_mutex_unlock(&fCopyLock);
+    if ((existing != NULL) && linkToCopy(existing, request.snapshotPath)) {
+        close(in_fd);
+        return;
+    }
+
+    std::string contentKey;
+    auto publishCopy = [&]() {
+        // the first completed copy wins, later ones just stay as separate files
+        pthread_mutex_lock(&fCopyLock);
+        fCopiedFiles.insert(std::make_pair(fileID, request.snapshotPath));
+        if (!contentKey.empty())
+            fCopiedContent.insert(std::make_pair(contentKey, request.snapshotPath));
+        pthread_mutex_unlock(&fCopyLock);
+    };
+
+#if __APPLE__
+    {
+        char tempPath[PATH_MAX];
+        snprintf(tempPath, sizeof(tempPath), "%s.clone", request.snapshotPath);
+        if (fclonefileat(in_fd, AT_FDCWD, tempPath, 0) == 0) {
+            chmod(tempPath, request.mode);
+            if (rename(tempPath, request.snapshotPath) == 0) {
+                publishCopy();
+                close(in_fd);
+                return;
+            }
+            unlink(tempPath);
+        }
+    }
+#endif
+
+    int out_fd = open(request.snapshotPath, O_WRONLY|O_TRUNC);
+    if (out_fd == -1) {
+        close(in_fd);
+        return;
+    }
+#if __linux__
+    if (ioctl(out_fd, FICLONE, in_fd) == 0) {
+        close(out_fd);
+        publishCopy();
+        close(in_fd);
+        return;
+    }
+#endif
+
+    // no extents to share, so don't store the same content twice
+    const uint8_t *content = NULL;
+    if (st.st_size > 0) {
+        content = (const uint8_t *)mmap(NULL, st.st_size, PROT_READ, MAP_FILE|MAP_PRIVATE, in_fd, 0);
+        if (content == (const uint8_t *)MAP_FAILED)
+            content = NULL;
+    }
+    if (content != NULL) {
+        uint8_t digest[CC_SHA256_DIGEST_LENGTH];
+        CC_SHA256(content, (CC_LONG)st.st_size, digest);
+        contentKey.assign((const char *)digest, sizeof(digest));
+        contentKey.append((const char *)&st.st_size, sizeof(st.st_size));
+        existing = NULL;
+        pthread_mutex_lock(&fCopyLock);
+        auto contentPos = fCopiedContent.find(contentKey);
+        if (contentPos != fCopiedContent.end())
+            existing = contentPos->second;
+        pthread_mutex_unlock(&fCopyLock);
+        if ((existing != NULL) && linkToCopy(existing, request.snapshotPath)) {
+            munmap((void *)content, st.st_size);
+            close(out_fd);
+            close(in_fd);
+            return;
+        }
+    }
+
+    bool copied = false;
+#if __linux__
+    loff_t inPos = 0;
+    loff_t outPos = 0;
+    off_t remaining = st.st_size;
+    while (remaining > 0) {
+        ssize_t amount = copy_file_range(in_fd, &inPos, out_fd, &outPos, remaining, 0);
+        if (amount <= 0)
+            break;
+        remaining -= amount;
+    }
+    copied = (remaining == 0);
+    if (!copied)
+        ftruncate(out_fd, 0);
+#elif __APPLE__
+    copied = (fcopyfile(in_fd, out_fd, NULL, COPYFILE_DATA) == 0);
+#endif
+    if (!copied && (content != NULL)) {
+        lseek(out_fd, 0, SEEK_SET);
+        off_t offset = 0;
+        while (offset < st.st_size) {
+            ssize_t amount = write(out_fd, &content[offset], st.st_size - offset);
+            if (amount <= 0)
+                break;
+            offset += amount;
+        }
+        copied = (offset == st.st_size);
+    }
+    if (content != NULL)
+        munmap((void *)content, st.st_size);
+    close(out_fd);
+    if (copied)
+        publishCopy();
+    close(in_fd);
+}
+
+
+// Wait for the copy threads to empty the queue, and write out buffered dylib symbols.
+void Snapshot::flush()
+{
+    pthread_mutex_lock(&fCopyLock);
+    if (fCopyThreads.empty()) {
+        // no copy thread could be started, so copy on this one
+        while (!fCopyQueue.empty()) {
+            CopyRequest request = fCopyQueue.front();
+            fCopyQueue.pop_front();
+            pthread_mutex_unlock(&fCopyLock);
+            copyFile(request);
+            pthread_mutex_lock(&fCopyLock);
+            --fCopiesPending;
+        }
+    }
+    while (fCopiesPending != 0)
+        pthread_cond_wait(&fCopyDone, &fCopyLock);
+    pthread_mutex_unlock(&fCopyLock);
+
+    for (auto& entry : fDylibSymbols)
+        fflush(entry.second);
+}
+
+
 // Create the snapshot root directory.
 void Snapshot::createSnapshot()
 {
@@ -511,15 +754,19 @@ void Snapshot::recordDylibSymbol(ld::dylib::File* dylibFile, const char *name)
 
             it = fDylibSymbols.find(dylibPath);
             bool isFramework = (strstr(dylibPath, "framework") != NULL);
-            int dylibFd;
+            FILE *dylibStream;
             if (it == fDylibSymbols.end()) {
-                // Didn't find a file descriptor for this dylib. Create one and add it to the dylib map.
+                // Didn't find a stream for this dylib. Create one and add it to the dylib map.
+                // Symbols are buffered, flush() writes out what is left.
                 char path_buf[PATH_MAX];
                 buildUniquePath(path_buf, subdir(isFramework ? frameworkStubsString : dylibStubsString), dylibPath);
 
                 mode_t mode = fRecordKext ? (S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH) : (S_IRUSR|S_IWUSR);
-                dylibFd = open(path_buf, O_WRONLY|O_APPEND|O_CREAT, mode);
-                fDylibSymbols.insert(std::pair<const char *, int>(dylibPath, dylibFd));
+                int dylibFd = open(path_buf, O_WRONLY|O_APPEND|O_CREAT, mode);
+                dylibStream = (dylibFd != -1) ? fdopen(dylibFd, "a") : NULL;
+                if (dylibStream == NULL)
+                    dylibStream = fopen("/dev/null", "w");
+                fDylibSymbols.insert(std::pair<const char *, FILE *>(dylibPath, dylibStream));
                 char *base_name = strdup(basename(path_buf));
                 if (isFramework) {
                     addFrameworkArg(base_name);
@@ -528,7 +775,7 @@ void Snapshot::recordDylibSymbol(ld::dylib::File* dylibFile, const char *name)
                 }
                 writeCommandLine();
             } else {
-                dylibFd = it->second;
+                dylibStream = it->second;
             }
             // Record the symbol.
             
@@ -540,17 +787,15 @@ void Snapshot::recordDylibSymbol(ld::dylib::File* dylibFile, const char *name)
             const char *weakAttr = "__attribute__ ((weak)) ";
             const char *suffix = "(void){}\n";
             if (isIdentifier) {
-                write(dylibFd, prefix, strlen(prefix));
+                fputs(prefix, dylibStream);
                 if (dylibFile->hasWeakExternals() && dylibFile->hasWeakDefinition(name))
-                    write(dylibFd, weakAttr, strlen(weakAttr));
+                    fputs(weakAttr, dylibStream);
                 if (*name == '_') name++;
-                write(dylibFd, name, strlen(name));
-                write(dylibFd, suffix, strlen(suffix));
+                fputs(name, dylibStream);
+                fputs(suffix, dylibStream);
             } else {
                 static int symbolCounter = 0;
-                char buf[64+strlen(name)];
-                sprintf(buf, "void s_%5.5d(void) __asm(\"%s\");\nvoid s_%5.5d(){}\n", symbolCounter, name, symbolCounter);
-                write(dylibFd, buf, strlen(buf));
+                fprintf(dylibStream, "void s_%5.5d(void) __asm(\"%s\");\nvoid s_%5.5d(){}\n", symbolCounter, name, symbolCounter);
                 symbolCounter++;
             }
         }                
@@ -559,41 +804,32 @@ void Snapshot::recordDylibSymbol(ld::dylib::File* dylibFile, const char *name)
 
 
 // Record a .a archive in the snapshot.
+// (Called for every symbol an archive provides, so repeats are dropped before anything is logged.)
 void Snapshot::recordArchive(const char *archiveFile)
 {
+    if (fCopiedArchives.count(archiveFile) != 0)
+        return;
+    const char *copy = strdup(archiveFile);
+    fCopiedArchives.insert(copy);
     if (fRootDir == NULL) {
-        const char *copy = strdup(archiveFile);
-        fLog.push_back(Block_copy(^{ this->recordArchive(archiveFile); ::free((void *)copy); }));
+        fLog.push_back(Block_copy(^{ this->copyArchive(copy); }));
     } else {
-        if (fRecordArchiveFiles) {
-
-            // lazily create a vector of .a files that have been added
-            if (fCopiedArchives == NULL) {
-                fCopiedArchives = new StringVector;
-            }
-            
-            // See if we have already added this .a
-            StringVector::iterator it;
-            bool found = false;
-            for (it = fCopiedArchives->begin(); it != fCopiedArchives->end() && !found; it++) {
-                if (strcmp(archiveFile, *it) == 0)
-                    found = true;
-            }
-            
-            // If this is a new .a then copy it to the snapshot and add it to the snapshot link command.
-            if (!found) {
-                char path[PATH_MAX];
-                fCopiedArchives->push_back(archiveFile);
+        copyArchive(copy);
+    }
+}
 
-                if (fRecordKext) {
-                    recordObjectFile(archiveFile);
-                } else {
-                    copyFileToSnapshot(archiveFile, subdir(archiveFilesString), path);
-                    fArgIndicies.push_back(fArgs.size());
-                    fArgs.push_back(strdup(path));
-                    writeCommandLine();
-                }
-            }
+// Copy a .a file to the snapshot and add it to the snapshot link command.
+void Snapshot::copyArchive(const char *archiveFile)
+{
+    if (fRecordArchiveFiles) {
+        char path[PATH_MAX];
+        if (fRecordKext) {
+            recordObjectFile(archiveFile);
+        } else {
+            copyFileToSnapshot(archiveFile, subdir(archiveFilesString), path);
+            fArgIndicies.push_back(fArgs.size());
+            fArgs.push_back(strdup(path));
+            writeCommandLine();
         }
     }
 }
@@ -9,8 +9,14 @@
 #ifndef ld64_Snapshot_h
 #define ld64_Snapshot_h
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <deque>
 #include <map>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "ld.hpp"
@@ -85,6 +91,10 @@ public:
     // Returns the snapshot root directory.
     const char *rootDir() { return fRootDir; }
 
+    // Waits for files still being copied into the snapshot, and writes out buffered dylib symbols.
+    // Must be called before exiting without running destructors (the destructor calls it).
+    void flush();
+
 private:
 
     friend class SnapshotArchiveFileLog;
@@ -95,9 +105,20 @@ private:
         bool operator() (const char *a, const char *b) const { return ::strcmp(a, b) < 0; }
     };
     typedef std::vector<const char *> StringVector;
-    typedef std::map<const char *, int, strcompclass > DylibMap;
+    typedef std::set<const char *, strcompclass> StringSet;
+    typedef std::map<const char *, FILE *, strcompclass > DylibMap;
     typedef std::map<const char *, const char *, strcompclass> PathMap;
     typedef std::vector<unsigned> IntVector;
+
+    // a file whose name in the snapshot is reserved, waiting for a copy thread to fill it in
+    struct CopyRequest {
+        const char *sourcePath;
+        const char *snapshotPath;
+        mode_t      mode;
+    };
+    typedef std::pair<uint64_t, uint64_t> FileID;               // st_dev, st_ino of an input file
+    typedef std::map<FileID, const char *> FileIDMap;           // input file -> its first copy in the snapshot
+    typedef std::map<std::string, const char *> ContentMap;     // size and SHA-256 of content -> first copy with it
     
     // Write the current contents of the args vector to a file in the snapshot.
     // If filename is NULL then "link_command" is used.
@@ -124,7 +145,18 @@ private:
     // Copies an arbitrary file to the snapshot. Subdir specifies an optional subdirectory name.
     // Uses buildUniquePath to construct a unique path. If the result path is needed by the caller
     // then a path buffer can be supplied in buf. Otherwise an internal buffer is used.
+    // The file is created right away, but its content is copied by a background thread.
     void copyFileToSnapshot(const char *sourcePath, const char *subdir, char *buf=NULL);
+
+    // Background copying used by copyFileToSnapshot()
+    void queueCopy(const char *sourcePath, const char *snapshotPath, mode_t mode);
+    static void *copyThreadMain(void *snapshot);
+    void copyThread();
+    void copyFile(const CopyRequest &request);
+    bool linkToCopy(const char *existingPath, const char *snapshotPath);
+    
+    // Copies the archive to the snapshot and adds it to the snapshot link command
+    void copyArchive(const char *archiveFile);
     
     // Convert a full path to snapshot relative by constructing an interior pointer at the right offset.
     const char *snapshotRelativePath(const char *path) { return path+strlen(fRootDir)+1; }
@@ -158,8 +190,19 @@ private:
     IntVector fArgIndicies;     // where args start in fArgs
     PathMap fPathMap;           // mapping of original paths->snapshot paths for copied files
     
-    DylibMap fDylibSymbols;    // map of dylib names to string vector containing referenced symbol names
-    StringVector *fCopiedArchives;  // vector of .a files that have been copied to the snapshot
+    DylibMap fDylibSymbols;    // map of dylib names to the stream their referenced symbol names are written to
+    StringSet fCopiedArchives;  // .a files that have been copied to the snapshot
+
+    pthread_mutex_t fCopyLock;              // guards everything below
+    pthread_cond_t fCopyQueued;             // signaled when a request is added to fCopyQueue, or threads should exit
+    pthread_cond_t fCopyDone;               // signaled when fCopiesPending drops to zero
+    std::deque<CopyRequest> fCopyQueue;
+    std::vector<pthread_t> fCopyThreads;
+    unsigned fCopiesPending;                // queued or being copied
+    unsigned fIdleCopyThreads;
+    bool fCopyThreadsExit;
+    FileIDMap fCopiedFiles;
+    ContentMap fCopiedContent;
 };
 
 #endif
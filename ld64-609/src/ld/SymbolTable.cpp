@@ -725,86 +725,71 @@ void SymbolTable::removeDeadAtoms()
 }
 
 
+// returns the table for coalescing strings in a non-standard cstring section
+SymbolTable::CStringToSlot* SymbolTable::nonStdCStringTable(const ld::Section& sect)
+{
+	// every input file has its own section objects, so look up each one by name only once
+	SectionToMap::iterator spos = _nonStdCStringSectionTables.find(&sect);
+	if ( spos != _nonStdCStringSectionTables.end() )
+		return spos->second;
+	// use seg/sect name is key to map to avoid coalescing across segments and sections
+	char segsect[64];
+	snprintf(segsect, sizeof(segsect), "%s/%s", sect.segmentName(), sect.sectionName());
+	CStringToSlot* map = NULL;
+	NameToMap::iterator mpos = _nonStdCStringSectionToMap.find(segsect);
+	if ( mpos == _nonStdCStringSectionToMap.end() ) {
+		map = new CStringToSlot();
+		_nonStdCStringSectionToMap[strdup(segsect)] = map;
+	}
+	else {
+		map = mpos->second;
+	}
+	_nonStdCStringSectionTables[&sect] = map;
+	return map;
+}
+
+// adds atom to table with the given slot, or changes slot to that of the atom with the same content
+template <typename T>
+static bool addContent(T& table, const ld::Atom* atom, SymbolTable::IndirectBindingSlot& slot)
+{
+	// a single probe, so the content is hashed once (parsers compute literal hashes ahead of time)
+	std::pair<typename T::iterator, bool> result = table.emplace(atom, slot);
+	slot = result.first->second;
+	return result.second;
+}
+
 // find existing or create new slot
 SymbolTable::IndirectBindingSlot SymbolTable::findSlotForContent(const ld::Atom* atom, const ld::Atom** existingAtom)
 {
 	//fprintf(stderr, "findSlotForContent(%p)\n", atom);
-	SymbolTable::IndirectBindingSlot slot = 0;
-	UTF16StringToSlot::iterator upos;
-	CStringToSlot::iterator cspos;
-	ContentToSlot::iterator pos;
+	SymbolTable::IndirectBindingSlot slot = _indirectBindingTable.size();
+	bool added = false;
 	switch ( atom->section().type() ) {
 		case ld::Section::typeCString:
-			cspos = _cstringTable.find(atom);
-			if ( cspos != _cstringTable.end() ) {
-				*existingAtom = _indirectBindingTable[cspos->second];
-				return cspos->second;
-			}
-			slot = _indirectBindingTable.size();
-			_cstringTable[atom] = slot;
+			added = addContent(_cstringTable, atom, slot);
 			break;
 		case ld::Section::typeNonStdCString:
-			{
-				// use seg/sect name is key to map to avoid coalescing across segments and sections
-				char segsect[64];
-				sprintf(segsect, "%s/%s", atom->section().segmentName(), atom->section().sectionName());
-				NameToMap::iterator mpos = _nonStdCStringSectionToMap.find(segsect);
-				CStringToSlot* map = NULL;
-				if ( mpos == _nonStdCStringSectionToMap.end() ) {
-					map = new CStringToSlot();
-					_nonStdCStringSectionToMap[strdup(segsect)] = map;
-				}
-				else {
-					map = mpos->second;
-				}
-				cspos = map->find(atom);
-				if ( cspos != map->end() ) {
-					*existingAtom = _indirectBindingTable[cspos->second];
-					return cspos->second;
-				}
-				slot = _indirectBindingTable.size();
-				map->operator[](atom) = slot;
-			}
+			added = addContent(*nonStdCStringTable(atom->section()), atom, slot);
 			break;
 		case ld::Section::typeUTF16Strings:
-			upos = _utf16Table.find(atom);
-			if ( upos != _utf16Table.end() ) {
-				*existingAtom = _indirectBindingTable[upos->second];
-				return upos->second;
-			}
-			slot = _indirectBindingTable.size();
-			_utf16Table[atom] = slot;
+			added = addContent(_utf16Table, atom, slot);
 			break;
 		case ld::Section::typeLiteral4:
-			pos = _literal4Table.find(atom);
-			if ( pos != _literal4Table.end() ) {
-				*existingAtom = _indirectBindingTable[pos->second];
-				return pos->second;
-			}
-			slot = _indirectBindingTable.size();
-			_literal4Table[atom] = slot;
+			added = addContent(_literal4Table, atom, slot);
 			break;
 		case ld::Section::typeLiteral8:
-			pos = _literal8Table.find(atom);
-			if ( pos != _literal8Table.end() ) {
-				*existingAtom = _indirectBindingTable[pos->second];
-				return pos->second;
-			}
-			slot = _indirectBindingTable.size();
-			_literal8Table[atom] = slot;
+			added = addContent(_literal8Table, atom, slot);
 			break;
 		case ld::Section::typeLiteral16:
-			pos = _literal16Table.find(atom);
-			if ( pos != _literal16Table.end() ) {
-				*existingAtom = _indirectBindingTable[pos->second];
-				return pos->second;
-			}
-			slot = _indirectBindingTable.size();
-			_literal16Table[atom] = slot;
+			added = addContent(_literal16Table, atom, slot);
 			break;
 		default:
 			assert(0 && "section type does not support coalescing by content");
 	}
+	if ( !added ) {
+		*existingAtom = _indirectBindingTable[slot];
+		return slot;
+	}
 	_indirectBindingTable.push_back(atom); 
 	*existingAtom = NULL;
 	return slot;
@@ -89,6 +89,7 @@ private:
 
 	typedef std::map<IndirectBindingSlot, const char*> SlotToName;
 	typedef std::unordered_map<const char*, CStringToSlot*, CStringHash, CStringEquals> NameToMap;
+	typedef std::unordered_map<const ld::Section*, CStringToSlot*> SectionToMap;
     
     typedef std::vector<const ld::Atom *> DuplicatedSymbolAtomList;
     typedef std::map<const char *, DuplicatedSymbolAtomList * > DuplicateSymbols;
@@ -142,6 +143,7 @@ private:
 	bool					addByContent(const ld::Atom& atom);
 	bool					addByReferences(const ld::Atom& atom);
 	void					markCoalescedAway(const ld::Atom* atom);
+	CStringToSlot*			nonStdCStringTable(const ld::Section& sect);
     
     // Tracks duplicated symbols. Each call adds file to the list of files defining symbol.
     // The file list is uniqued per symbol, so calling multiple times for the same symbol/file pair is permitted.
@@ -158,6 +160,7 @@ private:
 	UTF16StringToSlot				_utf16Table;
 	CStringToSlot					_cstringTable;
 	NameToMap						_nonStdCStringSectionToMap;
+	SectionToMap					_nonStdCStringSectionTables;	// caches _nonStdCStringSectionToMap lookups for each input section
 	ReferencesToSlot				_nonLazyPointerTable;
 	ReferencesToSlot				_threadPointerTable;
 	ReferencesToSlot				_cfStringTable;
@@ -33,6 +33,7 @@ extern "C" double log2 ( double );
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <sys/sysctl.h>
+#include <sys/resource.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <limits.h>
@@ -55,6 +56,7 @@ extern "C" double log2 ( double );
 #include <list>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <cxxabi.h>
 
 #include "Options.h"
@@ -67,6 +69,8 @@ extern "C" double log2 ( double );
 #include "Resolver.h"
 #include "OutputFile.h"
 #include "Snapshot.h"
+#include "LinkServer.h"
+#include "Parallel.h"
 
 #include "passes/stubs/make_stubs.h"
 #include "passes/dtrace_dof.h"
@@ -112,6 +116,7 @@ class InternalState : public ld::Internal
 public:
 											InternalState(const Options& opts) : _options(opts), _atomsOrderedInSections(false) { }
 	virtual	ld::Internal::FinalSection*		addAtom(const ld::Atom& atom);
+	virtual void							addAtoms(const std::vector<const ld::Atom*>& atoms);
 	virtual ld::Internal::FinalSection*		getFinalSection(const ld::Section&);
 			ld::Internal::FinalSection*     getFinalSection(const char* seg, const char* sect, ld::Section::Type type);
 	
@@ -123,6 +128,24 @@ public:
 
 	virtual									~InternalState() {}
 private:
+	// where an atom goes: a final section by name, or NULL segmentName for the default for its input section
+	struct SectionChoice {
+		const char*				segmentName;
+		const char*				sectionName;
+		ld::Section::Type		type;
+		const ld::Section*		inputSection;	// only set by addAtoms(), to tell default choices apart
+		bool					overridden;		// more than one rule applied, and addAtom() creates each section named
+
+		bool	operator==(const SectionChoice& other) const { return (segmentName == other.segmentName) && (sectionName == other.sectionName)
+																	&& (type == other.type) && (inputSection == other.inputSection); }
+	};
+	struct SectionChoiceHash {
+		size_t operator()(const SectionChoice&) const;
+	};
+	static const size_t						kAtomsPerPlacementChunk = 16384;
+
+	SectionChoice							chooseSection(const ld::Atom& atom, bool createSections);
+	ld::Internal::FinalSection*				finalSection(const ld::Atom& atom, const SectionChoice& choice);
 	bool									inMoveRWChain(const ld::Atom& atom, const char* filePath, bool followedBackBranch, const char*& dstSeg, bool& wildCardMatch);
 	bool									inMoveROChain(const ld::Atom& atom, const char* filePath, const char*& dstSeg, bool& wildCardMatch);
 	bool									inMoveAuthChain(const ld::Atom& atom, bool followedBackBranch, const char*& dstSeg);
@@ -163,9 +186,14 @@ private:
 		bool operator()(const ld::Section* left, const ld::Section* right) const;
 	};
 	typedef std::unordered_map<const ld::Section*, FinalSection*, SectionHash, SectionEquals> SectionInToOut;
+	struct SectionNameEquals {
+		bool operator()(const ld::Section* left, const ld::Section* right) const;
+	};
+	typedef std::unordered_map<const ld::Section*, FinalSection*, SectionHash, SectionNameEquals> SectionNameToFinal;
 	
 
 	SectionInToOut			_sectionInToFinalMap;
+	SectionNameToFinal		_finalSectionsByName;	// for getFinalSection(seg, sect, type)
 	const Options&			_options;
 	bool					_atomsOrderedInSections;
 	std::unordered_map<const ld::Atom*, const char*> _pendingSegMove;
@@ -198,6 +226,17 @@ bool InternalState::SectionEquals::operator()(const ld::Section* left, const ld:
 	return (*left == *right);
 }
 
+bool InternalState::SectionNameEquals::operator()(const ld::Section* left, const ld::Section* right) const
+{
+	return (strcmp(left->segmentName(), right->segmentName()) == 0) && (strcmp(left->sectionName(), right->sectionName()) == 0);
+}
+
+size_t InternalState::SectionChoiceHash::operator()(const SectionChoice& choice) const
+{
+	return std::hash<const void*>()(choice.inputSection) ^ std::hash<const void*>()(choice.segmentName)
+			^ (std::hash<const void*>()(choice.sectionName) << 1) ^ choice.type;
+}
+
 
 InternalState::FinalSection::FinalSection(const ld::Section& sect, uint32_t sectionsSeen, const Options& opts)
 	: ld::Internal::FinalSection(sect), 
@@ -742,10 +781,19 @@ bool InternalState::inMoveAuthChain(const ld::Atom& atom, bool followedBackBranc
 
 
 
-ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
+// decides which output section atom goes in.  Without createSections, and unless symbols are being moved
+// between segments or layout is traced, this only reads atom and options, so addAtoms() runs it on many atoms at once.
+InternalState::SectionChoice InternalState::chooseSection(const ld::Atom& atom, bool createSections)
 {
-	//fprintf(stderr, "addAtom: %s\n", atom.name());
-	ld::Internal::FinalSection* fs = NULL;
+	SectionChoice choice = { NULL, NULL, ld::Section::typeUnclassified, NULL, false };
+	auto choose = [&](const char* seg, const char* sect, ld::Section::Type type) -> ld::Internal::FinalSection* {
+		if ( choice.segmentName != NULL )
+			choice.overridden = true;
+		choice.segmentName = seg;
+		choice.sectionName = sect;
+		choice.type        = type;
+		return createSections ? this->getFinalSection(seg, sect, type) : NULL;
+	};
 	const char* curSectName = atom.section().sectionName();
 	const char* curSegName = atom.section().segmentName();
 	ld::Section::Type sectType = atom.section().type();
@@ -777,7 +825,7 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 				curSegName = dstSeg;
 				if ( _options.traceSymbolLayout() )
 					printf("symbol '%s', -move_to_rw_segment mapped it to %s/%s\n", atom.name(), curSegName, curSectName);
-				fs = this->getFinalSection(curSegName, curSectName, sectType);
+				choose(curSegName, curSectName, sectType);
 			}
 		}
 		else {
@@ -785,7 +833,7 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 			if ( strncmp(symName, "__OBJC_$_INSTANCE_METHODS_", 26) == 0 ) {
 				if ( _options.moveAXMethodList(&symName[26]) ) {
 					curSectName  = "__objc_const_ax";
-					fs = this->getFinalSection(curSegName, curSectName, sectType);
+					choose(curSegName, curSectName, sectType);
 					if ( _options.traceSymbolLayout() )
 						printf("symbol '%s', .axsymbol mapped it to %s/%s\n", atom.name(), curSegName, curSectName);
 				}
@@ -793,7 +841,7 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 			else if ( strncmp(symName, "__OBJC_$_CLASS_METHODS_", 23) == 0 ) {
 				if ( _options.moveAXMethodList(&symName[23]) ) {
 					curSectName  = "__objc_const_ax";
-					fs = this->getFinalSection(curSegName, curSectName, sectType);
+					choose(curSegName, curSectName, sectType);
 					if ( _options.traceSymbolLayout() )
 						printf("symbol '%s', .axsymbol mapped it to %s/%s\n", atom.name(), curSegName, curSectName);
 				}
@@ -807,14 +855,14 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 				if ( (atom.size() == 72) && _options.supportsAuthenticatedPointers() && _options.sharedRegionEligible() ) {
 					curSegName = "__OBJC_CONST";
 					curSectName  = "__objc_class_ro";
-					fs = this->getFinalSection(curSegName, curSectName, sectType);
+					choose(curSegName, curSectName, sectType);
 					if ( _options.traceSymbolLayout() )
 						printf("symbol '%s', class_ro_t mapped it to %s/%s\n", atom.name(), curSegName, curSectName);
 				}
 			}
 #endif
 		}
-		if ( (fs == NULL) && inMoveROChain(atom, path, dstSeg, wildCardMatch) ) {
+		if ( (choice.segmentName == NULL) && inMoveROChain(atom, path, dstSeg, wildCardMatch) ) {
 			if ( (sectType != ld::Section::typeCode)
 			  && (sectType != ld::Section::typeUnclassified) ) {
 				if ( !wildCardMatch )
@@ -824,7 +872,7 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 				curSegName = dstSeg;
 				if ( _options.traceSymbolLayout() )
 					printf("symbol '%s', -move_to_ro_segment mapped it to %s/%s\n", atom.name(), curSegName, curSectName);
-				fs = this->getFinalSection(curSegName, curSectName, ld::Section::typeCode);
+				choose(curSegName, curSectName, ld::Section::typeCode);
 			}
 		}
 	}
@@ -833,7 +881,7 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 		if ( strncmp(symName, "l_OBJC_$_INSTANCE_METHODS_", 26) == 0 ) {
 			if ( _options.moveAXMethodList(&symName[26]) ) {
 				curSectName  = "__objc_const_ax";
-				fs = this->getFinalSection(curSegName, curSectName, sectType);
+				choose(curSegName, curSectName, sectType);
 				if ( _options.traceSymbolLayout() )
 					printf("symbol '%s', .axsymbol mapped it to %s/%s\n", atom.name(), curSegName, curSectName);
 			}
@@ -841,7 +889,7 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 		else if ( strncmp(symName, "l_OBJC_$_CLASS_METHODS_", 23) == 0 ) {
 			if ( _options.moveAXMethodList(&symName[23]) ) {
 				curSectName  = "__objc_const_ax";
-				fs = this->getFinalSection(curSegName, curSectName, sectType);
+				choose(curSegName, curSectName, sectType);
 				if ( _options.traceSymbolLayout() )
 					printf("symbol '%s', .axsymbol mapped it to %s/%s\n", atom.name(), curSegName, curSectName);
 			}
@@ -863,7 +911,7 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 					curSegName = "__DATA";
 #endif
 
-				fs = this->getFinalSection(curSegName, curSectName, sectType);
+				choose(curSegName, curSectName, sectType);
 				if ( _options.traceSymbolLayout() )
 					printf("symbol '%s', contains pointers to weak symbols, so mapped it to %s/__const_weak\n", atom.name(), curSegName);
 			}
@@ -880,7 +928,7 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 					curSegName = "__DATA";
 #endif
 
-				fs = this->getFinalSection(curSegName, curSectName, sectType);
+				choose(curSegName, curSectName, sectType);
 				if ( _options.traceSymbolLayout() )
 					printf("symbol '%s', contains pointers to weak symbols, so mapped it to %s/__got_weak\n", atom.name(), curSegName);
 			}
@@ -899,7 +947,7 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 				}
 #endif
 
-				fs = this->getFinalSection(curSegName, rename.toSection, sectType);
+				ld::Internal::FinalSection* fs = choose(curSegName, rename.toSection, sectType);
 				if ( _options.traceSymbolLayout() )
 					printf("symbol '%s', -rename_section mapped it to %s/%s\n", atom.name(), fs->segmentName(), fs->sectionName());
 			}
@@ -909,19 +957,19 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 		if ( strcmp(curSegName, rename.fromSegment) == 0 ) {
 			if ( _options.traceSymbolLayout() )
 				printf("symbol '%s', -rename_segment mapped it to %s/%s\n", atom.name(), rename.toSegment, curSectName);
-			fs = this->getFinalSection(rename.toSegment, curSectName, sectType);
+			choose(rename.toSegment, curSectName, sectType);
 		}
 	}
 
 #if SUPPORT_ARCH_arm64e
-	if ( fs == NULL ) {
+	if ( choice.segmentName == NULL ) {
 		// Actually move to __AUTH if we are authenticated
 		if ( !strcmp(curSegName, "__DATA") ) {
 			// We may want __AUTH, but double check there isn't a chain already
 			// for this atom which will force it in a different segment
 			curSegName = "__AUTH";
 			if ( inMoveAuthChain(atom, false, curSegName) ) {
-				fs = this->getFinalSection(curSegName, curSectName, sectType);
+				ld::Internal::FinalSection* fs = choose(curSegName, curSectName, sectType);
 				if ( _options.traceSymbolLayout() && (atom.symbolTableInclusion() == ld::Atom::symbolTableIn) )
 					printf("symbol '%s', contains authenticated pointers, so mapped it to __AUTH/%s\n", atom.name(), fs->sectionName());
 			}
@@ -929,12 +977,26 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 	}
 #endif
 
+	return choice;
+}
+
+// returns the final section chosen for atom, creating it if needed
+ld::Internal::FinalSection* InternalState::finalSection(const ld::Atom& atom, const SectionChoice& choice)
+{
+	if ( choice.segmentName != NULL )
+		return this->getFinalSection(choice.segmentName, choice.sectionName, choice.type);
+
 	// if no override, use default location
-	if ( fs == NULL ) {
-		fs = this->getFinalSection(atom.section());
-		if ( _options.traceSymbolLayout() && (atom.symbolTableInclusion() == ld::Atom::symbolTableIn) )
-			printf("symbol '%s', use default mapping to %s/%s\n", atom.name(), fs->segmentName(), fs->sectionName());
-	}
+	ld::Internal::FinalSection* fs = this->getFinalSection(atom.section());
+	if ( _options.traceSymbolLayout() && (atom.symbolTableInclusion() == ld::Atom::symbolTableIn) )
+		printf("symbol '%s', use default mapping to %s/%s\n", atom.name(), fs->segmentName(), fs->sectionName());
+	return fs;
+}
+
+ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
+{
+	//fprintf(stderr, "addAtom: %s\n", atom.name());
+	ld::Internal::FinalSection* fs = this->finalSection(atom, this->chooseSection(atom, true));
 
 	//fprintf(stderr, "InternalState::doAtom(%p), name=%s, sect=%s, finalseg=%s\n", &atom, atom.name(), atom.section().sectionName(), fs->segmentName());
 #ifndef NDEBUG
@@ -964,12 +1026,82 @@ ld::Internal::FinalSection* InternalState::addAtom(const ld::Atom& atom)
 
 
 
+// Places the atoms the resolver found.  Same result as calling addAtom() on each in order, but sections are
+// chosen for a chunk of atoms at a time on several threads.  Creating final sections stays serial: each chunk
+// lists the atoms that first use a section choice, and going through those lists in chunk order creates final
+// sections in the same order addAtom() would have.  Atoms are then appended to their final sections in order.
+void InternalState::addAtoms(const std::vector<const ld::Atom*>& atoms)
+{
+	// moving symbols between segments follows chains of atoms and remembers moves for atoms later
+	// in the list, and tracing prints as it goes, so those links place one atom at a time
+	bool serial = _options.hasDataSymbolMoves() || _options.hasCodeSymbolMoves() || _options.traceSymbolLayout() || _atomsOrderedInSections;
+#if SUPPORT_ARCH_arm64e
+	serial = serial || _options.useAuthDataSegment();
+#endif
+	if ( serial || (atoms.size() < kAtomsPerPlacementChunk) ) {
+		for (const ld::Atom* atom : atoms)
+			this->addAtom(*atom);
+		return;
+	}
+
+	std::vector<SectionChoice>					choices(atoms.size());
+	std::vector<ld::Internal::FinalSection*>	atomSections(atoms.size(), NULL);
+	std::vector<std::vector<size_t>>			firstUses(ld::parallel::chunkCount(atoms.size(), kAtomsPerPlacementChunk));
+	ld::parallel::forEachChunk(atoms.size(), kAtomsPerPlacementChunk, [&](size_t chunkIndex, size_t begin, size_t end) {
+		std::unordered_set<SectionChoice, SectionChoiceHash> seen;
+		for (size_t i=begin; i < end; ++i) {
+			const ld::Atom* atom = atoms[i];
+			SectionChoice& choice = choices[i];
+			choice = this->chooseSection(*atom, false);
+			if ( choice.segmentName == NULL ) {
+				// input sections are shared by all atoms of a section in a file, so key by that
+				choice.inputSection = &atom->section();
+			}
+			// addAtom() also creates the sections of rules that a later rule overrode, so those atoms
+			// are placed again serially, at their position in the list
+			if ( choice.overridden || seen.insert(choice).second )
+				firstUses[chunkIndex].push_back(i);
+#ifndef NDEBUG
+			validateFixups(*atom);
+#endif
+		}
+	});
+
+	// in order, so final sections are created in the order atoms first use them
+	std::unordered_map<SectionChoice, ld::Internal::FinalSection*, SectionChoiceHash> finalSections;
+	for (const std::vector<size_t>& chunkUses : firstUses) {
+		for (size_t i : chunkUses) {
+			const ld::Atom* atom = atoms[i];
+			if ( choices[i].overridden ) {
+				atomSections[i] = this->finalSection(*atom, this->chooseSection(*atom, true));
+				continue;
+			}
+			ld::Internal::FinalSection*& fs = finalSections[choices[i]];
+			if ( fs == NULL )
+				fs = this->finalSection(*atom, choices[i]);
+		}
+	}
+	ld::parallel::forEachChunk(atoms.size(), kAtomsPerPlacementChunk, [&](size_t chunkIndex, size_t begin, size_t end) {
+		for (size_t i=begin; i < end; ++i) {
+			if ( atomSections[i] == NULL )
+				atomSections[i] = finalSections.find(choices[i])->second;
+		}
+	});
+
+	// several choices can share a final section, so append atom by atom to keep resolver order
+	for (size_t i=0; i < atoms.size(); ++i) {
+		atomSections[i]->atoms.push_back(atoms[i]);
+		this->atomToSection[atoms[i]] = atomSections[i];
+	}
+}
+
+
 ld::Internal::FinalSection* InternalState::getFinalSection(const char* seg, const char* sect, ld::Section::Type type)
 {	
-	for (std::vector<ld::Internal::FinalSection*>::iterator it=sections.begin(); it != sections.end(); ++it) {
-		if ( (strcmp((*it)->segmentName(),seg) == 0) && (strcmp((*it)->sectionName(),sect) == 0) )
-			return *it;
-	}
+	ld::Section key(seg, sect, type);
+	SectionNameToFinal::iterator pos = _finalSectionsByName.find(&key);
+	if ( pos != _finalSectionsByName.end() )
+		return pos->second;
 	return this->getFinalSection(*new ld::Section(seg, sect, type, false));
 }
 
@@ -1022,6 +1154,7 @@ ld::Internal::FinalSection* InternalState::getFinalSection(const ld::Section& in
 																	_sectionInToFinalMap.size(), _options);
 	_sectionInToFinalMap[baseForFinalSection] = result;
 	//fprintf(stderr, "_sectionInToFinalMap[%p(%s)] = %p\n", baseForFinalSection, baseForFinalSection->sectionName(), result);
+	_finalSectionsByName.insert(std::make_pair(result, result));	// first section with these names wins
 	sections.push_back(result);
 	return result;
 }
@@ -1482,6 +1615,17 @@ static void getVMInfo(vm_statistics_data_t& info)
 
 int main(int argc, const char* argv[])
 {
+	// "ld -link_server <socket>" only comes back here in each link process it forks
+	if ( (argc == 3) && (strcmp(argv[1], "-link_server") == 0) ) {
+		if ( !ld::tool::LinkServer::serve(argv[2], argc, argv) )
+			return 1;
+	}
+	else {
+		int exitStatus;
+		if ( ld::tool::LinkServer::forward(argc, argv, exitStatus) )
+			return exitStatus;
+	}
+
 	const char* archName = NULL;
 	bool showArch = false;
 	try {
@@ -1575,6 +1719,15 @@ int main(int argc, const char* argv[])
 			fprintf(stderr, "processed %3u archive files, totaling %15s bytes\n", inputFiles._totalArchivesLoaded, commatize(inputFiles._totalArchiveSize, temp));
 			fprintf(stderr, "processed %3u dylib files\n", inputFiles._totalDylibsLoaded);
 			fprintf(stderr, "wrote output file            totaling %15s bytes\n", commatize(out.fileSize(), temp));
+			struct rusage usage;
+			if ( getrusage(RUSAGE_SELF, &usage) == 0 ) {
+#if __APPLE__
+				uint64_t peakBytes = usage.ru_maxrss;
+#else
+				uint64_t peakBytes = (uint64_t)usage.ru_maxrss * 1024;	// kilobytes on Linux
+#endif
+				fprintf(stderr, "peak memory footprint        totaling %15s bytes\n", commatize(peakBytes, temp));
+			}
 		}
 		// <rdar://problem/6780050> Would like linker warning to be build error.
 		if ( options.errorBecauseOfWarnings() ) {
@@ -1583,6 +1736,8 @@ int main(int argc, const char* argv[])
 		}
 		// <rdar://problem/61228255> need to flush stdout since we skipping some clean up in calling _exit()
 		fflush(stdout);
+		// the snapshot's destructor won't run either, so finish copying files into it now
+		options.snapshot().flush();
 
 		// <rdar://problem/55031993> don't run terminators until all we can guarantee all threads are stopped
 		// <rdar://problem/56200095> don't run C++ destructors of stack objects to gain 5% linking perf win
@@ -1629,6 +1784,7 @@ void __assert_rtn(const char* func, const char* file, int line, const char* fail
 		fprintf(stderr, "%d  %p  %s + %ld\n", i, callStack[i], symboName, offset);
 		snapshot->recordAssertionMessage("%d  %p  %s + %ld\n", i, callStack[i], symboName, offset);
 	}
+    snapshot->flush();
     fprintf(stderr, "A linker snapshot was created at:\n\t%s\n", snapshot->rootDir());
 	fprintf(stderr, "ld: Assertion failed: (%s), function %s, file %s, line %d.\n", failedexpr, func, file, line);
 	_exit(1);
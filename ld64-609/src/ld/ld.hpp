@@ -1302,6 +1302,7 @@ public:
 	virtual uint64_t					assignFileOffsets() = 0;
 	virtual void						setSectionSizesAndAlignments() = 0;
 	virtual ld::Internal::FinalSection*	addAtom(const Atom&) = 0;
+	virtual void						addAtoms(const std::vector<const Atom*>&) = 0;	// same as addAtom() on each, in order
 	virtual ld::Internal::FinalSection* getFinalSection(const ld::Section& inputSection) = 0;
 	virtual								~Internal() {}
 										Internal() : bundleLoader(NULL),
@@ -34,6 +34,7 @@
 #include <map>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "MachOFileAbstraction.hpp"
 #include "Architectures.hpp"
@@ -89,6 +90,7 @@ public:
 
 private:
 	friend bool isArchiveFile(const uint8_t* fileContent, uint64_t fileLength, ld::Platform* platform, const char** archiveArchName);
+	friend bool indexTableOfContents(const uint8_t* fileContent, uint64_t fileLength, ld::ResidentInputs::ArchiveIndex& index);
 
 	static bool										validMachOFile(const uint8_t* fileContent, uint64_t fileLength,
 																	const mach_o::relocatable::ParserOptions& opts);
@@ -113,30 +115,36 @@ private:
 	struct MemberState { ld::relocatable::File* file; const Entry *entry; bool logged; bool loaded; uint32_t index;};
 	bool											loadMember(MemberState& state, ld::File::AtomHandler& handler, const char *format, ...) const;
 
-	typedef std::unordered_map<const char*, uint64_t, ld::CStringHash, ld::CStringEquals> NameToOffsetMap;
+	typedef ld::ResidentInputs::ArchiveIndex NameToOffsetMap;
 
 	typedef typename A::P							P;
 	typedef typename A::P::E						E;
 
 	typedef std::map<const class Entry*, MemberState> MemberToStateMap;
 
+	struct TableOfContents {
+		const struct ranlib*						entries;
+#ifdef SYMDEF_64
+		const struct ranlib_64*						entries64;
+#endif
+		uint64_t									count;
+		const char*									strings;
+	};
+
 	MemberState&									makeObjectFileForMember(const Entry* member) const;
 	bool											memberHasObjCCategories(const Entry* member) const;
+	bool											memberNeedsObjCLoad(const Entry* member) const;
+	const std::vector<const Entry*>&				objcCategoryMembers() const;
 	void											dumpTableOfContents();
-	void											buildHashTable();
-#ifdef SYMDEF_64
-	void											buildHashTable64();
-#endif
+	const NameToOffsetMap&							hashTable() const { return (_residentHashTable != NULL) ? *_residentHashTable : _hashTable; }
+	static bool										findTableOfContents(const uint8_t* fileContent, uint64_t fileLength, TableOfContents& toc);
+	static void										buildHashTable(const TableOfContents& toc, uint64_t fileLength, NameToOffsetMap& index);
 	const uint8_t*									_archiveFileContent;
 	uint64_t										_archiveFilelength;
-	const struct ranlib*							_tableOfContents;
-#ifdef SYMDEF_64
-	const struct ranlib_64*							_tableOfContents64;
-#endif
-	uint32_t										_tableOfContentCount;
-	const char*										_tableOfContentStrings;
+	TableOfContents									_tableOfContents;
 	mutable MemberToStateMap						_instantiatedEntries;
 	NameToOffsetMap									_hashTable;
+	const NameToOffsetMap*							_residentHashTable;
 	const bool										_forceLoadAll;
 	const bool										_forceLoadObjC;
 	const bool										_forceLoadThis;
@@ -144,6 +152,8 @@ private:
 	const bool										_verboseLoad;
 	const bool										_logAllFiles;
 	mutable bool									_alreadyLoadedAll;
+	mutable bool									_objcCategoryMembersComputed;
+	mutable std::vector<const Entry*>				_objcCategoryMembers;
 	const mach_o::relocatable::ParserOptions		_objOpts;
 };
 
@@ -285,48 +295,20 @@ template <typename A>
 File<A>::File(const uint8_t fileContent[], uint64_t fileLength, const char* pth, time_t modTime, 
 					ld::File::Ordinal ord, const ParserOptions& opts)
  : ld::archive::File(strdup(pth), modTime, ord),
-	_archiveFileContent(fileContent), _archiveFilelength(fileLength), 
-	_tableOfContents(NULL),
-#ifdef SYMDEF_64
-	_tableOfContents64(NULL),
-#endif
-	_tableOfContentCount(0), _tableOfContentStrings(NULL),
+	_archiveFileContent(fileContent), _archiveFilelength(fileLength), _residentHashTable(NULL),
 	_forceLoadAll(opts.forceLoadAll), _forceLoadObjC(opts.forceLoadObjC), 
 	_forceLoadThis(opts.forceLoadThisArchive), _objc2ABI(opts.objcABI2), _verboseLoad(opts.verboseLoad), 
-	_logAllFiles(opts.logAllFiles), _alreadyLoadedAll(false), _objOpts(opts.objOpts)
+	_logAllFiles(opts.logAllFiles), _alreadyLoadedAll(false), _objcCategoryMembersComputed(false), _objOpts(opts.objOpts)
 {
 	if ( strncmp((const char*)fileContent, "!<arch>\n", 8) != 0 )
 		throw "not an archive";
-
-		const Entry* const firstMember = (Entry*)&_archiveFileContent[8];
-		char memberName[256];
-		firstMember->getName(memberName, sizeof(memberName));
-		if ( (strcmp(memberName, SYMDEF_SORTED) == 0) || (strcmp(memberName, SYMDEF) == 0) ) {
-			const uint8_t* contents = firstMember->content();
-			uint32_t ranlibArrayLen = E::get32(*((uint32_t*)contents));
-			_tableOfContents = (const struct ranlib*)&contents[4];
-			_tableOfContentCount = ranlibArrayLen / sizeof(struct ranlib);
-			_tableOfContentStrings = (const char*)&contents[ranlibArrayLen+8];
-			if ( ((uint8_t*)(&_tableOfContents[_tableOfContentCount]) > &fileContent[fileLength])
-				|| ((uint8_t*)_tableOfContentStrings > &fileContent[fileLength]) )
-				throw "malformed archive, perhaps wrong architecture";
-			this->buildHashTable();
-		}
-#ifdef SYMDEF_64
-		else if ( (strcmp(memberName, SYMDEF_64_SORTED) == 0) || (strcmp(memberName, SYMDEF_64) == 0) ) {
-			const uint8_t* contents = firstMember->content();
-			uint64_t ranlibArrayLen = E::get64(*((uint64_t*)contents));
-			_tableOfContents64 = (const struct ranlib_64*)&contents[8];
-			_tableOfContentCount = ranlibArrayLen / sizeof(struct ranlib_64);
-			_tableOfContentStrings = (const char*)&contents[ranlibArrayLen+16];
-			if ( ((uint8_t*)(&_tableOfContents[_tableOfContentCount]) > &fileContent[fileLength])
-				|| ((uint8_t*)_tableOfContentStrings > &fileContent[fileLength]) )
-				throw "malformed archive, perhaps wrong architecture";
-			this->buildHashTable64();
-		}
-#endif
-		else
-			throw "archive has no table of contents";
+	if ( !findTableOfContents(fileContent, fileLength, _tableOfContents) )
+		throw "archive has no table of contents";
+	// a link server may already have the table of contents indexed
+	_residentHashTable = ld::ResidentInputs::archiveIndex(pth, modTime, opts.sliceOffset, fileLength,
+														 opts.objOpts.architecture, opts.objOpts.subType);
+	if ( _residentHashTable == NULL )
+		buildHashTable(_tableOfContents, fileLength, _hashTable);
 }
 
 template <>
@@ -353,6 +335,53 @@ bool File<A>::memberHasObjCCategories(const Entry* member) const
 }
 
 
+template <typename A>
+bool File<A>::memberNeedsObjCLoad(const Entry* member) const
+{
+	bool result = false;
+	if ( validMachOFile(member->content(), member->contentSize(), _objOpts) )
+		result = this->memberHasObjCCategories(member);
+	else if ( validLTOFile(member->content(), member->contentSize(), _objOpts) )
+		result = lto::hasObjCCategory(member->content(), member->contentSize());
+	return result;
+}
+
+
+template <typename A>
+const std::vector<const typename File<A>::Entry*>& File<A>::objcCategoryMembers() const
+{
+	if ( _objcCategoryMembersComputed )
+		return _objcCategoryMembers;
+	_objcCategoryMembersComputed = true;
+
+	// members defining a class are loaded because of their table of contents entry, no need to look inside them
+	std::unordered_set<uint64_t> classMemberOffsets;
+	for (const auto& entry : hashTable()) {
+		if ( (strncmp(entry.first, ".objc_c", 7) == 0) || (strncmp(entry.first, "_OBJC_CLASS_$_", 14) == 0) )
+			classMemberOffsets.insert(entry.second);
+	}
+
+	const Entry* const start = (Entry*)&_archiveFileContent[8];
+	const Entry* const end = (Entry*)&_archiveFileContent[_archiveFilelength];
+	for (const Entry* member=start; member < end; member = member->next()) {
+		char mname[256];
+		member->getName(mname, sizeof(mname));
+		// skip table-of-content member
+		if ( (member==start) && ((strcmp(mname, SYMDEF_SORTED) == 0) || (strcmp(mname, SYMDEF) == 0)) )
+			continue;
+#ifdef SYMDEF_64
+		if ( (member==start) && ((strcmp(mname, SYMDEF_64_SORTED) == 0) || (strcmp(mname, SYMDEF_64) == 0)) )
+			continue;
+#endif
+		if ( classMemberOffsets.count((uint8_t*)member - _archiveFileContent) != 0 )
+			continue;
+		if ( this->memberNeedsObjCLoad(member) )
+			_objcCategoryMembers.push_back(member);
+	}
+	return _objcCategoryMembers;
+}
+
+
 template <typename A>
 typename File<A>::MemberState& File<A>::makeObjectFileForMember(const Entry* member) const
 {
@@ -471,7 +500,7 @@ bool File<A>::forEachAtom(ld::File::AtomHandler& handler) const
 	}
 	else if ( _forceLoadObjC ) {
 		// call handler on all .o files in this archive containing objc classes
-		for (const auto& entry : _hashTable) {
+		for (const auto& entry : hashTable()) {
 			if ( (strncmp(entry.first, ".objc_c", 7) == 0) || (strncmp(entry.first, "_OBJC_CLASS_$_", 14) == 0) ) {
 				const Entry* member = (Entry*)&_archiveFileContent[entry.second];
 				MemberState& state = this->makeObjectFileForMember(member);
@@ -481,40 +510,13 @@ bool File<A>::forEachAtom(ld::File::AtomHandler& handler) const
 			}
 		}
 		// ObjC2 has no symbols in .o files with categories but not classes, look deeper for those
-		const Entry* const start = (Entry*)&_archiveFileContent[8];
-		const Entry* const end = (Entry*)&_archiveFileContent[_archiveFilelength];
-		for (const Entry* member=start; member < end; member = member->next()) {
-			char mname[256];
-			member->getName(mname, sizeof(mname));
-			// skip table-of-content member
-			if ( (member==start) && ((strcmp(mname, SYMDEF_SORTED) == 0) || (strcmp(mname, SYMDEF) == 0)) )
-				continue;
-#ifdef SYMDEF_64
-			if ( (member==start) && ((strcmp(mname, SYMDEF_64_SORTED) == 0) || (strcmp(mname, SYMDEF_64) == 0)) )
-				continue;
-#endif
-			if ( validMachOFile(member->content(), member->contentSize(), _objOpts) ) {
-				MemberState& state = this->makeObjectFileForMember(member);
-				// only look at files not already loaded
-				if ( ! state.loaded ) {
-					if ( this->memberHasObjCCategories(member) ) {
-						MemberState& state = this->makeObjectFileForMember(member);
-						char memberName[256];
-						member->getName(memberName, sizeof(memberName));
-						didSome |= loadMember(state, handler, "-ObjC forced load of %s(%s)\n", this->path(), memberName);
-					}
-				}
-			}
-			else if ( validLTOFile(member->content(), member->contentSize(), _objOpts) ) {
-				if ( lto::hasObjCCategory(member->content(), member->contentSize()) ) {
-					MemberState& state = this->makeObjectFileForMember(member);
-					// only look at files not already loaded
-					if ( ! state.loaded ) {
-						char memberName[256];
-						member->getName(memberName, sizeof(memberName));
-						didSome |= loadMember(state, handler, "-ObjC forced load of %s(%s)\n", this->path(), memberName);
-					}
-				}
+		for (const Entry* member : this->objcCategoryMembers()) {
+			MemberState& state = this->makeObjectFileForMember(member);
+			// only look at files not already loaded
+			if ( ! state.loaded ) {
+				char memberName[256];
+				member->getName(memberName, sizeof(memberName));
+				didSome |= loadMember(state, handler, "-ObjC forced load of %s(%s)\n", this->path(), memberName);
 			}
 		}
 	}
@@ -529,8 +531,8 @@ bool File<A>::justInTimeforEachAtom(const char* name, ld::File::AtomHandler& han
 		return false;
 	
 	// do a hash search of table of contents looking for requested symbol
-	const auto& pos = _hashTable.find(name);
-	if ( pos == _hashTable.end() )
+	const auto& pos = hashTable().find(name);
+	if ( pos == hashTable().end() )
 		return false;
 
 	// do a hash search of table of contents looking for requested symbol
@@ -568,8 +570,8 @@ bool File<A>::justInTimeDataOnlyforEachAtom(const char* name, ld::File::AtomHand
 		return false;
 	
 	// do a hash search of table of contents looking for requested symbol
-	const auto& pos = _hashTable.find(name);
-	if ( pos == _hashTable.end() )
+	const auto& pos = hashTable().find(name);
+	if ( pos == hashTable().end() )
 		return false;
 
 	const Entry* member = (Entry*)&_archiveFileContent[pos->second];
@@ -589,53 +591,85 @@ bool File<A>::justInTimeDataOnlyforEachAtom(const char* name, ld::File::AtomHand
 	return false;
 }
 
+// Finds the table of contents in the archive's first member, false if there is none.
 template <typename A>
-void File<A>::buildHashTable()
+bool File<A>::findTableOfContents(const uint8_t* fileContent, uint64_t fileLength, TableOfContents& toc)
 {
-	// walk through list backwards, adding/overwriting entries
-	// this assures that with duplicates those earliest in the list will be found
-	for (int i = _tableOfContentCount-1; i >= 0; --i) {
-		const struct ranlib* entry = &_tableOfContents[i];
-		const char* entryName = &_tableOfContentStrings[E::get32(entry->ran_un.ran_strx)];
-		uint64_t offset = E::get32(entry->ran_off);
-		if ( offset > _archiveFilelength ) {
-			throwf("malformed archive TOC entry for %s, offset %d is beyond end of file %lld\n",
-				entryName, entry->ran_off, _archiveFilelength);
-		}
-		
-		//const Entry* member = (Entry*)&_archiveFileContent[E::get32(entry->ran_off)];
-		//fprintf(stderr, "adding hash %d, %s -> %p\n", i, entryName, entry);
-		_hashTable[entryName] = offset;
+	bzero(&toc, sizeof(toc));
+	if ( fileLength < 8+sizeof(ar_hdr) )
+		return false;
+	const Entry* const firstMember = (Entry*)&fileContent[8];
+	char memberName[256];
+	firstMember->getName(memberName, sizeof(memberName));
+	const uint8_t* contents = firstMember->content();
+	const uint8_t* const fileEnd = &fileContent[fileLength];
+	const uint8_t* entriesEnd;
+	if ( (strcmp(memberName, SYMDEF_SORTED) == 0) || (strcmp(memberName, SYMDEF) == 0) ) {
+		if ( &contents[4] > fileEnd )
+			throw "malformed archive, perhaps wrong architecture";
+		uint32_t ranlibArrayLen = E::get32(*((uint32_t*)contents));
+		if ( ranlibArrayLen > fileLength )
+			throw "malformed archive, perhaps wrong architecture";
+		toc.entries = (const struct ranlib*)&contents[4];
+		toc.count   = ranlibArrayLen / sizeof(struct ranlib);
+		toc.strings = (const char*)&contents[ranlibArrayLen+8];
+		entriesEnd  = (uint8_t*)&toc.entries[toc.count];
+	}
+#ifdef SYMDEF_64
+	else if ( (strcmp(memberName, SYMDEF_64_SORTED) == 0) || (strcmp(memberName, SYMDEF_64) == 0) ) {
+		if ( &contents[8] > fileEnd )
+			throw "malformed archive, perhaps wrong architecture";
+		uint64_t ranlibArrayLen = E::get64(*((uint64_t*)contents));
+		if ( ranlibArrayLen > fileLength )
+			throw "malformed archive, perhaps wrong architecture";
+		toc.entries64 = (const struct ranlib_64*)&contents[8];
+		toc.count     = ranlibArrayLen / sizeof(struct ranlib_64);
+		toc.strings   = (const char*)&contents[ranlibArrayLen+16];
+		entriesEnd    = (uint8_t*)&toc.entries64[toc.count];
 	}
+#endif
+	else
+		return false;
+	if ( (entriesEnd > fileEnd) || ((uint8_t*)toc.strings > fileEnd) )
+		throw "malformed archive, perhaps wrong architecture";
+	return true;
 }
 
-#ifdef SYMDEF_64
 template <typename A>
-void File<A>::buildHashTable64()
+void File<A>::buildHashTable(const TableOfContents& toc, uint64_t fileLength, NameToOffsetMap& index)
 {
 	// walk through list backwards, adding/overwriting entries
 	// this assures that with duplicates those earliest in the list will be found
-	for (int i = _tableOfContentCount-1; i >= 0; --i) {
-		const struct ranlib_64* entry = &_tableOfContents64[i];
-		const char* entryName = &_tableOfContentStrings[E::get64(entry->ran_un.ran_strx)];
-		uint64_t offset = E::get64(entry->ran_off);
-		if ( offset > _archiveFilelength ) {
+	for (uint64_t i = toc.count; i > 0; --i) {
+		const char* entryName;
+		uint64_t offset;
+#ifdef SYMDEF_64
+		if ( toc.entries64 != NULL ) {
+			entryName = &toc.strings[E::get64(toc.entries64[i-1].ran_un.ran_strx)];
+			offset    = E::get64(toc.entries64[i-1].ran_off);
+		}
+		else
+#endif
+		{
+			entryName = &toc.strings[E::get32(toc.entries[i-1].ran_un.ran_strx)];
+			offset    = E::get32(toc.entries[i-1].ran_off);
+		}
+		if ( offset > fileLength ) {
 			throwf("malformed archive TOC entry for %s, offset %lld is beyond end of file %lld\n",
-				entryName, entry->ran_off, _archiveFilelength);
+				entryName, offset, fileLength);
 		}
-
-		//fprintf(stderr, "adding hash %d: %s -> 0x%0llX\n", i, entryName, offset);
-		_hashTable[entryName] = offset;
+		index[entryName] = offset;
 	}
 }
-#endif
 
 template <typename A>
 void File<A>::dumpTableOfContents()
 {
-	for (unsigned int i=0; i < _tableOfContentCount; ++i) {
-		const struct ranlib* e = &_tableOfContents[i];
-		printf("%s in %s\n", &_tableOfContentStrings[E::get32(e->ran_un.ran_strx)], ((Entry*)&_archiveFileContent[E::get32(e->ran_off)])->name());
+	if ( _tableOfContents.entries == NULL )
+		return;
+	for (uint64_t i=0; i < _tableOfContents.count; ++i) {
+		const struct ranlib* e = &_tableOfContents.entries[i];
+		printf("%s in %s\n", &_tableOfContents.strings[E::get32(e->ran_un.ran_strx)], ((Entry*)&_archiveFileContent[E::get32(e->ran_off)])->name());
 	}
 }
 
@@ -718,6 +752,19 @@ bool isArchiveFile(const uint8_t* fileContent, uint64_t fileLength, ld::Platform
 }
 
 
+bool indexTableOfContents(const uint8_t* fileContent, uint64_t fileLength, ld::ResidentInputs::ArchiveIndex& index)
+{
+	if ( (fileLength < 8) || (strncmp((const char*)fileContent, "!<arch>\n", 8) != 0) )
+		return false;
+	// the same walk a link does, all architectures with archives are little endian so the template type does not matter
+	File<x86_64>::TableOfContents toc;
+	if ( !File<x86_64>::findTableOfContents(fileContent, fileLength, toc) )
+		return false;
+	File<x86_64>::buildHashTable(toc, fileLength, index);
+	return true;
+}
+
+
 
 }; // namespace archive
 
@@ -27,11 +27,13 @@
 
 #include "ld.hpp"
 #include "macho_relocatable_file.h"
+#include "ResidentInputs.h"
 
 namespace archive {
 
 struct ParserOptions {
 	mach_o::relocatable::ParserOptions	objOpts;
+	uint64_t							sliceOffset;		// where the archive starts in a fat file
 	bool								forceLoadThisArchive;
 	bool								forceLoadAll;
 	bool								forceLoadObjC;
@@ -45,6 +47,10 @@ extern ld::archive::File* parse(const uint8_t* fileContent, uint64_t fileLength,
 
 extern bool isArchiveFile(const uint8_t* fileContent, uint64_t fileLength, ld::Platform* platform, const char** archiveArchName);
 
+// builds the symbol name to member offset map from an archive's table of contents with the checks a link
+// makes, false if it has none; throws if it is malformed
+extern bool indexTableOfContents(const uint8_t* fileContent, uint64_t fileLength, ld::ResidentInputs::ArchiveIndex& index);
+
 
 } // namespace archive
 
@@ -45,6 +45,7 @@
 #include "MachOFileAbstraction.hpp"
 #include "Architectures.hpp"
 #include "ld.hpp"
+#include "Parallel.h"
 #include "macho_relocatable_file.h"
 #include "lto_file.h"
 
@@ -1405,6 +1406,17 @@ bool Parser::optimizeThinLTO(const std::vector<File*>&              files,
 		}
 	}
 
+	// collect the generated objects, in libLTO order, and assign each its ordinal
+	struct ThinLTOObject {
+		LTOObjectBuffer			buffer;
+		std::string				path;
+		ld::File::Ordinal		ordinal;
+		bool					writeTempFile;
+		int						writeErrno;
+		ld::relocatable::File*	machoFile;
+	};
+	std::vector<ThinLTOObject> objects;
+	objects.reserve(numObjects);
 	auto ordinal = ld::File::Ordinal::LTOOrdinal().nextFileListOrdinal();
 	for (unsigned bufID = 0; bufID < numObjects; ++bufID) {
 		auto machOFile = get_thinlto_buffer_or_load_file(bufID);
@@ -1414,32 +1426,43 @@ bool Parser::optimizeThinLTO(const std::vector<File*>&              files,
 		}
 
 		// mach-o parsing is done in-memory, but need path for debug notes
-		std::string tmp_path;
+		ThinLTOObject object = { machOFile, std::string(), ordinal, false, 0, NULL };
 #if LTO_API_VERSION >= 21
 		if ( useFileBasedAPI ) {
-			tmp_path = thinlto_module_get_object_file(thingenerator, bufID);
+			object.path = thinlto_module_get_object_file(thingenerator, bufID);
 		}
 		else
 #endif
 		if ( options.tmpObjectFilePath != NULL) {
-			tmp_path = macho_dirpath + "/" + std::to_string(bufID) + ".o";
+			object.path = macho_dirpath + "/" + std::to_string(bufID) + ".o";
+			object.writeTempFile = true;
+		}
+		objects.push_back(object);
+		ordinal = ordinal.nextFileListOrdinal();
+	}
+
+	// writing temp files and parsing each generated mach-o file are independent, so do them in parallel
+	ld::parallel::forEach(objects.size(), [&](size_t index) {
+		ThinLTOObject& object = objects[index];
+		if ( object.writeTempFile ) {
 			// if needed, save temp mach-o file to specific location
-			int fd = ::open(tmp_path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0666);
+			int fd = ::open(object.path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0666);
 			if ( fd != -1) {
-				::write(fd, (const uint8_t *)machOFile.Buffer, machOFile.Size);
+				::write(fd, (const uint8_t *)object.buffer.Buffer, object.buffer.Size);
 				::close(fd);
 			}
 			else {
-				warning("could not write ThinLTO temp file '%s', errno=%d", tmp_path.c_str(), errno);
+				object.writeErrno = errno;
 			}
 		}
-
-		// parse generated mach-o file into a MachOReader
-		ld::relocatable::File* machoFile = parseMachOFile((const uint8_t *)machOFile.Buffer, machOFile.Size, tmp_path, options, ordinal);
-		ordinal = ordinal.nextFileListOrdinal();
-
-		// Load the generated MachO file
-		loadMachO(machoFile, options, handler, newAtoms, additionalUndefines, llvmAtoms, deadllvmAtoms);
+		object.machoFile = parseMachOFile((const uint8_t *)object.buffer.Buffer, object.buffer.Size, object.path, options, object.ordinal);
+	});
+
+	// Load the generated MachO files in ordinal order, since that updates the resolver's state
+	for (const ThinLTOObject& object : objects) {
+		if ( object.writeErrno != 0 )
+			warning("could not write ThinLTO temp file '%s', errno=%d", object.path.c_str(), object.writeErrno);
+		loadMachO(object.machoFile, options, handler, newAtoms, additionalUndefines, llvmAtoms, deadllvmAtoms);
 	}
 
 	// Remove Atoms from ld if code generator optimized them away
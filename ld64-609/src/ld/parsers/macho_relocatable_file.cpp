@@ -42,6 +42,9 @@
 #include <set>
 #include <map>
 #include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <exception>
 #include <type_traits>
 
 #include "dwarf2.h"
@@ -50,6 +53,7 @@
 #include "Architectures.hpp"
 #include "Bitcode.hpp"
 #include "ld.hpp"
+#include "Parallel.h"
 #include "macho_relocatable_file.h"
 
 
@@ -74,12 +78,13 @@ class File : public ld::relocatable::File
 public:
 											File(const char* p, time_t mTime, const uint8_t* content, ld::File::Ordinal ord) :
 												ld::relocatable::File(p,mTime,ord), _fileContent(content),
-												_sectionsArray(NULL), _atomsArray(NULL),
+												_sectionsArray(NULL), _sectionsOverlap(false), _atomsArray(NULL),
 												_sectionsArrayCount(0), _atomsArrayCount(0), _aliasAtomsArrayCount(0),
 												_debugInfoKind(ld::relocatable::File::kDebugInfoNone),
 												_dwarfTranslationUnitPath(NULL), 
 												_dwarfDebugInfoSect(NULL), _dwarfDebugAbbrevSect(NULL), 
 												_dwarfDebugLineSect(NULL), _dwarfDebugStringSect(NULL), 
+												_dwarfStmtList((uint64_t)-1),
 												_hasObjC(false),
 												_swiftVersion(0),
 												_swiftLanguageVersion(0),
@@ -119,6 +124,10 @@ public:
 	virtual const std::vector<AstTimeAndPath>*			astFiles() const 				{ return &_astFiles; }
 
 	void										        setHasllvmProfiling()			{ _hasllvmProfiling = true; }
+
+	// line info is decoded from __debug_line the first time any atom's line info is asked for
+	ld::Atom::LineInfo::iterator						lineInfoBegin(const Atom<A>* atom) const;
+	ld::Atom::LineInfo::iterator						lineInfoEnd(const Atom<A>* atom) const;
 private:
 	friend class Atom<A>;
 	friend class Section<A>;
@@ -126,9 +135,20 @@ private:
 	friend class CFISection<A>::OAS;
 
 	typedef typename A::P					P;
-	
+	typedef typename A::P::uint_t			pint_t;
+
+	void									decodeLineInfo() const;
+	Atom<A>*								lineInfoAtomForAddress(pint_t addr, bool nullIfStub) const;
+	void									indexSections(const macho_section<P>* machOSections, uint32_t machOSectionCount);
+	Section<A>*								sectionForAddress(pint_t addr) const;
+	Section<A>*								sectionForNum(unsigned int num) const;
+
 	const uint8_t*							_fileContent;
 	Section<A>**							_sectionsArray;
+	std::vector<Section<A>*>				_sectionsByAddress;			// sections with content, sorted by start address
+	std::vector<Section<A>*>				_emptySectionsByAddress;	// zero length sections, sorted by address
+	std::vector<Section<A>*>				_sectionsByNum;				// indexed by mach-o section number, NULL if not parsed
+	bool									_sectionsOverlap;
 	uint8_t*								_atomsArray;
 	uint8_t*								_aliasAtomsArray;
 	uint32_t								_sectionsArrayCount;
@@ -136,7 +156,9 @@ private:
 	uint32_t								_aliasAtomsArrayCount;
 	std::vector<ld::Fixup>					_fixups;
 	std::vector<ld::Atom::UnwindInfo>		_unwindInfos;
-	std::vector<ld::Atom::LineInfo>			_lineInfos;
+	mutable std::vector<ld::Atom::LineInfo>	_lineInfos;
+	mutable std::vector<uint32_t>			_lineInfoStarts;		// indexed by atom, one extra entry for the end
+	mutable std::once_flag					_lineInfoDecoded;
 	std::vector<ld::relocatable::File::Stab>_stabs;
 	std::vector<AstTimeAndPath>				_astFiles;
 	ld::relocatable::File::DebugInfoKind	_debugInfoKind;
@@ -146,6 +168,7 @@ private:
 	const macho_section<P>*					_dwarfDebugLineSect;
 	const macho_section<P>*					_dwarfDebugStringSect;
 	const macho_section<P>*					_dwarfDebugStringOffsSect;
+	uint64_t								_dwarfStmtList;
 	bool									_hasObjC;
 	uint8_t									_swiftVersion;
 	uint16_t								_swiftLanguageVersion;
@@ -189,7 +212,15 @@ public:
 														const struct Parser<A>::CFI_CU_InfoArrays&) = 0;
 	virtual void					makeFixups(class Parser<A>& parser, const struct Parser<A>::CFI_CU_InfoArrays&);
 	virtual bool					addRelocFixup(class Parser<A>& parser, const macho_relocation_info<P>*);
+	// sections using the default makeFixups() have it done in pieces, which Parser<A>::parse() spreads across threads
+	virtual bool					canSplitFixups() const		{ return true; }
+	const macho_relocation_info<P>*	relocations(class Parser<A>& parser);
+	void							makeRelocFixups(class Parser<A>& parser, uint32_t startReloc, uint32_t endReloc);
+	void							makeImplicitFixups(class Parser<A>& parser);
+	static bool						relocContinuesPair(const macho_relocation_info<P> relocs[], uint32_t index);
 	virtual unsigned long			contentHash(const class Atom<A>* atom, const ld::IndirectBindingTable& ind) const { return 0; }
+	// true if contentHash() only looks at the atom's bytes, so it can be computed while parsing
+	virtual bool					hashesContentOnly() const	{ return false; }
 	virtual bool					canCoalesceWith(const class Atom<A>* atom, const ld::Atom& rhs, 
 													const ld::IndirectBindingTable& ind) const { return false; }
 	virtual	bool					ignoreLabel(const char* label) const { return false; }
@@ -234,6 +265,7 @@ public:
 	virtual uint32_t	computeAtomCount(class Parser<A>& parser, struct Parser<A>::LabelAndCFIBreakIterator& it, const struct Parser<A>::CFI_CU_InfoArrays&);
 	virtual uint32_t	appendAtoms(class Parser<A>& parser, uint8_t* buffer, struct Parser<A>::LabelAndCFIBreakIterator& it, const struct Parser<A>::CFI_CU_InfoArrays&);
 	virtual void		makeFixups(class Parser<A>& parser, const struct Parser<A>::CFI_CU_InfoArrays&);
+	virtual bool		canSplitFixups() const		{ return false; }
 	virtual bool		addFollowOnFixups() const	{ return false; }
 
 
@@ -300,6 +332,7 @@ public:
 	virtual uint32_t		computeAtomCount(class Parser<A>& parser, struct Parser<A>::LabelAndCFIBreakIterator& it, const struct Parser<A>::CFI_CU_InfoArrays&) { return 0; }
 	virtual uint32_t		appendAtoms(class Parser<A>& parser, uint8_t* buffer, struct Parser<A>::LabelAndCFIBreakIterator& it, const struct Parser<A>::CFI_CU_InfoArrays&) { return 0; }
 	virtual void			makeFixups(class Parser<A>& parser, const struct Parser<A>::CFI_CU_InfoArrays&);
+	virtual bool			canSplitFixups() const		{ return false; }
 	virtual bool			addFollowOnFixups() const	{ return false; }
 	
 	struct Info {
@@ -343,6 +376,7 @@ public:
 										struct Parser<A>::LabelAndCFIBreakIterator& it, 
 										const struct Parser<A>::CFI_CU_InfoArrays&);
 	virtual void		makeFixups(class Parser<A>& parser, const struct Parser<A>::CFI_CU_InfoArrays&) {}
+	virtual bool		canSplitFixups() const		{ return false; }
 private:
 	typedef typename A::P::uint_t	pint_t;
 	typedef typename A::P			P;
@@ -367,6 +401,7 @@ public:
 										struct Parser<A>::LabelAndCFIBreakIterator& it, 
 										const struct Parser<A>::CFI_CU_InfoArrays&);
 	virtual void		makeFixups(class Parser<A>& parser, const struct Parser<A>::CFI_CU_InfoArrays&) {}
+	virtual bool		canSplitFixups() const		{ return false; }
 	virtual Atom<A>*	findAbsAtomForValue(typename A::P::uint_t);
 	
 private:
@@ -468,6 +503,7 @@ protected:
 	virtual	pint_t					elementSizeAtAddress(pint_t addr)		{ return 4; }
 	virtual ld::Atom::Combine		combine(Parser<A>&, pint_t)				{ return ld::Atom::combineByNameAndContent; }
 	virtual unsigned long			contentHash(const class Atom<A>* atom, const ld::IndirectBindingTable& ind) const;
+	virtual bool					hashesContentOnly() const				{ return true; }
 	virtual bool					canCoalesceWith(const class Atom<A>* atom, const ld::Atom& rhs, 
 													const ld::IndirectBindingTable& ind) const;
 	virtual	bool					ignoreLabel(const char* label) const;
@@ -488,6 +524,7 @@ protected:
 	virtual	pint_t					elementSizeAtAddress(pint_t addr)		{ return 8; }
 	virtual ld::Atom::Combine		combine(Parser<A>&, pint_t)				{ return ld::Atom::combineByNameAndContent; }
 	virtual unsigned long			contentHash(const class Atom<A>* atom, const ld::IndirectBindingTable& ind) const;
+	virtual bool					hashesContentOnly() const				{ return true; }
 	virtual bool					canCoalesceWith(const class Atom<A>* atom, const ld::Atom& rhs, 
 													const ld::IndirectBindingTable& ind) const;
 	virtual	bool					ignoreLabel(const char* label) const;
@@ -508,6 +545,7 @@ protected:
 	virtual	pint_t					elementSizeAtAddress(pint_t addr)		{ return 16; }
 	virtual ld::Atom::Combine		combine(Parser<A>&, pint_t)				{ return ld::Atom::combineByNameAndContent; }
 	virtual unsigned long			contentHash(const class Atom<A>* atom, const ld::IndirectBindingTable& ind) const;
+	virtual bool					hashesContentOnly() const				{ return true; }
 	virtual bool					canCoalesceWith(const class Atom<A>* atom, const ld::Atom& rhs, 
 													const ld::IndirectBindingTable& ind) const;
 	virtual	bool					ignoreLabel(const char* label) const;
@@ -525,6 +563,7 @@ protected:
 	typedef typename A::P			P;
 
 	virtual void					makeFixups(class Parser<A>& parser, const struct Parser<A>::CFI_CU_InfoArrays&);
+	virtual bool					canSplitFixups() const					{ return false; }
 	virtual ld::Atom::ContentType	contentType()							{ return ld::Atom::typeNonLazyPointer; }
 	virtual ld::Atom::Alignment		alignmentForAddress(pint_t addr)		{ return ld::Atom::Alignment(log2(sizeof(pint_t))); }
 	virtual const char*				unlabeledAtomName(Parser<A>&, pint_t)	{ return "non_lazy_ptr"; }
@@ -552,6 +591,7 @@ protected:
 	typedef typename A::P			P;
 
 	virtual void					makeFixups(class Parser<A>& parser, const struct Parser<A>::CFI_CU_InfoArrays&);
+	virtual bool					canSplitFixups() const					{ return false; }
 	virtual ld::Atom::ContentType	contentType()							{ return ld::Atom::typeTLVPointer; }
 	virtual ld::Atom::Alignment		alignmentForAddress(pint_t addr)		{ return ld::Atom::Alignment(log2(sizeof(pint_t))); }
 	virtual const char*				unlabeledAtomName(Parser<A>&, pint_t)	{ return "tlv_lazy_ptr"; }
@@ -715,6 +755,7 @@ protected:
 												struct Parser<A>::LabelAndCFIBreakIterator& it, pint_t addr);
 	virtual ld::Atom::Combine		combine(Parser<A>&, pint_t)				{ return ld::Atom::combineByNameAndContent; }
 	virtual unsigned long			contentHash(const class Atom<A>* atom, const ld::IndirectBindingTable& ind) const;
+	virtual bool					hashesContentOnly() const				{ return true; }
 	virtual bool					canCoalesceWith(const class Atom<A>* atom, const ld::Atom& rhs, 
 													const ld::IndirectBindingTable& ind) const;
 
@@ -733,6 +774,7 @@ protected:
 
 	virtual ld::Atom::Combine		combine(Parser<A>&, pint_t)				{ return ld::Atom::combineByNameAndContent; }
 	virtual unsigned long			contentHash(const class Atom<A>* atom, const ld::IndirectBindingTable& ind) const;
+	virtual bool					hashesContentOnly() const				{ return true; }
 	virtual bool					canCoalesceWith(const class Atom<A>* atom, const ld::Atom& rhs, 
 													const ld::IndirectBindingTable& ind) const;
 };
@@ -762,19 +804,17 @@ public:
 	virtual ld::Fixup::iterator					fixupsEnd()	const	{ return &machofile()._fixups[_fixupsStartIndex+_fixupsCount]; }
 	virtual ld::Atom::UnwindInfo::iterator		beginUnwind() const	{ return &machofile()._unwindInfos[_unwindInfoStartIndex]; }
 	virtual ld::Atom::UnwindInfo::iterator		endUnwind()	const	{ return &machofile()._unwindInfos[_unwindInfoStartIndex+_unwindInfoCount];  }
-	virtual ld::Atom::LineInfo::iterator		beginLineInfo() const{ return &machofile()._lineInfos[_lineInfoStartIndex]; }
-	virtual ld::Atom::LineInfo::iterator		endLineInfo() const { return &machofile()._lineInfos[_lineInfoStartIndex+_lineInfoCount];  }
+	virtual ld::Atom::LineInfo::iterator		beginLineInfo() const{ return machofile().lineInfoBegin(this); }
+	virtual ld::Atom::LineInfo::iterator		endLineInfo() const { return machofile().lineInfoEnd(this);  }
 	virtual void								setFile(const ld::File* f);
 
 private:
 
 	enum {	kFixupStartIndexBits = 32,
-			kLineInfoStartIndexBits = 32, 
 			kUnwindInfoStartIndexBits = 24,
 			kFixupCountBits = 24, 
-			kLineInfoCountBits = 12,
 			kUnwindInfoCountBits = 4
-		}; // must sum to 128
+		}; // must sum to no more than 128
 
 public:
 	// methods for all atoms from mach-o object file
@@ -783,9 +823,6 @@ public:
 			void								setFixupsRange(uint32_t s, uint32_t c);
 			void								setUnwindInfoRange(uint32_t s, uint32_t c);
 			void								extendUnwindInfoRange();
-			void								setLineInfoRange(uint32_t s, uint32_t c);
-			bool								roomForMoreLineInfoCount() { return (_lineInfoCount < ((1<<kLineInfoCountBits)-1)); }
-			void								incrementLineInfoCount() { assert(roomForMoreLineInfoCount()); ++_lineInfoCount; }
 			void								incrementFixupCount() { if (_fixupsCount == ((1 << kFixupCountBits)-1)) { throwf("too may fixups in %s", name()); } ++_fixupsCount; }
 			const uint8_t*						contentPointer() const;
 			uint32_t							fixupCount() const { return _fixupsCount; }
@@ -801,9 +838,9 @@ public:
 													bool dds, bool thumb, bool al, ld::Atom::Alignment a) 
 														: ld::Atom((ld::Section&)sct, d, c, s, ct, i, dds, thumb, al, a), 
 															_size(sz), _objAddress(addr), _name(nm), _hash(0), 
-															_fixupsStartIndex(0), _lineInfoStartIndex(0),
+															_fixupsStartIndex(0),
 															_unwindInfoStartIndex(0), _fixupsCount(0),  
-															_lineInfoCount(0), _unwindInfoCount(0) { }
+															_unwindInfoCount(0) { }
 												// construct via symbol table entry
 												Atom(Section<A>& sct, Parser<A>& parser, const macho_nlist<P>& sym, 
 																uint64_t sz, bool alias=false)
@@ -817,9 +854,9 @@ public:
 																parser.coldFromSymbol(sym)),
 															_size(sz), _objAddress(sym.n_value()), 
 															_name(parser.nameFromSymbol(sym)), _hash(0), 
-															_fixupsStartIndex(0), _lineInfoStartIndex(0),
+															_fixupsStartIndex(0),
 															_unwindInfoStartIndex(0), _fixupsCount(0),  
-															_lineInfoCount(0), _unwindInfoCount(0) { 
+															_unwindInfoCount(0) { 
 																// <rdar://problem/6783167> support auto-hidden weak symbols
 																if ( _scope == ld::Atom::scopeGlobal && 
 																		(sym.n_desc() & (N_WEAK_DEF|N_WEAK_REF)) == (N_WEAK_DEF|N_WEAK_REF) )
@@ -841,10 +878,8 @@ private:
 	mutable unsigned long						_hash;
 
 	uint64_t									_fixupsStartIndex		: kFixupStartIndexBits,
-												_lineInfoStartIndex		: kLineInfoStartIndexBits,			
 												_unwindInfoStartIndex	: kUnwindInfoStartIndexBits,
 												_fixupsCount			: kFixupCountBits,
-												_lineInfoCount			: kLineInfoCountBits,
 												_unwindInfoCount		: kUnwindInfoCountBits;
 												
 	static std::map<const ld::Atom*, const ld::File*> _s_fileOverride;
@@ -900,15 +935,6 @@ void Atom<A>::extendUnwindInfoRange()
 	_unwindInfoCount += 1;
 }
 
-template <typename A>
-void Atom<A>::setLineInfoRange(uint32_t startIndex, uint32_t count)
-{ 
-	assert((count < (1 << kLineInfoCountBits)) && "too many line infos");
-	assert((startIndex+count) < sect().file()._lineInfos.size() && "line info index out of range");
-	_lineInfoStartIndex = startIndex; 
-	_lineInfoCount = count; 
-}
-
 template <typename A>
 const uint8_t* Atom<A>::contentPointer() const
 {
@@ -1044,62 +1070,73 @@ public:
 #endif
 	};
 
+	// atoms' fixup counts are tallied when the lists are merged, see parse()
 	struct FixupInAtom {
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, Atom<A>* target) :
-			fixup(src.offsetInAtom, c, k, target), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, target), atom(src.atom) { }
 			
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, ld::Fixup::TargetBinding b, Atom<A>* target) :
-			fixup(src.offsetInAtom, c, k, b, target), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, b, target), atom(src.atom) { }
 			
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, bool wi, const char* name) :
-			fixup(src.offsetInAtom, c, k, wi, name), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, wi, name), atom(src.atom) { }
 					
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, ld::Fixup::TargetBinding b, const char* name) :
-			fixup(src.offsetInAtom, c, k, b, name), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, b, name), atom(src.atom) { }
 					
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, uint64_t addend) :
-			fixup(src.offsetInAtom, c, k, addend), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, addend), atom(src.atom) { }
 
 #if SUPPORT_ARCH_arm64e
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, ld::Fixup::AuthData authData) :
-			fixup(src.offsetInAtom, c, k, authData), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, authData), atom(src.atom) { }
 #endif
 
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k) :
-			fixup(src.offsetInAtom, c, k, (uint64_t)0), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, (uint64_t)0), atom(src.atom) { }
 
 		ld::Fixup		fixup;
 		Atom<A>*		atom;
 	};
 
+	// fixups go to the list of the parse task making them
+	static std::vector<FixupInAtom>*& currentFixupList() {
+		static thread_local std::vector<FixupInAtom>* sList = NULL;
+		return sList;
+	}
+	std::vector<FixupInAtom>& fixupList() {
+		assert(currentFixupList() != NULL && "fixup made outside of a parse task");
+		return *currentFixupList();
+	}
+
 	void addFixup(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, Atom<A>* target) { 
-		_allFixups.push_back(FixupInAtom(src, c, k, target)); 
+		fixupList().push_back(FixupInAtom(src, c, k, target)); 
 	}
 	
 	void addFixup(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, ld::Fixup::TargetBinding b, Atom<A>* target) { 
-		_allFixups.push_back(FixupInAtom(src, c, k, b, target)); 
+		fixupList().push_back(FixupInAtom(src, c, k, b, target)); 
 	}
 	
 	void addFixup(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, bool wi, const char* name) { 
-		_allFixups.push_back(FixupInAtom(src, c, k, wi, name)); 
+		fixupList().push_back(FixupInAtom(src, c, k, wi, name)); 
 	}
 	
 	void addFixup(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, ld::Fixup::TargetBinding b, const char* name) { 
-		_allFixups.push_back(FixupInAtom(src, c, k, b, name)); 
+		fixupList().push_back(FixupInAtom(src, c, k, b, name)); 
 	}
 	
 	void addFixup(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, uint64_t addend) { 
-		_allFixups.push_back(FixupInAtom(src, c, k, addend)); 
+		fixupList().push_back(FixupInAtom(src, c, k, addend)); 
 	}
 
 #if SUPPORT_ARCH_arm64e
 	void addFixup(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, ld::Fixup::AuthData authData) {
-		_allFixups.push_back(FixupInAtom(src, c, k, authData));
+		fixupList().push_back(FixupInAtom(src, c, k, authData));
 	}
 #endif
 
 	void addFixup(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k) { 
-		_allFixups.push_back(FixupInAtom(src, c, k)); 
+		fixupList().push_back(FixupInAtom(src, c, k)); 
 	}
 
 	const char*										path() { return _path; }
@@ -1123,13 +1160,13 @@ public:
 	uint32_t										machOSectionCount() { return _machOSectionsCount; }
 	uint32_t										undefinedStartIndex() { return _undefinedStartIndex; }
 	uint32_t										undefinedEndIndex() { return _undefinedEndIndex; }
-	void											addFixup(FixupInAtom f) { _allFixups.push_back(f); }
+	void											addFixup(FixupInAtom f) { fixupList().push_back(f); }
 	Section<A>*										sectionForNum(unsigned int sectNum);
 	Section<A>*										sectionForAddress(pint_t addr);
 	Atom<A>*										findAtomByAddress(pint_t addr);
 	Atom<A>*										findAtomByAddressOrNullIfStub(pint_t addr);
 	Atom<A>*										findAtomByAddressOrLocalTargetOfStub(pint_t addr, uint32_t* offsetInAtom);
-	Atom<A>*										findAtomByName(const char* name);	// slow!
+	Atom<A>*										findAtomByName(const char* name);
 	void											findTargetFromAddress(pint_t addr, TargetDesc& target);
 	void											findTargetFromAddress(pint_t baseAddr, pint_t addr, TargetDesc& target);
 	void											findTargetFromAddressAndSectionNum(pint_t addr, unsigned int sectNum,
@@ -1229,6 +1266,16 @@ private:
 	};
 	
 	struct ParserAndSectionsArray { Parser* parser; const uint32_t* sortedSectionsArray; };
+
+	// a piece of the work done after atoms are made, see parse()
+	struct FixupTask {
+		enum Kind { kindSection, kindRelocs, kindImplicit, kindDebugInfo };
+		Kind			kind;
+		Section<A>*		section;
+		uint32_t		startReloc;
+		uint32_t		endReloc;
+	};
+	static const uint32_t							kRelocsPerFixupTask = 16384;
 	
 
 													Parser(const uint8_t* fileContent, uint64_t fileLength, 
@@ -1236,7 +1283,10 @@ private:
 															bool warnUnwindConversionProblems, bool keepDwarfUnwind,
 															bool forceDwarfConversion, bool neverConvertDwarf,
 															bool verboseOptimizationHints);
+	typedef std::unordered_map<const char*, Atom<A>*, ld::CStringHash, ld::CStringEquals> CStringToAtom;
+
 	ld::relocatable::File*							parse(const ParserOptions& opts);
+	const CStringToAtom&							atomsByName();
 	static uint8_t									loadCommandSizeMask();
 	bool											parseLoadCommands(const ld::VersionSet& platforms, bool internalSDK);
 	void											makeSections();
@@ -1314,7 +1364,8 @@ private:
 	unsigned int								_stubsSectionNum;
 	const macho_section<P>*						_stubsMachOSection;
 	std::vector<const char*>					_dtraceProviderInfo;
-	std::vector<FixupInAtom>					_allFixups;
+	CStringToAtom								_atomsByName;
+	std::once_flag								_atomsByNameBuilt;
 #if SUPPORT_ARCH_arm64e
 	bool										_supportsAuthenticatedPointers;
 #endif
@@ -1828,6 +1879,16 @@ typename A::P::uint_t Parser<A>::realAddr(typename A::P::uint_t addr)
 		_name = _name##_buffer;
 
 
+// passed to contentHash() of sections whose hashes don't look up symbols (see Section<A>::hashesContentOnly())
+class NoIndirectBindings : public ld::IndirectBindingTable
+{
+public:
+	virtual const char*			indirectName(uint32_t) const	{ return NULL; }
+	virtual const ld::Atom*		indirectAtom(uint32_t) const	{ return NULL; }
+};
+static const NoIndirectBindings sNoIndirectBindings;
+
+
 template <typename A>
 ld::relocatable::File* Parser<A>::parse(const ParserOptions& opts)
 {
@@ -1989,16 +2050,105 @@ ld::relocatable::File* Parser<A>::parse(const ParserOptions& opts)
 		breakIterator2.beginSection();
 		uint32_t count = sections[i]->appendAtoms(*this, atoms, breakIterator2, cfis);
 		//fprintf(stderr, "append count=%u for section %s/%s\n", count, sections[i]->machoSection()->segname(), sections[i]->machoSection()->sectname());
+		// hash literals now, while files are parsed in parallel, so coalescing them only probes the symbol table
+		if ( sections[i]->hashesContentOnly() ) {
+			Atom<A>* sectionAtoms = (Atom<A>*)atoms;
+			for (uint32_t j=0; j < count; ++j)
+				sectionAtoms[j].contentHash(sNoIndirectBindings);
+		}
 		_file->_atomsArrayCount += count;
 	}
 	assert( _file->_atomsArrayCount == computedAtomCount && "more atoms allocated than expected");
 
 	
-	// have each section add all fix-ups for its atoms
-	_allFixups.reserve(computedAtomCount*5);
-	for (uint32_t i=0; i < sectionsCount; ++i )
-		sections[i]->makeFixups(*this, cfis);
-	
+	// have each section add all fix-ups for its atoms.  Relocations are parsed in ranges, and debug
+	// info alongside them, so a single huge object file is spread across threads.  Each task collects
+	// fixups in its own list, and the lists are merged in task order, so every atom gets its fixups
+	// in the same order as parsing one section after another would give.
+	std::vector<FixupTask> fixupTasks;
+	uint64_t relocTotal = 0;
+	for (uint32_t i=0; i < sectionsCount; ++i ) {
+		Section<A>* section = sections[i];
+		if ( !section->canSplitFixups() ) {
+			fixupTasks.push_back({ FixupTask::kindSection, section, 0, 0 });
+			continue;
+		}
+		const macho_relocation_info<P>* relocs = section->relocations(*this);
+		const uint32_t relocCount = section->machoSection()->nreloc();
+		relocTotal += relocCount;
+		for (uint32_t startReloc=0; startReloc < relocCount; ) {
+			uint32_t endReloc = ((relocCount - startReloc) > kRelocsPerFixupTask) ? (startReloc + kRelocsPerFixupTask) : relocCount;
+			// a range can't start with the second half of a relocation pair
+			while ( (endReloc < relocCount) && Section<A>::relocContinuesPair(relocs, endReloc) )
+				++endReloc;
+			fixupTasks.push_back({ FixupTask::kindRelocs, section, startReloc, endReloc });
+			startReloc = endReloc;
+		}
+		fixupTasks.push_back({ FixupTask::kindImplicit, section, 0, 0 });
+	}
+	fixupTasks.push_back({ FixupTask::kindDebugInfo, NULL, 0, 0 });
+
+	std::vector<std::vector<FixupInAtom>> taskFixups(fixupTasks.size());
+	std::vector<ld::parallel::WarningBuffer> taskWarnings(fixupTasks.size());
+	std::vector<std::exception_ptr> taskErrors(fixupTasks.size());
+	auto runFixupTask = [&](size_t index) {
+		const FixupTask& task = fixupTasks[index];
+		std::vector<FixupInAtom>*& currentList = currentFixupList();
+		std::vector<FixupInAtom>* outerList = currentList;
+		currentList = &taskFixups[index];
+		ld::parallel::WarningBuffer*& currentWarnings = ld::parallel::currentWarnings();
+		ld::parallel::WarningBuffer* outerWarnings = currentWarnings;
+		currentWarnings = &taskWarnings[index];
+		try {
+			switch ( task.kind ) {
+				case FixupTask::kindSection:
+					task.section->makeFixups(*this, cfis);
+					break;
+				case FixupTask::kindRelocs:
+					task.section->makeRelocFixups(*this, task.startReloc, task.endReloc);
+					break;
+				case FixupTask::kindImplicit:
+					task.section->makeImplicitFixups(*this);
+					break;
+				case FixupTask::kindDebugInfo:
+					// parse dwarf debug info to get line info
+					this->parseDebugInfo();
+					break;
+			}
+		}
+		catch (...) {
+			taskErrors[index] = std::current_exception();
+		}
+		currentWarnings = outerWarnings;
+		currentList = outerList;
+	};
+	if ( relocTotal < kRelocsPerFixupTask ) {
+		// not worth starting threads for
+		for (size_t i=0; i < fixupTasks.size(); ++i) {
+			runFixupTask(i);
+			if ( taskErrors[i] )
+				break;
+		}
+	}
+	else {
+		ld::parallel::forEach(fixupTasks.size(), runFixupTask);
+	}
+	// print warnings in task order, and report the same error a serial parse would have stopped at
+	for (size_t i=0; i < fixupTasks.size(); ++i) {
+		for (const std::string& message : taskWarnings[i])
+			warning("%s", message.c_str());
+		if ( taskErrors[i] )
+			std::rethrow_exception(taskErrors[i]);
+	}
+
+	// count fixups for each atom
+	size_t fixupCount = 0;
+	for (const std::vector<FixupInAtom>& list : taskFixups) {
+		for (const FixupInAtom& f : list)
+			f.atom->incrementFixupCount();
+		fixupCount += list.size();
+	}
+
 	// assign fixups start offset for each atom
 	uint8_t* p = _file->_atomsArray;
 	uint32_t fixupOffset = 0;
@@ -2009,18 +2159,17 @@ ld::relocatable::File* Parser<A>::parse(const ParserOptions& opts)
 		atom->_fixupsCount = 0;
 		p += sizeof(Atom<A>);
 	}
-	assert(fixupOffset == _allFixups.size());
+	assert(fixupOffset == fixupCount);
 	_file->_fixups.resize(fixupOffset);
 	
 	// copy each fixup for each atom 
-	for(typename std::vector<FixupInAtom>::iterator it=_allFixups.begin(); it != _allFixups.end(); ++it) {
-		uint32_t slot = it->atom->_fixupsStartIndex + it->atom->_fixupsCount;
-		_file->_fixups[slot] = it->fixup;
-		it->atom->_fixupsCount++;
+	for (const std::vector<FixupInAtom>& list : taskFixups) {
+		for (const FixupInAtom& f : list) {
+			uint32_t slot = f.atom->_fixupsStartIndex + f.atom->_fixupsCount;
+			_file->_fixups[slot] = f.fixup;
+			f.atom->_fixupsCount++;
+		}
 	}
-	
-	// done with temp vector
-	_allFixups.clear();
 
 	// add unwind info
 	_file->_unwindInfos.reserve(countOfFDEs+countOfCUs);
@@ -2076,10 +2225,6 @@ ld::relocatable::File* Parser<A>::parse(const ParserOptions& opts)
 		_file->_aliasAtomsArray = new uint8_t[_file->_aliasAtomsArrayCount*sizeof(AliasAtom)];
 		this->appendAliasAtoms(_file->_aliasAtomsArray);
 	}
-	
-	
-	// parse dwarf debug info to get line info
-	this->parseDebugInfo();
 
 	return _file;
 }
@@ -2905,48 +3050,26 @@ void Parser<A>::makeSections()
 				throw "internal error uknown SectionType";
 		}
 	}
+	_file->indexSections(_sectionsStart, _machOSectionsCount);
 }
 
 
 template <typename A>
 Section<A>* Parser<A>::sectionForAddress(typename A::P::uint_t addr)
 {
-	for (uint32_t i=0; i < _file->_sectionsArrayCount; ++i ) {
-		const macho_section<typename A::P>* sect = _file->_sectionsArray[i]->machoSection();
-		// TentativeDefinitionSection and AbsoluteSymbolSection have no mach-o section
-		if ( sect != NULL ) {
-			if ( (sect->addr() <= addr) && (addr < (sect->addr()+sect->size())) ) {
-				return _file->_sectionsArray[i];
-			}
-		}
-	}
-	// not strictly in any section
-	// may be in a zero length section
-	for (uint32_t i=0; i < _file->_sectionsArrayCount; ++i ) {
-		const macho_section<typename A::P>* sect = _file->_sectionsArray[i]->machoSection();
-		// TentativeDefinitionSection and AbsoluteSymbolSection have no mach-o section
-		if ( sect != NULL ) {
-			if ( (sect->addr() == addr) && (sect->size() == 0) ) {
-				return _file->_sectionsArray[i];
-			}
-		}
-	}
-	
-	throwf("sectionForAddress(0x%llX) address not in any section", (uint64_t)addr);
+	Section<A>* section = _file->sectionForAddress(addr);
+	if ( section == NULL )
+		throwf("sectionForAddress(0x%llX) address not in any section", (uint64_t)addr);
+	return section;
 }
 
 template <typename A>
 Section<A>* Parser<A>::sectionForNum(unsigned int num)
 {
-	for (uint32_t i=0; i < _file->_sectionsArrayCount; ++i ) {
-		const macho_section<typename A::P>* sect = _file->_sectionsArray[i]->machoSection();
-		// TentativeDefinitionSection and AbsoluteSymbolSection have no mach-o section
-		if ( sect != NULL ) {
-			if ( num == (unsigned int)((sect - _sectionsStart)+1) )
-				return _file->_sectionsArray[i];
-		}
-	}
-	throwf("sectionForNum(%u) section number not for any section", num);
+	Section<A>* section = _file->sectionForNum(num);
+	if ( section == NULL )
+		throwf("sectionForNum(%u) section number not for any section", num);
+	return section;
 }
 
 template <typename A>
@@ -2982,16 +3105,31 @@ Atom<A>* Parser<A>::findAtomByAddressOrLocalTargetOfStub(pint_t addr, uint32_t*
 	return target;
 }
 
+template <typename A>
+const typename Parser<A>::CStringToAtom& Parser<A>::atomsByName()
+{
+	// built on first use, after all atoms are made, so files that never look up by name pay nothing
+	// (once only, because parse tasks on several threads may ask at the same time)
+	std::call_once(_atomsByNameBuilt, [this]() {
+		_atomsByName.reserve(_file->_atomsArrayCount);
+		uint8_t* p = _file->_atomsArray;
+		for(int i=_file->_atomsArrayCount; i > 0; --i) {
+			Atom<A>* atom = (Atom<A>*)p;
+			// first atom with a given name wins, same as the linear scan this replaced
+			_atomsByName.insert({ atom->name(), atom });
+			p += sizeof(Atom<A>);
+		}
+	});
+	return _atomsByName;
+}
+
 template <typename A>
 Atom<A>* Parser<A>::findAtomByName(const char* name)
 {
-	uint8_t* p = _file->_atomsArray;
-	for(int i=_file->_atomsArrayCount; i > 0; --i) {
-		Atom<A>* atom = (Atom<A>*)p;
-		if ( strcmp(name, atom->name()) == 0 )
-			return atom;
-		p += sizeof(Atom<A>);
-	}
+	const CStringToAtom& atomMap = this->atomsByName();
+	typename CStringToAtom::const_iterator pos = atomMap.find(name);
+	if ( pos != atomMap.end() )
+		return pos->second;
 	return NULL;
 }
 
@@ -3825,13 +3963,6 @@ uint64_t Parser<A>::getDwarfOffset(uint64_t form, const uint8_t*& di, bool dwarf
 }
 
 
-template <typename A>
-struct AtomAndLineInfo {
-	Atom<A>*			atom;
-	ld::Atom::LineInfo	info;
-};
-
-
 // <rdar://problem/5591394> Add support to ld64 for N_FUN stabs when used for symbolic constants
 // Returns whether a stabStr belonging to an N_FUN stab represents a
 // symbolic constant rather than a function
@@ -3887,151 +4018,253 @@ void Parser<A>::parseDebugInfo()
 		_file->_dwarfTranslationUnitPath = NULL;
 	}
 	
+	// line number info is only decoded if something asks for it
+	_file->_dwarfStmtList = stmtList;
+}
+
+template <typename A>
+ld::Atom::LineInfo::iterator File<A>::lineInfoBegin(const Atom<A>* atom) const
+{
+	std::call_once(_lineInfoDecoded, [this]() { this->decodeLineInfo(); });
+	if ( _lineInfos.empty() )
+		return NULL;
+	const size_t atomIndex = ((const uint8_t*)atom - _atomsArray) / sizeof(Atom<A>);
+	return (ld::Atom::LineInfo::iterator)&_lineInfos.data()[_lineInfoStarts[atomIndex]];
+}
+
+template <typename A>
+ld::Atom::LineInfo::iterator File<A>::lineInfoEnd(const Atom<A>* atom) const
+{
+	std::call_once(_lineInfoDecoded, [this]() { this->decodeLineInfo(); });
+	if ( _lineInfos.empty() )
+		return NULL;
+	const size_t atomIndex = ((const uint8_t*)atom - _atomsArray) / sizeof(Atom<A>);
+	return (ld::Atom::LineInfo::iterator)&_lineInfos.data()[_lineInfoStarts[atomIndex+1]];
+}
+
+template <typename A>
+void File<A>::indexSections(const macho_section<P>* machOSections, uint32_t machOSectionCount)
+{
+	_sectionsByNum.assign(machOSectionCount+1, NULL);
+	for (uint32_t i=0; i < _sectionsArrayCount; ++i ) {
+		Section<A>* section = _sectionsArray[i];
+		const macho_section<P>* sect = section->machoSection();
+		// TentativeDefinitionSection and AbsoluteSymbolSection have no mach-o section
+		if ( sect == NULL )
+			continue;
+		if ( sect->size() != 0 )
+			_sectionsByAddress.push_back(section);
+		else
+			_emptySectionsByAddress.push_back(section);
+		_sectionsByNum[(sect - machOSections)+1] = section;
+	}
+	// stable, so the first of any sections at the same address is found, as with a linear scan
+	auto byAddress = [](const Section<A>* left, const Section<A>* right) { return left->machoSection()->addr() < right->machoSection()->addr(); };
+	std::stable_sort(_sectionsByAddress.begin(), _sectionsByAddress.end(), byAddress);
+	std::stable_sort(_emptySectionsByAddress.begin(), _emptySectionsByAddress.end(), byAddress);
+	_sectionsOverlap = false;
+	for (size_t i=1; i < _sectionsByAddress.size(); ++i) {
+		const macho_section<P>* prev = _sectionsByAddress[i-1]->machoSection();
+		if ( _sectionsByAddress[i]->machoSection()->addr() < (prev->addr()+prev->size()) )
+			_sectionsOverlap = true;
+	}
+}
+
+template <typename A>
+Section<A>* File<A>::sectionForAddress(pint_t addr) const
+{
+	if ( _sectionsOverlap ) {
+		// malformed file, the first section in _sectionsArray containing addr wins, as it always has
+		for (uint32_t i=0; i < _sectionsArrayCount; ++i ) {
+			const macho_section<P>* sect = _sectionsArray[i]->machoSection();
+			// TentativeDefinitionSection and AbsoluteSymbolSection have no mach-o section
+			if ( (sect != NULL) && (sect->addr() <= addr) && (addr < (sect->addr()+sect->size())) )
+				return _sectionsArray[i];
+		}
+	}
+	else {
+		// last section starting at or before addr
+		auto pos = std::upper_bound(_sectionsByAddress.begin(), _sectionsByAddress.end(), addr,
+									[](pint_t a, const Section<A>* section) { return a < section->machoSection()->addr(); });
+		if ( pos != _sectionsByAddress.begin() ) {
+			const macho_section<P>* sect = (*(pos-1))->machoSection();
+			if ( addr < (sect->addr()+sect->size()) )
+				return *(pos-1);
+		}
+	}
+	// not strictly in any section, may be in a zero length section
+	auto emptyPos = std::lower_bound(_emptySectionsByAddress.begin(), _emptySectionsByAddress.end(), addr,
+									 [](const Section<A>* section, pint_t a) { return section->machoSection()->addr() < a; });
+	if ( (emptyPos != _emptySectionsByAddress.end()) && ((*emptyPos)->machoSection()->addr() == addr) )
+		return *emptyPos;
+	return NULL;
+}
+
+template <typename A>
+Section<A>* File<A>::sectionForNum(unsigned int num) const
+{
+	if ( num < _sectionsByNum.size() )
+		return _sectionsByNum[num];
+	return NULL;
+}
+
+template <typename A>
+Atom<A>* File<A>::lineInfoAtomForAddress(pint_t addr, bool nullIfStub) const
+{
+	// same look up as Parser<A>::findAtomByAddress(), but the parser is gone by the time line info is decoded
+	Section<A>* section = this->sectionForAddress(addr);
+	if ( section == NULL )
+		throwf("sectionForAddress(0x%llX) address not in any section", (uint64_t)addr);
+	if ( nullIfStub && (section->machoSection()->size() != 0) && ((section->machoSection()->flags() & SECTION_TYPE) == S_SYMBOL_STUBS) )
+		return NULL;
+	return section->findAtomByAddress(addr);
+}
+
+template <typename A>
+void File<A>::decodeLineInfo() const
+{
+	if ( _debugInfoKind != ld::relocatable::File::kDebugInfoDwarf )
+		return;
+	// file with just data will have no __debug_line info
+	if ( (_dwarfDebugLineSect == NULL) || (_dwarfDebugLineSect->size() == 0) )
+		return;
+	// validate stmt_list
+	if ( (_dwarfStmtList == (uint64_t)-1) || (_dwarfStmtList >= _dwarfDebugLineSect->size()) )
+		return;
+
 	// add line number info to atoms from dwarf
-	std::vector<AtomAndLineInfo<A> > entries;
+	const uint32_t maxLineInfosPerAtom = (1 << 12) - 1;
+	std::vector<std::pair<uint32_t, ld::Atom::LineInfo> > entries;
+	std::vector<uint32_t> counts(_atomsArrayCount, 0);
 	entries.reserve(64);
-	if ( _file->_debugInfoKind == ld::relocatable::File::kDebugInfoDwarf ) {
-		// file with just data will have no __debug_line info
-		if ( (_file->_dwarfDebugLineSect != NULL) && (_file->_dwarfDebugLineSect->size() != 0) ) {
-			// validate stmt_list
-			if ( (stmtList != (uint64_t)-1) && (stmtList < _file->_dwarfDebugLineSect->size()) ) {
-				const uint8_t* debug_line = (uint8_t*)_file->fileContent() + _file->_dwarfDebugLineSect->offset();
-				struct line_reader_data* lines = line_open(&debug_line[stmtList],
-														_file->_dwarfDebugLineSect->size() - stmtList, E::little_endian);
-				struct line_info result;
-				Atom<A>* curAtom = NULL;
-				uint32_t curAtomOffset = 0;
-				uint32_t curAtomAddress = 0;
-				uint32_t curAtomSize = 0;
-				std::map<uint32_t,const char*>	dwarfIndexToFile;
-				if ( lines != NULL ) {
-					while ( line_next(lines, &result, line_stop_pc) ) {
-						//fprintf(stderr, "curAtom=%p, result.pc=0x%llX, result.line=%llu, result.end_of_sequence=%d,"
-						//				  " curAtomAddress=0x%X, curAtomSize=0x%X\n",
-						//		curAtom, result.pc, result.line, result.end_of_sequence, curAtomAddress, curAtomSize);
-						// work around weird debug line table compiler generates if no functions in __text section
-						if ( (curAtom == NULL) && (result.pc == 0) && result.end_of_sequence && (result.file == 1))
-							continue;
-						// for performance, see if in next pc is in current atom
-						if ( (curAtom != NULL) && (curAtomAddress <= result.pc) && (result.pc < (curAtomAddress+curAtomSize)) ) {
-							curAtomOffset = result.pc - curAtomAddress;
-						}
-						// or pc at end of current atom
-						else if ( result.end_of_sequence && (curAtom != NULL) && (result.pc == (curAtomAddress+curAtomSize)) ) {
-							curAtomOffset = result.pc - curAtomAddress;
-						}
-						// or only one function that is a one line function
-						else if ( result.end_of_sequence && (curAtom == NULL) && (this->findAtomByAddress(0) != NULL) && (result.pc == this->findAtomByAddress(0)->size()) ) {
-							curAtom			= this->findAtomByAddress(0);
-							curAtomOffset	= result.pc - curAtom->objectAddress();
-							curAtomAddress	= curAtom->objectAddress();
-							curAtomSize		= curAtom->size();
-						}
-						else {
-							// do slow look up of atom by address
-							try {
-								curAtom = this->findAtomByAddress(result.pc);
-							}
-							catch (...) {
-								// in case of bug in debug info, don't abort link, just limp on
-								curAtom = NULL;
-							}
-							if ( curAtom == NULL )
-								break; // file has line info but no functions
-							if ( result.end_of_sequence && (curAtomAddress+curAtomSize < result.pc) ) {	
-								// a one line function can be returned by line_next() as one entry with pc at end of blob
-								// look for alt atom starting at end of previous atom
-								uint32_t previousEnd = curAtomAddress+curAtomSize;
-								Atom<A>* alt = this->findAtomByAddressOrNullIfStub(previousEnd);
-								if ( alt == NULL )
-									continue; // ignore spurious debug info for stubs
-								if ( result.pc <= alt->objectAddress() + alt->size() ) {
-									curAtom			= alt;
-									curAtomOffset	= result.pc - alt->objectAddress();
-									curAtomAddress	= alt->objectAddress();
-									curAtomSize		= alt->size();
-								}
-								else {
-									curAtomOffset	= result.pc - curAtom->objectAddress();
-									curAtomAddress	= curAtom->objectAddress();
-									curAtomSize		= curAtom->size();
-								}
-							}
-							else {
-								curAtomOffset	= result.pc - curAtom->objectAddress();
-								curAtomAddress	= curAtom->objectAddress();
-								curAtomSize		= curAtom->size();
-							}
-						}
-						const char* filename;
-						std::map<uint32_t,const char*>::iterator pos = dwarfIndexToFile.find(result.file);
-						if ( pos == dwarfIndexToFile.end() ) {
-							filename = line_file(lines, result.file);
-							dwarfIndexToFile[result.file] = filename;
-						}
-						else {
-							filename = pos->second;
-						}
-						// only record for ~8000 line info records per function
-						if ( curAtom->roomForMoreLineInfoCount() ) {
-							AtomAndLineInfo<A> entry;
-							entry.atom = curAtom;
-							entry.info.atomOffset = curAtomOffset;
-							entry.info.fileName = filename;
-							entry.info.lineNumber = result.line;
-							//fprintf(stderr, "addr=0x%08llX, line=%lld, file=%s, atom=%s, atom.size=0x%X, end=%d\n", 
-							//		result.pc, result.line, filename, curAtom->name(), curAtomSize, result.end_of_sequence);
-							entries.push_back(entry);
-							curAtom->incrementLineInfoCount();
-						}
-						if ( result.end_of_sequence ) {
-							curAtom = NULL;
-						}
+	const uint8_t* debug_line = _fileContent + _dwarfDebugLineSect->offset();
+	struct line_reader_data* lines = line_open(&debug_line[_dwarfStmtList],
+											_dwarfDebugLineSect->size() - _dwarfStmtList, P::E::little_endian);
+	if ( lines == NULL )
+		return;
+	try {
+		struct line_info result;
+		Atom<A>* curAtom = NULL;
+		uint32_t curAtomOffset = 0;
+		uint32_t curAtomAddress = 0;
+		uint32_t curAtomSize = 0;
+		std::map<uint32_t,const char*>	dwarfIndexToFile;
+		while ( line_next(lines, &result, line_stop_pc) ) {
+			//fprintf(stderr, "curAtom=%p, result.pc=0x%llX, result.line=%llu, result.end_of_sequence=%d,"
+			//				  " curAtomAddress=0x%X, curAtomSize=0x%X\n",
+			//		curAtom, result.pc, result.line, result.end_of_sequence, curAtomAddress, curAtomSize);
+			// work around weird debug line table compiler generates if no functions in __text section
+			if ( (curAtom == NULL) && (result.pc == 0) && result.end_of_sequence && (result.file == 1))
+				continue;
+			// for performance, see if in next pc is in current atom
+			if ( (curAtom != NULL) && (curAtomAddress <= result.pc) && (result.pc < (curAtomAddress+curAtomSize)) ) {
+				curAtomOffset = result.pc - curAtomAddress;
+			}
+			// or pc at end of current atom
+			else if ( result.end_of_sequence && (curAtom != NULL) && (result.pc == (curAtomAddress+curAtomSize)) ) {
+				curAtomOffset = result.pc - curAtomAddress;
+			}
+			// or only one function that is a one line function
+			else if ( result.end_of_sequence && (curAtom == NULL) && (this->lineInfoAtomForAddress(0, false) != NULL) && (result.pc == this->lineInfoAtomForAddress(0, false)->size()) ) {
+				curAtom			= this->lineInfoAtomForAddress(0, false);
+				curAtomOffset	= result.pc - curAtom->objectAddress();
+				curAtomAddress	= curAtom->objectAddress();
+				curAtomSize		= curAtom->size();
+			}
+			else {
+				// do slow look up of atom by address
+				try {
+					curAtom = this->lineInfoAtomForAddress(result.pc, false);
+				}
+				catch (...) {
+					// in case of bug in debug info, don't abort link, just limp on
+					curAtom = NULL;
+				}
+				if ( curAtom == NULL )
+					break; // file has line info but no functions
+				if ( result.end_of_sequence && (curAtomAddress+curAtomSize < result.pc) ) {	
+					// a one line function can be returned by line_next() as one entry with pc at end of blob
+					// look for alt atom starting at end of previous atom
+					uint32_t previousEnd = curAtomAddress+curAtomSize;
+					Atom<A>* alt = this->lineInfoAtomForAddress(previousEnd, true);
+					if ( alt == NULL )
+						continue; // ignore spurious debug info for stubs
+					if ( result.pc <= alt->objectAddress() + alt->size() ) {
+						curAtom			= alt;
+						curAtomOffset	= result.pc - alt->objectAddress();
+						curAtomAddress	= alt->objectAddress();
+						curAtomSize		= alt->size();
+					}
+					else {
+						curAtomOffset	= result.pc - curAtom->objectAddress();
+						curAtomAddress	= curAtom->objectAddress();
+						curAtomSize		= curAtom->size();
 					}
-					line_free(lines);
 				}
+				else {
+					curAtomOffset	= result.pc - curAtom->objectAddress();
+					curAtomAddress	= curAtom->objectAddress();
+					curAtomSize		= curAtom->size();
+				}
+			}
+			const char* filename;
+			std::map<uint32_t,const char*>::iterator pos = dwarfIndexToFile.find(result.file);
+			if ( pos == dwarfIndexToFile.end() ) {
+				filename = line_file(lines, result.file);
+				dwarfIndexToFile[result.file] = filename;
+			}
+			else {
+				filename = pos->second;
+			}
+			// only record for ~8000 line info records per function
+			const uint32_t atomIndex = (uint32_t)(((uint8_t*)curAtom - _atomsArray) / sizeof(Atom<A>));
+			if ( counts[atomIndex] < maxLineInfosPerAtom ) {
+				ld::Atom::LineInfo info;
+				info.atomOffset = curAtomOffset;
+				info.fileName = filename;
+				info.lineNumber = result.line;
+				//fprintf(stderr, "addr=0x%08llX, line=%lld, file=%s, atom=%s, atom.size=0x%X, end=%d\n", 
+				//		result.pc, result.line, filename, curAtom->name(), curAtomSize, result.end_of_sequence);
+				entries.push_back(std::make_pair(atomIndex, info));
+				++counts[atomIndex];
+			}
+			if ( result.end_of_sequence ) {
+				curAtom = NULL;
 			}
 		}
 	}
-		
+	catch (const char* msg) {
+		// line info is only used for debug notes, so a bad line table should not fail the link
+		warning("can't parse dwarf line info in %s: %s", this->path(), msg);
+	}
+	line_free(lines);
+	if ( entries.empty() )
+		return;
+
 	// assign line info start offset for each atom
-	uint8_t* p = _file->_atomsArray;
+	_lineInfoStarts.resize(_atomsArrayCount+1);
 	uint32_t liOffset = 0;
-	for(int i=_file->_atomsArrayCount; i > 0; --i) {
-		Atom<A>* atom = (Atom<A>*)p;
-		atom->_lineInfoStartIndex = liOffset;
-		liOffset += atom->_lineInfoCount;
-		atom->_lineInfoCount = 0;
-		p += sizeof(Atom<A>);
+	for (uint32_t i=0; i < _atomsArrayCount; ++i) {
+		_lineInfoStarts[i] = liOffset;
+		liOffset += counts[i];
+		counts[i] = 0;
 	}
+	_lineInfoStarts[_atomsArrayCount] = liOffset;
 	assert(liOffset == entries.size());
-	_file->_lineInfos.resize(liOffset);
+	_lineInfos.resize(liOffset);
 
 	// copy each line info for each atom 
-	for (typename std::vector<AtomAndLineInfo<A> >::iterator it = entries.begin(); it != entries.end(); ++it) {
-		uint32_t slot = it->atom->_lineInfoStartIndex + it->atom->_lineInfoCount;
-		_file->_lineInfos[slot] = it->info;
-		it->atom->_lineInfoCount++;
+	for (const std::pair<uint32_t, ld::Atom::LineInfo>& entry : entries) {
+		uint32_t slot = _lineInfoStarts[entry.first] + counts[entry.first];
+		_lineInfos[slot] = entry.second;
+		++counts[entry.first];
 	}
-	
-	// done with temp vector
-	entries.clear();
 }
 
 template <typename A>
 void Parser<A>::parseStabs()
 {
-	typedef std::unordered_map<const char*, Atom<A>*, ld::CStringHash, ld::CStringEquals> CStringToAtom;
-	CStringToAtom atomMap;
-
-	{
-		uint8_t* p = _file->_atomsArray;
-		for(int i=_file->_atomsArrayCount; i > 0; --i) {
-			Atom<A>* atom = (Atom<A>*)p;
-			atomMap.insert({ atom->name(), atom });
-			p += sizeof(Atom<A>);
-		}
-	}
+	const CStringToAtom& atomMap = this->atomsByName();
 
 	// scan symbol table for stabs entries
 	Atom<A>* currentAtom = NULL;
@@ -7977,9 +8210,8 @@ bool Section<arm64>::addRelocFixup(class Parser<arm64>& parser, const macho_relo
 				target.authData.hasAddressDiversity = (contentValue & (1ULL << 48)) != 0;
 				target.authData.key = (ld::Fixup::AuthData::ptrauth_key)((contentValue >> 49) & 0x3);
 			} else {
-				static bool emittedWarning = false;
-				if (!emittedWarning) {
-					emittedWarning = true;
+				static std::atomic<bool> emittedWarning(false);
+				if (!emittedWarning.exchange(true)) {
 					warning("stripping authenticated relocation as image uses -preload or -static");
 				}
 			}
@@ -8539,15 +8771,71 @@ void Section<A>::addLOH(class Parser<A>& parser, int kind, int count, const uint
 
 }
 
+
+template <>
+bool Section<x86_64>::relocContinuesPair(const macho_relocation_info<P> relocs[], uint32_t index)
+{
+	return (index != 0) && (relocs[index-1].r_type() == X86_64_RELOC_SUBTRACTOR);
+}
+
+template <>
+bool Section<x86>::relocContinuesPair(const macho_relocation_info<P> relocs[], uint32_t index)
+{
+	// file format allows pair to be scattered or not
+	if ( (relocs[index].r_address() & R_SCATTERED) == 0 )
+		return (relocs[index].r_type() == GENERIC_RELOC_PAIR);
+	return (((macho_scattered_relocation_info<P>*)&relocs[index])->r_type() == GENERIC_RELOC_PAIR);
+}
+
+#if SUPPORT_ARCH_arm_any
+template <>
+bool Section<arm>::relocContinuesPair(const macho_relocation_info<P> relocs[], uint32_t index)
+{
+	// file format allows pair to be scattered or not
+	if ( (relocs[index].r_address() & R_SCATTERED) == 0 )
+		return (relocs[index].r_type() == ARM_RELOC_PAIR);
+	return (((macho_scattered_relocation_info<P>*)&relocs[index])->r_type() == ARM_RELOC_PAIR);
+}
+#endif
+
+#if SUPPORT_ARCH_arm64
+template <>
+bool Section<arm64>::relocContinuesPair(const macho_relocation_info<P> relocs[], uint32_t index)
+{
+	return (index != 0) && ((relocs[index-1].r_type() == ARM64_RELOC_ADDEND) || (relocs[index-1].r_type() == ARM64_RELOC_SUBTRACTOR));
+}
+#endif
+
+#if SUPPORT_ARCH_arm64_32
+template <>
+bool Section<arm64_32>::relocContinuesPair(const macho_relocation_info<P> relocs[], uint32_t index)
+{
+	return (index != 0) && ((relocs[index-1].r_type() == ARM64_RELOC_ADDEND) || (relocs[index-1].r_type() == ARM64_RELOC_SUBTRACTOR));
+}
+#endif
+
 template <typename A>
 void Section<A>::makeFixups(class Parser<A>& parser, const struct Parser<A>::CFI_CU_InfoArrays&)
+{
+	this->makeRelocFixups(parser, 0, this->machoSection()->nreloc());
+	this->makeImplicitFixups(parser);
+}
+
+template <typename A>
+const macho_relocation_info<typename A::P>* Section<A>::relocations(class Parser<A>& parser)
 {
 	const macho_section<P>* sect = this->machoSection();
 	if ( sect->reloff() + (sect->nreloc() * sizeof(macho_relocation_info<P>)) > parser.fileLength() )
 		throwf("relocations for section %s/%s extends beyond end of file,", sect->segname(), Section<A>::makeSectionName(sect) );
-	const macho_relocation_info<P>* relocs = (macho_relocation_info<P>*)(file().fileContent() + sect->reloff());
-	const uint32_t relocCount = sect->nreloc();
-	for (uint32_t r = 0; r < relocCount; ++r) {
+	return (macho_relocation_info<P>*)(file().fileContent() + sect->reloff());
+}
+
+template <typename A>
+void Section<A>::makeRelocFixups(class Parser<A>& parser, uint32_t startReloc, uint32_t endReloc)
+{
+	const macho_section<P>* sect = this->machoSection();
+	const macho_relocation_info<P>* relocs = this->relocations(parser);
+	for (uint32_t r = startReloc; r < endReloc; ++r) {
 		try {
 			if ( this->addRelocFixup(parser, &relocs[r]) )
 				++r; // skip next
@@ -8556,7 +8844,14 @@ void Section<A>::makeFixups(class Parser<A>& parser, const struct Parser<A>::CFI
 			throwf("in section %s,%s reloc %u: %s", sect->segname(), Section<A>::makeSectionName(sect), r, msg);
 		}
 	}
-	
+}
+
+// fixups that don't come from relocations
+template <typename A>
+void Section<A>::makeImplicitFixups(class Parser<A>& parser)
+{
+	const macho_section<P>* sect = this->machoSection();
+
 	// add follow-on fixups if .o file is missing .subsections_via_symbols
 	if ( this->addFollowOnFixups() ) {
 		Atom<A>* end = &_endAtoms[-1];
@@ -34,6 +34,7 @@
 #include "MachOTrie.hpp"
 #include "generic_dylib_file.hpp"
 #include "textstub_dylib_file.hpp"
+#include "ResidentInputs.h"
 
 
 namespace textstub {
@@ -171,9 +172,13 @@ File<A>::File(const char* path, const uint8_t* fileContent, uint64_t fileLength,
 		if (!allowWeakImports)
 			flags |= tapi::ParsingFlags::DisallowWeakImports;
 
-		_interface = tapi::LinkerInterfaceFile::create(
-			path, cpuType, cpuSubType, flags,
-			tapi::PackedVersion32(linkMinOSVersion), errorMessage);
+		// a link server may already have this file parsed
+		_interface = ld::ResidentInputs::textStub(path, mTime, fileLength, cpuType, cpuSubType, (uint32_t)flags, linkMinOSVersion);
+		if ( _interface == nullptr ) {
+			_interface = tapi::LinkerInterfaceFile::create(
+				path, cpuType, cpuSubType, flags,
+				tapi::PackedVersion32(linkMinOSVersion), errorMessage);
+		}
 	} else {
 		throwf("unsupported libtapi API version '%i.%i'", tapi::APIVersion::getMajor(), tapi::APIVersion::getMinor());
 	}
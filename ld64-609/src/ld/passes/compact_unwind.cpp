@@ -31,12 +31,14 @@
 #include <mach-o/compact_unwind_encoding.h>
 
 #include <vector>
-#include <map>
+#include <algorithm>
+#include <unordered_map>
 
 #include "ld.hpp"
 #include "compact_unwind.h"
 #include "Architectures.hpp"
 #include "MachOFileAbstraction.hpp"
+#include "Parallel.h"
 
 
 namespace ld {
@@ -63,6 +65,8 @@ struct LSDAEntry {
 	const ld::Atom*		lsda; 
 };
 
+typedef std::unordered_map<compact_unwind_encoding_t, unsigned int> EncodingToIndex;
+
 
 template <typename A>
 class UnwindInfoAtom : public ld::Atom {
@@ -86,27 +90,43 @@ private:
 
 	typedef macho_unwind_info_compressed_second_level_page_header<P> CSLP;
 
+	// A second level page is planned (which entries, where in the buffer) serially, 
+	// then its content and fixups are filled in independently of the other pages.
+	struct SecondLevelPage {
+		unsigned int			startIndex;		// first uniqueInfos entry on page
+		unsigned int			endIndex;		// one past last uniqueInfos entry on page
+		bool					compressed;
+		uint32_t				pad;
+		uint8_t*				pageStart;
+		EncodingToIndex			pageSpecificEncodings;
+		std::vector<ld::Fixup>	fixups;
+	};
+
 	bool						encodingMeansUseDwarf(compact_unwind_encoding_t enc);
 	bool						encodingCannotBeMerged(compact_unwind_encoding_t enc);
 	void						compressDuplicates(const std::vector<UnwindEntry>& entries,
 													std::vector<UnwindEntry>& uniqueEntries);
 	void						makePersonalityIndexes(std::vector<UnwindEntry>& entries, 
-														std::map<const ld::Atom*, uint32_t>& personalityIndexMap);
+														std::vector<const ld::Atom*>& personalities);
 	void						findCommonEncoding(const std::vector<UnwindEntry>& entries, 
-													std::map<compact_unwind_encoding_t, unsigned int>& commonEncodings);
+													EncodingToIndex& commonEncodings);
 	void						makeLsdaIndex(const std::vector<UnwindEntry>& entries, std::vector<LSDAEntry>& lsdaIndex, 
-																std::map<const ld::Atom*, uint32_t>& lsdaIndexOffsetMap);
-	unsigned int				makeCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,   
-													const std::map<compact_unwind_encoding_t,unsigned int> commonEncodings,  
-													uint32_t pageSize, unsigned int endIndex, uint8_t*& pageEnd);
-	unsigned int				makeRegularSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos, uint32_t pageSize,  
-															unsigned int endIndex, uint8_t*& pageEnd);
-	void						addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc);
-	void						addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde);
-	void						addRegularAddressFixup(uint32_t offset, const ld::Atom* func);
-	void						addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde);
-	void						addImageOffsetFixup(uint32_t offset, const ld::Atom* targ);
-	void						addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend);
+																std::unordered_map<const ld::Atom*, uint32_t>& lsdaIndexOffsetMap);
+	unsigned int				planCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,   
+													const EncodingToIndex& commonEncodings,  
+													uint32_t pageSize, unsigned int endIndex, uint8_t*& pageEnd,
+													SecondLevelPage& page);
+	unsigned int				planRegularSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos, uint32_t pageSize,  
+															unsigned int endIndex, uint8_t*& pageEnd, SecondLevelPage& page);
+	void						fillCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,
+													const EncodingToIndex& commonEncodings, SecondLevelPage& page);
+	void						fillRegularSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos, SecondLevelPage& page);
+	void						addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc);
+	void						addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde);
+	void						addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func);
+	void						addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde);
+	void						addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ);
+	void						addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend);
 
 	uint8_t*								_pagesForDelete;
 	uint8_t*								_pageAlignedPages;
@@ -142,18 +162,18 @@ UnwindInfoAtom<A>::UnwindInfoAtom(const std::vector<UnwindEntry>& entries, uint6
 	_fixups.reserve(uniqueEntries.size()*3);
 
 	// build personality index, update encodings with personality index
-	std::map<const ld::Atom*, uint32_t>	personalityIndexMap;
-	makePersonalityIndexes(uniqueEntries, personalityIndexMap);
-	if ( personalityIndexMap.size() > 3 ) {
+	std::vector<const ld::Atom*> personalities;
+	makePersonalityIndexes(uniqueEntries, personalities);
+	if ( personalities.size() > 3 ) {
 		throw "too many personality routines for compact unwind to encode";
 	}
 
 	// put the most common encodings into the common table, but at most 127 of them
-	std::map<compact_unwind_encoding_t, unsigned int> commonEncodings;
+	EncodingToIndex commonEncodings;
 	findCommonEncoding(uniqueEntries, commonEncodings);
 	
 	// build lsda index
-	std::map<const ld::Atom*, uint32_t> lsdaIndexOffsetMap;
+	std::unordered_map<const ld::Atom*, uint32_t> lsdaIndexOffsetMap;
 	std::vector<LSDAEntry>	lsdaIndex;
 	makeLsdaIndex(uniqueEntries, lsdaIndex, lsdaIndexOffsetMap);
 	
@@ -176,24 +196,32 @@ UnwindInfoAtom<A>::UnwindInfoAtom(const std::vector<UnwindEntry>& entries, uint6
 		maxLastPageSize = 4096;
 	}
 	
-	// fill in pages in reverse order
-	const ld::Atom* secondLevelFirstFuncs[pageCount*3];
-	uint8_t* secondLevelPagesStarts[pageCount*3];
+	// lay out pages in reverse order.  Where a page ends depends on how many entries
+	// the page after it took, so this is serial, but filling in the pages is not
+	std::vector<SecondLevelPage> secondLevelPages;
+	secondLevelPages.reserve(pageCount*3);
 	unsigned int endIndex = uniqueEntries.size();
-	unsigned int secondLevelPageCount = 0;
 	uint8_t* pageEnd = &_pageAlignedPages[pageCount*4096];
 	uint32_t pageSize = maxLastPageSize;
 	while ( endIndex > 0 ) {
-		endIndex = makeCompressedSecondLevelPage(uniqueEntries, commonEncodings, pageSize, endIndex, pageEnd);
-		secondLevelPagesStarts[secondLevelPageCount] = pageEnd;
-		secondLevelFirstFuncs[secondLevelPageCount] = uniqueEntries[endIndex].func;
-		++secondLevelPageCount;
+		secondLevelPages.emplace_back();
+		endIndex = planCompressedSecondLevelPage(uniqueEntries, commonEncodings, pageSize, endIndex, pageEnd, secondLevelPages.back());
 		// if this requires more than one page, align so that next starts on page boundary
 		if ( (pageSize != 4096) && (endIndex > 0) ) {
 			pageEnd = (uint8_t*)((uintptr_t)(pageEnd) & -4096);
 			pageSize = 4096;  // last page can be odd size, make rest up to 4096 bytes in size
 		}
 	}
+	const unsigned int secondLevelPageCount = secondLevelPages.size();
+	ld::parallel::forEach(secondLevelPageCount, [&](size_t pageIndex) {
+		SecondLevelPage& page = secondLevelPages[pageIndex];
+		if ( page.compressed )
+			fillCompressedSecondLevelPage(uniqueEntries, commonEncodings, page);
+		else
+			fillRegularSecondLevelPage(uniqueEntries, page);
+	});
+	for (SecondLevelPage& page : secondLevelPages)
+		_fixups.insert(_fixups.end(), page.fixups.begin(), page.fixups.end());
 	_pages = pageEnd;
 	_pagesSize = &_pageAlignedPages[pageCount*4096] - pageEnd;
 
@@ -202,7 +230,7 @@ UnwindInfoAtom<A>::UnwindInfoAtom(const std::vector<UnwindEntry>& entries, uint6
 	const uint32_t commonEncodingsArrayCount = commonEncodings.size();
 	const uint32_t commonEncodingsArraySize = commonEncodingsArrayCount * sizeof(compact_unwind_encoding_t);
 	const uint32_t personalityArraySectionOffset = commonEncodingsArraySectionOffset + commonEncodingsArraySize;
-	const uint32_t personalityArrayCount = personalityIndexMap.size();
+	const uint32_t personalityArrayCount = personalities.size();
 	const uint32_t personalityArraySize = personalityArrayCount * sizeof(uint32_t);
 	const uint32_t indexSectionOffset = personalityArraySectionOffset + personalityArraySize;
 	const uint32_t indexCount = secondLevelPageCount+1;
@@ -233,38 +261,39 @@ UnwindInfoAtom<A>::UnwindInfoAtom(const std::vector<UnwindEntry>& entries, uint6
 	
 	// copy common encodings
 	uint32_t* commonEncodingsTable = (uint32_t*)&_header[commonEncodingsArraySectionOffset];
-	for (std::map<uint32_t, unsigned int>::iterator it=commonEncodings.begin(); it != commonEncodings.end(); ++it)
+	for (EncodingToIndex::iterator it=commonEncodings.begin(); it != commonEncodings.end(); ++it)
 		E::set32(commonEncodingsTable[it->second], it->first);
 		
 	// make references for personality entries
 	uint32_t* personalityArray = (uint32_t*)&_header[sectionHeader->personalityArraySectionOffset()];
-	for (std::map<const ld::Atom*, unsigned int>::iterator it=personalityIndexMap.begin(); it != personalityIndexMap.end(); ++it) {
-		uint32_t offset = (uint8_t*)&personalityArray[it->second-1] - _header;
-		this->addImageOffsetFixup(offset, it->first);
+	for (unsigned int i=0; i < personalities.size(); ++i) {
+		uint32_t offset = (uint8_t*)&personalityArray[i] - _header;
+		this->addImageOffsetFixup(_fixups, offset, personalities[i]);
 	}
 
 	// build first level index and references
 	macho_unwind_info_section_header_index_entry<P>* indexTable = (macho_unwind_info_section_header_index_entry<P>*)&_header[indexSectionOffset];
 	uint32_t refOffset;
 	for (unsigned int i=0; i < secondLevelPageCount; ++i) {
-		unsigned int reverseIndex = secondLevelPageCount - 1 - i;
+		const SecondLevelPage& page = secondLevelPages[secondLevelPageCount - 1 - i];
+		const ld::Atom* firstFunc = uniqueEntries[page.startIndex].func;
 		indexTable[i].set_functionOffset(0);
-		indexTable[i].set_secondLevelPagesSectionOffset(secondLevelPagesStarts[reverseIndex]-_pages+headerEndSectionOffset);
-		indexTable[i].set_lsdaIndexArraySectionOffset(lsdaIndexOffsetMap[secondLevelFirstFuncs[reverseIndex]]+lsdaIndexArraySectionOffset); 
+		indexTable[i].set_secondLevelPagesSectionOffset(page.pageStart-_pages+headerEndSectionOffset);
+		indexTable[i].set_lsdaIndexArraySectionOffset(lsdaIndexOffsetMap[firstFunc]+lsdaIndexArraySectionOffset); 
 		refOffset = (uint8_t*)&indexTable[i] - _header;
-		this->addImageOffsetFixup(refOffset, secondLevelFirstFuncs[reverseIndex]);
+		this->addImageOffsetFixup(_fixups, refOffset, firstFunc);
 	}
 	indexTable[secondLevelPageCount].set_functionOffset(0);
 	indexTable[secondLevelPageCount].set_secondLevelPagesSectionOffset(0);
 	indexTable[secondLevelPageCount].set_lsdaIndexArraySectionOffset(lsdaIndexArraySectionOffset+lsdaIndexArraySize); 
 	refOffset = (uint8_t*)&indexTable[secondLevelPageCount] - _header;
-	this->addImageOffsetFixupPlusAddend(refOffset, entries.back().func, entries.back().func->size()+1);
+	this->addImageOffsetFixupPlusAddend(_fixups, refOffset, entries.back().func, entries.back().func->size()+1);
 	
 	// build lsda references
 	uint32_t lsdaEntrySectionOffset = lsdaIndexArraySectionOffset;
 	for (std::vector<LSDAEntry>::iterator it = lsdaIndex.begin(); it != lsdaIndex.end(); ++it) {
-		this->addImageOffsetFixup(lsdaEntrySectionOffset, it->func);
-		this->addImageOffsetFixup(lsdaEntrySectionOffset+4, it->lsda);
+		this->addImageOffsetFixup(_fixups, lsdaEntrySectionOffset, it->func);
+		this->addImageOffsetFixup(_fixups, lsdaEntrySectionOffset+4, it->lsda);
 		lsdaEntrySectionOffset += sizeof(unwind_info_section_header_lsda_index_entry);
 	}
 	
@@ -362,62 +391,70 @@ void UnwindInfoAtom<A>::compressDuplicates(const std::vector<UnwindEntry>& entri
 }
 
 template <typename A>
-void UnwindInfoAtom<A>::makePersonalityIndexes(std::vector<UnwindEntry>& entries, std::map<const ld::Atom*, uint32_t>& personalityIndexMap)
+void UnwindInfoAtom<A>::makePersonalityIndexes(std::vector<UnwindEntry>& entries, std::vector<const ld::Atom*>& personalities)
 {
+	// personality index is one plus position in personalities, which is in order of first use
 	for(std::vector<UnwindEntry>::iterator it=entries.begin(); it != entries.end(); ++it) {
 		if ( it->personalityPointer != NULL ) {
-			std::map<const ld::Atom*, uint32_t>::iterator pos = personalityIndexMap.find(it->personalityPointer);
-			if ( pos == personalityIndexMap.end() ) {
-				const uint32_t nextIndex = personalityIndexMap.size() + 1;
-				personalityIndexMap[it->personalityPointer] = nextIndex;
-			}
-			uint32_t personalityIndex = personalityIndexMap[it->personalityPointer];
+			std::vector<const ld::Atom*>::iterator pos = std::find(personalities.begin(), personalities.end(), it->personalityPointer);
+			if ( pos == personalities.end() )
+				pos = personalities.insert(personalities.end(), it->personalityPointer);
+			uint32_t personalityIndex = (uint32_t)(pos - personalities.begin()) + 1;
 			it->encoding |= (personalityIndex << (__builtin_ctz(UNWIND_PERSONALITY_MASK)) );
 		}
 	}
-	if (_s_log) fprintf(stderr, "makePersonalityIndexes() %lu personality routines used\n", personalityIndexMap.size()); 
+	if (_s_log) fprintf(stderr, "makePersonalityIndexes() %lu personality routines used\n", personalities.size()); 
 }
 
 
 template <typename A>
 void UnwindInfoAtom<A>::findCommonEncoding(const std::vector<UnwindEntry>& entries, 
-											std::map<compact_unwind_encoding_t, unsigned int>& commonEncodings)
+											EncodingToIndex& commonEncodings)
 {
-	// scan infos to get frequency counts for each encoding
-	std::map<compact_unwind_encoding_t, unsigned int> encodingsUsed;
-	unsigned int mostCommonEncodingUsageCount = 0;
-	for(std::vector<UnwindEntry>::const_iterator it=entries.begin(); it != entries.end(); ++it) {
-		// never put dwarf into common table
-		if ( encodingMeansUseDwarf(it->encoding) )
-			continue;
-		std::map<compact_unwind_encoding_t, unsigned int>::iterator pos = encodingsUsed.find(it->encoding);
-		if ( pos == encodingsUsed.end() ) {
-			encodingsUsed[it->encoding] = 1;
-		}
-		else {
-			encodingsUsed[it->encoding] += 1;
-			if ( mostCommonEncodingUsageCount < encodingsUsed[it->encoding] )
-				mostCommonEncodingUsageCount = encodingsUsed[it->encoding];
+	// scan infos to get frequency counts for each encoding, in parallel over ranges of entries
+	std::vector<EncodingToIndex> chunkEncodingsUsed(ld::parallel::chunkCount(entries.size(), 16384));
+	ld::parallel::forEachChunk(entries.size(), 16384, [&](size_t chunk, size_t begin, size_t end) {
+		EncodingToIndex& encodingsUsed = chunkEncodingsUsed[chunk];
+		for (size_t i=begin; i < end; ++i) {
+			// never put dwarf into common table
+			if ( encodingMeansUseDwarf(entries[i].encoding) )
+				continue;
+			encodingsUsed[entries[i].encoding] += 1;
 		}
+	});
+	EncodingToIndex encodingsUsed;
+	for (const EncodingToIndex& chunkCounts : chunkEncodingsUsed) {
+		for (const auto& encodingAndCount : chunkCounts)
+			encodingsUsed[encodingAndCount.first] += encodingAndCount.second;
 	}
-	// put the most common encodings into the common table, but at most 127 of them
-	for(unsigned int usages=mostCommonEncodingUsageCount; usages > 1; --usages) {
-		for (std::map<compact_unwind_encoding_t, unsigned int>::iterator euit=encodingsUsed.begin(); euit != encodingsUsed.end(); ++euit) {
-			if ( euit->second == usages ) {
-				unsigned int sz = commonEncodings.size();
-				if ( sz < 127 ) {
-					commonEncodings[euit->first] = sz;
-				}
-			}
-		}
+
+	// put the most common encodings into the common table, but at most 127 of them.
+	// Ties are broken by encoding value so the table does not depend on hash order.
+	std::vector<std::pair<compact_unwind_encoding_t, unsigned int>> usedMoreThanOnce;
+	for (const auto& encodingAndCount : encodingsUsed) {
+		if ( encodingAndCount.second > 1 )
+			usedMoreThanOnce.push_back(encodingAndCount);
+	}
+	std::sort(usedMoreThanOnce.begin(), usedMoreThanOnce.end(),
+			  [](const std::pair<compact_unwind_encoding_t, unsigned int>& a, const std::pair<compact_unwind_encoding_t, unsigned int>& b) {
+		if ( a.second != b.second )
+			return (a.second > b.second);
+		return (a.first < b.first);
+	});
+	for (const auto& encodingAndCount : usedMoreThanOnce) {
+		unsigned int sz = commonEncodings.size();
+		if ( sz >= 127 )
+			break;
+		commonEncodings[encodingAndCount.first] = sz;
 	}
 	if (_s_log) fprintf(stderr, "findCommonEncoding() %lu common encodings found\n", commonEncodings.size()); 
 }
 
 
 template <typename A>
-void UnwindInfoAtom<A>::makeLsdaIndex(const std::vector<UnwindEntry>& entries, std::vector<LSDAEntry>& lsdaIndex, std::map<const ld::Atom*, uint32_t>& lsdaIndexOffsetMap)
+void UnwindInfoAtom<A>::makeLsdaIndex(const std::vector<UnwindEntry>& entries, std::vector<LSDAEntry>& lsdaIndex, std::unordered_map<const ld::Atom*, uint32_t>& lsdaIndexOffsetMap)
 {
+	lsdaIndexOffsetMap.reserve(entries.size());
 	for(std::vector<UnwindEntry>::const_iterator it=entries.begin(); it != entries.end(); ++it) {
 		lsdaIndexOffsetMap[it->func] = lsdaIndex.size() * sizeof(unwind_info_section_header_lsda_index_entry);
 		if ( it->lsda != NULL ) {
@@ -432,285 +469,299 @@ void UnwindInfoAtom<A>::makeLsdaIndex(const std::vector<UnwindEntry>& entries, s
 
 
 template <>
-void UnwindInfoAtom<x86>::addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
+void UnwindInfoAtom<x86>::addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
+void UnwindInfoAtom<x86_64>::addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
+void UnwindInfoAtom<arm64>::addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
+void UnwindInfoAtom<arm64_32>::addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
+void UnwindInfoAtom<arm>::addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
 {
 	if ( fromFunc->isThumb() ) {
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of4, ld::Fixup::kindSetTargetAddress, func));
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of4, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of4, ld::Fixup::kindSubtractAddend, 1));
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k4of4, ld::Fixup::kindStoreLittleEndianLow24of32));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of4, ld::Fixup::kindSetTargetAddress, func));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of4, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of4, ld::Fixup::kindSubtractAddend, 1));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k4of4, ld::Fixup::kindStoreLittleEndianLow24of32));
 	}
 	else {
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
 	}
 }
 
 template <>
-void UnwindInfoAtom<x86>::addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<x86>::addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<x86_64>::addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm64>::addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm64_32>::addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm>::addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<x86>::addRegularAddressFixup(uint32_t offset, const ld::Atom* func)
+void UnwindInfoAtom<x86>::addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addRegularAddressFixup(uint32_t offset, const ld::Atom* func)
+void UnwindInfoAtom<x86_64>::addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addRegularAddressFixup(uint32_t offset, const ld::Atom* func)
+void UnwindInfoAtom<arm64>::addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addRegularAddressFixup(uint32_t offset, const ld::Atom* func)
+void UnwindInfoAtom<arm64_32>::addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addRegularAddressFixup(uint32_t offset, const ld::Atom* func)
+void UnwindInfoAtom<arm>::addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<x86>::addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<x86>::addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<x86_64>::addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm64>::addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm64_32>::addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm>::addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<x86>::addImageOffsetFixup(uint32_t offset, const ld::Atom* targ)
+void UnwindInfoAtom<x86>::addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addImageOffsetFixup(uint32_t offset, const ld::Atom* targ)
+void UnwindInfoAtom<x86_64>::addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addImageOffsetFixup(uint32_t offset, const ld::Atom* targ)
+void UnwindInfoAtom<arm64>::addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addImageOffsetFixup(uint32_t offset, const ld::Atom* targ)
+void UnwindInfoAtom<arm64_32>::addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addImageOffsetFixup(uint32_t offset, const ld::Atom* targ)
+void UnwindInfoAtom<arm>::addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<x86>::addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend)
+void UnwindInfoAtom<x86>::addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend)
+void UnwindInfoAtom<x86_64>::addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend)
+void UnwindInfoAtom<arm64>::addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend)
+void UnwindInfoAtom<arm64_32>::addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend)
+void UnwindInfoAtom<arm>::addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
 }
 
 
 
 
 template <typename A>
-unsigned int UnwindInfoAtom<A>::makeRegularSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos, uint32_t pageSize,  
-															unsigned int endIndex, uint8_t*& pageEnd)
+unsigned int UnwindInfoAtom<A>::planRegularSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos, uint32_t pageSize,  
+															unsigned int endIndex, uint8_t*& pageEnd, SecondLevelPage& page)
 {
 	const unsigned int maxEntriesPerPage = (pageSize - sizeof(unwind_info_regular_second_level_page_header))/sizeof(unwind_info_regular_second_level_entry);
 	const unsigned int entriesToAdd = ((endIndex > maxEntriesPerPage) ? maxEntriesPerPage : endIndex);
-	uint8_t* pageStart = pageEnd 
+	page.compressed = false;
+	page.startIndex = endIndex - entriesToAdd;
+	page.endIndex = endIndex;
+	page.pad = 0;
+	page.pageStart = pageEnd 
 						- entriesToAdd*sizeof(unwind_info_regular_second_level_entry) 
 						- sizeof(unwind_info_regular_second_level_page_header);
-	macho_unwind_info_regular_second_level_page_header<P>* page = (macho_unwind_info_regular_second_level_page_header<P>*)pageStart;
-	page->set_kind(UNWIND_SECOND_LEVEL_REGULAR);
-	page->set_entryPageOffset(sizeof(macho_unwind_info_regular_second_level_page_header<P>));
-	page->set_entryCount(entriesToAdd);
-	macho_unwind_info_regular_second_level_entry<P>* entryTable = (macho_unwind_info_regular_second_level_entry<P>*)(pageStart + page->entryPageOffset());
+	if (_s_log) fprintf(stderr, "regular page with %u entries\n", entriesToAdd);
+	pageEnd = page.pageStart;
+	return page.startIndex;
+}
+
+
+template <typename A>
+void UnwindInfoAtom<A>::fillRegularSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos, SecondLevelPage& page)
+{
+	const unsigned int entriesToAdd = page.endIndex - page.startIndex;
+	uint8_t* pageStart = page.pageStart;
+	macho_unwind_info_regular_second_level_page_header<P>* header = (macho_unwind_info_regular_second_level_page_header<P>*)pageStart;
+	header->set_kind(UNWIND_SECOND_LEVEL_REGULAR);
+	header->set_entryPageOffset(sizeof(macho_unwind_info_regular_second_level_page_header<P>));
+	header->set_entryCount(entriesToAdd);
+	macho_unwind_info_regular_second_level_entry<P>* entryTable = (macho_unwind_info_regular_second_level_entry<P>*)(pageStart + header->entryPageOffset());
+	page.fixups.reserve(entriesToAdd*4);
 	for (unsigned int i=0; i < entriesToAdd; ++i) {
-		const UnwindEntry& info = uniqueInfos[endIndex-entriesToAdd+i];
+		const UnwindEntry& info = uniqueInfos[page.startIndex+i];
 		entryTable[i].set_functionOffset(0);
 		entryTable[i].set_encoding(info.encoding);
 		// add fixup for address part of entry
 		uint32_t offset = (uint8_t*)(&entryTable[i]) - _pageAlignedPages;
-		this->addRegularAddressFixup(offset, info.func);
+		this->addRegularAddressFixup(page.fixups, offset, info.func);
 		if ( encodingMeansUseDwarf(info.encoding) ) {
 			// add fixup for dwarf offset part of page specific encoding
 			uint32_t encOffset = (uint8_t*)(&entryTable[i]) - _pageAlignedPages;
-			this->addRegularFDEOffsetFixup(encOffset, info.fde);
+			this->addRegularFDEOffsetFixup(page.fixups, encOffset, info.fde);
 		}
 	}
-	if (_s_log) fprintf(stderr, "regular page with %u entries\n", entriesToAdd);
-	pageEnd = pageStart;
-	return endIndex - entriesToAdd;
 }
 
 
 template <typename A>
-unsigned int UnwindInfoAtom<A>::makeCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,   
-													const std::map<compact_unwind_encoding_t,unsigned int> commonEncodings,  
-													uint32_t pageSize, unsigned int endIndex, uint8_t*& pageEnd)
+unsigned int UnwindInfoAtom<A>::planCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,   
+													const EncodingToIndex& commonEncodings,  
+													uint32_t pageSize, unsigned int endIndex, uint8_t*& pageEnd,
+													SecondLevelPage& page)
 {
 	if (_s_log) fprintf(stderr, "makeCompressedSecondLevelPage(pageSize=%u, endIndex=%u)\n", pageSize, endIndex);
 	// first pass calculates how many compressed entries we could fit in this sized page
@@ -719,7 +770,7 @@ unsigned int UnwindInfoAtom<A>::makeCompressedSecondLevelPage(const std::vector<
 	//  2) the file offset delta from the first to last function > 24 bits
 	//  3) custom encoding index reaches 255
 	//  4) run out of uniqueInfos to encode
-	std::map<compact_unwind_encoding_t, unsigned int> pageSpecificEncodings;
+	EncodingToIndex& pageSpecificEncodings = page.pageSpecificEncodings;
 	uint32_t space4 =  (pageSize - sizeof(unwind_info_compressed_second_level_page_header))/sizeof(uint32_t);
 	int index = endIndex-1;
 	int entryCount = 0;
@@ -729,7 +780,7 @@ unsigned int UnwindInfoAtom<A>::makeCompressedSecondLevelPage(const std::vector<
 		const UnwindEntry& info = uniqueInfos[index--];
 		// compute encoding index
 		unsigned int encodingIndex;
-		std::map<compact_unwind_encoding_t, unsigned int>::const_iterator pos = commonEncodings.find(info.encoding);
+		EncodingToIndex::const_iterator pos = commonEncodings.find(info.encoding);
 		if ( pos != commonEncodings.end() ) {
 			encodingIndex = pos->second;
 			if (_s_log) fprintf(stderr, "makeCompressedSecondLevelPage(): funcIndex=%d, re-use commonEncodings[%d]=0x%08X\n", index, encodingIndex, info.encoding);
@@ -741,9 +792,9 @@ unsigned int UnwindInfoAtom<A>::makeCompressedSecondLevelPage(const std::vector<
 				// make unique pseudo encoding so this dwarf will gets is own encoding entry slot
 				encoding += (index+1);
 			}
-			std::map<compact_unwind_encoding_t, unsigned int>::iterator ppos = pageSpecificEncodings.find(encoding);
+			EncodingToIndex::iterator ppos = pageSpecificEncodings.find(encoding);
 			if ( ppos != pageSpecificEncodings.end() ) {
-				encodingIndex = pos->second;
+				encodingIndex = ppos->second;
 				if (_s_log) fprintf(stderr, "makeCompressedSecondLevelPage(): funcIndex=%d, re-use pageSpecificEncodings[%d]=0x%08X\n", index, encodingIndex, encoding);
 			}
 			else {
@@ -785,63 +836,79 @@ unsigned int UnwindInfoAtom<A>::makeCompressedSecondLevelPage(const std::vector<
 	if ( (compressPageUsed < (pageSize-4) && (index >= 0) ) ) {
 		const int regularEntriesPerPage = (pageSize - sizeof(unwind_info_regular_second_level_page_header))/sizeof(unwind_info_regular_second_level_entry);
 		if ( entryCount < regularEntriesPerPage ) {
-			return makeRegularSecondLevelPage(uniqueInfos, pageSize, endIndex, pageEnd);
+			pageSpecificEncodings.clear();
+			return planRegularSecondLevelPage(uniqueInfos, pageSize, endIndex, pageEnd, page);
 		}
 	}
 	
 	// check if we need any padding because adding another entry would take 8 bytes but only have room for 4
-	uint32_t pad = 0;
+	page.pad = 0;
 	if ( compressPageUsed == (pageSize-4) )
-		pad = 4;
-
-	// second pass fills in page 
-	uint8_t* pageStart = pageEnd - compressPageUsed - pad;
-	CSLP* page = (CSLP*)pageStart;
-	page->set_kind(UNWIND_SECOND_LEVEL_COMPRESSED);
-	page->set_entryPageOffset(sizeof(CSLP));
-	page->set_entryCount(entryCount);
-	page->set_encodingsPageOffset(page->entryPageOffset()+entryCount*sizeof(uint32_t));
-	page->set_encodingsCount(pageSpecificEncodings.size());
-	uint32_t* const encodingsArray = (uint32_t*)&pageStart[page->encodingsPageOffset()];
+		page.pad = 4;
+
+	page.compressed = true;
+	page.startIndex = endIndex-entryCount;
+	page.endIndex = endIndex;
+	page.pageStart = pageEnd - compressPageUsed - page.pad;
+	if (_s_log) fprintf(stderr, "compressed page with %u entries, %lu custom encodings\n", entryCount, pageSpecificEncodings.size());
+	
+	// update pageEnd;
+	pageEnd = page.pageStart;
+	return page.startIndex;  // endIndex for next page
+}
+
+
+template <typename A>
+void UnwindInfoAtom<A>::fillCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,   
+													const EncodingToIndex& commonEncodings, SecondLevelPage& page)
+{
+	const EncodingToIndex& pageSpecificEncodings = page.pageSpecificEncodings;
+	const unsigned int endIndex = page.endIndex;
+	const unsigned int entryCount = page.endIndex - page.startIndex;
+	uint8_t* pageStart = page.pageStart;
+	CSLP* header = (CSLP*)pageStart;
+	header->set_kind(UNWIND_SECOND_LEVEL_COMPRESSED);
+	header->set_entryPageOffset(sizeof(CSLP));
+	header->set_entryCount(entryCount);
+	header->set_encodingsPageOffset(header->entryPageOffset()+entryCount*sizeof(uint32_t));
+	header->set_encodingsCount(pageSpecificEncodings.size());
+	uint32_t* const encodingsArray = (uint32_t*)&pageStart[header->encodingsPageOffset()];
 	// fill in entry table
-	uint32_t* const entiresArray = (uint32_t*)&pageStart[page->entryPageOffset()];
+	uint32_t* const entiresArray = (uint32_t*)&pageStart[header->entryPageOffset()];
 	const ld::Atom* firstFunc = uniqueInfos[endIndex-entryCount].func;
+	page.fixups.reserve(entryCount*5);
 	for(unsigned int i=endIndex-entryCount; i < endIndex; ++i) {
 		const UnwindEntry& info = uniqueInfos[i];
 		uint8_t encodingIndex;
 		if ( encodingMeansUseDwarf(info.encoding) ) {
 			// dwarf entries are always in page specific encodings
-			assert(pageSpecificEncodings.find(info.encoding+i) != pageSpecificEncodings.end());
-			encodingIndex = pageSpecificEncodings[info.encoding+i];
+			EncodingToIndex::const_iterator pos = pageSpecificEncodings.find(info.encoding+i);
+			assert(pos != pageSpecificEncodings.end());
+			encodingIndex = pos->second;
 		}
 		else {
-			std::map<uint32_t, unsigned int>::const_iterator pos = commonEncodings.find(info.encoding);
-			if ( pos != commonEncodings.end() ) 
-				encodingIndex = pos->second;
-			else 
-				encodingIndex = pageSpecificEncodings[info.encoding];
+			EncodingToIndex::const_iterator pos = commonEncodings.find(info.encoding);
+			if ( pos == commonEncodings.end() ) {
+				pos = pageSpecificEncodings.find(info.encoding);
+				assert(pos != pageSpecificEncodings.end());
+			}
+			encodingIndex = pos->second;
 		}
 		uint32_t entryIndex = i - endIndex + entryCount;
 		E::set32(entiresArray[entryIndex], encodingIndex << 24);
 		// add fixup for address part of entry
 		uint32_t offset = (uint8_t*)(&entiresArray[entryIndex]) - _pageAlignedPages;
-		this->addCompressedAddressOffsetFixup(offset, info.func, firstFunc);
+		this->addCompressedAddressOffsetFixup(page.fixups, offset, info.func, firstFunc);
 		if ( encodingMeansUseDwarf(info.encoding) ) {
 			// add fixup for dwarf offset part of page specific encoding
 			uint32_t encOffset = (uint8_t*)(&encodingsArray[encodingIndex-commonEncodings.size()]) - _pageAlignedPages;
-			this->addCompressedEncodingFixup(encOffset, info.fde);
+			this->addCompressedEncodingFixup(page.fixups, encOffset, info.fde);
 		}
 	}
 	// fill in encodings table
-	for(std::map<uint32_t, unsigned int>::const_iterator it = pageSpecificEncodings.begin(); it != pageSpecificEncodings.end(); ++it) {
+	for(EncodingToIndex::const_iterator it = pageSpecificEncodings.begin(); it != pageSpecificEncodings.end(); ++it) {
 		E::set32(encodingsArray[it->second-commonEncodings.size()], it->first);
 	}
-	
-	if (_s_log) fprintf(stderr, "compressed page with %u entries, %lu custom encodings\n", entryCount, pageSpecificEncodings.size());
-	
-	// update pageEnd;
-	pageEnd = pageStart;
-	return endIndex-entryCount;  // endIndex for next page
 }
 
 
@@ -869,93 +936,145 @@ static uint64_t calculateEHFrameSize(ld::Internal& state)
 	return size;
 }
 
-static void getAllUnwindInfos(const ld::Internal& state, std::vector<UnwindEntry>& entries)
+// adjust address for atom alignment
+static uint64_t alignAddress(uint64_t address, const ld::Atom* atom)
 {
-	uint64_t address = 0;
-	for (std::vector<ld::Internal::FinalSection*>::const_iterator sit=state.sections.begin(); sit != state.sections.end(); ++sit) {
-		ld::Internal::FinalSection* sect = *sit;
-		for (std::vector<const ld::Atom*>::iterator ait=sect->atoms.begin(); ait != sect->atoms.end(); ++ait) {
-			const ld::Atom* atom = *ait;
-			// adjust address for atom alignment
-			uint64_t alignment = 1 << atom->alignment().powerOf2;
-			uint64_t currentModulus = (address % alignment);
-			uint64_t requiredModulus = atom->alignment().modulus;
-			if ( currentModulus != requiredModulus ) {
-				if ( requiredModulus > currentModulus )
-					address += requiredModulus-currentModulus;
-				else
-					address += requiredModulus+alignment-currentModulus;
-			}
+	uint64_t alignment = 1 << atom->alignment().powerOf2;
+	uint64_t currentModulus = (address % alignment);
+	uint64_t requiredModulus = atom->alignment().modulus;
+	if ( currentModulus != requiredModulus ) {
+		if ( requiredModulus > currentModulus )
+			address += requiredModulus-currentModulus;
+		else
+			address += requiredModulus+alignment-currentModulus;
+	}
+	return address;
+}
 
-			if ( atom->beginUnwind() == atom->endUnwind() ) {
-				// be sure to mark that we have no unwind info for stuff in the TEXT segment without unwind info
-				if ( (atom->section().type() == ld::Section::typeCode) && (atom->size() !=0) ) {
-					entries.push_back(UnwindEntry(atom, address, 0, NULL, NULL, NULL, 0));
-				}
+static void getAtomUnwindInfos(const ld::Internal& state, const ld::Atom* atom, uint64_t address, std::vector<UnwindEntry>& entries)
+{
+	if ( atom->beginUnwind() == atom->endUnwind() ) {
+		// be sure to mark that we have no unwind info for stuff in the TEXT segment without unwind info
+		if ( (atom->section().type() == ld::Section::typeCode) && (atom->size() !=0) ) {
+			entries.push_back(UnwindEntry(atom, address, 0, NULL, NULL, NULL, 0));
+		}
+	}
+	else {
+		// atom has unwind info(s), add entry for each
+		const ld::Atom*	fde = NULL;
+		const ld::Atom*	lsda = NULL; 
+		const ld::Atom*	personalityPointer = NULL; 
+		for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
+			switch ( fit->kind ) {
+				case ld::Fixup::kindNoneGroupSubordinateFDE:
+					assert(fit->binding == ld::Fixup::bindingDirectlyBound);
+					fde = fit->u.target;
+					break;
+				case ld::Fixup::kindNoneGroupSubordinateLSDA:
+					assert(fit->binding == ld::Fixup::bindingDirectlyBound);
+					lsda = fit->u.target;
+					break;
+				case ld::Fixup::kindNoneGroupSubordinatePersonality:
+					assert(fit->binding == ld::Fixup::bindingDirectlyBound);
+					personalityPointer = fit->u.target;
+					assert(personalityPointer->section().type() == ld::Section::typeNonLazyPointer);
+					break;
+				default:
+					break;
 			}
-			else {
-				// atom has unwind info(s), add entry for each
-				const ld::Atom*	fde = NULL;
-				const ld::Atom*	lsda = NULL; 
-				const ld::Atom*	personalityPointer = NULL; 
-				for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
-					switch ( fit->kind ) {
-						case ld::Fixup::kindNoneGroupSubordinateFDE:
-							assert(fit->binding == ld::Fixup::bindingDirectlyBound);
-							fde = fit->u.target;
-							break;
-						case ld::Fixup::kindNoneGroupSubordinateLSDA:
-							assert(fit->binding == ld::Fixup::bindingDirectlyBound);
-							lsda = fit->u.target;
-							break;
-						case ld::Fixup::kindNoneGroupSubordinatePersonality:
-							assert(fit->binding == ld::Fixup::bindingDirectlyBound);
-							personalityPointer = fit->u.target;
-							assert(personalityPointer->section().type() == ld::Section::typeNonLazyPointer);
-							break;
-						default:
-							break;
-					}
-				}
-				if ( fde != NULL ) {
-					// find CIE for this FDE
-					const ld::Atom*	cie = NULL;
-					for (ld::Fixup::iterator fit = fde->fixupsBegin(), end=fde->fixupsEnd(); fit != end; ++fit) {
-						if ( fit->kind != ld::Fixup::kindSubtractTargetAddress )
-							continue;
-						if ( fit->binding != ld::Fixup::bindingDirectlyBound )
-							continue;
-						cie = fit->u.target;
-						// CIE is only direct subtracted target in FDE
-						assert(cie->section().type() == ld::Section::typeCFI);
-						break;
-					}
-					if ( cie != NULL ) {
-						// if CIE can have just one fixup - to the personality pointer
-						for (ld::Fixup::iterator fit = cie->fixupsBegin(), end=cie->fixupsEnd(); fit != end; ++fit) {
-							if ( fit->kind == ld::Fixup::kindSetTargetAddress ) {
-								switch ( fit->binding ) {
-									case ld::Fixup::bindingsIndirectlyBound:
-										personalityPointer = state.indirectBindingTable[fit->u.bindingIndex];
-										assert(personalityPointer->section().type() == ld::Section::typeNonLazyPointer);
-										break;
-									case ld::Fixup::bindingDirectlyBound:
-										personalityPointer = fit->u.target;
-										assert(personalityPointer->section().type() == ld::Section::typeNonLazyPointer);
-										break;
-									default:
-										break;
-								}
-							}
+		}
+		if ( fde != NULL ) {
+			// find CIE for this FDE
+			const ld::Atom*	cie = NULL;
+			for (ld::Fixup::iterator fit = fde->fixupsBegin(), end=fde->fixupsEnd(); fit != end; ++fit) {
+				if ( fit->kind != ld::Fixup::kindSubtractTargetAddress )
+					continue;
+				if ( fit->binding != ld::Fixup::bindingDirectlyBound )
+					continue;
+				cie = fit->u.target;
+				// CIE is only direct subtracted target in FDE
+				assert(cie->section().type() == ld::Section::typeCFI);
+				break;
+			}
+			if ( cie != NULL ) {
+				// if CIE can have just one fixup - to the personality pointer
+				for (ld::Fixup::iterator fit = cie->fixupsBegin(), end=cie->fixupsEnd(); fit != end; ++fit) {
+					if ( fit->kind == ld::Fixup::kindSetTargetAddress ) {
+						switch ( fit->binding ) {
+							case ld::Fixup::bindingsIndirectlyBound:
+								personalityPointer = state.indirectBindingTable[fit->u.bindingIndex];
+								assert(personalityPointer->section().type() == ld::Section::typeNonLazyPointer);
+								break;
+							case ld::Fixup::bindingDirectlyBound:
+								personalityPointer = fit->u.target;
+								assert(personalityPointer->section().type() == ld::Section::typeNonLazyPointer);
+								break;
+							default:
+								break;
 						}
 					}
 				}
-				for ( ld::Atom::UnwindInfo::iterator uit = atom->beginUnwind(); uit != atom->endUnwind(); ++uit ) {
-					entries.push_back(UnwindEntry(atom, address, uit->startOffset, fde, lsda, personalityPointer, uit->unwindInfo));
-				}
 			}
+		}
+		for ( ld::Atom::UnwindInfo::iterator uit = atom->beginUnwind(); uit != atom->endUnwind(); ++uit ) {
+			entries.push_back(UnwindEntry(atom, address, uit->startOffset, fde, lsda, personalityPointer, uit->unwindInfo));
+		}
+	}
+}
+
+struct SectionUnwindInfos {
+	std::vector<UnwindEntry>	entries;
+	uint64_t					size;			// size of section if laid out starting at address zero
+	uint8_t						maxAlignPowerOf2;
+};
+
+static void getAllUnwindInfos(const ld::Internal& state, std::vector<UnwindEntry>& entries)
+{
+	// Tentative function addresses replay atom alignment across all sections.  Each section
+	// is scanned in parallel as if it started at address zero, which gives the same addresses
+	// as a serial replay whenever the real start is aligned to the most aligned atom in the
+	// section.  Sections where that is not the case are re-addressed serially while merging.
+	const std::vector<ld::Internal::FinalSection*>& sections = state.sections;
+	std::vector<SectionUnwindInfos> sectionInfos(sections.size());
+	ld::parallel::forEach(sections.size(), [&](size_t sectionIndex) {
+		SectionUnwindInfos& info = sectionInfos[sectionIndex];
+		uint64_t address = 0;
+		uint8_t maxAlignPowerOf2 = 0;
+		for (const ld::Atom* atom : sections[sectionIndex]->atoms) {
+			if ( atom->alignment().powerOf2 > maxAlignPowerOf2 )
+				maxAlignPowerOf2 = atom->alignment().powerOf2;
+			address = alignAddress(address, atom);
+			getAtomUnwindInfos(state, atom, address, info.entries);
 			address += atom->size();
 		}
+		info.size = address;
+		info.maxAlignPowerOf2 = maxAlignPowerOf2;
+	});
+
+	size_t entryCount = 0;
+	for (const SectionUnwindInfos& info : sectionInfos)
+		entryCount += info.entries.size();
+	entries.reserve(entryCount);
+
+	uint64_t address = 0;
+	for (size_t sectionIndex=0; sectionIndex < sections.size(); ++sectionIndex) {
+		SectionUnwindInfos& info = sectionInfos[sectionIndex];
+		if ( (address % (1ULL << info.maxAlignPowerOf2)) == 0 ) {
+			for (UnwindEntry& entry : info.entries)
+				entry.funcTentAddress += address;
+			address += info.size;
+		}
+		else {
+			// entries are in atom order, so walk both together
+			std::vector<UnwindEntry>::iterator eit = info.entries.begin();
+			for (const ld::Atom* atom : sections[sectionIndex]->atoms) {
+				address = alignAddress(address, atom);
+				for ( ; (eit != info.entries.end()) && (eit->func == atom); ++eit)
+					eit->funcTentAddress = address;
+				address += atom->size();
+			}
+		}
+		entries.insert(entries.end(), info.entries.begin(), info.entries.end());
 	}
 }
 
@@ -32,6 +32,9 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
 
 #include "Architectures.hpp"
 #include "MachOFileAbstraction.hpp"
@@ -45,6 +48,7 @@ namespace objc {
 
 
 typedef std::unordered_map<const char*, const ld::Atom*, ld::CStringHash, ld::CStringEquals> NameToAtom;
+typedef std::unordered_set<const ld::Atom*> AtomSet;
 
 struct objc_image_info  {
 	uint32_t	version;	// initially 0
@@ -232,7 +236,7 @@ public:
 
 											MethodListAtom(ld::Internal& state, const ld::Atom* baseMethodList, ListFormat kind, ListUse use, const char* className,
 														   bool meta, const std::vector<const ld::Atom*>* categories, NameToAtom& selectorNameToSlot,
-														   std::set<const ld::Atom*>& deadAtoms);
+														   AtomSet& deadAtoms);
 
 	virtual const ld::File*					file() const					{ return _file; }
 	virtual const char*						name() const					{ return _name; }
@@ -276,7 +280,7 @@ class ProtocolListAtom : public ld::Atom {
 public:
 											ProtocolListAtom(ld::Internal& state, const ld::Atom* baseProtocolList,
 															const char* className, const std::vector<const ld::Atom*>* categories,
-															std::set<const ld::Atom*>& deadAtoms);
+															AtomSet& deadAtoms);
 
 	virtual const ld::File*					file() const					{ return _file; }
 	virtual const char*						name() const					{ return _name.c_str(); }
@@ -314,7 +318,7 @@ public:
 
 											PropertyListAtom(ld::Internal& state, const ld::Atom* basePropertyList,
 															 const std::vector<const ld::Atom*>* categories,
-															 std::set<const ld::Atom*>& deadAtoms,
+															 AtomSet& deadAtoms,
 															 PropertyKind kind);
 
 	virtual const ld::File*					file() const					{ return _file; }
@@ -431,9 +435,66 @@ public:
 	static const ld::Atom*	getPointerInContent(ld::Internal& state, const ld::Atom* contentAtom, unsigned int offset, uint64_t* addend=NULL, bool* isAuthPtr=NULL);
 	static void				setPointerInContent(ld::Internal& state, const ld::Atom* contentAtom, 
 												unsigned int offset, const ld::Atom* newAtom);
+	static void				forgetFixupIndex(const ld::Atom* contentAtom);
 	typedef typename A::P::uint_t			pint_t;
+
+	// While one of these exists, field reads and writes go through a per-atom index of fixups
+	// sorted by offset, instead of rescanning all of an atom's fixups for every field.
+	class FixupIndexScope {
+	public:
+							FixupIndexScope()  { assert(_s_fixupIndex == NULL); _s_fixupIndex = new AtomToFixupOrder(); }
+							~FixupIndexScope() { delete _s_fixupIndex; _s_fixupIndex = NULL; }
+	};
+
+private:
+	typedef std::unordered_map<const ld::Atom*, std::vector<uint32_t>> AtomToFixupOrder;
+
+	template <typename F>
+	static void				forEachFixupAtOffset(const ld::Atom* contentAtom, unsigned int offset, F handler);
+
+	static AtomToFixupOrder*	_s_fixupIndex;
 };
 
+template <typename A>
+typename ObjCData<A>::AtomToFixupOrder* ObjCData<A>::_s_fixupIndex = NULL;
+
+// calls handler on each fixup at offset, in fixup order, until it returns true
+template <typename A>
+template <typename F>
+void ObjCData<A>::forEachFixupAtOffset(const ld::Atom* contentAtom, unsigned int offset, F handler)
+{
+	ld::Fixup::iterator fixups = contentAtom->fixupsBegin();
+	if ( _s_fixupIndex == NULL ) {
+		for (ld::Fixup::iterator fit=fixups; fit != contentAtom->fixupsEnd(); ++fit) {
+			if ( (fit->offsetInAtom == offset) && handler(fit) )
+				return;
+		}
+		return;
+	}
+	auto pos = _s_fixupIndex->find(contentAtom);
+	if ( pos == _s_fixupIndex->end() ) {
+		std::vector<uint32_t> order(contentAtom->fixupsEnd() - fixups);
+		for (uint32_t i=0; i < order.size(); ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t l, uint32_t r) { return fixups[l].offsetInAtom < fixups[r].offsetInAtom; });
+		pos = _s_fixupIndex->insert({ contentAtom, std::move(order) }).first;
+	}
+	const std::vector<uint32_t>& order = pos->second;
+	auto it = std::lower_bound(order.begin(), order.end(), offset, [&](uint32_t i, unsigned int off) { return fixups[i].offsetInAtom < off; });
+	for ( ; (it != order.end()) && (fixups[*it].offsetInAtom == offset); ++it) {
+		if ( handler(&fixups[*it]) )
+			return;
+	}
+}
+
+// must be called when fixups are added to or removed from an atom
+template <typename A>
+void ObjCData<A>::forgetFixupIndex(const ld::Atom* contentAtom)
+{
+	if ( _s_fixupIndex != NULL )
+		_s_fixupIndex->erase(contentAtom);
+}
+
 template <typename A>
 const ld::Atom* ObjCData<A>::getPointerInContent(ld::Internal& state, const ld::Atom* contentAtom, unsigned int offset, uint64_t* addend, bool* isAuthPtr)
 {
@@ -442,8 +503,8 @@ const ld::Atom* ObjCData<A>::getPointerInContent(ld::Internal& state, const ld::
 		*addend = 0;
 	if ( isAuthPtr != NULL )
 		*isAuthPtr = false;
-	for (ld::Fixup::iterator fit=contentAtom->fixupsBegin(); fit != contentAtom->fixupsEnd(); ++fit) {
-		if ( (fit->offsetInAtom == offset) && (fit->kind != ld::Fixup::kindNoneFollowOn) && (fit->kind != ld::Fixup::kindNoneGroupSubordinate) ) {
+	forEachFixupAtOffset(contentAtom, offset, [&](ld::Fixup::iterator fit) -> bool {
+		if ( (fit->kind != ld::Fixup::kindNoneFollowOn) && (fit->kind != ld::Fixup::kindNoneGroupSubordinate) ) {
 			switch ( fit->binding ) {
 				case ld::Fixup::bindingsIndirectlyBound:
 					target = state.indirectBindingTable[fit->u.bindingIndex];
@@ -467,7 +528,8 @@ const ld::Atom* ObjCData<A>::getPointerInContent(ld::Internal& state, const ld::
                     break;   
 			}
 		}
-	}
+		return false;
+	});
 	return target;
 }
 
@@ -475,21 +537,24 @@ template <typename A>
 void ObjCData<A>::setPointerInContent(ld::Internal& state, const ld::Atom* contentAtom, 
 														unsigned int offset, const ld::Atom* newAtom)
 {
-	for (ld::Fixup::iterator fit=contentAtom->fixupsBegin(); fit != contentAtom->fixupsEnd(); ++fit) {
-		if ( fit->offsetInAtom == offset ) {
-			switch ( fit->binding ) {
-				case ld::Fixup::bindingsIndirectlyBound:
-					state.indirectBindingTable[fit->u.bindingIndex] = newAtom;
-					return;
-				case ld::Fixup::bindingDirectlyBound:
-					fit->u.target = newAtom;
-					return;
-                default:
-                     break;    
-			}
+	bool updated = false;
+	forEachFixupAtOffset(contentAtom, offset, [&](ld::Fixup::iterator fit) -> bool {
+		switch ( fit->binding ) {
+			case ld::Fixup::bindingsIndirectlyBound:
+				state.indirectBindingTable[fit->u.bindingIndex] = newAtom;
+				updated = true;
+				return true;
+			case ld::Fixup::bindingDirectlyBound:
+				fit->u.target = newAtom;
+				updated = true;
+				return true;
+            default:
+                 break;    
 		}
-	}
-	assert(0 && "could not update method list");
+		return false;
+	});
+	if ( !updated )
+		assert(0 && "could not update method list");
 }
 
 
@@ -526,18 +591,18 @@ public:
 	static bool				usesRelMethodLists(ld::Internal& state, const ld::Atom* contentAtom);
 	// Setters
 	static const ld::Atom*	setName(ld::Internal& state, const ld::Atom* categoryAtom,
-									const ld::Atom* categoryNameAtom, std::set<const ld::Atom*>& deadAtoms);
+									const ld::Atom* categoryNameAtom, AtomSet& deadAtoms);
 	static void				setInstanceMethods(ld::Internal& state, const ld::Atom*& categoryAtom, const ld::Atom* methodListAtom,
-												bool usesAuthPtrs, bool& categoryIsNowOverlay, std::set<const ld::Atom*>& deadAtoms);
+												bool usesAuthPtrs, bool& categoryIsNowOverlay, AtomSet& deadAtoms);
 	static void				setClassMethods(ld::Internal& state, const ld::Atom*& categoryAtom, const ld::Atom* methodListAtom,
-												bool usesAuthPtrs, bool& categoryIsNowOverlay, std::set<const ld::Atom*>& deadAtoms);
+												bool usesAuthPtrs, bool& categoryIsNowOverlay, AtomSet& deadAtoms);
 	static void 			setInstanceProperties(ld::Internal& state, const ld::Atom*& categoryAtom, const ld::Atom* propertyListAtom,
-												  bool& categoryIsNowOverlay, std::set<const ld::Atom*>& deadAtoms);
+												  bool& categoryIsNowOverlay, AtomSet& deadAtoms);
 	static void				setClassProperties(ld::Internal& state, const ld::Atom*& categoryAtom, const ld::Atom* propertyListAtom,
-											   bool& categoryIsNowOverlay, std::set<const ld::Atom*>& deadAtoms);
+											   bool& categoryIsNowOverlay, AtomSet& deadAtoms);
 	static void				setProtocols(ld::Internal& state, const ld::Atom*& categoryAtom,
 										 const ld::Atom* protocolListAtom, bool& categoryIsNowOverlay,
-										 std::set<const ld::Atom*>& deadAtoms);
+										 AtomSet& deadAtoms);
 	static uint32_t         size() { return 6*sizeof(pint_t); }
 
 	static bool				hasCategoryClassPropertiesField(const ld::Atom* categoryAtom);
@@ -650,7 +715,7 @@ bool Category<A>::hasCategoryClassPropertiesField(const ld::Atom* contentAtom)
 
 
 template <typename A>
-void Category<A>::setInstanceMethods(ld::Internal& state, const ld::Atom*& categoryAtom, const ld::Atom* methodListAtom, bool useAuthPtrs, bool& categoryIsNowOverlay, std::set<const ld::Atom*>& deadAtoms)
+void Category<A>::setInstanceMethods(ld::Internal& state, const ld::Atom*& categoryAtom, const ld::Atom* methodListAtom, bool useAuthPtrs, bool& categoryIsNowOverlay, AtomSet& deadAtoms)
 {
 	// if the base class does not already have a method list, we need to create an overlay
 	bool needAuthPtrToMethodList = useAuthPtrs && (strcmp(methodListAtom->section().sectionName(), "__objc_methlist") == 0);
@@ -668,7 +733,7 @@ void Category<A>::setInstanceMethods(ld::Internal& state, const ld::Atom*& categ
 }
 
 template <typename A>
-void Category<A>::setClassMethods(ld::Internal& state, const ld::Atom*& categoryAtom, const ld::Atom* methodListAtom, bool useAuthPtrs, bool& categoryIsNowOverlay, std::set<const ld::Atom*>& deadAtoms)
+void Category<A>::setClassMethods(ld::Internal& state, const ld::Atom*& categoryAtom, const ld::Atom* methodListAtom, bool useAuthPtrs, bool& categoryIsNowOverlay, AtomSet& deadAtoms)
 {
 	// if the base class does not already have a method list, we need to create an overlay
 	bool needAuthPtrToMethodList = useAuthPtrs && (strcmp(methodListAtom->section().sectionName(), "__objc_methlist") == 0);
@@ -693,7 +758,7 @@ void Category<A>::setClassMethods(ld::Internal& state, const ld::Atom*& category
 template <typename A>
 void Category<A>::setProtocols(ld::Internal& state, const ld::Atom*& categoryAtom,
 							   const ld::Atom* protocolListAtom, bool& categoryIsNowOverlay,
-							   std::set<const ld::Atom*>& deadAtoms)
+							   AtomSet& deadAtoms)
 {
 	// if the base category does not already have a protocol list, we need to create an overlay
 	if ( getProtocols(state, categoryAtom) == NULL ) {
@@ -715,7 +780,7 @@ void Category<A>::setProtocols(ld::Internal& state, const ld::Atom*& categoryAto
 
 template <typename A>
 void Category<A>::setInstanceProperties(ld::Internal& state, const ld::Atom*& categoryAtom, const ld::Atom* methodListAtom,
-										bool& categoryIsNowOverlay, std::set<const ld::Atom*>& deadAtoms)
+										bool& categoryIsNowOverlay, AtomSet& deadAtoms)
 {
 	// if the base category does not already have a property list, we need to create an overlay
 	if ( getInstanceProperties(state, categoryAtom) == NULL ) {
@@ -737,7 +802,7 @@ void Category<A>::setInstanceProperties(ld::Internal& state, const ld::Atom*& ca
 
 template <typename A>
 void Category<A>::setClassProperties(ld::Internal& state, const ld::Atom*& categoryAtom, const ld::Atom* methodListAtom,
-									 bool& categoryIsNowOverlay, std::set<const ld::Atom*>& deadAtoms)
+									 bool& categoryIsNowOverlay, AtomSet& deadAtoms)
 {
 	// if the base category does not already have a property list, we need to create an overlay
 	if ( getClassProperties(state, categoryAtom) == NULL ) {
@@ -798,17 +863,17 @@ public:
 	static const ld::Atom*	getClassPropertyList(ld::Internal& state, const ld::Atom* classAtom);
 	static bool				usesRelMethodLists(ld::Internal& state, const ld::Atom* classAtom);
 	static void				setInstanceMethodList(ld::Internal& state, const ld::Atom* classAtom,
-												const ld::Atom* methodListAtom, bool useAuthPtrs, std::set<const ld::Atom*>& deadAtoms);
+												const ld::Atom* methodListAtom, bool useAuthPtrs, AtomSet& deadAtoms);
 	static void				setInstanceProtocolList(ld::Internal& state, const ld::Atom* classAtom,
-												const ld::Atom* protocolListAtom, std::set<const ld::Atom*>& deadAtoms);
+												const ld::Atom* protocolListAtom, AtomSet& deadAtoms);
 	static void        		setInstancePropertyList(ld::Internal& state, const ld::Atom* classAtom,
-												const ld::Atom* propertyListAtom, std::set<const ld::Atom*>& deadAtoms);
+												const ld::Atom* propertyListAtom, AtomSet& deadAtoms);
 	static void  			setClassMethodList(ld::Internal& state, const ld::Atom* classAtom,
-												const ld::Atom* methodListAtom, bool useAuthPtrs, std::set<const ld::Atom*>& deadAtoms);
+												const ld::Atom* methodListAtom, bool useAuthPtrs, AtomSet& deadAtoms);
 	static void				setClassProtocolList(ld::Internal& state, const ld::Atom* classAtom,
-												const ld::Atom* protocolListAtom, std::set<const ld::Atom*>& deadAtoms);
+												const ld::Atom* protocolListAtom, AtomSet& deadAtoms);
 	static void				setClassPropertyList(ld::Internal& state, const ld::Atom* classAtom,
-												const ld::Atom* propertyListAtom, std::set<const ld::Atom*>& deadAtoms);
+												const ld::Atom* propertyListAtom, AtomSet& deadAtoms);
 	static uint32_t         size() { return sizeof(Content); }
 
 private:
@@ -921,7 +986,7 @@ const ld::Atom*	Class<A>::getClassPropertyList(ld::Internal& state, const ld::At
 
 template <typename A>
 void Class<A>::setInstanceMethodList(ld::Internal& state, const ld::Atom* classAtom,
-									 const ld::Atom* methodListAtom, bool useAuthPtrs, std::set<const ld::Atom*>& deadAtoms)
+									 const ld::Atom* methodListAtom, bool useAuthPtrs, AtomSet& deadAtoms)
 {
 	// if the base class does not already have a method list, we need to create an overlay
 	bool needAuthPtrToMethodList = useAuthPtrs && (strcmp(methodListAtom->section().sectionName(), "__objc_methlist") == 0);
@@ -941,7 +1006,7 @@ void Class<A>::setInstanceMethodList(ld::Internal& state, const ld::Atom* classA
 
 template <typename A>
 void Class<A>::setInstanceProtocolList(ld::Internal& state, const ld::Atom* classAtom,
-									const ld::Atom* protocolListAtom, std::set<const ld::Atom*>& deadAtoms)
+									const ld::Atom* protocolListAtom, AtomSet& deadAtoms)
 {
 	// if the base class does not already have a protocol list, we need to create an overlay
 	if ( getInstanceProtocolList(state, classAtom) == NULL ) {
@@ -959,7 +1024,7 @@ void Class<A>::setInstanceProtocolList(ld::Internal& state, const ld::Atom* clas
 
 template <typename A>
 void Class<A>::setClassProtocolList(ld::Internal& state, const ld::Atom* classAtom,
-									const ld::Atom* protocolListAtom, std::set<const ld::Atom*>& deadAtoms)
+									const ld::Atom* protocolListAtom, AtomSet& deadAtoms)
 {
 	// meta class also points to same protocol list as class
 	const ld::Atom* metaClassAtom = getMetaClass(state, classAtom);
@@ -971,7 +1036,7 @@ void Class<A>::setClassProtocolList(ld::Internal& state, const ld::Atom* classAt
 
 template <typename A>
 void Class<A>::setInstancePropertyList(ld::Internal& state, const ld::Atom* classAtom,
-										const ld::Atom* propertyListAtom, std::set<const ld::Atom*>& deadAtoms)
+										const ld::Atom* propertyListAtom, AtomSet& deadAtoms)
 {
 	// if the base class does not already have a property list, we need to create an overlay
 	if ( getInstancePropertyList(state, classAtom) == NULL ) {
@@ -989,7 +1054,7 @@ void Class<A>::setInstancePropertyList(ld::Internal& state, const ld::Atom* clas
 
 template <typename A>
 void Class<A>::setClassMethodList(ld::Internal& state, const ld::Atom* classAtom,
-											const ld::Atom* methodListAtom, bool useAuthPtrs, std::set<const ld::Atom*>& deadAtoms)
+											const ld::Atom* methodListAtom, bool useAuthPtrs, AtomSet& deadAtoms)
 {
 	// class methods is just instance methods of metaClass
 	setInstanceMethodList(state, getMetaClass(state, classAtom), methodListAtom, useAuthPtrs, deadAtoms);
@@ -997,7 +1062,7 @@ void Class<A>::setClassMethodList(ld::Internal& state, const ld::Atom* classAtom
 
 template <typename A>
 void Class<A>::setClassPropertyList(ld::Internal& state, const ld::Atom* classAtom,
-											const ld::Atom* propertyListAtom, std::set<const ld::Atom*>& deadAtoms)
+											const ld::Atom* propertyListAtom, AtomSet& deadAtoms)
 {
 	// class properties is just instance properties of metaClass
 	setInstancePropertyList(state, getMetaClass(state, classAtom), propertyListAtom, deadAtoms);
@@ -1033,6 +1098,7 @@ template <typename A>
 void ObjCOverlayAtom<A>::addFixupAtOffset(uint32_t offset, bool isAuthPtr)
 {
 	// remove any fixups from original atom at this location
+	ObjCData<A>::forgetFixupIndex(this);
 	_fixups.erase(std::remove_if(_fixups.begin(), _fixups.end(), [offset](const ld::Fixup& f){return f.offsetInAtom == offset;}), _fixups.end());
 
 	if ( isAuthPtr ) {
@@ -1261,12 +1327,12 @@ static const ld::Atom* fixClassAliases(const ld::Atom* classAtom, uint64_t& adde
 //
 class OptimizedAway {
 public:
-	OptimizedAway(const std::set<const ld::Atom*>& oa) : _dead(oa) {}
+	OptimizedAway(const AtomSet& oa) : _dead(oa) {}
 	bool operator()(const ld::Atom* atom) const {
 		return ( _dead.count(atom) != 0 );
 	}
 private:
-	const std::set<const ld::Atom*>& _dead;
+	const AtomSet& _dead;
 };
 
 struct AtomSorter
@@ -1311,7 +1377,8 @@ static bool compSelRefs(const ld::Atom* l, const ld::Atom* r)
 template <typename A>
 void OptimizeCategories<A>::doit(const Options& opts, ld::Internal& state, bool haveCategoriesWithoutClassPropertyStorage)
 {
-	std::set<const ld::Atom*> deadAtoms;
+	typename ObjCData<A>::FixupIndexScope fixupIndex;
+	AtomSet deadAtoms;
 	static const bool log = false;
 #if SUPPORT_ARCH_arm64e
 	const bool usesAuthPtrs = opts.supportsAuthenticatedPointers();
@@ -1323,9 +1390,9 @@ void OptimizeCategories<A>::doit(const Options& opts, ld::Internal& state, bool
 																    : (usesAuthPtrs ? MethodListAtom<A>::threePointersAuthImpl : MethodListAtom<A>::threePointers);
 
 	// find all category atoms and the class they apply to
-	std::map<const ld::Atom*, const ld::Atom*> categoryToClassAtoms;
-	std::map<const ld::Atom*, const ld::Atom*> categoryToListElement;
-	std::map<const ld::Atom*, const ld::Atom*> categoryToNlListElement;
+	std::unordered_map<const ld::Atom*, const ld::Atom*> categoryToClassAtoms;
+	std::unordered_map<const ld::Atom*, const ld::Atom*> categoryToListElement;
+	std::unordered_map<const ld::Atom*, const ld::Atom*> categoryToNlListElement;
 	for (ld::Internal::FinalSection* sect : state.sections) {
 		if ( sect->type() == ld::Section::typeObjC2CategoryList ) {
 			bool isNonLazyCategory = (strcmp(sect->sectionName(), "__objc_nlcatlist") == 0);
@@ -1367,9 +1434,9 @@ void OptimizeCategories<A>::doit(const Options& opts, ld::Internal& state, bool
 	}
 
 	// find all class definition atoms
-	std::set<const ld::Atom*> classDefAtoms;
-	std::set<const ld::Atom*> nlClassDefAtoms;
-	std::map<const ld::Atom*, unsigned> classDefToPlusLoadCount;
+	AtomSet classDefAtoms;
+	AtomSet nlClassDefAtoms;
+	std::unordered_map<const ld::Atom*, unsigned> classDefToPlusLoadCount;
 	for (ld::Internal::FinalSection* sect : state.sections) {
 		if ( strncmp(sect->segmentName(), "__DATA", 6) != 0 )
 			continue;
@@ -1396,7 +1463,7 @@ void OptimizeCategories<A>::doit(const Options& opts, ld::Internal& state, bool
 	}
 
 	// build map of all categories on each class
-	typedef std::map<const ld::Atom*, std::vector<const ld::Atom*>> ClassToCategories;
+	typedef std::unordered_map<const ld::Atom*, std::vector<const ld::Atom*>> ClassToCategories;
 	ClassToCategories classDefsToCategories;
 	ClassToCategories externalClassToCategories;
 	std::vector<const ld::Atom*> externalClassAtoms;
@@ -1795,7 +1862,7 @@ static void forEachMethod(ld::Internal& state, const ld::Atom* categoryMethodLis
 template <typename A> 
 MethodListAtom<A>::MethodListAtom(ld::Internal& state, const ld::Atom* baseMethodList, MethodListAtom<A>::ListFormat kind, MethodListAtom<A>::ListUse use,
 								  const char* className, bool meta, const std::vector<const ld::Atom*>* categories, NameToAtom& selectorNameToSlot,
-								  std::set<const ld::Atom*>& deadAtoms)
+								  AtomSet& deadAtoms)
   : ld::Atom((kind == threeDeltas) ? _s_section_rel : _s_section_ptrs,
 			ld::Atom::definitionRegular, ld::Atom::combineNever,
 			ld::Atom::scopeTranslationUnit, ld::Atom::typeUnclassified,
@@ -2027,7 +2094,7 @@ void MethodListAtom<A>::copyRawContent(uint8_t buffer[]) const
 
 template <typename A>
 ProtocolListAtom<A>::ProtocolListAtom(ld::Internal& state, const ld::Atom* baseProtocolList, const char* className,
-									const std::vector<const ld::Atom*>* categories, std::set<const ld::Atom*>& deadAtoms)
+									const std::vector<const ld::Atom*>* categories, AtomSet& deadAtoms)
   : ld::Atom(_s_section, ld::Atom::definitionRegular, ld::Atom::combineNever,
 			ld::Atom::scopeLinkageUnit, ld::Atom::typeUnclassified,
 			symbolTableIn, false, false, false, ld::Atom::Alignment(3)), _file(NULL), _protocolCount(0)
@@ -2102,7 +2169,7 @@ ProtocolListAtom<A>::ProtocolListAtom(ld::Internal& state, const ld::Atom* baseP
 
 template <typename A>
 PropertyListAtom<A>::PropertyListAtom(ld::Internal& state, const ld::Atom* basePropertyList,
-				      const std::vector<const ld::Atom*>* categories, std::set<const ld::Atom*>& deadAtoms, PropertyKind kind)
+				      const std::vector<const ld::Atom*>* categories, AtomSet& deadAtoms, PropertyKind kind)
   : ld::Atom(_s_section, ld::Atom::definitionRegular, ld::Atom::combineNever,
 			ld::Atom::scopeLinkageUnit, ld::Atom::typeUnclassified,
 			symbolTableNotIn, false, false, false, ld::Atom::Alignment(3)), _file(NULL), _propertyCount(0)
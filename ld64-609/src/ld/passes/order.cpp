@@ -32,6 +32,7 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <string_view>
 #include <unordered_map>
 
 #include "ld.hpp"
@@ -66,7 +67,8 @@ namespace order {
 // atom in a cluster to the first Atom in the cluster.  The "nexts" maps an Atom in a
 // cluster to the next Atom in the cluster.  With this in place, while processing an
 // order_file, if any entry is in a cluster (in "starts" map), then the entire cluster is
-// given ordinal overrides.
+// given ordinal overrides.  Once built, each cluster is copied into one flat array so the
+// order_file pass can walk a cluster without map lookups.
 //
 
 class Layout
@@ -86,25 +88,40 @@ private:
 	};
 				
 	typedef std::unordered_map<std::string_view, const ld::Atom*> NameToAtom;
+
+	typedef std::pair<std::string_view, std::string_view> NameAndFile;
+	struct NameAndFileHash {
+		size_t operator()(const NameAndFile& key) const {
+			return std::hash<std::string_view>()(key.first) ^ (std::hash<std::string_view>()(key.second) * 31);
+		}
+	};
+	typedef std::unordered_map<NameAndFile, const ld::Atom*, NameAndFileHash> NameAndFileToAtom;
 	
-	typedef std::map<const ld::Atom*, const ld::Atom*> AtomToAtom;
+	typedef std::unordered_map<const ld::Atom*, const ld::Atom*> AtomToAtom;
 	
-	typedef std::map<const ld::Atom*, uint32_t> AtomToOrdinal;
+	typedef std::unordered_map<const ld::Atom*, uint32_t> AtomToOrdinal;
+
+	typedef std::unordered_map<const ld::Atom*, size_t> AtomToIndex;
 	
 	const ld::Atom*		findAtom(const Options::OrderedSymbol& orderedSymbol);
 	void				buildNameTable();
+	void				addNameCollision(std::string_view name, const ld::Atom* atom);
 	void				buildFollowOnTables();
 	void				buildOrdinalOverrideMap();
 	const ld::Atom*		follower(const ld::Atom* atom);
 	static bool			matchesObjectFile(const ld::Atom* atom, const char* objectFileLeafName);
+	static std::string_view	leafFileName(const ld::Atom* atom);
 			bool		possibleToOrder(const ld::Internal::FinalSection*);
 	
 	const Options&						_options;
 	ld::Internal&						_state;
 	AtomToAtom							_followOnStarts;
 	AtomToAtom							_followOnNexts;
+	AtomToAtom							_followOnPrevs;
+	std::vector<const ld::Atom*>		_followOnClusters;		// atoms of each cluster in layout order, each followed by NULL
+	AtomToIndex							_followOnClusterStart;	// index in _followOnClusters of the cluster an atom is in
 	NameToAtom							_nameTable;
-	std::vector<const ld::Atom*>		_nameCollisionAtoms;
+	NameAndFileToAtom					_nameCollisionTable;	// duplicated names by (name, .o leaf name), and by (name, "") for the first one
 	AtomToOrdinal						_ordinalOverrideMap;
 	Comparer							_comparer;
 	bool								_haveOrderFile;
@@ -267,6 +284,15 @@ bool Layout::Comparer::operator()(const ld::Atom* left, const ld::Atom* right)
 	return (addrDiff < 0);
 }
 
+std::string_view Layout::leafFileName(const ld::Atom* atom)
+{
+	const char* atomFullPath = atom->file()->path();
+	const char* lastSlash = strrchr(atomFullPath, '/');
+	if ( lastSlash != NULL )
+		return &lastSlash[1];
+	return atomFullPath;
+}
+
 bool Layout::matchesObjectFile(const ld::Atom* atom, const char* objectFileLeafName)
 {
 	if ( objectFileLeafName == NULL )
@@ -326,12 +352,11 @@ void Layout::buildNameTable()
 					if ( pos == _nameTable.end() )
 						_nameTable[name] = atom;
 					else {
-						const ld::Atom* existing = _nameTable[name];
-						if ( existing != NULL ) {
-							_nameCollisionAtoms.push_back(existing);
-							_nameTable[name] = NULL;	// collision, denote with NULL
+						if ( pos->second != NULL ) {
+							this->addNameCollision(name, pos->second);
+							pos->second = NULL;	// collision, denote with NULL
 						}
-						_nameCollisionAtoms.push_back(atom);
+						this->addNameCollision(name, atom);
 					}
 				}
 			}
@@ -341,12 +366,20 @@ void Layout::buildNameTable()
 		fprintf(stderr, "buildNameTable() _nameTable:\n");
 		for(NameToAtom::iterator it=_nameTable.begin(); it != _nameTable.end(); ++it)
 			fprintf(stderr, "  %p <- %s\n", it->second, std::string(it->first).c_str());
-		fprintf(stderr, "buildNameTable() _nameCollisionAtoms:\n");
-		for(std::vector<const ld::Atom*>::iterator it=_nameCollisionAtoms.begin(); it != _nameCollisionAtoms.end(); ++it)
-			fprintf(stderr, "  %p, %s\n", *it, std::string((*it)->getUserVisibleName()).c_str());
+		fprintf(stderr, "buildNameTable() _nameCollisionTable:\n");
+		for(NameAndFileToAtom::iterator it=_nameCollisionTable.begin(); it != _nameCollisionTable.end(); ++it)
+			fprintf(stderr, "  %p <- %s/%s\n", it->second, std::string(it->first.second).c_str(), std::string(it->first.first).c_str());
 	}
 }
 
+void Layout::addNameCollision(std::string_view name, const ld::Atom* atom)
+{
+	// the first atom seen with a name wins, as if the duplicates were searched in order
+	_nameCollisionTable.emplace(NameAndFile(name, std::string_view()), atom);
+	if ( atom->file() != NULL )
+		_nameCollisionTable.emplace(NameAndFile(name, leafFileName(atom)), atom);
+}
+
 
 const ld::Atom* Layout::findAtom(const Options::OrderedSymbol& orderedSymbol)
 {
@@ -358,19 +391,20 @@ const ld::Atom* Layout::findAtom(const Options::OrderedSymbol& orderedSymbol)
 			return pos->second;
 		}
 		if ( pos->second == NULL ) {
-			// name is in hash table, but atom is NULL, so that means there are duplicates, so we use super slow way
+			// name is in hash table, but atom is NULL, so that means there are duplicates, so look up name and .o file
 			if ( ( orderedSymbol.objectFileName == NULL) && _options.printOrderFileStatistics() ) {
 				warning("%s specified in order_file but it exists in multiple .o files. "
 						"Prefix symbol with .o filename in order_file to disambiguate", orderedSymbol.symbolName);
 			}
-			for (std::vector<const ld::Atom*>::iterator it=_nameCollisionAtoms.begin(); it != _nameCollisionAtoms.end(); it++) {
-				const ld::Atom* atom = *it;
-				if ( atom->getUserVisibleName() == std::string_view(orderedSymbol.symbolName) ) {
-					if ( matchesObjectFile(atom, orderedSymbol.objectFileName) ) {
-						return atom;
-					}
-				}
+			std::string_view fileName;
+			if ( orderedSymbol.objectFileName != NULL ) {
+				fileName = orderedSymbol.objectFileName;
+				if ( fileName.empty() )
+					return NULL;
 			}
+			NameAndFileToAtom::iterator collision = _nameCollisionTable.find(NameAndFile(pos->first, fileName));
+			if ( collision != _nameCollisionTable.end() )
+				return collision->second;
 		}
 	}
 		
@@ -379,12 +413,9 @@ const ld::Atom* Layout::findAtom(const Options::OrderedSymbol& orderedSymbol)
 
 const ld::Atom* Layout::follower(const ld::Atom* atom)
 {
-	for (const ld::Atom* a = _followOnStarts[atom]; a != NULL; a = _followOnNexts[a]) {
-		assert(a != NULL);
-		if ( _followOnNexts[a] == atom ) {
-			return a;
-		}
-	}
+	AtomToAtom::iterator pos = _followOnPrevs.find(atom);
+	if ( pos != _followOnPrevs.end() )
+		return pos->second;
 	// no follower, first in chain
 	return NULL;
 }
@@ -418,6 +449,7 @@ void Layout::buildFollowOnTables()
 					if ( _followOnStarts.count(followOnAtom) == 0 ) {
 						// first time followOnAtom has been seen, make atom start of chain
 						_followOnStarts[followOnAtom] = _followOnStarts[atom];
+						_followOnPrevs[followOnAtom] = atom;
 						if ( _s_log ) fprintf(stderr, "  start %s -> %s\n", followOnAtom->name(), _followOnStarts[atom]->name());
 					}
 					else {
@@ -435,6 +467,7 @@ void Layout::buildFollowOnTables()
 								else
 									break;
 							}
+							_followOnPrevs[followOnAtom] = atom;
 						}
 						else {
 							// attempt to insert atom into existing followOn chain
@@ -446,6 +479,8 @@ void Layout::buildFollowOnTables()
 								_followOnNexts[curPrevToFollowOnAtom] = atom;
 								_followOnNexts[atom] = followOnAtom;
 								_followOnStarts[atom] = _followOnStarts[followOnAtom];
+								_followOnPrevs[atom] = curPrevToFollowOnAtom;
+								_followOnPrevs[followOnAtom] = atom;
 							}
 							else {
 								// insert real atom into existing chain right before alias of followOnAtom
@@ -453,9 +488,12 @@ void Layout::buildFollowOnTables()
 								if ( curPrevPrevToFollowOn == NULL ) {
 									// nothing previous, so make this a start of a new chain
 									_followOnNexts[atom] = curPrevToFollowOnAtom;
-									for (const ld::Atom* a = atom; a != NULL; a = _followOnNexts[a]) {
+									_followOnPrevs[curPrevToFollowOnAtom] = atom;
+									for (const ld::Atom* a = atom; a != NULL; ) {
 										if ( _s_log ) fprintf(stderr, "  adjust start for %s -> %s\n", a->name(), atom->name());
 										_followOnStarts[a] = atom;
+										AtomToAtom::iterator pos = _followOnNexts.find(a);
+										a = (pos != _followOnNexts.end()) ? pos->second : NULL;
 									}
 								}
 								else {
@@ -463,6 +501,8 @@ void Layout::buildFollowOnTables()
 									_followOnNexts[curPrevPrevToFollowOn] = atom;
 									_followOnNexts[atom] = curPrevToFollowOnAtom;
 									_followOnStarts[atom] = _followOnStarts[curPrevToFollowOnAtom];
+									_followOnPrevs[atom] = curPrevPrevToFollowOn;
+									_followOnPrevs[curPrevToFollowOnAtom] = atom;
 								}
 							}
 						}
@@ -479,6 +519,28 @@ void Layout::buildFollowOnTables()
 		for(AtomToAtom::iterator it = _followOnNexts.begin(); it != _followOnNexts.end(); ++it)
 			fprintf(stderr, "next %s -> %s\n", it->first->name(), (it->second != NULL) ? it->second->name() : "null");
 	}
+
+	// copy each cluster into _followOnClusters, and record where every atom's cluster starts
+	AtomToIndex clusterIndexOfStart;
+	for (AtomToAtom::iterator it = _followOnStarts.begin(); it != _followOnStarts.end(); ++it) {
+		if ( it->first != it->second )
+			continue;
+		clusterIndexOfStart[it->first] = _followOnClusters.size();
+		for (const ld::Atom* a = it->first; a != NULL; ) {
+			_followOnClusters.push_back(a);
+			AtomToAtom::iterator pos = _followOnNexts.find(a);
+			a = (pos != _followOnNexts.end()) ? pos->second : NULL;
+		}
+		_followOnClusters.push_back(NULL);
+	}
+	for (AtomToAtom::iterator it = _followOnStarts.begin(); it != _followOnStarts.end(); ++it) {
+		AtomToIndex::iterator pos = clusterIndexOfStart.find(it->second);
+		if ( pos != clusterIndexOfStart.end() )
+			_followOnClusterStart[it->first] = pos->second;
+	}
+	_followOnStarts.clear();
+	_followOnNexts.clear();
+	_followOnPrevs.clear();
 }
 
 
@@ -529,10 +591,11 @@ void Layout::buildOrdinalOverrideMap()
 					break;
 			}
 		
-			AtomToAtom::iterator start = _followOnStarts.find(atom);
-			if ( start != _followOnStarts.end() ) {
+			AtomToIndex::iterator start = _followOnClusterStart.find(atom);
+			if ( start != _followOnClusterStart.end() ) {
 				// this symbol for the order file corresponds to an atom that is in a cluster that must lay out together
-				for(const ld::Atom* nextAtom = start->second; nextAtom != NULL; nextAtom = _followOnNexts[nextAtom]) {
+				for(size_t i = start->second; _followOnClusters[i] != NULL; ++i) {
+					const ld::Atom* nextAtom = _followOnClusters[i];
 					AtomToOrdinal::iterator pos = _ordinalOverrideMap.find(nextAtom);
 					if ( pos == _ordinalOverrideMap.end() ) {
 						_ordinalOverrideMap[nextAtom] = index++;
@@ -540,7 +603,7 @@ void Layout::buildOrdinalOverrideMap()
 					}
 					else {
 						if (_s_log ) fprintf(stderr, "could not order %s as %u because it was already laid out earlier by %s as %u\n",
-										atom->name(), index, _followOnStarts[atom]->name(), _ordinalOverrideMap[atom] );
+										atom->name(), index, _followOnClusters[start->second]->name(), _ordinalOverrideMap[atom] );
 					}
 				}
 			}
@@ -34,6 +34,7 @@
 #include "MachOFileAbstraction.hpp"
 #include "parsers/macho_relocatable_file.h"
 #include "parsers/lto_file.h"
+#include "Parallel.h"
 
 const ld::VersionSet ld::File::_platforms;
 
@@ -70,6 +71,15 @@ void throwf(const char* format, ...)
 void warning(const char* format, ...)
 {
 	va_list	list;
+	if ( ld::parallel::WarningBuffer* buffer = ld::parallel::currentWarnings() ) {
+		char* message;
+		va_start(list, format);
+		vasprintf(&message, format, list);
+		va_end(list);
+		buffer->push_back(message);
+		free(message);
+		return;
+	}
 	fprintf(stderr, "warning: ");
 	va_start(list, format);
 	vfprintf(stderr, format, list);
@@ -31,6 +31,8 @@
 #include <unistd.h>
 #include <errno.h>
 
+#include <algorithm>
+#include <functional>
 #include <vector>
 #include <tuple>
 #include <set>
@@ -40,6 +42,7 @@
 #include "MachOFileAbstraction.hpp"
 #include "Architectures.hpp"
 #include "MachOTrie.hpp"
+#include "MachOChainedFixups.hpp"
 #include "../ld/code-sign-blobs/superblob.h"
 
 static bool printRebase = false;
@@ -55,6 +58,7 @@ static bool printFunctionStarts = false;
 static bool printDylibs = false;
 static bool printDRs = false;
 static bool printDataCode = false;
+static bool printFixupChains = false;
 static cpu_type_t	sPreferredArch = 0;
 static cpu_type_t	sPreferredSubArch = 0;
 
@@ -110,6 +114,9 @@ private:
 	void										printDylibsInfo();
 	void										printDRInfo();
 	void										printDataInCode();
+	void										printChainedRebaseInfo();
+	void										printChainedBindingInfo();
+	void										printChainedFixupsInfo();
 	void										printFunctionStartLine(uint64_t addr);
 	const uint8_t*								printSharedRegionV1InfoForEachULEB128Address(const uint8_t* p, const uint8_t* end, uint8_t kind);
 	const uint8_t*								printSharedRegionV2InfoForEachULEB128Address(const uint8_t* p, const uint8_t* end);
@@ -118,6 +125,26 @@ private:
 	const uint8_t*								printSharedRegionV2ToSectionOffset(const uint8_t* p, const uint8_t* end);
 	const uint8_t*								printSharedRegionV2Kind(const uint8_t* p, const uint8_t* end);
 
+	struct AddressRange {
+		pint_t						start;
+		pint_t						end;
+		uint8_t						segIndex;
+		const macho_section<P>*		sect;
+	};
+	struct ChainedImport {
+		int							libOrdinal;
+		bool						weakImport;
+		int64_t						addend;
+		const char*					name;
+	};
+	typedef mach_o::chained_fixups::Fixup ChainedFixup;
+
+	void										buildAddressTables();
+	static const AddressRange*					findRange(const std::vector<AddressRange>& ranges, pint_t address);
+	const dyld_chained_fixups_header*			chainedFixupsHeader();
+	const char*									chainedPointerFormatName(uint16_t format);
+	void										parseChainedImports();
+	void										forEachChainedFixup(const std::function<void(uint8_t segIndex, pint_t address, const ChainedFixup& fixup)>& handler);
 	pint_t										localRelocBase();
 	pint_t										externalRelocBase();
 	const char*									relocTypeName(uint8_t r_type);
@@ -153,6 +180,7 @@ private:
 	const macho_linkedit_data_command<P>*		fFunctionStartsInfo;
 	const macho_linkedit_data_command<P>*		fDataInCode;
 	const macho_linkedit_data_command<P>*		fDRInfo;
+	const macho_linkedit_data_command<P>*		fChainedFixups;
 	uint64_t									fBaseAddress;
 	const macho_dysymtab_command<P>*			fDynamicSymbolTable;
 	const macho_segment_command<P>*				fFirstSegment;
@@ -160,6 +188,9 @@ private:
 	bool										fWriteableSegmentWithAddrOver4G;
 	std::vector<const macho_segment_command<P>*>fSegments;
 	std::vector<const macho_section<P>*>		fSections;
+	std::vector<AddressRange>					fSegmentRanges;		// sorted by address, for address to segment lookups
+	std::vector<AddressRange>					fSectionRanges;		// sorted by address, for address to section lookups
+	std::vector<ChainedImport>					fChainedImports;
 	std::vector<const char*>					fDylibs;
 	std::vector<const macho_dylib_command<P>*>	fDylibLoadCommands;
 	macho_section<P>							fMachHeaderPseudoSection;
@@ -317,7 +348,7 @@ template <typename A>
 DyldInfoPrinter<A>::DyldInfoPrinter(const uint8_t* fileContent, uint32_t fileLength, const char* path, bool printArch)
  : fHeader(NULL), fLength(fileLength), 
    fStrings(NULL), fStringsEnd(NULL), fSymbols(NULL), fSymbolCount(0), fInfo(NULL), 
-   fSharedRegionInfo(NULL), fFunctionStartsInfo(NULL), fDataInCode(NULL), fDRInfo(NULL), 
+   fSharedRegionInfo(NULL), fFunctionStartsInfo(NULL), fDataInCode(NULL), fDRInfo(NULL), fChainedFixups(NULL),
    fBaseAddress(0), fDynamicSymbolTable(NULL), fFirstSegment(NULL), fFirstWritableSegment(NULL),
    fWriteableSegmentWithAddrOver4G(false)
 {
@@ -420,9 +451,13 @@ DyldInfoPrinter<A>::DyldInfoPrinter(const uint8_t* fileContent, uint32_t fileLen
 			case LC_DYLIB_CODE_SIGN_DRS:
 				fDRInfo = (macho_linkedit_data_command<P>*)cmd;
 				break;
+			case LC_DYLD_CHAINED_FIXUPS:
+				fChainedFixups = (macho_linkedit_data_command<P>*)cmd;
+				break;
 		}
 		cmd = (const macho_load_command<P>*)endOfCmd;
 	}
+	buildAddressTables();
 	
 	if ( printArch ) {
 		for (const ArchInfo* t=archInfoArray; t->archName != NULL; ++t) {
@@ -437,12 +472,16 @@ DyldInfoPrinter<A>::DyldInfoPrinter(const uint8_t* fileContent, uint32_t fileLen
 	if ( printRebase ) {
 		if ( fInfo != NULL )
 			printRebaseInfo();
+		else if ( fChainedFixups != NULL )
+			printChainedRebaseInfo();
 		else
 			printRelocRebaseInfo();
 	}
 	if ( printBind ) {
 		if ( fInfo != NULL )
 			printBindingInfo();
+		else if ( fChainedFixups != NULL )
+			printChainedBindingInfo();
 		else
 			printClassicBindingInfo();
 	}
@@ -480,6 +519,8 @@ DyldInfoPrinter<A>::DyldInfoPrinter(const uint8_t* fileContent, uint32_t fileLen
 		printDRInfo();
 	if ( printDataCode )
 		printDataInCode();
+	if ( printFixupChains )
+		printChainedFixupsInfo();
 }
 
 static uint64_t read_uleb128(const uint8_t*& p, const uint8_t* end)
@@ -568,24 +609,52 @@ const char* DyldInfoPrinter<A>::segmentName(uint8_t segIndex)
 	return fSegments[segIndex]->segname();
 }
 
+template <typename A>
+void DyldInfoPrinter<A>::buildAddressTables()
+{
+	for (unsigned int i=0; i < fSegments.size(); ++i) {
+		const macho_segment_command<P>* segCmd = fSegments[i];
+		if ( segCmd->vmsize() != 0 )
+			fSegmentRanges.push_back({ (pint_t)segCmd->vmaddr(), (pint_t)(segCmd->vmaddr()+segCmd->vmsize()), (uint8_t)i, NULL });
+		const macho_section<P>* const sectionsStart = (macho_section<P>*)((char*)segCmd + sizeof(macho_segment_command<P>));
+		const macho_section<P>* const sectionsEnd = &sectionsStart[segCmd->nsects()];
+		for(const macho_section<P>* sect = sectionsStart; sect < sectionsEnd; ++sect) {
+			if ( sect->size() != 0 )
+				fSectionRanges.push_back({ (pint_t)sect->addr(), (pint_t)(sect->addr()+sect->size()), (uint8_t)i, sect });
+		}
+	}
+	auto byStart = [](const AddressRange& left, const AddressRange& right) { return left.start < right.start; };
+	std::stable_sort(fSegmentRanges.begin(), fSegmentRanges.end(), byStart);
+	std::stable_sort(fSectionRanges.begin(), fSectionRanges.end(), byStart);
+}
+
+template <typename A>
+const typename DyldInfoPrinter<A>::AddressRange* DyldInfoPrinter<A>::findRange(const std::vector<AddressRange>& ranges, pint_t address)
+{
+	// find last range starting at or before address
+	auto pos = std::upper_bound(ranges.begin(), ranges.end(), address, [](pint_t addr, const AddressRange& range) { return addr < range.start; });
+	if ( pos == ranges.begin() )
+		return NULL;
+	--pos;
+	if ( address >= pos->end )
+		return NULL;
+	return &*pos;
+}
+
 template <typename A>
 const char* DyldInfoPrinter<A>::sectionName(uint8_t segIndex, pint_t address)
 {
 	if ( segIndex > fSegments.size() )
 		throw "segment index out of range";
-	const macho_segment_command<P>* segCmd = fSegments[segIndex];
-	macho_section<P>* const sectionsStart = (macho_section<P>*)((char*)segCmd + sizeof(macho_segment_command<P>));
-	macho_section<P>* const sectionsEnd = &sectionsStart[segCmd->nsects()];
-	for(macho_section<P>* sect = sectionsStart; sect < sectionsEnd; ++sect) {
-		if ( (sect->addr() <= address) && (address < (sect->addr()+sect->size())) ) {
-			if ( strlen(sect->sectname()) > 15 ) {
-				static char temp[18];
-				strlcpy(temp, sect->sectname(), 17);
-				return temp;
-			}
-			else {
-				return sect->sectname();
-			}
+	const AddressRange* range = findRange(fSectionRanges, address);
+	if ( (range != NULL) && (range->segIndex == segIndex) ) {
+		if ( strlen(range->sect->sectname()) > 15 ) {
+			static char temp[18];
+			strlcpy(temp, range->sect->sectname(), 17);
+			return temp;
+		}
+		else {
+			return range->sect->sectname();
 		}
 	}
 	return "??";
@@ -597,16 +666,12 @@ const char* DyldInfoPrinter<A>::getSegAndSectName(uint8_t segIndex, pint_t addre
 	static char buffer[64];
 	strcpy(buffer, segmentName(segIndex));
 	strcat(buffer, "/");
-	const macho_segment_command<P>* segCmd = fSegments[segIndex];
-	macho_section<P>* const sectionsStart = (macho_section<P>*)((char*)segCmd + sizeof(macho_segment_command<P>));
-	macho_section<P>* const sectionsEnd = &sectionsStart[segCmd->nsects()];
-	for(macho_section<P>* sect = sectionsStart; sect < sectionsEnd; ++sect) {
-		if ( (sect->addr() <= address) && (address < (sect->addr()+sect->size())) ) {
-			// section name may not be zero terminated
-			char* end = &buffer[strlen(buffer)];
-			strlcpy(end, sect->sectname(), 16);
-			return buffer;				
-		}
+	const AddressRange* range = findRange(fSectionRanges, address);
+	if ( (range != NULL) && (range->segIndex == segIndex) ) {
+		// section name may not be zero terminated
+		char* end = &buffer[strlen(buffer)];
+		strlcpy(end, range->sect->sectname(), 16);
+		return buffer;
 	}
 	return "??";
 }
@@ -614,22 +679,20 @@ const char* DyldInfoPrinter<A>::getSegAndSectName(uint8_t segIndex, pint_t addre
 template <typename A>
 uint8_t DyldInfoPrinter<A>::segmentIndexForAddress(pint_t address)
 {
-	for(unsigned int i=0; i < fSegments.size(); ++i) {
-		if ( (fSegments[i]->vmaddr() <= address) && (address < (fSegments[i]->vmaddr()+fSegments[i]->vmsize())) ) {
-			return i;
-		}
-	}
+	const AddressRange* range = findRange(fSegmentRanges, address);
+	if ( range != NULL )
+		return range->segIndex;
 	throwf("address 0x%llX is not in any segment", (uint64_t)address);
 }
 
 template <typename A>
 typename A::P::uint_t*	DyldInfoPrinter<A>::mappedAddressForVMAddress(pint_t vmaddress)
 {
-	for(unsigned int i=0; i < fSegments.size(); ++i) {
-		if ( (fSegments[i]->vmaddr() <= vmaddress) && (vmaddress < (fSegments[i]->vmaddr()+fSegments[i]->vmsize())) ) {
-			unsigned long offsetInMappedFile = fSegments[i]->fileoff()+vmaddress-fSegments[i]->vmaddr();
-			return (pint_t*)((uint8_t*)fHeader + offsetInMappedFile);
-		}
+	const AddressRange* range = findRange(fSegmentRanges, vmaddress);
+	if ( range != NULL ) {
+		const macho_segment_command<P>* segCmd = fSegments[range->segIndex];
+		unsigned long offsetInMappedFile = segCmd->fileoff()+vmaddress-segCmd->vmaddr();
+		return (pint_t*)((uint8_t*)fHeader + offsetInMappedFile);
 	}
 	throwf("address 0x%llX is not in any segment", (uint64_t)vmaddress);
 }
@@ -2286,6 +2349,220 @@ const char*	DyldInfoPrinter<arm64_32>::relocTypeName(uint8_t r_type)
 }
 #endif
 
+template <typename A>
+const char* DyldInfoPrinter<A>::chainedPointerFormatName(uint16_t format)
+{
+	switch ( format ) {
+		case DYLD_CHAINED_PTR_ARM64E:
+			return "DYLD_CHAINED_PTR_ARM64E";
+		case DYLD_CHAINED_PTR_64:
+			return "DYLD_CHAINED_PTR_64";
+		case DYLD_CHAINED_PTR_32:
+			return "DYLD_CHAINED_PTR_32";
+		case DYLD_CHAINED_PTR_32_CACHE:
+			return "DYLD_CHAINED_PTR_32_CACHE";
+		case DYLD_CHAINED_PTR_32_FIRMWARE:
+			return "DYLD_CHAINED_PTR_32_FIRMWARE";
+		case DYLD_CHAINED_PTR_64_OFFSET:
+			return "DYLD_CHAINED_PTR_64_OFFSET";
+		case DYLD_CHAINED_PTR_ARM64E_KERNEL:
+			return "DYLD_CHAINED_PTR_ARM64E_KERNEL";
+		case DYLD_CHAINED_PTR_ARM64E_USERLAND:
+			return "DYLD_CHAINED_PTR_ARM64E_USERLAND";
+		case DYLD_CHAINED_PTR_ARM64E_USERLAND24:
+			return "DYLD_CHAINED_PTR_ARM64E_USERLAND24";
+	}
+	return "!!unknown!!";
+}
+
+template <typename A>
+const dyld_chained_fixups_header* DyldInfoPrinter<A>::chainedFixupsHeader()
+{
+	if ( (uint64_t)fChainedFixups->dataoff() + fChainedFixups->datasize() > fLength )
+		throw "LC_DYLD_CHAINED_FIXUPS data extends beyond end of file";
+	if ( fChainedFixups->datasize() < sizeof(dyld_chained_fixups_header) )
+		throw "LC_DYLD_CHAINED_FIXUPS data too small";
+	const dyld_chained_fixups_header* header = (dyld_chained_fixups_header*)((uint8_t*)fHeader + fChainedFixups->dataoff());
+	if ( header->fixups_version != 0 )
+		throwf("unknown chained fixups version %d", header->fixups_version);
+	return header;
+}
+
+template <typename A>
+void DyldInfoPrinter<A>::parseChainedImports()
+{
+	if ( !fChainedImports.empty() )
+		return;
+	const dyld_chained_fixups_header* header = chainedFixupsHeader();
+	const uint8_t* chainData = (uint8_t*)header;
+	const uint8_t* chainDataEnd = chainData + fChainedFixups->datasize();
+	if ( header->symbols_format != 0 )
+		throw "compressed chained fixup symbol names not supported";
+	const char* symbolsStart = (char*)chainData + header->symbols_offset;
+	const char* symbolsEnd = (char*)chainDataEnd;
+	size_t importSize;
+	switch ( header->imports_format ) {
+		case DYLD_CHAINED_IMPORT:
+			importSize = sizeof(dyld_chained_import);
+			break;
+		case DYLD_CHAINED_IMPORT_ADDEND:
+			importSize = sizeof(dyld_chained_import_addend);
+			break;
+		case DYLD_CHAINED_IMPORT_ADDEND64:
+			importSize = sizeof(dyld_chained_import_addend64);
+			break;
+		default:
+			throwf("unknown chained fixups imports format %d", header->imports_format);
+	}
+	if ( (uint64_t)header->imports_offset + (uint64_t)header->imports_count*importSize > fChainedFixups->datasize() )
+		throw "chained fixups imports table extends beyond LC_DYLD_CHAINED_FIXUPS data";
+	fChainedImports.reserve(header->imports_count);
+	const uint8_t* importsStart = chainData + header->imports_offset;
+	for (uint32_t i=0; i < header->imports_count; ++i) {
+		ChainedImport import;
+		uint32_t nameOffset;
+		switch ( header->imports_format ) {
+			case DYLD_CHAINED_IMPORT: {
+				const dyld_chained_import* imp = &((dyld_chained_import*)importsStart)[i];
+				import.libOrdinal = (imp->lib_ordinal > 0xF0) ? (int8_t)imp->lib_ordinal : imp->lib_ordinal;
+				import.weakImport = imp->weak_import;
+				import.addend     = 0;
+				nameOffset        = imp->name_offset;
+				break;
+			}
+			case DYLD_CHAINED_IMPORT_ADDEND: {
+				const dyld_chained_import_addend* imp = &((dyld_chained_import_addend*)importsStart)[i];
+				import.libOrdinal = (imp->lib_ordinal > 0xF0) ? (int8_t)imp->lib_ordinal : imp->lib_ordinal;
+				import.weakImport = imp->weak_import;
+				import.addend     = imp->addend;
+				nameOffset        = imp->name_offset;
+				break;
+			}
+			default: {
+				const dyld_chained_import_addend64* imp = &((dyld_chained_import_addend64*)importsStart)[i];
+				import.libOrdinal = (imp->lib_ordinal > 0xFFF0) ? (int16_t)imp->lib_ordinal : imp->lib_ordinal;
+				import.weakImport = imp->weak_import;
+				import.addend     = imp->addend;
+				nameOffset        = imp->name_offset;
+				break;
+			}
+		}
+		if ( symbolsStart + nameOffset >= symbolsEnd )
+			throwf("chained fixups import #%d name offset out of range", i);
+		import.name = symbolsStart + nameOffset;
+		fChainedImports.push_back(import);
+	}
+}
+
+template <typename A>
+void DyldInfoPrinter<A>::forEachChainedFixup(const std::function<void(uint8_t segIndex, pint_t address, const ChainedFixup& fixup)>& handler)
+{
+	mach_o::chained_fixups::forEachFixup<A>((uint8_t*)fHeader, (uint8_t*)chainedFixupsHeader(), fChainedFixups->datasize(), fSegments, fBaseAddress,
+											  [&](uint32_t segIndex, uint64_t address, const ChainedFixup& fixup) {
+		handler(segIndex, (pint_t)address, fixup);
+	});
+}
+
+template <typename A>
+void DyldInfoPrinter<A>::printChainedRebaseInfo()
+{
+	static const char* keyNames[] = { "IA", "IB", "DA", "DB" };
+	printf("rebase information (from chained fixups):\n");
+	printf("segment section          address     type         value\n");
+	forEachChainedFixup([&](uint8_t segIndex, pint_t address, const ChainedFixup& fixup) {
+		if ( fixup.isBind )
+			return;
+		if ( fixup.isAuth )
+			printf("%-7s %-16s 0x%08llX  %s  0x%08llX (JOP: diversity %d, address %s, %s)\n", segmentName(segIndex), sectionName(segIndex, address),
+					(uint64_t)address, rebaseTypeName(REBASE_TYPE_POINTER), fixup.target, fixup.diversity, fixup.addrDiv ? "true" : "false", keyNames[fixup.key]);
+		else
+			printf("%-7s %-16s 0x%08llX  %s  0x%08llX\n", segmentName(segIndex), sectionName(segIndex, address),
+					(uint64_t)address, rebaseTypeName(REBASE_TYPE_POINTER), fixup.target);
+	});
+}
+
+template <typename A>
+void DyldInfoPrinter<A>::printChainedBindingInfo()
+{
+	parseChainedImports();
+	printf("bind information (from chained fixups):\n");
+	printf("segment section          address        type    addend dylib            symbol\n");
+	forEachChainedFixup([&](uint8_t segIndex, pint_t address, const ChainedFixup& fixup) {
+		if ( !fixup.isBind )
+			return;
+		if ( fixup.bindOrdinal >= fChainedImports.size() )
+			throwf("chained fixup at 0x%llX uses import #%u which is out of range", (uint64_t)address, fixup.bindOrdinal);
+		const ChainedImport& import = fChainedImports[fixup.bindOrdinal];
+		printf("%-7s %-16s 0x%08llX %10s  %5lld %-16s %s%s\n", segmentName(segIndex), sectionName(segIndex, address), (uint64_t)address,
+				bindTypeName(BIND_TYPE_POINTER), import.addend + fixup.addend, ordinalName(import.libOrdinal), import.name,
+				import.weakImport ? " (weak import)" : "");
+	});
+}
+
+template <typename A>
+void DyldInfoPrinter<A>::printChainedFixupsInfo()
+{
+	if ( fChainedFixups == NULL ) {
+		printf("no chained fixups\n");
+		return;
+	}
+	const dyld_chained_fixups_header* header = chainedFixupsHeader();
+	printf("chained fixups header:\n");
+	printf("  fixups_version = %d\n", header->fixups_version);
+	printf("  starts_offset  = 0x%08X\n", header->starts_offset);
+	printf("  imports_offset = 0x%08X\n", header->imports_offset);
+	printf("  symbols_offset = 0x%08X\n", header->symbols_offset);
+	printf("  imports_count  = %d\n", header->imports_count);
+	printf("  imports_format = %d\n", header->imports_format);
+	printf("  symbols_format = %d\n", header->symbols_format);
+
+	const uint8_t* chainDataEnd = (uint8_t*)header + fChainedFixups->datasize();
+	const dyld_chained_starts_in_image* startsInImage = (dyld_chained_starts_in_image*)((uint8_t*)header + header->starts_offset);
+	if ( (uint8_t*)&startsInImage->seg_info_offset[startsInImage->seg_count] > chainDataEnd )
+		throw "chained fixups segment count out of range";
+	for (uint32_t segIndex=0; (segIndex < startsInImage->seg_count) && (segIndex < fSegments.size()); ++segIndex) {
+		if ( startsInImage->seg_info_offset[segIndex] == 0 )
+			continue;
+		const dyld_chained_starts_in_segment* segInfo = (dyld_chained_starts_in_segment*)((uint8_t*)startsInImage + startsInImage->seg_info_offset[segIndex]);
+		if ( (uint8_t*)&segInfo->page_start[segInfo->page_count] > chainDataEnd )
+			throwf("chained fixups for segment %s extend beyond LC_DYLD_CHAINED_FIXUPS data", segmentName(segIndex));
+		printf("chain starts for segment %s:\n", segmentName(segIndex));
+		printf("  pointer_format    = %d (%s)\n", segInfo->pointer_format, chainedPointerFormatName(segInfo->pointer_format));
+		printf("  page_size         = 0x%04X\n", segInfo->page_size);
+		printf("  segment_offset    = 0x%08llX\n", (uint64_t)segInfo->segment_offset);
+		printf("  max_valid_pointer = 0x%08X\n", segInfo->max_valid_pointer);
+		printf("  page_count        = %d\n", segInfo->page_count);
+		for (uint32_t pageIndex=0; pageIndex < segInfo->page_count; ++pageIndex) {
+			if ( segInfo->page_start[pageIndex] == DYLD_CHAINED_PTR_START_NONE )
+				printf("    page_start[%d] = none\n", pageIndex);
+			else
+				printf("    page_start[%d] = 0x%04X\n", pageIndex, segInfo->page_start[pageIndex]);
+		}
+	}
+
+	parseChainedImports();
+	printf("imports:\n");
+	for (uint32_t i=0; i < fChainedImports.size(); ++i) {
+		const ChainedImport& import = fChainedImports[i];
+		printf("  [%d] %-16s %s%s", i, ordinalName(import.libOrdinal), import.name, import.weakImport ? " (weak import)" : "");
+		if ( import.addend != 0 )
+			printf(" + %lld", import.addend);
+		printf("\n");
+	}
+
+	printf("fixups:\n");
+	printf("segment section          address     kind    value\n");
+	forEachChainedFixup([&](uint8_t segIndex, pint_t address, const ChainedFixup& fixup) {
+		const char* auth = fixup.isAuth ? " (auth)" : "";
+		if ( fixup.isBind )
+			printf("%-7s %-16s 0x%08llX  bind    import #%u + %lld%s\n", segmentName(segIndex), sectionName(segIndex, address), (uint64_t)address,
+					fixup.bindOrdinal, fixup.addend, auth);
+		else
+			printf("%-7s %-16s 0x%08llX  rebase  0x%08llX%s\n", segmentName(segIndex), sectionName(segIndex, address), (uint64_t)address,
+					fixup.target, auth);
+	});
+}
+
 template <typename A>
 void DyldInfoPrinter<A>::printRelocRebaseInfo()
 {
@@ -2772,6 +3049,7 @@ static void usage()
 			"\t-function_starts  print table of function start addresses\n"
 			"\t-export_dot       print a GraphViz .dot file of the exported symbols trie\n"
 			"\t-data_in_code     print any data-in-code information\n"
+			"\t-fixup_chains     print chained fixup starts, imports, and every fixup in the chains\n"
 		);
 }
 
@@ -2850,6 +3128,9 @@ int main(int argc, const char* argv[])
 				else if ( strcmp(arg, "-data_in_code") == 0 ) {
 					printDataCode = true;
 				}
+				else if ( strcmp(arg, "-fixup_chains") == 0 ) {
+					printFixupChains = true;
+				}
 				else {
 					throwf("unknown option: %s\n", arg);
 				}
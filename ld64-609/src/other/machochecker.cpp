@@ -32,6 +32,7 @@
 #include <unistd.h>
 #include <errno.h>
 
+#include <algorithm>
 #include <vector>
 #include <set>
 #include <unordered_set>
@@ -39,6 +40,7 @@
 #include "configure.h"
 
 #include "MachOFileAbstraction.hpp"
+#include "MachOChainedFixups.hpp"
 #include "Architectures.hpp"
 
 
@@ -154,6 +156,10 @@ private:
 	pint_t										segStartAddress(uint8_t segIndex);
 	bool										addressIsRebaseSite(pint_t addr, pint_t& pointeeAddr);
 	bool										addressIsBindingSite(pint_t addr);
+	void										buildFixupSiteIndex();
+	void										addRebaseOpcodeSites();
+	void										addBindOpcodeSites();
+	void										addChainedFixupSites();
 	pint_t										getInitialStackPointer(const macho_thread_command<P>*);
 	pint_t										getEntryPoint(const macho_thread_command<P>*);
 	const char*									archName();
@@ -184,9 +190,20 @@ private:
 	const macho_segment_command<P>*				fFirstWritableSegment;
 	const macho_segment_command<P>*				fTEXTSegment;
 	const macho_dyld_info_command<P>*			fDyldInfo;
+	const macho_linkedit_data_command<P>*		fChainedFixups = NULL;
 	uint32_t									fSectionCount;
 	std::vector<const macho_segment_command<P>*>fSegments;
 	const std::vector<const char*>& 			fMergeRootPaths;
+
+	// every rebase and bind location, decoded once the first time a check needs them
+	struct RebaseSite {
+		pint_t		address;
+		pint_t		pointee;
+		bool		hasPointee;		// threaded and chained rebases encode the target in place
+	};
+	bool										fFixupSitesIndexed = false;
+	std::vector<RebaseSite>						fRebaseSites;		// sorted by address
+	std::vector<pint_t>							fBindingSites;		// sorted
 };
 
 
@@ -515,9 +532,11 @@ void MachOChecker<A>::checkLoadCommands()
 			case LC_SOURCE_VERSION:
 			case LC_NOTE:
 			case LC_BUILD_VERSION:
-			case LC_DYLD_CHAINED_FIXUPS:
 			case LC_DYLD_EXPORTS_TRIE:
 				break;
+			case LC_DYLD_CHAINED_FIXUPS:
+				fChainedFixups = (macho_linkedit_data_command<P>*)cmd;
+				break;
 			case LC_RPATH:
 				fHasLC_RPATH = true;
 				break;
@@ -1664,89 +1683,13 @@ typename A::P::uint_t MachOChecker<A>::segStartAddress(uint8_t segIndex)
 template <typename A>
 bool MachOChecker<A>::hasTextRelocInRange(pint_t rangeStart, pint_t rangeEnd)
 {
-	// look at local relocs
-	const macho_relocation_info<P>* const localRelocsEnd = &fLocalRelocations[fLocalRelocationsCount];
-	for (const macho_relocation_info<P>* reloc = fLocalRelocations; reloc < localRelocsEnd; ++reloc) {
-		pint_t relocAddress = reloc->r_address() + this->relocBase();
-		if ( (rangeStart <= relocAddress) && (relocAddress < rangeEnd) )
+	buildFixupSiteIndex();
+	auto pos = std::lower_bound(fRebaseSites.begin(), fRebaseSites.end(), rangeStart,
+								[](const RebaseSite& site, pint_t addr) { return site.address < addr; });
+	for ( ; (pos != fRebaseSites.end()) && (pos->address < rangeEnd); ++pos) {
+		// only local relocs and rebase opcodes can be text relocs
+		if ( !pos->hasPointee )
 			return true;
-	}	
-	// look rebase info
-	if ( fDyldInfo != NULL ) {
-		const uint8_t* p = (uint8_t*)fHeader + fDyldInfo->rebase_off();
-		const uint8_t* end = &p[fDyldInfo->rebase_size()];
-		
-		uint8_t type = 0;
-		uint64_t segOffset = 0;
-		uint32_t count;
-		uint32_t skip;
-		int segIndex;
-		pint_t segStartAddr = 0;
-		pint_t addr;
-		bool done = false;
-		while ( !done && (p < end) ) {
-			uint8_t immediate = *p & REBASE_IMMEDIATE_MASK;
-			uint8_t opcode = *p & REBASE_OPCODE_MASK;
-			++p;
-			switch (opcode) {
-				case REBASE_OPCODE_DONE:
-					done = true;
-					break;
-				case REBASE_OPCODE_SET_TYPE_IMM:
-					type = immediate;
-					break;
-				case REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB:
-					segIndex = immediate;
-					segStartAddr = segStartAddress(segIndex);
-					segOffset = read_uleb128(p, end);
-					break;
-				case REBASE_OPCODE_ADD_ADDR_ULEB:
-					segOffset += read_uleb128(p, end);
-					break;
-				case REBASE_OPCODE_ADD_ADDR_IMM_SCALED:
-					segOffset += immediate*sizeof(pint_t);
-					break;
-				case REBASE_OPCODE_DO_REBASE_IMM_TIMES:
-					for (int i=0; i < immediate; ++i) {
-						addr = segStartAddr+segOffset;
-						if ( (rangeStart <= addr) && (addr < rangeEnd) )
-							return true;
-						//printf("%-7s %-16s 0x%08llX  %s\n", segName, sectionName(segIndex, segStartAddr+segOffset), segStartAddr+segOffset, typeName);
-						segOffset += sizeof(pint_t);
-					}
-					break;
-				case REBASE_OPCODE_DO_REBASE_ULEB_TIMES:
-					count = read_uleb128(p, end);
-					for (uint32_t i=0; i < count; ++i) {
-						addr = segStartAddr+segOffset;
-						if ( (rangeStart <= addr) && (addr < rangeEnd) )
-							return true;
-						//printf("%-7s %-16s 0x%08llX  %s\n", segName, sectionName(segIndex, segStartAddr+segOffset), segStartAddr+segOffset, typeName);
-						segOffset += sizeof(pint_t);
-					}
-					break;
-				case REBASE_OPCODE_DO_REBASE_ADD_ADDR_ULEB:
-					addr = segStartAddr+segOffset;
-					if ( (rangeStart <= addr) && (addr < rangeEnd) )
-						return true;
-					//printf("%-7s %-16s 0x%08llX  %s\n", segName, sectionName(segIndex, segStartAddr+segOffset), segStartAddr+segOffset, typeName);
-					segOffset += read_uleb128(p, end) + sizeof(pint_t);
-					break;
-				case REBASE_OPCODE_DO_REBASE_ULEB_TIMES_SKIPPING_ULEB:
-					count = read_uleb128(p, end);
-					skip = read_uleb128(p, end);
-					for (uint32_t i=0; i < count; ++i) {
-						addr = segStartAddr+segOffset;
-						if ( (rangeStart <= addr) && (addr < rangeEnd) )
-							return true;
-						//printf("%-7s %-16s 0x%08llX  %s\n", segName, sectionName(segIndex, segStartAddr+segOffset), segStartAddr+segOffset, typeName);
-						segOffset += skip + sizeof(pint_t);
-					}
-					break;
-				default:
-					throwf("bad rebase opcode %d", *p);
-			}
-		}	
 	}
 	return false;
 }
@@ -1754,334 +1697,245 @@ bool MachOChecker<A>::hasTextRelocInRange(pint_t rangeStart, pint_t rangeEnd)
 template <typename A>
 bool MachOChecker<A>::addressIsRebaseSite(pint_t targetAddr, pint_t& pointeeAddr)
 {
-	// look at local relocs
+	buildFixupSiteIndex();
+	auto pos = std::lower_bound(fRebaseSites.begin(), fRebaseSites.end(), targetAddr,
+								[](const RebaseSite& site, pint_t addr) { return site.address < addr; });
+	if ( (pos == fRebaseSites.end()) || (pos->address != targetAddr) )
+		return false;
+	if ( pos->hasPointee )
+		pointeeAddr = pos->pointee;
+	return true;
+}
+
+template <typename A>
+bool MachOChecker<A>::addressIsBindingSite(pint_t targetAddr)
+{
+	buildFixupSiteIndex();
+	return std::binary_search(fBindingSites.begin(), fBindingSites.end(), targetAddr);
+}
+
+template <typename A>
+void MachOChecker<A>::buildFixupSiteIndex()
+{
+	if ( fFixupSitesIndexed )
+		return;
+	fFixupSitesIndexed = true;
+
+	// local relocs are added first so they win over an in-place rebase at the same address
 	const macho_relocation_info<P>* const localRelocsEnd = &fLocalRelocations[fLocalRelocationsCount];
-	for (const macho_relocation_info<P>* reloc = fLocalRelocations; reloc < localRelocsEnd; ++reloc) {
-		pint_t relocAddress = reloc->r_address() + this->relocBase();
-		if ( relocAddress == targetAddr )
-			return true;
-	}	
-	// look rebase info
+	for (const macho_relocation_info<P>* reloc = fLocalRelocations; reloc < localRelocsEnd; ++reloc)
+		fRebaseSites.push_back({ (pint_t)(reloc->r_address() + this->relocBase()), 0, false });
+	const macho_relocation_info<P>* const externRelocsEnd = &fExternalRelocations[fExternalRelocationsCount];
+	for (const macho_relocation_info<P>* reloc = fExternalRelocations; reloc < externRelocsEnd; ++reloc)
+		fBindingSites.push_back(reloc->r_address() + this->relocBase());
 	if ( fDyldInfo != NULL ) {
-		const uint8_t* p = (uint8_t*)fHeader + fDyldInfo->rebase_off();
-		const uint8_t* end = &p[fDyldInfo->rebase_size()];
-		
-		uint8_t type = 0;
-		uint64_t segOffset = 0;
-		uint32_t count;
-		uint32_t skip;
-		int segIndex;
-		pint_t segStartAddr = 0;
-		pint_t addr;
-		bool done = false;
-		while ( !done && (p < end) ) {
-			uint8_t immediate = *p & REBASE_IMMEDIATE_MASK;
-			uint8_t opcode = *p & REBASE_OPCODE_MASK;
-			++p;
-			switch (opcode) {
-				case REBASE_OPCODE_DONE:
-					done = true;
-					break;
-				case REBASE_OPCODE_SET_TYPE_IMM:
-					type = immediate;
-					break;
-				case REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB:
-					segIndex = immediate;
-					segStartAddr = segStartAddress(segIndex);
-					segOffset = read_uleb128(p, end);
-					break;
-				case REBASE_OPCODE_ADD_ADDR_ULEB:
-					segOffset += read_uleb128(p, end);
-					break;
-				case REBASE_OPCODE_ADD_ADDR_IMM_SCALED:
-					segOffset += immediate*sizeof(pint_t);
-					break;
-				case REBASE_OPCODE_DO_REBASE_IMM_TIMES:
-					for (int i=0; i < immediate; ++i) {
-						addr = segStartAddr+segOffset;
-						if ( addr == targetAddr )
-							return true;
-						//printf("%-7s %-16s 0x%08llX  %s\n", segName, sectionName(segIndex, segStartAddr+segOffset), segStartAddr+segOffset, typeName);
-						segOffset += sizeof(pint_t);
-					}
-					break;
-				case REBASE_OPCODE_DO_REBASE_ULEB_TIMES:
-					count = read_uleb128(p, end);
-					for (uint32_t i=0; i < count; ++i) {
-						addr = segStartAddr+segOffset;
-						if ( addr == targetAddr )
-							return true;
-						//printf("%-7s %-16s 0x%08llX  %s\n", segName, sectionName(segIndex, segStartAddr+segOffset), segStartAddr+segOffset, typeName);
-						segOffset += sizeof(pint_t);
-					}
-					break;
-				case REBASE_OPCODE_DO_REBASE_ADD_ADDR_ULEB:
-					addr = segStartAddr+segOffset;
-					if ( addr == targetAddr )
-						return true;
-					//printf("%-7s %-16s 0x%08llX  %s\n", segName, sectionName(segIndex, segStartAddr+segOffset), segStartAddr+segOffset, typeName);
-					segOffset += read_uleb128(p, end) + sizeof(pint_t);
-					break;
-				case REBASE_OPCODE_DO_REBASE_ULEB_TIMES_SKIPPING_ULEB:
-					count = read_uleb128(p, end);
-					skip = read_uleb128(p, end);
-					for (uint32_t i=0; i < count; ++i) {
-						addr = segStartAddr+segOffset;
-						if ( addr == targetAddr )
-							return true;
-						//printf("%-7s %-16s 0x%08llX  %s\n", segName, sectionName(segIndex, segStartAddr+segOffset), segStartAddr+segOffset, typeName);
-						segOffset += skip + sizeof(pint_t);
-					}
-					break;
-				default:
-					throwf("bad rebase opcode %d", *p);
-			}
+		addRebaseOpcodeSites();
+		addBindOpcodeSites();
+	}
+	if ( fChainedFixups != NULL )
+		addChainedFixupSites();
+
+	std::stable_sort(fRebaseSites.begin(), fRebaseSites.end(),
+					 [](const RebaseSite& left, const RebaseSite& right) { return left.address < right.address; });
+	std::sort(fBindingSites.begin(), fBindingSites.end());
+}
+
+template <typename A>
+void MachOChecker<A>::addRebaseOpcodeSites()
+{
+	const uint8_t* p = (uint8_t*)fHeader + fDyldInfo->rebase_off();
+	const uint8_t* end = &p[fDyldInfo->rebase_size()];
+
+	uint64_t segOffset = 0;
+	uint32_t count;
+	uint32_t skip;
+	pint_t segStartAddr = 0;
+	bool done = false;
+	while ( !done && (p < end) ) {
+		uint8_t immediate = *p & REBASE_IMMEDIATE_MASK;
+		uint8_t opcode = *p & REBASE_OPCODE_MASK;
+		++p;
+		switch (opcode) {
+			case REBASE_OPCODE_DONE:
+				done = true;
+				break;
+			case REBASE_OPCODE_SET_TYPE_IMM:
+				break;
+			case REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB:
+				segStartAddr = segStartAddress(immediate);
+				segOffset = read_uleb128(p, end);
+				break;
+			case REBASE_OPCODE_ADD_ADDR_ULEB:
+				segOffset += read_uleb128(p, end);
+				break;
+			case REBASE_OPCODE_ADD_ADDR_IMM_SCALED:
+				segOffset += immediate*sizeof(pint_t);
+				break;
+			case REBASE_OPCODE_DO_REBASE_IMM_TIMES:
+				for (int i=0; i < immediate; ++i) {
+					fRebaseSites.push_back({ (pint_t)(segStartAddr+segOffset), 0, false });
+					segOffset += sizeof(pint_t);
+				}
+				break;
+			case REBASE_OPCODE_DO_REBASE_ULEB_TIMES:
+				count = read_uleb128(p, end);
+				for (uint32_t i=0; i < count; ++i) {
+					fRebaseSites.push_back({ (pint_t)(segStartAddr+segOffset), 0, false });
+					segOffset += sizeof(pint_t);
+				}
+				break;
+			case REBASE_OPCODE_DO_REBASE_ADD_ADDR_ULEB:
+				fRebaseSites.push_back({ (pint_t)(segStartAddr+segOffset), 0, false });
+				segOffset += read_uleb128(p, end) + sizeof(pint_t);
+				break;
+			case REBASE_OPCODE_DO_REBASE_ULEB_TIMES_SKIPPING_ULEB:
+				count = read_uleb128(p, end);
+				skip = read_uleb128(p, end);
+				for (uint32_t i=0; i < count; ++i) {
+					fRebaseSites.push_back({ (pint_t)(segStartAddr+segOffset), 0, false });
+					segOffset += skip + sizeof(pint_t);
+				}
+				break;
+			default:
+				throwf("bad rebase opcode %d", *p);
 		}
-		
-		// If we have no rebase opcodes, then we may be using the threaded rebase/bind combined
-		// format and need to parse the bind opcodes instead.
-		if ( (fDyldInfo->rebase_size() == 0) && (fDyldInfo->bind_size() != 0) ) {
-			const uint8_t* p = (uint8_t*)fHeader + fDyldInfo->bind_off();
-			const uint8_t* end = &p[fDyldInfo->bind_size()];
-
-			uint8_t segIndex = 0;
-			uint64_t segOffset = 0;
-			uint32_t count;
-			uint32_t skip;
-			pint_t segStartAddr = 0;
-			bool done = false;
-			while ( !done && (p < end) ) {
-				uint8_t immediate = *p & BIND_IMMEDIATE_MASK;
-				uint8_t opcode = *p & BIND_OPCODE_MASK;
+	}
+}
+
+template <typename A>
+void MachOChecker<A>::addBindOpcodeSites()
+{
+	const uint8_t* p = (uint8_t*)fHeader + fDyldInfo->bind_off();
+	const uint8_t* end = &p[fDyldInfo->bind_size()];
+	// with no rebase opcodes, the threaded rebase/bind combined format may hold the rebases
+	const bool threadedRebases = (fDyldInfo->rebase_size() == 0);
+
+	uint8_t segIndex = 0;
+	uint64_t segOffset = 0;
+	uint32_t count;
+	uint32_t skip;
+	pint_t segStartAddr = 0;
+	bool done = false;
+	while ( !done && (p < end) ) {
+		uint8_t immediate = *p & BIND_IMMEDIATE_MASK;
+		uint8_t opcode = *p & BIND_OPCODE_MASK;
+		++p;
+		switch (opcode) {
+			case BIND_OPCODE_DONE:
+				done = true;
+				break;
+			case BIND_OPCODE_SET_DYLIB_ORDINAL_IMM:
+				break;
+			case BIND_OPCODE_SET_DYLIB_ORDINAL_ULEB:
+				read_uleb128(p, end);
+				break;
+			case BIND_OPCODE_SET_DYLIB_SPECIAL_IMM:
+				break;
+			case BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM:
+				while (*p != '\0')
+					++p;
 				++p;
-				switch (opcode) {
-					case BIND_OPCODE_DONE:
-						done = true;
-						break;
-					case BIND_OPCODE_SET_DYLIB_ORDINAL_IMM:
-						break;
-					case BIND_OPCODE_SET_DYLIB_ORDINAL_ULEB:
-						read_uleb128(p, end);
-						break;
-					case BIND_OPCODE_SET_DYLIB_SPECIAL_IMM:
-						break;
-					case BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM:
-						while (*p != '\0')
-							++p;
-						++p;
-						break;
-					case BIND_OPCODE_SET_TYPE_IMM:
-						break;
-					case BIND_OPCODE_SET_ADDEND_SLEB:
-						read_sleb128(p, end);
-						break;
-					case BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB:
-						segIndex = immediate;
-						segStartAddr = segStartAddress(segIndex);
-						segOffset = read_uleb128(p, end);
-						break;
-					case BIND_OPCODE_ADD_ADDR_ULEB:
-						segOffset += read_uleb128(p, end);
-						break;
-					case BIND_OPCODE_DO_BIND:
-						break;
-					case BIND_OPCODE_DO_BIND_ADD_ADDR_ULEB:
-						segOffset += read_uleb128(p, end) + sizeof(pint_t);
-						break;
-					case BIND_OPCODE_DO_BIND_ADD_ADDR_IMM_SCALED:
-						segOffset += immediate*sizeof(pint_t) + sizeof(pint_t);
-						break;
-					case BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB:
+				break;
+			case BIND_OPCODE_SET_TYPE_IMM:
+				break;
+			case BIND_OPCODE_SET_ADDEND_SLEB:
+				read_sleb128(p, end);
+				break;
+			case BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB:
+				segIndex = immediate;
+				segStartAddr = segStartAddress(segIndex);
+				segOffset = read_uleb128(p, end);
+				break;
+			case BIND_OPCODE_ADD_ADDR_ULEB:
+				segOffset += read_uleb128(p, end);
+				break;
+			case BIND_OPCODE_DO_BIND:
+				fBindingSites.push_back(segStartAddr+segOffset);
+				segOffset += sizeof(pint_t);
+				break;
+			case BIND_OPCODE_DO_BIND_ADD_ADDR_ULEB:
+				fBindingSites.push_back(segStartAddr+segOffset);
+				segOffset += read_uleb128(p, end) + sizeof(pint_t);
+				break;
+			case BIND_OPCODE_DO_BIND_ADD_ADDR_IMM_SCALED:
+				fBindingSites.push_back(segStartAddr+segOffset);
+				segOffset += immediate*sizeof(pint_t) + sizeof(pint_t);
+				break;
+			case BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB:
+				count = read_uleb128(p, end);
+				skip = read_uleb128(p, end);
+				for (uint32_t i=0; i < count; ++i) {
+					fBindingSites.push_back(segStartAddr+segOffset);
+					segOffset += skip + sizeof(pint_t);
+				}
+				break;
+			case BIND_OPCODE_THREADED:
+				// Note the immediate is a sub opcode
+				switch (immediate) {
+					case BIND_SUBOPCODE_THREADED_SET_BIND_ORDINAL_TABLE_SIZE_ULEB:
 						count = read_uleb128(p, end);
-						skip = read_uleb128(p, end);
-						for (uint32_t i=0; i < count; ++i) {
-							segOffset += skip + sizeof(pint_t);
-						}
 						break;
-					case BIND_OPCODE_THREADED:
-						// Note the immediate is a sub opcode
-						switch (immediate) {
-							case BIND_SUBOPCODE_THREADED_SET_BIND_ORDINAL_TABLE_SIZE_ULEB:
-								count = read_uleb128(p, end);
-								break;
-							case BIND_SUBOPCODE_THREADED_APPLY: {
-								uint64_t delta = 0;
-								do {
-									uint8_t* pointerLocation = (uint8_t*)fHeader + fSegments[segIndex]->fileoff() + segOffset;
-									uint64_t value = P::getP(*(uint64_t*)pointerLocation);
+					case BIND_SUBOPCODE_THREADED_APPLY: {
+						uint64_t delta = 0;
+						do {
+							uint8_t* pointerLocation = (uint8_t*)fHeader + fSegments[segIndex]->fileoff() + segOffset;
+							uint64_t value = P::getP(*(uint64_t*)pointerLocation);
 #if SUPPORT_ARCH_arm64e
-									bool isAuthenticated = (value & (1ULL << 63)) != 0;
+							bool isAuthenticated = (value & (1ULL << 63)) != 0;
 #endif
-									bool isRebase = (value & (1ULL << 62)) == 0;
-									if ( isRebase && ( (segStartAddr+segOffset) == targetAddr ) ) {
-
+							bool isRebase = (value & (1ULL << 62)) == 0;
+							if ( !isRebase ) {
+								fBindingSites.push_back(segStartAddr+segOffset);
+							}
+							else if ( threadedRebases ) {
+								uint64_t targetValue;
 #if SUPPORT_ARCH_arm64e
-										if (isAuthenticated) {
-											uint64_t targetValue = value & 0xFFFFFFFFULL;
-											targetValue += fBaseAddress;
-											pointeeAddr = (pint_t)targetValue;
-										} else
+								if (isAuthenticated) {
+									targetValue = value & 0xFFFFFFFFULL;
+									targetValue += fBaseAddress;
+								} else
 #endif
-										{
-											// Regular pointer which needs to fit in 51-bits of value.
-											// C++ RTTI uses the top bit, so we'll allow the whole top-byte
-											// and the signed-extended bottom 43-bits to be fit in to 51-bits.
-											uint64_t top8Bits = value & 0x0007F80000000000ULL;
-											uint64_t bottom43Bits = value & 0x000007FFFFFFFFFFULL;
-											uint64_t targetValue = ( top8Bits << 13 ) | (((intptr_t)(bottom43Bits << 21) >> 21) & 0x00FFFFFFFFFFFFFF);
-											pointeeAddr = (pint_t)targetValue;
-										}
-										return true;
-									}
-
-									// The delta is bits [51..61]
-									// And bit 62 is to tell us if we are a rebase (0) or bind (1)
-									value &= ~(1ULL << 62);
-									delta = ( value & 0x3FF8000000000000 ) >> 51;
-									segOffset += delta * sizeof(pint_t);
-								} while ( delta != 0 );
-								break;
+								{
+									// Regular pointer which needs to fit in 51-bits of value.
+									// C++ RTTI uses the top bit, so we'll allow the whole top-byte
+									// and the signed-extended bottom 43-bits to be fit in to 51-bits.
+									uint64_t top8Bits = value & 0x0007F80000000000ULL;
+									uint64_t bottom43Bits = value & 0x000007FFFFFFFFFFULL;
+									targetValue = ( top8Bits << 13 ) | (((intptr_t)(bottom43Bits << 21) >> 21) & 0x00FFFFFFFFFFFFFF);
+								}
+								fRebaseSites.push_back({ (pint_t)(segStartAddr+segOffset), (pint_t)targetValue, true });
 							}
-							default:
-								throwf("unknown threaded bind subopcode %d", immediate);
-						}
+
+							// The delta is bits [51..61]
+							// And bit 62 is to tell us if we are a rebase (0) or bind (1)
+							value &= ~(1ULL << 62);
+							delta = ( value & 0x3FF8000000000000 ) >> 51;
+							segOffset += delta * sizeof(pint_t);
+						} while ( delta != 0 );
 						break;
+					}
 					default:
-						throwf("bad bind opcode %d", *p);
+						throwf("unknown threaded bind subopcode %d", immediate);
 				}
-			}
+				break;
+			default:
+				throwf("bad bind opcode %d", *p);
 		}
 	}
-	return false;
 }
 
 template <typename A>
-bool MachOChecker<A>::addressIsBindingSite(pint_t targetAddr)
+void MachOChecker<A>::addChainedFixupSites()
 {
-	// look at external relocs
-	const macho_relocation_info<P>* const externRelocsEnd = &fExternalRelocations[fExternalRelocationsCount];
-	for (const macho_relocation_info<P>* reloc = fExternalRelocations; reloc < externRelocsEnd; ++reloc) {
-		pint_t relocAddress = reloc->r_address() + this->relocBase();
-		if ( relocAddress == targetAddr )
-			return true;
-	}	
-	// look bind info
-	if ( fDyldInfo != NULL ) {
-		const uint8_t* p = (uint8_t*)fHeader + fDyldInfo->bind_off();
-		const uint8_t* end = &p[fDyldInfo->bind_size()];
-		
-		uint8_t type = 0;
-		uint64_t segOffset = 0;
-		uint32_t count;
-		uint32_t skip;
-		const char* symbolName = NULL;
-		int libraryOrdinal = 0;
-		int segIndex;
-		int64_t addend = 0;
-		pint_t segStartAddr = 0;
-		bool done = false;
-		while ( !done && (p < end) ) {
-			uint8_t immediate = *p & BIND_IMMEDIATE_MASK;
-			uint8_t opcode = *p & BIND_OPCODE_MASK;
-			++p;
-			switch (opcode) {
-				case BIND_OPCODE_DONE:
-					done = true;
-					break;
-				case BIND_OPCODE_SET_DYLIB_ORDINAL_IMM:
-					libraryOrdinal = immediate;
-					break;
-				case BIND_OPCODE_SET_DYLIB_ORDINAL_ULEB:
-					libraryOrdinal = read_uleb128(p, end);
-					break;
-				case BIND_OPCODE_SET_DYLIB_SPECIAL_IMM:
-					// the special ordinals are negative numbers
-					if ( immediate == 0 )
-						libraryOrdinal = 0;
-					else {
-						int8_t signExtended = BIND_OPCODE_MASK | immediate;
-						libraryOrdinal = signExtended;
-					}
-					break;
-				case BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM:
-					symbolName = (char*)p;
-					while (*p != '\0')
-						++p;
-					++p;
-					break;
-				case BIND_OPCODE_SET_TYPE_IMM:
-					type = immediate;
-					break;
-				case BIND_OPCODE_SET_ADDEND_SLEB:
-					addend = read_sleb128(p, end);
-					break;
-				case BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB:
-					segIndex = immediate;
-					segStartAddr = segStartAddress(segIndex);
-					segOffset = read_uleb128(p, end);
-					break;
-				case BIND_OPCODE_ADD_ADDR_ULEB:
-					segOffset += read_uleb128(p, end);
-					break;
-				case BIND_OPCODE_DO_BIND:
-					if ( (segStartAddr+segOffset) == targetAddr )
-						return true;
-					segOffset += sizeof(pint_t);
-					break;
-				case BIND_OPCODE_DO_BIND_ADD_ADDR_ULEB:
-					if ( (segStartAddr+segOffset) == targetAddr )
-						return true;
-					segOffset += read_uleb128(p, end) + sizeof(pint_t);
-					break;
-				case BIND_OPCODE_DO_BIND_ADD_ADDR_IMM_SCALED:
-					if ( (segStartAddr+segOffset) == targetAddr )
-						return true;
-					segOffset += immediate*sizeof(pint_t) + sizeof(pint_t);
-					break;
-				case BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB:
-					count = read_uleb128(p, end);
-					skip = read_uleb128(p, end);
-					for (uint32_t i=0; i < count; ++i) {
-						if ( (segStartAddr+segOffset) == targetAddr )
-							return true;
-						segOffset += skip + sizeof(pint_t);
-					}
-					break;
-				case BIND_OPCODE_THREADED:
-					// Note the immediate is a sub opcode
-					switch (immediate) {
-						case BIND_SUBOPCODE_THREADED_SET_BIND_ORDINAL_TABLE_SIZE_ULEB:
-							count = read_uleb128(p, end);
-							break;
-						case BIND_SUBOPCODE_THREADED_APPLY: {
-							uint64_t delta = 0;
-							do {
-								uint8_t* pointerLocation = (uint8_t*)fHeader + fSegments[segIndex]->fileoff() + segOffset;
-								uint64_t value = P::getP(*(uint64_t*)pointerLocation);
-								bool isRebase = (value & (1ULL << 62)) == 0;
-								if (!isRebase) {
-									if ( (segStartAddr+segOffset) == targetAddr )
-										return true;
-								}
-
-								// The delta is bits [51..61]
-								// And bit 62 is to tell us if we are a rebase (0) or bind (1)
-								value &= ~(1ULL << 62);
-								delta = ( value & 0x3FF8000000000000 ) >> 51;
-								segOffset += delta * sizeof(pint_t);
-							} while ( delta != 0 );
-							break;
-						}
-						default:
-							throwf("unknown threaded bind subopcode %d", immediate);
-					}
-					break;
-				default:
-					throwf("bad bind opcode %d", *p);
-			}
-		}	
-	}
-	return false;
+	if ( (fChainedFixups->dataoff() + fChainedFixups->datasize()) > fLength )
+		throw "LC_DYLD_CHAINED_FIXUPS data extends beyond end of file";
+	mach_o::chained_fixups::forEachFixup<A>((uint8_t*)fHeader, (uint8_t*)fHeader + fChainedFixups->dataoff(), fChainedFixups->datasize(), fSegments, fBaseAddress,
+											  [&](uint32_t segIndex, uint64_t address, const mach_o::chained_fixups::Fixup& fixup) {
+		if ( fixup.isBind )
+			fBindingSites.push_back((pint_t)address);
+		else
+			fRebaseSites.push_back({ (pint_t)address, (pint_t)fixup.target, true });
+	});
 }
 
 
@@ -0,0 +1,496 @@
+#!/usr/bin/perl
+
+#
+# Generates a synthetic link of configurable size: mach-o object files, static
+# archives, and text-based dylib stubs, plus the linker arguments to link them.
+# Everything is written directly, so no compiler, assembler, or SDK is needed and
+# the inputs can be generated on any host.  Output is fully determined by the
+# options (including -seed), so runs are comparable over time.
+#
+# usage: gen-large-link.pl -o <dir> [options]
+#
+
+use strict;
+use Getopt::Long;
+use File::Path qw(mkpath);
+
+my %opt = (
+	'arch'					=> 'arm64',
+	'objects'				=> 200,		# object files linked directly
+	'functions'				=> 100,		# functions per object file
+	'calls'					=> 8,		# call fixups per function
+	'data-pointers'			=> 64,		# pointer fixups in __data per object file
+	'objc-classes'			=> 400,		# total ObjC classes, spread over the object files
+	'dylibs'				=> 20,		# text-based dylib stubs
+	'dylib-symbols'			=> 500,		# exported symbols per dylib
+	'archives'				=> 10,		# static archives
+	'archive-members'		=> 50,		# object files per archive
+	'seed'					=> 1,
+);
+my $outDir;
+
+GetOptions(
+	'o=s'					=> \$outDir,
+	'arch=s'				=> \$opt{'arch'},
+	'objects=i'				=> \$opt{'objects'},
+	'functions=i'			=> \$opt{'functions'},
+	'calls=i'				=> \$opt{'calls'},
+	'data-pointers=i'		=> \$opt{'data-pointers'},
+	'objc-classes=i'		=> \$opt{'objc-classes'},
+	'dylibs=i'				=> \$opt{'dylibs'},
+	'dylib-symbols=i'		=> \$opt{'dylib-symbols'},
+	'archives=i'			=> \$opt{'archives'},
+	'archive-members=i'		=> \$opt{'archive-members'},
+	'seed=i'				=> \$opt{'seed'},
+) or usage();
+usage() if ( !defined $outDir || $opt{'objects'} < 1 || $opt{'functions'} < 1 );
+
+my %archInfo = (
+	# cputype, cpusubtype
+	'arm64'		=> [ 0x0100000C, 0 ],
+	'x86_64'	=> [ 0x01000007, 3 ],
+);
+die "unsupported architecture '$opt{'arch'}', use arm64 or x86_64\n" if ( !exists $archInfo{$opt{'arch'}} );
+my ($cpuType, $cpuSubType) = @{$archInfo{$opt{'arch'}}};
+
+# mach-o constants used below
+my $MH_MAGIC_64				= 0xfeedfacf;
+my $MH_OBJECT				= 1;
+my $MH_SUBSECTIONS_VIA_SYMBOLS = 0x2000;
+my $LC_SEGMENT_64			= 0x19;
+my $LC_SYMTAB				= 0x2;
+my $LC_DYSYMTAB				= 0xB;
+my $LC_BUILD_VERSION		= 0x32;
+my $PLATFORM_MACOS			= 1;
+my $N_EXT					= 0x01;
+my $N_SECT					= 0x0e;
+my $S_CSTRING_LITERALS		= 0x2;
+my $S_ATTR_NO_DEAD_STRIP	= 0x10000000;
+my $S_ATTR_PURE_INSTRUCTIONS = 0x80000000;
+my $S_ATTR_SOME_INSTRUCTIONS = 0x00000400;
+my $RELOC_UNSIGNED			= 0;		# same value for ARM64_RELOC_UNSIGNED and X86_64_RELOC_UNSIGNED
+my $RELOC_BRANCH			= 2;		# same value for ARM64_RELOC_BRANCH26 and X86_64_RELOC_BRANCH
+
+# small deterministic generator, so output does not depend on the perl version
+my $rngState = ($opt{'seed'} * 2654435761 + 1) & 0xFFFFFFFF;
+$rngState = 1 if ( $rngState == 0 );
+sub random
+{
+	my ($limit) = @_;
+	$rngState ^= ($rngState << 13) & 0xFFFFFFFF;
+	$rngState ^= ($rngState >> 17);
+	$rngState ^= ($rngState << 5) & 0xFFFFFFFF;
+	return $rngState % $limit;
+}
+
+sub functionName	{ my ($obj, $i) = @_; return ($obj == 0 && $i == 0) ? "_main" : "_bench_o${obj}_f${i}"; }
+sub memberFunction	{ my ($a, $m, $i) = @_; return "_bench_a${a}_m${m}_f${i}"; }
+sub dylibSymbol		{ my ($d, $i) = @_; return "_bench_lib${d}_s${i}"; }
+
+# picks the target of a call made from object file $obj
+sub randomCallee
+{
+	my ($obj) = @_;
+	my $kind = random(10);
+	if ( $kind < 4 || ($opt{'dylibs'} == 0 && $opt{'archives'} == 0) ) {
+		# another function in the same file
+		return functionName($obj, random($opt{'functions'}));
+	}
+	elsif ( $kind < 7 ) {
+		# function in any object file
+		return functionName(random($opt{'objects'}), random($opt{'functions'}));
+	}
+	elsif ( $kind < 9 && $opt{'archives'} > 0 && $opt{'archive-members'} > 0 ) {
+		# function in an archive member, so resolver has to load members
+		return memberFunction(random($opt{'archives'}), random($opt{'archive-members'}), random($opt{'functions'}));
+	}
+	elsif ( $opt{'dylibs'} > 0 ) {
+		return dylibSymbol(random($opt{'dylibs'}), random($opt{'dylib-symbols'}));
+	}
+	return functionName($obj, random($opt{'functions'}));
+}
+
+
+#
+# Object file builder.  Sections are lists of bytes plus relocations.  A relocation
+# targets either a symbol by name (extern) or an offset in another section, whose
+# address is filled in once the file is laid out.
+#
+sub newObject
+{
+	return { 'sections' => [], 'sectionIndex' => {}, 'symbols' => [] };
+}
+
+sub section
+{
+	my ($obj, $seg, $sect, $align, $flags) = @_;
+	my $key = "$seg,$sect";
+	if ( !exists $obj->{'sectionIndex'}{$key} ) {
+		push(@{$obj->{'sections'}}, { 'seg' => $seg, 'sect' => $sect, 'align' => $align, 'flags' => $flags, 'data' => '', 'relocs' => [] });
+		$obj->{'sectionIndex'}{$key} = scalar(@{$obj->{'sections'}});	# 1-based, like n_sect
+	}
+	return $obj->{'sectionIndex'}{$key};
+}
+
+sub sectionData		{ my ($obj, $index) = @_; return \$obj->{'sections'}[$index-1]{'data'}; }
+
+sub defineSymbol
+{
+	my ($obj, $name, $sectIndex, $offset, $global) = @_;
+	push(@{$obj->{'symbols'}}, { 'name' => $name, 'sect' => $sectIndex, 'offset' => $offset, 'global' => $global });
+}
+
+# appends a pointer to symbol $name
+sub appendPointerToSymbol
+{
+	my ($obj, $sectIndex, $name) = @_;
+	my $data = sectionData($obj, $sectIndex);
+	push(@{$obj->{'sections'}[$sectIndex-1]{'relocs'}}, { 'offset' => length($$data), 'symbol' => $name, 'pcrel' => 0, 'length' => 3, 'type' => $RELOC_UNSIGNED });
+	$$data .= pack('Q<', 0);
+}
+
+# appends a pointer to offset $targetOffset in section $targetSect
+sub appendPointerToSection
+{
+	my ($obj, $sectIndex, $targetSect, $targetOffset) = @_;
+	my $data = sectionData($obj, $sectIndex);
+	push(@{$obj->{'sections'}[$sectIndex-1]{'relocs'}}, { 'offset' => length($$data), 'targetSect' => $targetSect, 'targetOffset' => $targetOffset, 'pcrel' => 0, 'length' => 3, 'type' => $RELOC_UNSIGNED });
+	$$data .= pack('Q<', 0);
+}
+
+# appends a C string, returns its offset
+sub appendString
+{
+	my ($obj, $sectIndex, $string) = @_;
+	my $data = sectionData($obj, $sectIndex);
+	my $offset = length($$data);
+	$$data .= $string . "\0";
+	return $offset;
+}
+
+sub appendFunction
+{
+	my ($obj, $textSect, $name, $global, @callees) = @_;
+	my $data = sectionData($obj, $textSect);
+	$$data .= "\0" x ((4 - (length($$data) % 4)) % 4);
+	defineSymbol($obj, $name, $textSect, length($$data), $global);
+	foreach my $callee (@callees) {
+		if ( $opt{'arch'} eq 'arm64' ) {
+			push(@{$obj->{'sections'}[$textSect-1]{'relocs'}}, { 'offset' => length($$data), 'symbol' => $callee, 'pcrel' => 1, 'length' => 2, 'type' => $RELOC_BRANCH });
+			$$data .= pack('V', 0x94000000);		# bl
+		}
+		else {
+			push(@{$obj->{'sections'}[$textSect-1]{'relocs'}}, { 'offset' => length($$data)+1, 'symbol' => $callee, 'pcrel' => 1, 'length' => 2, 'type' => $RELOC_BRANCH });
+			$$data .= pack('C V', 0xE8, 0);			# call
+		}
+	}
+	$$data .= ($opt{'arch'} eq 'arm64') ? pack('V', 0xD65F03C0) : pack('C', 0xC3);	# ret
+}
+
+# adds class $className (a subclass of NSObject with one instance method implemented by $imp)
+sub appendObjCClass
+{
+	my ($obj, $className, $imp) = @_;
+	my $classNames	= section($obj, '__TEXT', '__objc_classname', 0, $S_CSTRING_LITERALS);
+	my $methNames	= section($obj, '__TEXT', '__objc_methname', 0, $S_CSTRING_LITERALS);
+	my $methTypes	= section($obj, '__TEXT', '__objc_methtype', 0, $S_CSTRING_LITERALS);
+	my $const		= section($obj, '__DATA', '__objc_const', 3, 0);
+	my $classData	= section($obj, '__DATA', '__objc_data', 3, 0);
+	my $classList	= section($obj, '__DATA', '__objc_classlist', 3, $S_ATTR_NO_DEAD_STRIP);
+	my $imageInfo	= section($obj, '__DATA', '__objc_imageinfo', 2, $S_ATTR_NO_DEAD_STRIP);
+	my $imageInfoData = sectionData($obj, $imageInfo);
+	$$imageInfoData = pack('V V', 0, 64) if ( length($$imageInfoData) == 0 );
+
+	my $nameOffset = appendString($obj, $classNames, $className);
+	my $selOffset  = appendString($obj, $methNames, "benchMethod_$className");
+	my $typeOffset = appendString($obj, $methTypes, "v16\@0:8");
+
+	# method list
+	my $constData = sectionData($obj, $const);
+	my $methodListOffset = length($$constData);
+	defineSymbol($obj, "__OBJC_\$_INSTANCE_METHODS_$className", $const, $methodListOffset, 0);
+	$$constData .= pack('V V', 24, 1);
+	appendPointerToSection($obj, $const, $methNames, $selOffset);
+	appendPointerToSection($obj, $const, $methTypes, $typeOffset);
+	appendPointerToSymbol($obj, $const, $imp);
+
+	# class_ro_t for metaclass and class
+	my @roOffsets;
+	foreach my $meta (1, 0) {
+		my $roOffset = length($$constData);
+		push(@roOffsets, $roOffset);
+		defineSymbol($obj, ($meta ? "__OBJC_METACLASS_RO_\$_" : "__OBJC_CLASS_RO_\$_") . $className, $const, $roOffset, 0);
+		$$constData .= pack('V V V V Q<', $meta, ($meta ? 40 : 8), ($meta ? 40 : 8), 0, 0);
+		appendPointerToSection($obj, $const, $classNames, $nameOffset);
+		if ( $meta ) {
+			$$constData .= pack('Q<', 0);
+		}
+		else {
+			appendPointerToSection($obj, $const, $const, $methodListOffset);
+		}
+		$$constData .= pack('Q< Q< Q< Q<', 0, 0, 0, 0);
+	}
+
+	# class_t for metaclass and class
+	my $data = sectionData($obj, $classData);
+	defineSymbol($obj, "_OBJC_METACLASS_\$_$className", $classData, length($$data), 1);
+	appendPointerToSymbol($obj, $classData, "_OBJC_METACLASS_\$_NSObject");
+	appendPointerToSymbol($obj, $classData, "_OBJC_METACLASS_\$_NSObject");
+	appendPointerToSymbol($obj, $classData, "__objc_empty_cache");
+	$$data .= pack('Q<', 0);
+	appendPointerToSection($obj, $classData, $const, $roOffsets[0]);
+	defineSymbol($obj, "_OBJC_CLASS_\$_$className", $classData, length($$data), 1);
+	appendPointerToSymbol($obj, $classData, "_OBJC_METACLASS_\$_$className");
+	appendPointerToSymbol($obj, $classData, "_OBJC_CLASS_\$_NSObject");
+	appendPointerToSymbol($obj, $classData, "__objc_empty_cache");
+	$$data .= pack('Q<', 0);
+	appendPointerToSection($obj, $classData, $const, $roOffsets[1]);
+
+	appendPointerToSymbol($obj, $classList, "_OBJC_CLASS_\$_$className");
+}
+
+sub align
+{
+	my ($value, $alignment) = @_;
+	return ($value + $alignment - 1) & ~($alignment - 1);
+}
+
+# lays out the object file and returns its bytes
+sub objectFileContent
+{
+	my ($obj) = @_;
+	my @sections = @{$obj->{'sections'}};
+	my $loadCommandsSize = (72 + 80*scalar(@sections)) + 24 + 24 + 80;
+
+	# assign section addresses, file offsets equal addresses plus the header size
+	my $dataStart = 32 + $loadCommandsSize;
+	my $address = 0;
+	foreach my $sect (@sections) {
+		$address = align($address, 1 << $sect->{'align'});
+		$sect->{'addr'} = $address;
+		$address += length($sect->{'data'});
+	}
+	my $segmentSize = $address;
+
+	# symbol table: locals, then external definitions, then undefined symbols, each group sorted by name
+	my %defined;
+	$defined{$_->{'name'}} = $_ foreach @{$obj->{'symbols'}};
+	my %undefined;
+	foreach my $sect (@sections) {
+		foreach my $reloc (@{$sect->{'relocs'}}) {
+			$undefined{$reloc->{'symbol'}} = 1 if ( exists $reloc->{'symbol'} && !exists $defined{$reloc->{'symbol'}} );
+		}
+	}
+	my @locals	= sort { $a->{'name'} cmp $b->{'name'} } grep { !$_->{'global'} } @{$obj->{'symbols'}};
+	my @globals	= sort { $a->{'name'} cmp $b->{'name'} } grep { $_->{'global'} } @{$obj->{'symbols'}};
+	my @undefs	= sort keys %undefined;
+	my %symbolIndex;
+	my $strings = "\0";
+	my $symbols = '';
+	foreach my $sym (@locals, @globals) {
+		$symbolIndex{$sym->{'name'}} = scalar(keys %symbolIndex);
+		$symbols .= pack('V C C v Q<', length($strings), $N_SECT | ($sym->{'global'} ? $N_EXT : 0), $sym->{'sect'}, 0,
+						 $sections[$sym->{'sect'}-1]{'addr'} + $sym->{'offset'});
+		$strings .= $sym->{'name'} . "\0";
+	}
+	foreach my $name (@undefs) {
+		$symbolIndex{$name} = scalar(keys %symbolIndex);
+		$symbols .= pack('V C C v Q<', length($strings), $N_EXT, 0, 0, 0);
+		$strings .= $name . "\0";
+	}
+	$strings .= "\0" x ((8 - (length($strings) % 8)) % 8);
+
+	# section content with addresses of section relative pointers filled in, followed by relocations
+	my $content = '';
+	my $relocContent = '';
+	my $relocStart = align($dataStart + $segmentSize, 8);
+	foreach my $sect (@sections) {
+		my $data = $sect->{'data'};
+		$sect->{'reloff'} = $relocStart + length($relocContent);
+		# relocations are listed in reverse address order, like the assembler does
+		foreach my $reloc (reverse @{$sect->{'relocs'}}) {
+			my ($symbolNum, $extern);
+			if ( exists $reloc->{'symbol'} ) {
+				$symbolNum = $symbolIndex{$reloc->{'symbol'}};
+				$extern = 1;
+			}
+			else {
+				$symbolNum = $reloc->{'targetSect'};
+				$extern = 0;
+				substr($data, $reloc->{'offset'}, 8) = pack('Q<', $sections[$reloc->{'targetSect'}-1]{'addr'} + $reloc->{'targetOffset'});
+			}
+			$relocContent .= pack('l< V', $reloc->{'offset'},
+								  $symbolNum | ($reloc->{'pcrel'} << 24) | ($reloc->{'length'} << 25) | ($extern << 27) | ($reloc->{'type'} << 28));
+		}
+		$content .= "\0" x ($sect->{'addr'} - length($content));
+		$content .= $data;
+	}
+	my $symbolStart = $relocStart + length($relocContent);
+	my $stringStart = $symbolStart + length($symbols);
+
+	# mach_header_64 and load commands
+	my $header = pack('V V V V V V V V', $MH_MAGIC_64, $cpuType, $cpuSubType, $MH_OBJECT, 4, $loadCommandsSize, $MH_SUBSECTIONS_VIA_SYMBOLS, 0);
+	$header .= pack('V V a16 Q< Q< Q< Q< V V V V', $LC_SEGMENT_64, 72 + 80*scalar(@sections), '', 0, $segmentSize,
+					$dataStart, $segmentSize, 7, 7, scalar(@sections), 0);
+	foreach my $sect (@sections) {
+		$header .= pack('a16 a16 Q< Q< V V V V V V V V', $sect->{'sect'}, $sect->{'seg'}, $sect->{'addr'}, length($sect->{'data'}),
+						$dataStart + $sect->{'addr'}, $sect->{'align'}, (@{$sect->{'relocs'}} ? $sect->{'reloff'} : 0),
+						scalar(@{$sect->{'relocs'}}), $sect->{'flags'}, 0, 0, 0);
+	}
+	$header .= pack('V V V V V V', $LC_BUILD_VERSION, 24, $PLATFORM_MACOS, 0x000B0000, 0x000B0000, 0);
+	$header .= pack('V V V V V V', $LC_SYMTAB, 24, $symbolStart, scalar(@locals)+scalar(@globals)+scalar(@undefs), $stringStart, length($strings));
+	$header .= pack('V V V V V V V V', $LC_DYSYMTAB, 80, 0, scalar(@locals), scalar(@locals), scalar(@globals),
+					scalar(@locals)+scalar(@globals), scalar(@undefs)) . ("\0" x 48);
+
+	my $result = $header . $content;
+	$result .= "\0" x ($relocStart - length($result));
+	return $result . $relocContent . $symbols . $strings;
+}
+
+sub writeFile
+{
+	my ($path, $content) = @_;
+	open(my $fh, '>', $path) or die "can't create $path: $!\n";
+	binmode($fh);
+	print $fh $content;
+	close($fh) or die "can't write $path: $!\n";
+}
+
+# BSD archive with a sorted table of contents.  Members are (name, content, [defined symbols]).
+sub archiveContent
+{
+	my (@members) = @_;
+	my $memberHeader = sub {
+		my ($name, $size) = @_;
+		# long names follow the header, padded so member content stays 8-byte aligned
+		my $paddedName = $name . ("\0" x (((4 - length($name)) % 8 + 8) % 8));
+		return (sprintf("%-16s%-12s%-6s%-6s%-8s%-10s`\n", "#1/" . length($paddedName), 0, 0, 0, 100644, length($paddedName) + $size) . $paddedName);
+	};
+	my @toc;
+	foreach my $index (0 .. $#members) {
+		push(@toc, [ $_, $index ]) foreach @{$members[$index][2]};
+	}
+	@toc = sort { $a->[0] cmp $b->[0] } @toc;
+	my $tocStrings = '';
+	my @tocStringOffsets;
+	foreach my $entry (@toc) {
+		push(@tocStringOffsets, length($tocStrings));
+		$tocStrings .= $entry->[0] . "\0";
+	}
+	$tocStrings .= "\0" x ((8 - (length($tocStrings) % 8)) % 8);
+	my $tocSize = 4 + 8*scalar(@toc) + 4 + length($tocStrings);
+
+	# member offsets, needed by the table of contents
+	my @memberOffsets;
+	my $offset = 8 + length($memberHeader->("__.SYMDEF SORTED", $tocSize)) + $tocSize;
+	foreach my $member (@members) {
+		push(@memberOffsets, $offset);
+		$offset += length($memberHeader->($member->[0], length($member->[1]))) + align(length($member->[1]), 8);
+	}
+
+	my $toc = pack('V', 8*scalar(@toc));
+	foreach my $i (0 .. $#toc) {
+		$toc .= pack('V V', $tocStringOffsets[$i], $memberOffsets[$toc[$i][1]]);
+	}
+	$toc .= pack('V', length($tocStrings)) . $tocStrings;
+	my $result = "!<arch>\n" . $memberHeader->("__.SYMDEF SORTED", $tocSize) . $toc;
+	foreach my $member (@members) {
+		$result .= $memberHeader->($member->[0], length($member->[1])) . $member->[1];
+		$result .= "\0" x ((8 - (length($member->[1]) % 8)) % 8);
+	}
+	return $result;
+}
+
+sub tbdContent
+{
+	my ($installName, $symbols, $objcClasses) = @_;
+	my $target = "$opt{'arch'}-macos";
+	my $result = "--- !tapi-tbd\ntbd-version:     4\ntargets:         [ $target ]\n";
+	$result .= "install-name:    '$installName'\ncurrent-version: 1\ncompatibility-version: 1\nexports:\n";
+	$result .= "  - targets:         [ $target ]\n";
+	$result .= "    symbols:         [ " . join(", ", @$symbols) . " ]\n" if ( @$symbols );
+	$result .= "    objc-classes:    [ " . join(", ", @$objcClasses) . " ]\n" if ( @$objcClasses );
+	return $result . "...\n";
+}
+
+
+mkpath(["$outDir/obj", "$outDir/lib"]);
+
+# dylib stubs, including the few system symbols the generated code needs
+writeFile("$outDir/lib/libSystem.tbd", tbdContent('/usr/lib/libSystem.B.dylib', [ 'dyld_stub_binder' ], []));
+writeFile("$outDir/lib/libobjc.tbd", tbdContent('/usr/lib/libobjc.A.dylib', [ '__objc_empty_cache' ], [ 'NSObject' ]));
+foreach my $d (0 .. $opt{'dylibs'}-1) {
+	my @symbols = map { dylibSymbol($d, $_) } (0 .. $opt{'dylib-symbols'}-1);
+	writeFile("$outDir/lib/libbench$d.tbd", tbdContent("/usr/lib/libbench$d.dylib", \@symbols, []));
+}
+
+# object files linked directly
+my @objectPaths;
+foreach my $o (0 .. $opt{'objects'}-1) {
+	my $obj = newObject();
+	my $text = section($obj, '__TEXT', '__text', 2, $S_ATTR_PURE_INSTRUCTIONS | $S_ATTR_SOME_INSTRUCTIONS);
+	foreach my $f (0 .. $opt{'functions'}-1) {
+		appendFunction($obj, $text, functionName($o, $f), 1, map { randomCallee($o) } (1 .. $opt{'calls'}));
+	}
+	if ( $opt{'data-pointers'} > 0 ) {
+		my $data = section($obj, '__DATA', '__data', 3, 0);
+		defineSymbol($obj, "_bench_o${o}_table", $data, 0, 1);
+		appendPointerToSymbol($obj, $data, randomCallee($o)) foreach (1 .. $opt{'data-pointers'});
+	}
+	for (my $c = $o; $c < $opt{'objc-classes'}; $c += $opt{'objects'}) {
+		appendObjCClass($obj, "BenchClass$c", functionName($o, random($opt{'functions'})));
+	}
+	my $path = "$outDir/obj/bench$o.o";
+	writeFile($path, objectFileContent($obj));
+	push(@objectPaths, $path);
+}
+
+# archives, whose members only call into themselves and the dylibs
+my @archivePaths;
+foreach my $a (0 .. $opt{'archives'}-1) {
+	my @members;
+	foreach my $m (0 .. $opt{'archive-members'}-1) {
+		my $obj = newObject();
+		my $text = section($obj, '__TEXT', '__text', 2, $S_ATTR_PURE_INSTRUCTIONS | $S_ATTR_SOME_INSTRUCTIONS);
+		my @defined;
+		foreach my $f (0 .. $opt{'functions'}-1) {
+			my @callees;
+			foreach (1 .. $opt{'calls'}) {
+				if ( $opt{'dylibs'} > 0 && random(2) == 0 ) {
+					push(@callees, dylibSymbol(random($opt{'dylibs'}), random($opt{'dylib-symbols'})));
+				}
+				else {
+					push(@callees, memberFunction($a, $m, random($opt{'functions'})));
+				}
+			}
+			appendFunction($obj, $text, memberFunction($a, $m, $f), 1, @callees);
+			push(@defined, memberFunction($a, $m, $f));
+		}
+		push(@members, [ "member$m.o", objectFileContent($obj), \@defined ]);
+	}
+	my $path = "$outDir/lib/libbencharchive$a.a";
+	writeFile($path, archiveContent(@members));
+	push(@archivePaths, $path);
+}
+
+# linker arguments, one per line, for run-large-link.pl
+writeFile("$outDir/objects.filelist", join("\n", @objectPaths) . "\n");
+my @args = ('-arch', $opt{'arch'}, '-platform_version', 'macos', '11.0', '11.0', '-Z', "-L$outDir/lib",
+			'-filelist', "$outDir/objects.filelist", '-o', "$outDir/a.out");
+push(@args, $_) foreach @archivePaths;
+push(@args, "-lbench$_") foreach (0 .. $opt{'dylibs'}-1);
+push(@args, '-lobjc', '-lSystem');
+writeFile("$outDir/link.args", join("\n", @args) . "\n");
+
+# record how the inputs were made, so results can be compared like with like
+writeFile("$outDir/scale.txt", join("", map { "$_=$opt{$_}\n" } sort keys %opt));
+exit 0;
+
+
+sub usage
+{
+	print STDERR "usage: gen-large-link.pl -o <dir> [-arch arm64|x86_64] [-objects N] [-functions N] [-calls N]\n";
+	print STDERR "                         [-data-pointers N] [-objc-classes N] [-dylibs N] [-dylib-symbols N]\n";
+	print STDERR "                         [-archives N] [-archive-members N] [-seed N]\n";
+	exit 1;
+}
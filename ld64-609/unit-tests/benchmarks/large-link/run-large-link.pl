@@ -0,0 +1,110 @@
+#!/usr/bin/perl
+
+#
+# Links the inputs made by gen-large-link.pl and reports the linker's per-phase
+# times (from -print_statistics), wall time, and peak memory.  With -repeat the
+# median of each value is reported.  With -results a line is appended to a
+# tab separated file, so a series of runs can be compared to find regressions.
+#
+# usage: run-large-link.pl -ld <path> -inputs <dir> [-repeat N] [-results <file>] [-label <text>] [-- <extra ld args>]
+#
+
+use strict;
+use Getopt::Long;
+use Time::HiRes qw(time);
+use POSIX qw(strftime);
+
+my $ld = 'ld';
+my $inputs;
+my $repeat = 3;
+my $resultsPath;
+my $label = '';
+GetOptions(
+	'ld=s'		=> \$ld,
+	'inputs=s'	=> \$inputs,
+	'repeat=i'	=> \$repeat,
+	'results=s'	=> \$resultsPath,
+	'label=s'	=> \$label,
+) or usage();
+usage() if ( !defined $inputs || $repeat < 1 );
+my @extraArgs = @ARGV;
+
+open(my $argsFile, '<', "$inputs/link.args") or die "can't read $inputs/link.args: $!\n";
+my @args = map { chomp; $_ } grep { /\S/ } <$argsFile>;
+close($argsFile);
+
+# phases in the order -print_statistics prints them
+my @phases = ('ld total time', 'option parsing time', 'object file processing', 'resolve symbols',
+			  'build atom list', 'passess', 'write output');
+my %samples;
+
+foreach my $run (1 .. $repeat) {
+	my $start = time();
+	my $output = `'$ld' @{[ map { "'$_'" } (@args, @extraArgs) ]} -print_statistics 2>&1`;
+	my $wall = time() - $start;
+	if ( $? != 0 ) {
+		print STDERR $output;
+		die "link failed\n";
+	}
+	push(@{$samples{'wall time'}}, $wall * 1000);
+	foreach my $line (split(/\n/, $output)) {
+		if ( $line =~ /^\s*(.+?):\s+([\d.]+) (milliseconds|seconds)/ ) {
+			push(@{$samples{$1}}, ($3 eq 'seconds') ? $2 * 1000 : $2);
+		}
+		elsif ( $line =~ /^peak memory footprint\s+totaling\s+([\d,]+) bytes/ ) {
+			(my $bytes = $1) =~ s/,//g;
+			push(@{$samples{'peak memory'}}, $bytes);
+		}
+		elsif ( $line =~ /^wrote output file\s+totaling\s+([\d,]+) bytes/ ) {
+			(my $bytes = $1) =~ s/,//g;
+			push(@{$samples{'output size'}}, $bytes);
+		}
+	}
+}
+
+sub median
+{
+	my @sorted = sort { $a <=> $b } @_;
+	return undef if ( !@sorted );
+	return $sorted[$#sorted / 2] if ( @sorted % 2 );
+	return ($sorted[@sorted/2 - 1] + $sorted[@sorted/2]) / 2;
+}
+
+my @columns = ('wall time', @phases, 'peak memory', 'output size');
+my %result;
+foreach my $column (@columns) {
+	$result{$column} = median(@{$samples{$column} || []});
+}
+
+printf("%-24s %12s\n", "median of $repeat", '');
+foreach my $column (@columns) {
+	next if ( !defined $result{$column} );
+	if ( $column eq 'peak memory' || $column eq 'output size' ) {
+		printf("%24s: %12.1f MB\n", $column, $result{$column} / (1024*1024));
+	}
+	else {
+		printf("%24s: %12.1f ms\n", $column, $result{$column});
+	}
+}
+
+if ( defined $resultsPath ) {
+	my $newFile = ! -e $resultsPath;
+	open(my $results, '>>', $resultsPath) or die "can't append to $resultsPath: $!\n";
+	print $results join("\t", 'date', 'label', 'scale', @columns) . "\n" if ( $newFile );
+	my $scale = '';
+	if ( open(my $scaleFile, '<', "$inputs/scale.txt") ) {
+		$scale = join(',', map { chomp; $_ } <$scaleFile>);
+		close($scaleFile);
+	}
+	print $results join("\t", strftime("%Y-%m-%d %H:%M:%S", localtime()), $label, $scale,
+						map { defined $result{$_} ? $result{$_} : '' } @columns) . "\n";
+	close($results);
+}
+exit 0;
+
+
+sub usage
+{
+	print STDERR "usage: run-large-link.pl -ld <path> -inputs <dir> [-repeat N] [-results <file>] [-label <text>] [-- <extra ld args>]\n";
+	exit 1;
+}
@@ -0,0 +1,46 @@
+#!/usr/bin/perl -w
+
+#
+# Usage: check-rebases.pl <dyldinfo> <image>
+#
+# Checks that "dyldinfo -rebase" reports exactly the addresses of the
+# _p<n> and _last pointers, each pointing at _a or _b.
+#
+
+use strict;
+
+my ($dyldinfo, $image) = @ARGV;
+
+my %symbols;
+foreach my $line (`nm $image`) {
+	if ( $line =~ /^([0-9a-fA-F]+)\s+\S\s+(_\w+)$/ ) {
+		$symbols{$2} = hex($1);
+	}
+}
+my %targets = map { $symbols{$_} => 1 } grep { exists $symbols{$_} } ('_a', '_b');
+my %expected = map { $symbols{$_} => $_ } grep { /^_p\d+$/ || ($_ eq '_last') } keys %symbols;
+die "$image: missing symbols\n" if ( (keys %targets != 2) || (keys %expected != 17) );
+
+my $errors = 0;
+my %found;
+foreach my $line (`$dyldinfo -rebase $image`) {
+	next if ( $line !~ /\s0x([0-9A-F]+)\s+pointer\s+0x([0-9A-F]+)/ );
+	my ($address, $value) = (hex($1), hex($2));
+	if ( !exists $expected{$address} ) {
+		printf("unexpected rebase at 0x%X\n", $address);
+		++$errors;
+		next;
+	}
+	if ( !exists $targets{$value} ) {
+		printf("rebase of %s points to 0x%X\n", $expected{$address}, $value);
+		++$errors;
+	}
+	$found{$address} = 1;
+}
+foreach my $address (keys %expected) {
+	if ( !exists $found{$address} ) {
+		printf("no rebase for %s\n", $expected{$address});
+		++$errors;
+	}
+}
+exit($errors ? 1 : 0);
@@ -0,0 +1,27 @@
+int a = 1;
+int b = 2;
+
+// Pointers are further apart than a 32-bit chain can step (31 * 4 bytes).
+// The Makefile links this as a shared region eligible dylib, where ld may
+// not chain through the pad bytes, so each pointer starts a new chain and
+// every page lists several starts.
+#define POINTER(n, target)	void* p##n = &target; char pad##n[200] = { n };
+
+POINTER(0, a)
+POINTER(1, b)
+POINTER(2, a)
+POINTER(3, b)
+POINTER(4, a)
+POINTER(5, b)
+POINTER(6, a)
+POINTER(7, b)
+POINTER(8, a)
+POINTER(9, b)
+POINTER(10, a)
+POINTER(11, b)
+POINTER(12, a)
+POINTER(13, b)
+POINTER(14, a)
+POINTER(15, b)
+
+void* last = &b;
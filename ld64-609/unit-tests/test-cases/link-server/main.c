@@ -0,0 +1,7 @@
+extern void bar();
+
+int main()
+{
+	bar();
+	return 0;
+}
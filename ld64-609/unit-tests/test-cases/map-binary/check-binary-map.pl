@@ -0,0 +1,74 @@
+#!/usr/bin/perl -w
+
+#
+# Usage: check-binary-map.pl <image> <binary map>
+#
+# Parses a -map_binary file using the layout in BinaryMap.h.  Checks that
+# every array is 8-byte aligned, that every global symbol in <image> has an
+# atom at the same address in a section that contains it, and that _unused
+# is listed as dead stripped.
+#
+
+use strict;
+
+my ($image, $mapPath) = @ARGV;
+
+open(my $fh, '<:raw', $mapPath) or die "cannot open $mapPath\n";
+my $map = do { local $/; <$fh> };
+close($fh);
+
+my $errors = 0;
+sub fail { print "$mapPath: $_[0]\n"; ++$errors; }
+
+# struct binary_map_header
+my ($magic, $version, $cputype, $outputPathOffset, $fileCount, $sectionCount, $atomCount,
+	$filesOffset, $sectionsOffset, $addressesOffset, $sizesOffset, $nameOffsetsOffset,
+	$sectionIndexesOffset, $fileIndexesOffset, $stringsOffset, $stringsSize) = unpack("a8 L L Q L L Q Q Q Q Q Q Q Q Q Q", $map);
+die "$mapPath: bad magic\n" if ( $magic ne "ld64map\0" );
+die "$mapPath: bad version $version\n" if ( $version != 1 );
+fail("strings do not end the file") if ( $stringsOffset + $stringsSize != length($map) );
+foreach my $offset ($filesOffset, $sectionsOffset, $addressesOffset, $sizesOffset, $nameOffsetsOffset,
+					$sectionIndexesOffset, $fileIndexesOffset, $stringsOffset) {
+	fail(sprintf("array at 0x%X is not 8-byte aligned", $offset)) if ( ($offset % 8) != 0 );
+}
+
+sub string { my $start = $stringsOffset + $_[0]; return substr($map, $start, index($map, "\0", $start) - $start); }
+fail("output path is " . string($outputPathOffset)) if ( string($outputPathOffset) !~ /\Q$image\E$/ );
+
+my @sections;
+for (my $i = 0; $i < $sectionCount; ++$i) {
+	my ($address, $size) = unpack("Q Q", substr($map, $sectionsOffset + $i*32, 16));
+	push(@sections, [$address, $size]);
+}
+my @addresses		= unpack("Q$atomCount", substr($map, $addressesOffset, 8*$atomCount));
+my @nameOffsets		= unpack("Q$atomCount", substr($map, $nameOffsetsOffset, 8*$atomCount));
+my @sectionIndexes	= unpack("L$atomCount", substr($map, $sectionIndexesOffset, 4*$atomCount));
+my @fileIndexes		= unpack("L$atomCount", substr($map, $fileIndexesOffset, 4*$atomCount));
+my %atoms;
+for (my $i = 0; $i < $atomCount; ++$i) {
+	fail("atom $i has file index $fileIndexes[$i]") if ( $fileIndexes[$i] >= $fileCount );
+	$atoms{string($nameOffsets[$i])} = [$addresses[$i], $sectionIndexes[$i]];
+}
+
+foreach my $line (`nm -g $image`) {
+	next if ( $line !~ /^([0-9a-fA-F]+)\s+[TDS]\s+(_\w+)$/ );
+	my ($address, $name) = (hex($1), $2);
+	if ( !exists $atoms{$name} ) {
+		fail("no atom for $name");
+		next;
+	}
+	my ($atomAddress, $sectionIndex) = @{$atoms{$name}};
+	fail(sprintf("$name at 0x%X, map says 0x%X", $address, $atomAddress)) if ( $atomAddress != $address );
+	if ( $sectionIndex >= $sectionCount ) {
+		fail("$name has section index $sectionIndex");
+		next;
+	}
+	my ($sectionAddress, $sectionSize) = @{$sections[$sectionIndex]};
+	fail("$name is not in its section") if ( ($address < $sectionAddress) || ($address >= $sectionAddress + $sectionSize) );
+}
+
+if ( !exists $atoms{'_unused'} || ($atoms{'_unused'}[1] != 0xFFFFFFFF) ) {
+	fail("_unused is not listed as dead stripped");
+}
+
+exit($errors ? 1 : 0);
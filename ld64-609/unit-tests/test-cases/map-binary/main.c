@@ -0,0 +1,28 @@
+#include <stdio.h>
+
+int counter = 1;
+
+void unused(void)
+{
+	printf("never called\n");
+}
+
+int foo(int x)
+{
+	return x + counter;
+}
+
+#if EXTRA
+int bar(int x)
+{
+	return x * 2;
+}
+#endif
+
+int main()
+{
+#if EXTRA
+	counter = bar(counter);
+#endif
+	return foo(counter);
+}
@@ -0,0 +1,23 @@
+#!/usr/bin/perl -w
+
+#
+# Usage: gen-atoms.pl <count>
+#
+# Writes C source for <count> data atoms, cycling through __DATA,__one,
+# __DATA,__two, __DATA,__three and the default __DATA,__data so that
+# neighbouring atoms land in different input sections.
+#
+
+use strict;
+
+my $count = shift @ARGV;
+my @sections = ('one', 'two', 'three', '');
+for (my $i = 0; $i < $count; ++$i) {
+	my $section = $sections[$i % @sections];
+	if ( $section eq '' ) {
+		print "int data_$i = $i;\n";
+	}
+	else {
+		print "int ${section}_$i __attribute__((section(\"__DATA,__$section\"))) = $i;\n";
+	}
+}